@@ -1623,156 +1623,6 @@ void uvg_encode_alf_adaptive_parameter_set(encoder_state_t * const state)
 
 //-------------------------CC ALF encoding functions------------------------
 
-static void filter_blk_cc_alf(encoder_state_t * const state,
-  uvg_pixel *dst_buf, const uvg_pixel *rec_src,
-  const int rec_luma_stride,
-  const alf_component_id comp_id, const int16_t *filter_coeff,
-  const clp_rngs clp_rngs, int vb_ctu_height, int vb_pos,
-  const int x_pos, const int y_pos,
-  const int blk_width,
-  const int blk_height)
-{
-
-  assert(!(1 << uvg_math_floor_log2(vb_ctu_height) != vb_ctu_height)); //Not a power of 2
-
-  assert(comp_id != COMPONENT_Y); //Must be chroma
-
-  enum uvg_chroma_format chroma_format = state->encoder_control->chroma_format;
-  uint8_t scale_y = (comp_id == COMPONENT_Y || chroma_format != UVG_CSP_420) ? 0 : 1;
-  uint8_t scale_x = (comp_id == COMPONENT_Y || chroma_format == UVG_CSP_444) ? 0 : 1;
-  const int cls_size_y = 4;
-  const int cls_size_x = 4;
-  const int start_height = y_pos;
-  const int end_height = y_pos + blk_height;
-  const int start_width = x_pos;
-  const int end_width = x_pos + blk_width;
-  const int luma_start_height = start_height << scale_y;
-  const int luma_start_width = start_width << scale_x;
-
-  assert(!(start_height % cls_size_y)); //Wrong start_height in filtering
-  assert(!(start_width % cls_size_x)); //Wrong start_width in filtering
-  assert(!((end_height - start_height) % cls_size_y)); //Wrong end_height in filtering
-  assert(!((end_width - start_width) % cls_size_x)); //Wrong end_width in filtering
-
-  const uvg_pixel* src_buf = rec_src;
-  const uvg_pixel* luma_ptr = src_buf + luma_start_height * rec_luma_stride + luma_start_width;
-
-  const int chroma_stride = rec_luma_stride >> scale_x;
-  uvg_pixel* chroma_ptr = dst_buf + start_height * chroma_stride + start_width;
-
-  for (int i = 0; i < end_height - start_height; i += cls_size_y)
-  {
-    for (int j = 0; j < end_width - start_width; j += cls_size_x)
-    {
-      for (int ii = 0; ii < cls_size_y; ii++)
-      {
-        int row = ii;
-        int col = j;
-        uvg_pixel *src_self = chroma_ptr + col + row * chroma_stride;
-
-        int offset1 = rec_luma_stride;
-        int offset2 = -rec_luma_stride;
-        int offset3 = 2 * rec_luma_stride;
-        row <<= scale_y;
-        col <<= scale_x;
-        const uvg_pixel *src_cross = luma_ptr + col + row * rec_luma_stride;
-
-        int pos = ((start_height + i + ii) << scale_y) & (vb_ctu_height - 1);
-        if (scale_y == 0 && (pos == vb_pos || pos == vb_pos + 1))
-        {
-          continue;
-        }
-        if (pos == (vb_pos - 2) || pos == (vb_pos + 1))
-        {
-          offset3 = offset1;
-        }
-        else if (pos == (vb_pos - 1) || pos == vb_pos)
-        {
-          offset1 = 0;
-          offset2 = 0;
-          offset3 = 0;
-        }
-
-        for (int jj = 0; jj < cls_size_x; jj++)
-        {
-          const int jj2 = (jj << scale_x);
-          const int offset0 = 0;
-
-          int sum = 0;
-          const uvg_pixel curr_src_cross = src_cross[offset0 + jj2];
-          sum += filter_coeff[0] * (src_cross[offset2 + jj2] - curr_src_cross);
-          sum += filter_coeff[1] * (src_cross[offset0 + jj2 - 1] - curr_src_cross);
-          sum += filter_coeff[2] * (src_cross[offset0 + jj2 + 1] - curr_src_cross);
-          sum += filter_coeff[3] * (src_cross[offset1 + jj2 - 1] - curr_src_cross);
-          sum += filter_coeff[4] * (src_cross[offset1 + jj2] - curr_src_cross);
-          sum += filter_coeff[5] * (src_cross[offset1 + jj2 + 1] - curr_src_cross);
-          sum += filter_coeff[6] * (src_cross[offset3 + jj2] - curr_src_cross);
-
-          sum = (sum + ((1 << 7/*m_scaleBits*/) >> 1)) >> 7/*m_scaleBits*/;
-          const int offset = 1 << clp_rngs.comp[comp_id].bd >> 1;
-          sum = uvg_fast_clip_32bit_to_pixel(sum + offset) - offset;
-          sum += src_self[jj];
-          src_self[jj] = uvg_fast_clip_32bit_to_pixel(sum);
-        }
-      }
-    }
-
-    chroma_ptr += chroma_stride * cls_size_y;
-
-    luma_ptr += rec_luma_stride * cls_size_y << scale_y;
-  }
-}
-
-static void apply_cc_alf_filter(encoder_state_t * const state, alf_component_id comp_id, uvg_pixel *dst_buf,
-  const uvg_pixel *rec_yuv_ext, const int luma_stride, uint8_t *filter_control,
-  const short filter_set[MAX_NUM_CC_ALF_FILTERS][MAX_NUM_CC_ALF_CHROMA_COEFF],
-  const int   selected_filter_idx,
-  array_variables *arr_vars)
-{
-  enum uvg_chroma_format chroma_format = state->encoder_control->chroma_format;
-  uint8_t component_scale_y = (comp_id == COMPONENT_Y || chroma_format != UVG_CSP_420) ? 0 : 1;
-  uint8_t component_scale_x = (comp_id == COMPONENT_Y || chroma_format == UVG_CSP_444) ? 0 : 1;
-  const int pic_height = state->tile->frame->height;
-  const int pic_width = state->tile->frame->width;
-  const int max_ctu_height_log2 = uvg_math_floor_log2(LCU_WIDTH);
-  const int max_ctu_width_log2 = uvg_math_floor_log2(LCU_WIDTH);
-  const int width_in_ctus = state->tile->frame->width_in_lcu;
-  const int alf_vb_luma_ctu_height = LCU_WIDTH;
-  const int alf_vb_luma_pos = LCU_WIDTH - ALF_VB_POS_ABOVE_CTUROW_LUMA;
-
-  int ctu_idx = 0;
-  for (int y_pos = 0; y_pos < pic_height; y_pos += LCU_WIDTH)
-  {
-    for (int x_pos = 0; x_pos < pic_width; x_pos += LCU_WIDTH)
-    {
-      int filter_idx =
-        (filter_control == NULL)
-        ? selected_filter_idx
-        : filter_control[(y_pos >> max_ctu_height_log2) * width_in_ctus + (x_pos >> max_ctu_width_log2)];
-      bool skip_filtering = (filter_control != NULL && filter_idx == 0) ? true : false;
-      if (!skip_filtering)
-      {
-        if (filter_control != NULL)
-        {
-          filter_idx--;
-        }
-
-        const int16_t *filter_coeff = filter_set[filter_idx];
-
-        const int width = (x_pos + LCU_WIDTH > pic_width) ? (pic_width - x_pos) : LCU_WIDTH;
-        const int height = (y_pos + LCU_WIDTH > pic_height) ? (pic_height - y_pos) : LCU_WIDTH;
-
-        {
-          filter_blk_cc_alf(state, dst_buf, rec_yuv_ext, luma_stride, comp_id, filter_coeff, arr_vars->clp_rngs, alf_vb_luma_ctu_height,
-            alf_vb_luma_pos, x_pos >> component_scale_x, y_pos >> component_scale_y,
-            width >> component_scale_x, height >> component_scale_y);
-        }
-      }
-      ctu_idx++;
-    }
-  }
-}
-
 static void setup_cc_alf_aps(encoder_state_t * const state,
   const int *cc_reuse_aps_id)
 {
@@ -2777,9 +2627,12 @@ static void get_blk_stats_cc_alf(encoder_state_t * const state,
   }
 }
 
-static void derive_stats_for_cc_alf_filtering(encoder_state_t * const state,
-  const uvg_picture *org_yuv,
-  const int comp_idx, const int mask_stride,
+/**
+ * \brief Sum the CC-ALF statistics of all CTUs to the frame statistics in
+ * raster scan order.
+ */
+static void cc_alf_sum_frame_stats(encoder_state_t * const state,
+  const int comp_idx,
   const uint8_t filter_idc)
 {
   alf_covariance **alf_covariance_cc_alf = state->tile->frame->alf_info->alf_covariance_cc_alf;
@@ -2787,33 +2640,13 @@ static void derive_stats_for_cc_alf_filtering(encoder_state_t * const state,
   const int32_t num_ctus_in_pic = state->tile->frame->width_in_lcu * state->tile->frame->height_in_lcu;
   const int filter_idx = filter_idc - 1;
 
-  // init CTU stats buffers
-  for (int ctu_idx = 0; ctu_idx < num_ctus_in_pic; ctu_idx++)
-  {
-    reset_alf_covariance(&alf_covariance_cc_alf[comp_idx - 1][(filter_idx * num_ctus_in_pic) + ctu_idx], -1);
-  }
-
   // init Frame stats buffers
   reset_alf_covariance(&alf_covariance_frame_cc_alf[filter_idx], -1);
 
-  int ctu_rs_addr = 0;
-  const int frame_height = state->tile->frame->height;
-  const int frame_width = state->tile->frame->width;
-  const int max_cu_width = LCU_WIDTH;
-  const int max_cu_height = LCU_WIDTH;
-
-  for (int y_pos = 0; y_pos < state->tile->frame->height; y_pos += max_cu_height)
+  for (int ctu_rs_addr = 0; ctu_rs_addr < num_ctus_in_pic; ctu_rs_addr++)
   {
-    for (int x_pos = 0; x_pos < state->tile->frame->width; x_pos += max_cu_width)
-    {
-      const int width = (x_pos + max_cu_width > frame_width) ? (frame_width - x_pos) : max_cu_width;
-      const int height = (y_pos + max_cu_height > frame_height) ? (frame_height - y_pos) : max_cu_height;
-      get_blk_stats_cc_alf(state, &alf_covariance_cc_alf[comp_idx - 1][(filter_idx * num_ctus_in_pic) + ctu_rs_addr],
-        org_yuv, comp_idx, x_pos, y_pos, width, height);
-      add_alf_cov(&alf_covariance_frame_cc_alf[filter_idx],
-        &alf_covariance_cc_alf[comp_idx - 1][(filter_idx * num_ctus_in_pic) + ctu_rs_addr]);
-      ctu_rs_addr++;
-    }
+    add_alf_cov(&alf_covariance_frame_cc_alf[filter_idx],
+      &alf_covariance_cc_alf[comp_idx - 1][(filter_idx * num_ctus_in_pic) + ctu_rs_addr]);
   }
 }
 /*
@@ -4224,7 +4057,9 @@ static void alf_get_avai_aps_ids_luma(encoder_state_t * const state,
 }
 
 
-static void alf_derive_stats_for_filtering(encoder_state_t * const state,
+static void alf_derive_ctu_stats(encoder_state_t * const state,
+  const int x_pos, const int y_pos,
+  const int width, const int height,
   short alf_clipping_values[MAX_NUM_CHANNEL_TYPE][MAX_ALF_NUM_CLIPPING_VALUES])
 {
   alf_info_t *alf_info = state->tile->frame->alf_info;
@@ -4232,33 +4067,69 @@ static void alf_derive_stats_for_filtering(encoder_state_t * const state,
   bool chroma_scale_x = (chroma_fmt == UVG_CSP_444) ? 0 : 1;
   bool chroma_scale_y = (chroma_fmt != UVG_CSP_420) ? 0 : 1;
 
-  const int32_t num_ctus_in_pic = state->tile->frame->width_in_lcu * state->tile->frame->height_in_lcu;
   const int alf_vb_luma_ctu_height = LCU_WIDTH;
   const int alf_vb_chma_ctu_height = (LCU_WIDTH >> ((chroma_fmt == UVG_CSP_420) ? 1 : 0));
   const int alf_vb_luma_pos = LCU_WIDTH - ALF_VB_POS_ABOVE_CTUROW_LUMA;
   const int alf_vb_chma_pos = (LCU_WIDTH >> ((chroma_fmt == UVG_CSP_420) ? 1 : 0)) - ALF_VB_POS_ABOVE_CTUROW_CHMA;
-  int32_t pic_width = state->tile->frame->width;
-  int32_t pic_height = state->tile->frame->height;
-  int ctu_rs_addr = 0;
+  const int ctu_rs_addr = (y_pos / LCU_WIDTH) * state->tile->frame->width_in_lcu + x_pos / LCU_WIDTH;
 
   const int number_of_components = (chroma_fmt == UVG_CSP_400) ? 1 : MAX_NUM_COMPONENT;
 
-  // init CTU stats buffers
+  alf_covariance* alf_cov;
+  for (int comp_idx = 0; comp_idx < number_of_components; comp_idx++)
   {
-    for (int ctu_idx = 0; ctu_idx < num_ctus_in_pic; ctu_idx++)
-    {
-      for (int class_idx = 0; class_idx < MAX_NUM_ALF_CLASSES; class_idx++)
-      {
-        reset_alf_covariance(&state->tile->frame->alf_info->alf_covariance_y[(ctu_idx * MAX_NUM_ALF_CLASSES) + class_idx], MAX_ALF_NUM_CLIPPING_VALUES);
-      }
+    alf_cov = comp_idx == COMPONENT_Y ? alf_info->alf_covariance_y :
+      comp_idx == COMPONENT_Cb ? alf_info->alf_covariance_u :
+      comp_idx == COMPONENT_Cr ? alf_info->alf_covariance_v : NULL;
+
+    if (alf_cov == NULL) {
+      assert(0);
     }
 
-    for (int ctu_idx = 0; ctu_idx < num_ctus_in_pic; ctu_idx++)
+    const bool is_luma = comp_idx == COMPONENT_Y ? 1 : 0;
+    channel_type ch_type = is_luma ? CHANNEL_TYPE_LUMA : CHANNEL_TYPE_CHROMA;
+
+    int blk_w = is_luma ? width : width >> chroma_scale_x;
+    int blk_h = is_luma ? height : height >> chroma_scale_y;
+    int pos_x = is_luma ? x_pos : x_pos >> chroma_scale_x;
+    int pos_y = is_luma ? y_pos : y_pos >> chroma_scale_y;
+
+    int32_t org_stride = is_luma ? state->tile->frame->source->stride : state->tile->frame->source->stride >> chroma_scale_x;
+    int32_t rec_stride = is_luma ? state->tile->frame->rec->stride : state->tile->frame->rec->stride >> chroma_scale_x;
+
+    uvg_pixel *org = comp_idx ? (comp_idx - 1 ? &state->tile->frame->source->v[pos_x + pos_y * org_stride] : &state->tile->frame->source->u[pos_x + pos_y * org_stride]) : &state->tile->frame->source->y[pos_x + pos_y * org_stride];
+    uvg_pixel *rec = comp_idx ? (comp_idx - 1 ? &state->tile->frame->rec->v[pos_x + pos_y * rec_stride] : &state->tile->frame->rec->u[pos_x + pos_y * rec_stride]) : &state->tile->frame->rec->y[pos_x + pos_y * rec_stride];
+
+    const int num_classes = is_luma ? MAX_NUM_ALF_CLASSES : 1;
+    const int cov_index = ctu_rs_addr * num_classes;
+    for (int class_idx = 0; class_idx < num_classes; class_idx++)
     {
-      reset_alf_covariance(&state->tile->frame->alf_info->alf_covariance_u[ctu_idx], MAX_ALF_NUM_CLIPPING_VALUES);
-      reset_alf_covariance(&state->tile->frame->alf_info->alf_covariance_v[ctu_idx], MAX_ALF_NUM_CLIPPING_VALUES);
+      reset_alf_covariance(&alf_cov[cov_index + class_idx], MAX_ALF_NUM_CLIPPING_VALUES);
     }
+
+    uvg_alf_get_blk_stats(state, ch_type,
+      &alf_cov[cov_index],
+      comp_idx ? NULL : alf_info->classifier,
+      org, org_stride, rec, rec_stride, pos_x, pos_y, pos_x, pos_y, blk_w, blk_h,
+      (is_luma ? alf_vb_luma_ctu_height : alf_vb_chma_ctu_height),
+      (is_luma) ? alf_vb_luma_pos : alf_vb_chma_pos,
+      alf_clipping_values
+    );
   }
+}
+
+/**
+ * \brief Sum the statistics of all CTUs to the frame statistics.
+ *
+ * The CTUs are summed in raster scan order so that the result does not
+ * depend on the order in which the CTU statistics were derived.
+ */
+static void alf_sum_frame_stats(encoder_state_t * const state)
+{
+  alf_info_t *alf_info = state->tile->frame->alf_info;
+  enum uvg_chroma_format chroma_fmt = state->encoder_control->chroma_format;
+  const int32_t num_ctus_in_pic = state->tile->frame->width_in_lcu * state->tile->frame->height_in_lcu;
+  const int number_of_components = (chroma_fmt == UVG_CSP_400) ? 1 : MAX_NUM_COMPONENT;
 
   // init Frame stats buffers
   const int number_of_channels = (chroma_fmt == UVG_CSP_400) ? 1 : MAX_NUM_CHANNEL_TYPE;
@@ -4273,58 +4144,23 @@ static void alf_derive_stats_for_filtering(encoder_state_t * const state,
     reset_alf_covariance(&alf_info->alf_covariance_frame_chroma[0], MAX_ALF_NUM_CLIPPING_VALUES);
   }
 
-  alf_covariance* alf_cov;
-  alf_covariance* alf_cov_frame;
-  for (int y_pos = 0; y_pos < pic_height; y_pos += LCU_WIDTH)
+  for (int ctu_rs_addr = 0; ctu_rs_addr < num_ctus_in_pic; ctu_rs_addr++)
   {
-    for (int x_pos = 0; x_pos < pic_width; x_pos += LCU_WIDTH)
+    for (int comp_idx = 0; comp_idx < number_of_components; comp_idx++)
     {
-      const int width = (x_pos + LCU_WIDTH > pic_width) ? (pic_width - x_pos) : LCU_WIDTH;
-      const int height = (y_pos + LCU_WIDTH > pic_height) ? (pic_height - y_pos) : LCU_WIDTH;
-      for (int comp_idx = 0; comp_idx < number_of_components; comp_idx++)
-      {
-        alf_cov = comp_idx == COMPONENT_Y ? state->tile->frame->alf_info->alf_covariance_y :
-          comp_idx == COMPONENT_Cb ? state->tile->frame->alf_info->alf_covariance_u :
-          comp_idx == COMPONENT_Cr ? state->tile->frame->alf_info->alf_covariance_v : NULL;
-
-        if (alf_cov == NULL) {
-          assert(0);
-        }
+      const bool is_luma = comp_idx == COMPONENT_Y ? 1 : 0;
+      alf_covariance *alf_cov = comp_idx == COMPONENT_Y ? alf_info->alf_covariance_y :
+        comp_idx == COMPONENT_Cb ? alf_info->alf_covariance_u : alf_info->alf_covariance_v;
+      alf_covariance *alf_cov_frame = is_luma ? alf_info->alf_covariance_frame_luma : alf_info->alf_covariance_frame_chroma;
 
-        const bool is_luma = comp_idx == COMPONENT_Y ? 1 : 0;
-        channel_type ch_type = is_luma ? CHANNEL_TYPE_LUMA : CHANNEL_TYPE_CHROMA;
-        alf_cov_frame = is_luma ? alf_info->alf_covariance_frame_luma : alf_info->alf_covariance_frame_chroma;
-
-        int blk_w = is_luma ? width : width >> chroma_scale_x;
-        int blk_h = is_luma ? height : height >> chroma_scale_y;
-        int pos_x = is_luma ? x_pos : x_pos >> chroma_scale_x;
-        int pos_y = is_luma ? y_pos : y_pos >> chroma_scale_y;
-
-        int32_t org_stride = is_luma ? state->tile->frame->source->stride : state->tile->frame->source->stride >> chroma_scale_x;
-        int32_t rec_stride = is_luma ? state->tile->frame->rec->stride : state->tile->frame->rec->stride >> chroma_scale_x;
-
-        uvg_pixel *org = comp_idx ? (comp_idx - 1 ? &state->tile->frame->source->v[pos_x + pos_y * org_stride] : &state->tile->frame->source->u[pos_x + pos_y * org_stride]) : &state->tile->frame->source->y[pos_x + pos_y * org_stride];
-        uvg_pixel *rec = comp_idx ? (comp_idx - 1 ? &state->tile->frame->rec->v[pos_x + pos_y * rec_stride] : &state->tile->frame->rec->u[pos_x + pos_y * rec_stride]) : &state->tile->frame->rec->y[pos_x + pos_y * rec_stride];
-
-        const int num_classes = is_luma ? MAX_NUM_ALF_CLASSES : 1;
-        const int cov_index = ctu_rs_addr * num_classes;
-        uvg_alf_get_blk_stats(state, ch_type,
-          &alf_cov[cov_index],
-          comp_idx ? NULL : alf_info->classifier,
-          org, org_stride, rec, rec_stride, pos_x, pos_y, pos_x, pos_y, blk_w, blk_h,
-          (is_luma ? alf_vb_luma_ctu_height : alf_vb_chma_ctu_height),
-          (is_luma) ? alf_vb_luma_pos : alf_vb_chma_pos,
-          alf_clipping_values
+      const int num_classes = is_luma ? MAX_NUM_ALF_CLASSES : 1;
+      const int cov_index = ctu_rs_addr * num_classes;
+      for (int class_idx = 0; class_idx < num_classes; class_idx++)
+      {
+        add_alf_cov(&alf_cov_frame[is_luma ? class_idx : 0],
+          &alf_cov[cov_index + class_idx]
         );
-
-        for (int class_idx = 0; class_idx < num_classes; class_idx++)
-        {
-          add_alf_cov(&alf_cov_frame[is_luma ? class_idx : 0],
-            &alf_cov[cov_index + class_idx]
-          );
-        }
       }
-      ctu_rs_addr++;
     }
   }
 }
@@ -5029,112 +4865,6 @@ static void alf_encoder_ctb(encoder_state_t * const state,
 }
 
 
-static void alf_reconstruct(encoder_state_t * const state,
-  array_variables *arr_vars)
-{
-  if (!state->slice->alf->tile_group_alf_enabled_flag[COMPONENT_Y])
-  {
-    return;
-  }
-
-  alf_reconstruct_coeff_aps(state, true, state->slice->alf->tile_group_alf_enabled_flag[COMPONENT_Cb] || state->slice->alf->tile_group_alf_enabled_flag[COMPONENT_Cr], false, arr_vars);
-
-  alf_info_t *alf_info = state->tile->frame->alf_info;
-  bool **ctu_enable_flags = alf_info->ctu_enable_flag;
-  enum uvg_chroma_format chroma_fmt = state->encoder_control->chroma_format;
-  bool chroma_scale_x = (chroma_fmt == UVG_CSP_444) ? 0 : 1;
-  bool chroma_scale_y = (chroma_fmt != UVG_CSP_420) ? 0 : 1;
-
-  const int alf_vb_luma_ctu_height = LCU_WIDTH;
-  const int alf_vb_chma_ctu_height = (LCU_WIDTH >> ((chroma_fmt == UVG_CSP_420) ? 1 : 0));
-  const int alf_vb_luma_pos = LCU_WIDTH - ALF_VB_POS_ABOVE_CTUROW_LUMA;
-  const int alf_vb_chma_pos = (LCU_WIDTH >> ((chroma_fmt == UVG_CSP_420) ? 1 : 0)) - ALF_VB_POS_ABOVE_CTUROW_CHMA;
-  const int luma_height = state->tile->frame->height;
-  const int luma_width = state->tile->frame->width;
-  const int max_cu_width = LCU_WIDTH;
-  const int max_cu_height = LCU_WIDTH;
-
-  int ctu_idx = 0;
-
-  const int luma_stride = state->tile->frame->rec->stride;
-  const int chroma_stride = luma_stride >> chroma_scale_x;
-  const int chroma_height = luma_height >> chroma_scale_y;
-  const int chroma_padding = MAX_ALF_PADDING_SIZE >> chroma_scale_x;
-
-  const int index_luma = -(luma_stride * MAX_ALF_PADDING_SIZE + MAX_ALF_PADDING_SIZE);
-  const int index_chroma = -(chroma_stride * chroma_padding + chroma_padding);
-
-  //Copy reconstructed samples to a buffer.
-  memcpy(&alf_info->alf_tmp_y[index_luma], &state->tile->frame->rec->y[index_luma],
-    sizeof(uvg_pixel) * luma_stride * (luma_height + MAX_ALF_PADDING_SIZE * 2));
-  memcpy(&alf_info->alf_tmp_u[index_chroma], &state->tile->frame->rec->u[index_chroma],
-    sizeof(uvg_pixel) * chroma_stride * (chroma_height + chroma_padding * 2));
-  memcpy(&alf_info->alf_tmp_v[index_chroma], &state->tile->frame->rec->v[index_chroma],
-    sizeof(uvg_pixel) * chroma_stride * (chroma_height + chroma_padding * 2));
-
-  for (int y_pos = 0; y_pos < luma_height; y_pos += max_cu_height)
-  {
-    for (int x_pos = 0; x_pos < luma_width; x_pos += max_cu_width)
-    {
-
-      const int width = (x_pos + max_cu_width > luma_width) ? (luma_width - x_pos) : max_cu_width;
-      const int height = (y_pos + max_cu_height > luma_height) ? (luma_height - y_pos) : max_cu_height;
-
-      bool ctu_enable_flag = ctu_enable_flags[COMPONENT_Y][ctu_idx];
-      for (int comp_idx = 1; comp_idx < MAX_NUM_COMPONENT; comp_idx++)
-      {
-        ctu_enable_flag |= ctu_enable_flags[comp_idx][ctu_idx] > 0;
-      }
-
-      {
-        if (ctu_enable_flags[COMPONENT_Y][ctu_idx])
-        {
-          short filter_set_index = alf_info->alf_ctb_filter_index[ctu_idx];
-          short *coeff;
-          int16_t *clip;
-          if (filter_set_index >= ALF_NUM_FIXED_FILTER_SETS)
-          {
-            coeff = arr_vars->coeff_aps_luma[filter_set_index - ALF_NUM_FIXED_FILTER_SETS];
-            clip = arr_vars->clipp_aps_luma[filter_set_index - ALF_NUM_FIXED_FILTER_SETS];
-          }
-          else
-          {
-            coeff = arr_vars->fixed_filter_set_coeff_dec[filter_set_index];
-            clip = arr_vars->clip_default;
-          }
-          uvg_alf_filter_7x7_blk(state,
-            alf_info->alf_tmp_y, state->tile->frame->rec->y,
-            luma_stride, luma_stride,
-            coeff, clip, arr_vars->clp_rngs.comp[COMPONENT_Y],
-            width, height, x_pos, y_pos, x_pos, y_pos,
-            alf_vb_luma_pos, alf_vb_luma_ctu_height);
-        }
-        for (int comp_idx = 1; comp_idx < MAX_NUM_COMPONENT; comp_idx++)
-        {
-          alf_component_id comp_id = comp_idx;
-
-          if (ctu_enable_flags[comp_idx][ctu_idx])
-          {
-            uvg_pixel *dst_pixels = comp_id - 1 ? state->tile->frame->rec->v : state->tile->frame->rec->u;
-            const uvg_pixel *src_pixels = comp_id - 1 ? alf_info->alf_tmp_v : alf_info->alf_tmp_u;
-
-            const int alt_num = alf_info->ctu_alternative[comp_id][ctu_idx];
-            uvg_alf_filter_5x5_blk(state,
-              src_pixels, dst_pixels,
-              chroma_stride, chroma_stride,
-              arr_vars->chroma_coeff_final[alt_num], arr_vars->chroma_clipp_final[alt_num], arr_vars->clp_rngs.comp[comp_idx],
-              width >> chroma_scale_x, height >> chroma_scale_y,
-              x_pos >> chroma_scale_x, y_pos >> chroma_scale_y,
-              x_pos >> chroma_scale_x, y_pos >> chroma_scale_y,
-              alf_vb_chma_pos, alf_vb_chma_ctu_height);
-          }
-        }
-      }
-      ctu_idx++;
-    }
-  }
-}
-
 static void alf_derive_classification(encoder_state_t * const state,
   const int width,
   const int height,
@@ -5155,21 +4885,29 @@ static void alf_derive_classification(encoder_state_t * const state,
   int max_height = y_pos + height;
   int max_width = x_pos + width;
 
-  adjust_pixels(state->tile->frame->rec->y, x_pos, pic_width, y_pos, pic_height, state->tile->frame->rec->stride,
+  // Pad the picture borders next to the block and its statistics. The
+  // padding next to the block is written again by the neighbouring blocks,
+  // so those must not be processed concurrently.
+  const int pad_x_start = MAX(0, x_pos - MAX_ALF_PADDING_SIZE);
+  const int pad_y_start = MAX(0, y_pos - MAX_ALF_PADDING_SIZE);
+  const int pad_x_end = MIN(pic_width, max_width + MAX_ALF_PADDING_SIZE);
+  const int pad_y_end = MIN(pic_height, max_height + MAX_ALF_PADDING_SIZE);
+
+  adjust_pixels(state->tile->frame->rec->y, pad_x_start, pad_x_end, pad_y_start, pad_y_end, state->tile->frame->rec->stride,
     pic_width, pic_height);
   adjust_pixels_chroma(state->tile->frame->rec->u,
-    x_pos >> chroma_scale_x,
-    pic_width >> chroma_scale_x,
-    y_pos >> chroma_scale_y,
-    pic_height >> chroma_scale_y,
+    pad_x_start >> chroma_scale_x,
+    pad_x_end >> chroma_scale_x,
+    pad_y_start >> chroma_scale_y,
+    pad_y_end >> chroma_scale_y,
     state->tile->frame->rec->stride >> chroma_scale_x,
     pic_width >> chroma_scale_x,
     pic_height >> chroma_scale_y);
   adjust_pixels_chroma(state->tile->frame->rec->v,
-    x_pos >> chroma_scale_x,
-    pic_width >> chroma_scale_x,
-    y_pos >> chroma_scale_y,
-    pic_height >> chroma_scale_y,
+    pad_x_start >> chroma_scale_x,
+    pad_x_end >> chroma_scale_x,
+    pad_y_start >> chroma_scale_y,
+    pad_y_end >> chroma_scale_y,
     state->tile->frame->rec->stride >> chroma_scale_x,
     pic_width >> chroma_scale_x,
     pic_height >> chroma_scale_y);
@@ -5190,122 +4928,153 @@ static void alf_derive_classification(encoder_state_t * const state,
   }
 }
 
+/**
+ * \brief Run the whole ALF encoding process for the frame.
+ */
 void uvg_alf_enc_process(encoder_state_t *const state)
 {
-  alf_init_covariance(state->tile->frame, state->encoder_control->chroma_format);
-  alf_info_t *alf_info = state->tile->frame->alf_info;
-  alf_create_frame_buffer(state, alf_info);
-  /*
-  //if (!layerIdx && cs.slice->getPendingRasInit()
-  if (1 && (false
-  || (state->frame->pictype == UVG_NAL_IDR_W_RADL || state->frame->pictype == UVG_NAL_IDR_N_LP)))
-  {
-    for (int i = 0; i < ALF_CTB_MAX_NUM_APS; i++) {
-      reset_aps(&state->slice->alf->apss[i], state->encoder_control->cfg.alf_type == UVG_ALF_FULL);
-      if (state->tile->frame->alf_param_set_map[i + T_ALF_APS].b_changed)
-      {
-        alf_aps* alf_aps = &state->tile->frame->alf_param_set_map[i + T_ALF_APS].parameter_set;
-        state->tile->frame->alf_param_set_map[i + T_ALF_APS].b_changed = false;
-        reset_aps(alf_aps, state->encoder_control->cfg.alf_type == UVG_ALF_FULL);
-      }
-    }
-    alf_info->aps_id_start = ALF_CTB_MAX_NUM_APS;
-  }*/
+  const int width_in_lcu = state->tile->frame->width_in_lcu;
+  const int height_in_lcu = state->tile->frame->height_in_lcu;
 
-  alf_aps alf_param;
-  reset_alf_param(&alf_param);
-  cc_alf_filter_param *cc_filter_param = state->slice->alf->cc_filter_param;
-
-
-  enum uvg_chroma_format chroma_fmt = state->encoder_control->chroma_format;
-  bool chroma_scale_x = (chroma_fmt == UVG_CSP_444) ? 0 : 1;
-  bool chroma_scale_y = (chroma_fmt != UVG_CSP_420) ? 0 : 1;
-  int8_t uvg_bit_depth = state->encoder_control->bitdepth;
-  const uint32_t num_ctus_in_pic = state->tile->frame->width_in_lcu * state->tile->frame->height_in_lcu;
-  const int8_t input_bitdepth = state->encoder_control->bitdepth;
-  double lambda_chroma_weight = 0.0;
-
-  cabac_data_t ctx_start;
-  cabac_data_t ctx_start_cc_alf;
-  cabac_data_t *cabac_estimator = &alf_info->cabac_estimator;
-  memcpy(cabac_estimator, &state->cabac, sizeof(*cabac_estimator));
-  memcpy(&ctx_start, &state->cabac, sizeof(ctx_start));
-  memcpy(&ctx_start_cc_alf, cabac_estimator, sizeof(ctx_start_cc_alf));
-  cabac_estimator->only_count = 1;
-  ctx_start.only_count = 1;
-  ctx_start_cc_alf.only_count = 1;
-
-  // derive classification
-  const int luma_height = state->tile->frame->height;
-  const int luma_width = state->tile->frame->width;
-
-  array_variables arr_vars;
-  bool init_values = false;
-
-  if (!init_values)
-  {
-    assert(MAX_ALF_NUM_CLIPPING_VALUES > 0); //"g_alf_num_clipping_values[CHANNEL_TYPE_LUMA] must be at least one"
-    arr_vars.alf_clipping_values[CHANNEL_TYPE_LUMA][0] = 1 << input_bitdepth;
-    int shift_luma = input_bitdepth - 8;
-    for (int i = 1; i < MAX_ALF_NUM_CLIPPING_VALUES; ++i)
-    {
-      arr_vars.alf_clipping_values[CHANNEL_TYPE_LUMA][i] = 1 << (7 - 2 * i + shift_luma);
+  uvg_alf_enc_init(state);
+  for (int y = 0; y < height_in_lcu; y++) {
+    for (int x = 0; x < width_in_lcu; x++) {
+      uvg_alf_enc_ctu_stats(state, x, y);
     }
+  }
 
-    assert(MAX_ALF_NUM_CLIPPING_VALUES > 0); //"g_alf_num_clipping_values[CHANNEL_TYPE_CHROMA] must be at least one"
-    arr_vars.alf_clipping_values[CHANNEL_TYPE_CHROMA][0] = 1 << input_bitdepth;
-    int shift_chroma = input_bitdepth - 8;
-    for (int i = 1; i < MAX_ALF_NUM_CLIPPING_VALUES; ++i)
-    {
-      arr_vars.alf_clipping_values[CHANNEL_TYPE_CHROMA][i] = 1 << (7 - 2 * i + shift_chroma);
+  uvg_alf_enc_derive(state);
+  for (int y = 0; y < height_in_lcu; y++) {
+    for (int x = 0; x < width_in_lcu; x++) {
+      uvg_alf_enc_filter_ctu(state, x, y);
     }
+  }
 
-    for (int i = 0; i < MAX_NUM_ALF_LUMA_COEFF * MAX_NUM_ALF_CLASSES; i++)
-    {
-      arr_vars.clip_default[i] = arr_vars.alf_clipping_values[CHANNEL_TYPE_LUMA][0];
+  if (state->encoder_control->cfg.alf_type == UVG_ALF_FULL) {
+    uvg_alf_enc_cc_prepare(state);
+    for (int y = 0; y < height_in_lcu; y++) {
+      for (int x = 0; x < width_in_lcu; x++) {
+        uvg_alf_enc_cc_ctu_stats(state, x, y);
+      }
     }
 
-    for (int filter_set_index = 0; filter_set_index < ALF_NUM_FIXED_FILTER_SETS; filter_set_index++)
-    {
-      for (int class_idx = 0; class_idx < MAX_NUM_ALF_CLASSES; class_idx++)
-      {
-        int fixed_filter_idx = g_class_to_filter_mapping[filter_set_index][class_idx];
-        for (int i = 0; i < MAX_NUM_ALF_LUMA_COEFF - 1; i++)
-        {
-          arr_vars.fixed_filter_set_coeff_dec[filter_set_index][class_idx * MAX_NUM_ALF_LUMA_COEFF + i] = g_fixed_filter_set_coeff[fixed_filter_idx][i];
-        }
-        arr_vars.fixed_filter_set_coeff_dec[filter_set_index][class_idx * MAX_NUM_ALF_LUMA_COEFF + MAX_NUM_ALF_LUMA_COEFF - 1] = (1 << (input_bitdepth - 1));
+    uvg_alf_enc_cc_derive(state);
+    for (int y = 0; y < height_in_lcu; y++) {
+      for (int x = 0; x < width_in_lcu; x++) {
+        uvg_alf_enc_cc_filter_ctu(state, x, y);
       }
     }
+  }
+
+  uvg_alf_enc_finish(state);
+}
+
+/**
+ * \brief Allocate the ALF buffers of the frame.
+ */
+void uvg_alf_enc_init(encoder_state_t *const state)
+{
+  alf_init_covariance(state->tile->frame, state->encoder_control->chroma_format);
+  alf_info_t *alf_info = state->tile->frame->alf_info;
+  alf_create_frame_buffer(state, alf_info);
+
+  array_variables *arr_vars = &alf_info->arr_vars;
+  int8_t uvg_bit_depth = state->encoder_control->bitdepth;
+  const int8_t input_bitdepth = state->encoder_control->bitdepth;
+
+  assert(MAX_ALF_NUM_CLIPPING_VALUES > 0); //"g_alf_num_clipping_values[CHANNEL_TYPE_LUMA] must be at least one"
+  arr_vars->alf_clipping_values[CHANNEL_TYPE_LUMA][0] = 1 << input_bitdepth;
+  int shift_luma = input_bitdepth - 8;
+  for (int i = 1; i < MAX_ALF_NUM_CLIPPING_VALUES; ++i)
+  {
+    arr_vars->alf_clipping_values[CHANNEL_TYPE_LUMA][i] = 1 << (7 - 2 * i + shift_luma);
+  }
 
-    //Default clp_rng
-    arr_vars.clp_rngs.comp[COMPONENT_Y].min = arr_vars.clp_rngs.comp[COMPONENT_Cb].min = arr_vars.clp_rngs.comp[COMPONENT_Cr].min = 0;
-    arr_vars.clp_rngs.comp[COMPONENT_Y].max = (1 << uvg_bit_depth) - 1;
-    arr_vars.clp_rngs.comp[COMPONENT_Y].bd = uvg_bit_depth;
-    arr_vars.clp_rngs.comp[COMPONENT_Y].n = 0;
-    arr_vars.clp_rngs.comp[COMPONENT_Cb].max = arr_vars.clp_rngs.comp[COMPONENT_Cr].max = (1 << uvg_bit_depth) - 1;
-    arr_vars.clp_rngs.comp[COMPONENT_Cb].bd = arr_vars.clp_rngs.comp[COMPONENT_Cr].bd = uvg_bit_depth;
-    arr_vars.clp_rngs.comp[COMPONENT_Cb].n = arr_vars.clp_rngs.comp[COMPONENT_Cr].n = 0;
-    arr_vars.clp_rngs.used = arr_vars.clp_rngs.chroma = false;
+  assert(MAX_ALF_NUM_CLIPPING_VALUES > 0); //"g_alf_num_clipping_values[CHANNEL_TYPE_CHROMA] must be at least one"
+  arr_vars->alf_clipping_values[CHANNEL_TYPE_CHROMA][0] = 1 << input_bitdepth;
+  int shift_chroma = input_bitdepth - 8;
+  for (int i = 1; i < MAX_ALF_NUM_CLIPPING_VALUES; ++i)
+  {
+    arr_vars->alf_clipping_values[CHANNEL_TYPE_CHROMA][i] = 1 << (7 - 2 * i + shift_chroma);
+  }
 
-    init_values = true;
+  for (int i = 0; i < MAX_NUM_ALF_LUMA_COEFF * MAX_NUM_ALF_CLASSES; i++)
+  {
+    arr_vars->clip_default[i] = arr_vars->alf_clipping_values[CHANNEL_TYPE_LUMA][0];
   }
 
-  for (int y_pos = 0; y_pos < luma_height; y_pos += LCU_WIDTH)
+  for (int filter_set_index = 0; filter_set_index < ALF_NUM_FIXED_FILTER_SETS; filter_set_index++)
   {
-    for (int x_pos = 0; x_pos < luma_width; x_pos += LCU_WIDTH)
+    for (int class_idx = 0; class_idx < MAX_NUM_ALF_CLASSES; class_idx++)
     {
-      const int width = (x_pos + LCU_WIDTH > luma_width) ? (luma_width - x_pos) : LCU_WIDTH;
-      const int height = (y_pos + LCU_WIDTH > luma_height) ? (luma_height - y_pos) : LCU_WIDTH;
+      int fixed_filter_idx = g_class_to_filter_mapping[filter_set_index][class_idx];
+      for (int i = 0; i < MAX_NUM_ALF_LUMA_COEFF - 1; i++)
       {
-        alf_derive_classification(state, width, height, x_pos, y_pos, x_pos, y_pos);
+        arr_vars->fixed_filter_set_coeff_dec[filter_set_index][class_idx * MAX_NUM_ALF_LUMA_COEFF + i] = g_fixed_filter_set_coeff[fixed_filter_idx][i];
       }
+      arr_vars->fixed_filter_set_coeff_dec[filter_set_index][class_idx * MAX_NUM_ALF_LUMA_COEFF + MAX_NUM_ALF_LUMA_COEFF - 1] = (1 << (input_bitdepth - 1));
     }
   }
 
+  //Default clp_rng
+  arr_vars->clp_rngs.comp[COMPONENT_Y].min = arr_vars->clp_rngs.comp[COMPONENT_Cb].min = arr_vars->clp_rngs.comp[COMPONENT_Cr].min = 0;
+  arr_vars->clp_rngs.comp[COMPONENT_Y].max = (1 << uvg_bit_depth) - 1;
+  arr_vars->clp_rngs.comp[COMPONENT_Y].bd = uvg_bit_depth;
+  arr_vars->clp_rngs.comp[COMPONENT_Y].n = 0;
+  arr_vars->clp_rngs.comp[COMPONENT_Cb].max = arr_vars->clp_rngs.comp[COMPONENT_Cr].max = (1 << uvg_bit_depth) - 1;
+  arr_vars->clp_rngs.comp[COMPONENT_Cb].bd = arr_vars->clp_rngs.comp[COMPONENT_Cr].bd = uvg_bit_depth;
+  arr_vars->clp_rngs.comp[COMPONENT_Cb].n = arr_vars->clp_rngs.comp[COMPONENT_Cr].n = 0;
+  arr_vars->clp_rngs.used = arr_vars->clp_rngs.chroma = false;
+}
 
-  // get CTB stats for filtering 
-  alf_derive_stats_for_filtering(state, arr_vars.alf_clipping_values);
+/**
+ * \brief Derive the classification and the statistics of a CTU.
+ *
+ * Reads the reconstruction up to MAX_ALF_PADDING_SIZE pixels around the
+ * CTU and pads the picture borders there, so the CTUs to the left and
+ * above must have been processed before this one.
+ */
+void uvg_alf_enc_ctu_stats(encoder_state_t *const state, const int ctu_x, const int ctu_y)
+{
+  const int luma_height = state->tile->frame->height;
+  const int luma_width = state->tile->frame->width;
+  const int x_pos = ctu_x * LCU_WIDTH;
+  const int y_pos = ctu_y * LCU_WIDTH;
+  const int width = (x_pos + LCU_WIDTH > luma_width) ? (luma_width - x_pos) : LCU_WIDTH;
+  const int height = (y_pos + LCU_WIDTH > luma_height) ? (luma_height - y_pos) : LCU_WIDTH;
+
+  alf_derive_classification(state, width, height, x_pos, y_pos, x_pos, y_pos);
+  alf_derive_ctu_stats(state, x_pos, y_pos, width, height,
+                       state->tile->frame->alf_info->arr_vars.alf_clipping_values);
+}
+
+/**
+ * \brief Derive the ALF filters and the CTU decisions of the frame.
+ *
+ * The statistics of every CTU must have been derived. Prepares the
+ * buffers for uvg_alf_enc_filter_ctu.
+ */
+void uvg_alf_enc_derive(encoder_state_t *const state)
+{
+  alf_info_t *alf_info = state->tile->frame->alf_info;
+  array_variables *arr_vars = &alf_info->arr_vars;
+
+  alf_aps alf_param;
+  reset_alf_param(&alf_param);
+
+  const uint32_t num_ctus_in_pic = state->tile->frame->width_in_lcu * state->tile->frame->height_in_lcu;
+  double lambda_chroma_weight = 0.0;
+
+  cabac_data_t ctx_start;
+  cabac_data_t *cabac_estimator = &alf_info->cabac_estimator;
+  memcpy(cabac_estimator, &state->cabac, sizeof(*cabac_estimator));
+  memcpy(&ctx_start, &state->cabac, sizeof(ctx_start));
+  memcpy(&alf_info->cabac_start, cabac_estimator, sizeof(alf_info->cabac_start));
+  cabac_estimator->only_count = 1;
+  ctx_start.only_count = 1;
+  alf_info->cabac_start.only_count = 1;
+
+  alf_sum_frame_stats(state);
 
   for (uint32_t ctb_iIdx = 0; ctb_iIdx < num_ctus_in_pic; ctb_iIdx++)
   {
@@ -5321,7 +5090,7 @@ void uvg_alf_enc_process(encoder_state_t *const state)
   alf_encoder(state,
     &alf_param, CHANNEL_TYPE_LUMA,
     lambda_chroma_weight,
-    &arr_vars
+    arr_vars
   );
 
   // derive filter (chroma)
@@ -5329,7 +5098,7 @@ void uvg_alf_enc_process(encoder_state_t *const state)
     alf_encoder(state,
       &alf_param, CHANNEL_TYPE_CHROMA,
       lambda_chroma_weight,
-      &arr_vars
+      arr_vars
     );
   }
   // let alfEncoderCtb decide now
@@ -5339,7 +5108,7 @@ void uvg_alf_enc_process(encoder_state_t *const state)
 
   //m_CABACEstimator->getCtx() = AlfCtx(ctxStart);
   memcpy(cabac_estimator, &ctx_start, sizeof(*cabac_estimator));
-  alf_encoder_ctb(state, &alf_param, lambda_chroma_weight, &arr_vars);
+  alf_encoder_ctb(state, &alf_param, lambda_chroma_weight, arr_vars);
 
   //for (int s = 0; s < state.; s++) //numSliceSegments
   {
@@ -5355,13 +5124,120 @@ void uvg_alf_enc_process(encoder_state_t *const state)
     }
   }
 
-  alf_reconstruct(state, &arr_vars);
+  if (!state->slice->alf->tile_group_alf_enabled_flag[COMPONENT_Y])
+  {
+    return;
+  }
+
+  alf_reconstruct_coeff_aps(state, true, state->slice->alf->tile_group_alf_enabled_flag[COMPONENT_Cb] || state->slice->alf->tile_group_alf_enabled_flag[COMPONENT_Cr], false, arr_vars);
+
+  enum uvg_chroma_format chroma_fmt = state->encoder_control->chroma_format;
+  bool chroma_scale_x = (chroma_fmt == UVG_CSP_444) ? 0 : 1;
+  bool chroma_scale_y = (chroma_fmt != UVG_CSP_420) ? 0 : 1;
+  const int luma_height = state->tile->frame->height;
+  const int luma_stride = state->tile->frame->rec->stride;
+  const int chroma_stride = luma_stride >> chroma_scale_x;
+  const int chroma_height = luma_height >> chroma_scale_y;
+  const int chroma_padding = MAX_ALF_PADDING_SIZE >> chroma_scale_x;
 
-  if (state->encoder_control->cfg.alf_type != UVG_ALF_FULL)
+  const int index_luma = -(luma_stride * MAX_ALF_PADDING_SIZE + MAX_ALF_PADDING_SIZE);
+  const int index_chroma = -(chroma_stride * chroma_padding + chroma_padding);
+
+  //Copy reconstructed samples to a buffer.
+  memcpy(&alf_info->alf_tmp_y[index_luma], &state->tile->frame->rec->y[index_luma],
+    sizeof(uvg_pixel) * luma_stride * (luma_height + MAX_ALF_PADDING_SIZE * 2));
+  memcpy(&alf_info->alf_tmp_u[index_chroma], &state->tile->frame->rec->u[index_chroma],
+    sizeof(uvg_pixel) * chroma_stride * (chroma_height + chroma_padding * 2));
+  memcpy(&alf_info->alf_tmp_v[index_chroma], &state->tile->frame->rec->v[index_chroma],
+    sizeof(uvg_pixel) * chroma_stride * (chroma_height + chroma_padding * 2));
+}
+
+/**
+ * \brief Apply the derived ALF filters to a CTU.
+ *
+ * CTUs are independent of each other because the unfiltered pixels are
+ * read from the copy made in uvg_alf_enc_derive.
+ */
+void uvg_alf_enc_filter_ctu(encoder_state_t *const state, const int ctu_x, const int ctu_y)
+{
+  if (!state->slice->alf->tile_group_alf_enabled_flag[COMPONENT_Y])
   {
     return;
   }
 
+  alf_info_t *alf_info = state->tile->frame->alf_info;
+  array_variables *arr_vars = &alf_info->arr_vars;
+  bool **ctu_enable_flags = alf_info->ctu_enable_flag;
+  enum uvg_chroma_format chroma_fmt = state->encoder_control->chroma_format;
+  bool chroma_scale_x = (chroma_fmt == UVG_CSP_444) ? 0 : 1;
+  bool chroma_scale_y = (chroma_fmt != UVG_CSP_420) ? 0 : 1;
+
+  const int alf_vb_luma_ctu_height = LCU_WIDTH;
+  const int alf_vb_chma_ctu_height = (LCU_WIDTH >> ((chroma_fmt == UVG_CSP_420) ? 1 : 0));
+  const int alf_vb_luma_pos = LCU_WIDTH - ALF_VB_POS_ABOVE_CTUROW_LUMA;
+  const int alf_vb_chma_pos = (LCU_WIDTH >> ((chroma_fmt == UVG_CSP_420) ? 1 : 0)) - ALF_VB_POS_ABOVE_CTUROW_CHMA;
+  const int luma_height = state->tile->frame->height;
+  const int luma_width = state->tile->frame->width;
+  const int luma_stride = state->tile->frame->rec->stride;
+  const int chroma_stride = luma_stride >> chroma_scale_x;
+
+  const int ctu_idx = ctu_y * state->tile->frame->width_in_lcu + ctu_x;
+  const int x_pos = ctu_x * LCU_WIDTH;
+  const int y_pos = ctu_y * LCU_WIDTH;
+  const int width = (x_pos + LCU_WIDTH > luma_width) ? (luma_width - x_pos) : LCU_WIDTH;
+  const int height = (y_pos + LCU_WIDTH > luma_height) ? (luma_height - y_pos) : LCU_WIDTH;
+
+  if (ctu_enable_flags[COMPONENT_Y][ctu_idx])
+  {
+    short filter_set_index = alf_info->alf_ctb_filter_index[ctu_idx];
+    short *coeff;
+    int16_t *clip;
+    if (filter_set_index >= ALF_NUM_FIXED_FILTER_SETS)
+    {
+      coeff = arr_vars->coeff_aps_luma[filter_set_index - ALF_NUM_FIXED_FILTER_SETS];
+      clip = arr_vars->clipp_aps_luma[filter_set_index - ALF_NUM_FIXED_FILTER_SETS];
+    }
+    else
+    {
+      coeff = arr_vars->fixed_filter_set_coeff_dec[filter_set_index];
+      clip = arr_vars->clip_default;
+    }
+    uvg_alf_filter_7x7_blk(state,
+      alf_info->alf_tmp_y, state->tile->frame->rec->y,
+      luma_stride, luma_stride,
+      coeff, clip, arr_vars->clp_rngs.comp[COMPONENT_Y],
+      width, height, x_pos, y_pos, x_pos, y_pos,
+      alf_vb_luma_pos, alf_vb_luma_ctu_height);
+  }
+  for (int comp_idx = 1; comp_idx < MAX_NUM_COMPONENT; comp_idx++)
+  {
+    alf_component_id comp_id = comp_idx;
+
+    if (ctu_enable_flags[comp_idx][ctu_idx])
+    {
+      uvg_pixel *dst_pixels = comp_id - 1 ? state->tile->frame->rec->v : state->tile->frame->rec->u;
+      const uvg_pixel *src_pixels = comp_id - 1 ? alf_info->alf_tmp_v : alf_info->alf_tmp_u;
+
+      const int alt_num = alf_info->ctu_alternative[comp_id][ctu_idx];
+      uvg_alf_filter_5x5_blk(state,
+        src_pixels, dst_pixels,
+        chroma_stride, chroma_stride,
+        arr_vars->chroma_coeff_final[alt_num], arr_vars->chroma_clipp_final[alt_num], arr_vars->clp_rngs.comp[comp_idx],
+        width >> chroma_scale_x, height >> chroma_scale_y,
+        x_pos >> chroma_scale_x, y_pos >> chroma_scale_y,
+        x_pos >> chroma_scale_x, y_pos >> chroma_scale_y,
+        alf_vb_chma_pos, alf_vb_chma_ctu_height);
+    }
+  }
+}
+
+/**
+ * \brief Prepare the CC-ALF derivation after every CTU has been filtered.
+ */
+void uvg_alf_enc_cc_prepare(encoder_state_t *const state)
+{
+  alf_info_t *alf_info = state->tile->frame->alf_info;
+
   // Do not transmit CC ALF if it is unchanged
   if (state->slice->alf->tile_group_alf_enabled_flag[COMPONENT_Y])
   {
@@ -5387,9 +5263,12 @@ void uvg_alf_enc_process(encoder_state_t *const state)
     aps->cc_alf_aps_param.new_cc_alf_filter[1] = false;
   }
 
-  const uvg_picture *org_yuv = state->tile->frame->source;
+  enum uvg_chroma_format chroma_fmt = state->encoder_control->chroma_format;
+  bool chroma_scale_x = (chroma_fmt == UVG_CSP_444) ? 0 : 1;
+  bool chroma_scale_y = (chroma_fmt != UVG_CSP_420) ? 0 : 1;
   const uvg_picture *rec_yuv = state->tile->frame->rec;
 
+  const int luma_height = state->tile->frame->height;
   const int luma_stride = state->tile->frame->rec->stride;
   const int chroma_stride = luma_stride >> chroma_scale_x;
   const int chroma_height = luma_height >> chroma_scale_y;
@@ -5419,29 +5298,102 @@ void uvg_alf_enc_process(encoder_state_t *const state)
     rec_yuv->stride >> chroma_scale_x,
     rec_yuv->width >> chroma_scale_x,
     rec_yuv->height >> chroma_scale_y);
+}
+
+/**
+ * \brief Derive the CC-ALF statistics of a CTU.
+ */
+void uvg_alf_enc_cc_ctu_stats(encoder_state_t *const state, const int ctu_x, const int ctu_y)
+{
+  alf_covariance **alf_covariance_cc_alf = state->tile->frame->alf_info->alf_covariance_cc_alf;
+  const int frame_height = state->tile->frame->height;
+  const int frame_width = state->tile->frame->width;
+  const int ctu_rs_addr = ctu_y * state->tile->frame->width_in_lcu + ctu_x;
+  const int x_pos = ctu_x * LCU_WIDTH;
+  const int y_pos = ctu_y * LCU_WIDTH;
+  const int width = (x_pos + LCU_WIDTH > frame_width) ? (frame_width - x_pos) : LCU_WIDTH;
+  const int height = (y_pos + LCU_WIDTH > frame_height) ? (frame_height - y_pos) : LCU_WIDTH;
+
+  // Only the first filter is trained.
+  for (int comp_idx = COMPONENT_Cb; comp_idx <= COMPONENT_Cr; comp_idx++)
+  {
+    alf_covariance *alf_cov = &alf_covariance_cc_alf[comp_idx - 1][ctu_rs_addr];
+    reset_alf_covariance(alf_cov, -1);
+    get_blk_stats_cc_alf(state, alf_cov, state->tile->frame->source, comp_idx, x_pos, y_pos, width, height);
+  }
+}
+
+/**
+ * \brief Derive the CC-ALF filters of the frame from the CTU statistics.
+ */
+void uvg_alf_enc_cc_derive(encoder_state_t *const state)
+{
+  alf_info_t *alf_info = state->tile->frame->alf_info;
+  array_variables *arr_vars = &alf_info->arr_vars;
+  const uvg_picture *org_yuv = state->tile->frame->source;
+  const uvg_picture *rec_yuv = state->tile->frame->rec;
+  const uint32_t num_ctus_in_pic = state->tile->frame->width_in_lcu * state->tile->frame->height_in_lcu;
+  cabac_data_t *cabac_estimator = &alf_info->cabac_estimator;
 
-  const int num_ctus_in_width = state->tile->frame->width_in_lcu;
-  derive_stats_for_cc_alf_filtering(state, org_yuv, COMPONENT_Cb, num_ctus_in_width, (0 + 1));
-  derive_stats_for_cc_alf_filtering(state, org_yuv, COMPONENT_Cr, num_ctus_in_width, (0 + 1));
+  cc_alf_sum_frame_stats(state, COMPONENT_Cb, (0 + 1));
+  cc_alf_sum_frame_stats(state, COMPONENT_Cr, (0 + 1));
   init_distortion_cc_alf(alf_info->alf_covariance_cc_alf, alf_info->ctb_distortion_unfilter, num_ctus_in_pic);
 
-  memcpy(cabac_estimator, &ctx_start_cc_alf, sizeof(*cabac_estimator));
-  derive_cc_alf_filter(state, COMPONENT_Cb, org_yuv, rec_yuv, arr_vars.cc_reuse_aps_id);
-  memcpy(cabac_estimator, &ctx_start_cc_alf, sizeof(*cabac_estimator));
-  derive_cc_alf_filter(state, COMPONENT_Cr, org_yuv, rec_yuv, arr_vars.cc_reuse_aps_id);
+  memcpy(cabac_estimator, &alf_info->cabac_start, sizeof(*cabac_estimator));
+  derive_cc_alf_filter(state, COMPONENT_Cb, org_yuv, rec_yuv, arr_vars->cc_reuse_aps_id);
+  memcpy(cabac_estimator, &alf_info->cabac_start, sizeof(*cabac_estimator));
+  derive_cc_alf_filter(state, COMPONENT_Cr, org_yuv, rec_yuv, arr_vars->cc_reuse_aps_id);
+
+  setup_cc_alf_aps(state, arr_vars->cc_reuse_aps_id);
+}
 
-  setup_cc_alf_aps(state, arr_vars.cc_reuse_aps_id);
+/**
+ * \brief Apply the derived CC-ALF filters to a CTU.
+ */
+void uvg_alf_enc_cc_filter_ctu(encoder_state_t *const state, const int ctu_x, const int ctu_y)
+{
+  alf_info_t *alf_info = state->tile->frame->alf_info;
+  cc_alf_filter_param *cc_filter_param = state->slice->alf->cc_filter_param;
+  const uvg_picture *rec_yuv = state->tile->frame->rec;
+  enum uvg_chroma_format chroma_format = state->encoder_control->chroma_format;
+  const int pic_height = state->tile->frame->height;
+  const int pic_width = state->tile->frame->width;
+  const int alf_vb_luma_ctu_height = LCU_WIDTH;
+  const int alf_vb_luma_pos = LCU_WIDTH - ALF_VB_POS_ABOVE_CTUROW_LUMA;
+  const int ctu_idx = ctu_y * state->tile->frame->width_in_lcu + ctu_x;
+  const int x_pos = ctu_x * LCU_WIDTH;
+  const int y_pos = ctu_y * LCU_WIDTH;
+  const int width = (x_pos + LCU_WIDTH > pic_width) ? (pic_width - x_pos) : LCU_WIDTH;
+  const int height = (y_pos + LCU_WIDTH > pic_height) ? (pic_height - y_pos) : LCU_WIDTH;
 
-  for (alf_component_id comp_idx = 1; comp_idx < (state->encoder_control->chroma_format == UVG_CSP_400 ? 1 : MAX_NUM_COMPONENT); comp_idx++)
+  for (alf_component_id comp_idx = 1; comp_idx < (chroma_format == UVG_CSP_400 ? 1 : MAX_NUM_COMPONENT); comp_idx++)
   {
-    if (cc_filter_param->cc_alf_filter_enabled[comp_idx - 1])
+    if (!cc_filter_param->cc_alf_filter_enabled[comp_idx - 1])
+    {
+      continue;
+    }
+
+    const int filter_idx = alf_info->cc_alf_filter_control[comp_idx - 1][ctu_idx];
+    if (filter_idx == 0)
     {
-      uvg_pixel* rec_uv = comp_idx == COMPONENT_Cb ? rec_yuv->u : rec_yuv->v;
-      const int luma_stride = rec_yuv->stride;
-      apply_cc_alf_filter(state, comp_idx, rec_uv, alf_info->alf_tmp_y, luma_stride, alf_info->cc_alf_filter_control[comp_idx - 1],
-        cc_filter_param->cc_alf_coeff[comp_idx - 1], -1, &arr_vars);
+      continue;
     }
+
+    uint8_t component_scale_y = (chroma_format != UVG_CSP_420) ? 0 : 1;
+    uint8_t component_scale_x = (chroma_format == UVG_CSP_444) ? 0 : 1;
+    uvg_pixel *rec_uv = comp_idx == COMPONENT_Cb ? rec_yuv->u : rec_yuv->v;
+    const int16_t *filter_coeff = cc_filter_param->cc_alf_coeff[comp_idx - 1][filter_idx - 1];
+
+    uvg_alf_filter_cc_blk(state, rec_uv, alf_info->alf_tmp_y, rec_yuv->stride, comp_idx, filter_coeff, alf_info->arr_vars.clp_rngs, alf_vb_luma_ctu_height,
+      alf_vb_luma_pos, x_pos >> component_scale_x, y_pos >> component_scale_y,
+      width >> component_scale_x, height >> component_scale_y);
   }
+}
 
+/**
+ * \brief Free the ALF buffers of the frame.
+ */
+void uvg_alf_enc_finish(encoder_state_t *const state)
+{
   alf_covariance_destroy(state->tile->frame);
-}
\ No newline at end of file
+}
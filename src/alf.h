@@ -235,6 +235,30 @@ typedef struct alf_aps {
 
 } alf_aps;
 
+typedef struct array_variables {
+  short fixed_filter_set_coeff_dec[ALF_NUM_FIXED_FILTER_SETS][MAX_NUM_ALF_CLASSES * MAX_NUM_ALF_LUMA_COEFF];
+  short chroma_coeff_final[MAX_NUM_ALF_ALTERNATIVES_CHROMA][MAX_NUM_ALF_CHROMA_COEFF];
+  short coeff_final[MAX_NUM_ALF_CLASSES * MAX_NUM_ALF_LUMA_COEFF];
+  short coeff_aps_luma[ALF_CTB_MAX_NUM_APS][MAX_NUM_ALF_CLASSES * MAX_NUM_ALF_LUMA_COEFF];
+
+  int16_t chroma_clipp_final[MAX_NUM_ALF_ALTERNATIVES_CHROMA][MAX_NUM_ALF_CHROMA_COEFF];
+  int16_t clip_default[MAX_NUM_ALF_CLASSES * MAX_NUM_ALF_LUMA_COEFF];
+  int16_t clipp_final[MAX_NUM_ALF_CLASSES * MAX_NUM_ALF_LUMA_COEFF];
+  int16_t clipp_aps_luma[ALF_CTB_MAX_NUM_APS][MAX_NUM_ALF_CLASSES * MAX_NUM_ALF_LUMA_COEFF];
+
+  short filter_indices[MAX_NUM_ALF_CLASSES][MAX_NUM_ALF_CLASSES];
+
+  unsigned bits_new_filter[MAX_NUM_CHANNEL_TYPE];
+  short alf_clipping_values[MAX_NUM_CHANNEL_TYPE][MAX_ALF_NUM_CLIPPING_VALUES];
+  int cc_reuse_aps_id[2];
+
+  int filter_coeff_set[MAX_NUM_ALF_CLASSES][MAX_NUM_ALF_LUMA_COEFF];
+  int filter_clipp_set[MAX_NUM_ALF_CLASSES][MAX_NUM_ALF_LUMA_COEFF];
+
+  struct clp_rngs clp_rngs;
+
+} array_variables;
+
 typedef struct alf_info_t {
   cabac_data_t cabac_estimator;
 
@@ -278,6 +302,9 @@ typedef struct alf_info_t {
   alf_classifier **classifier;
   alf_aps alf_param_temp;
 
+  array_variables arr_vars;
+  cabac_data_t cabac_start; //CABAC state before the ALF RDO, used again for CC-ALF
+
 } alf_info_t;
 
 typedef struct param_set_map {
@@ -286,39 +313,31 @@ typedef struct param_set_map {
   struct alf_aps parameter_set;
 } param_set_map;
 
-typedef struct array_variables {
-  short fixed_filter_set_coeff_dec[ALF_NUM_FIXED_FILTER_SETS][MAX_NUM_ALF_CLASSES * MAX_NUM_ALF_LUMA_COEFF];
-  short chroma_coeff_final[MAX_NUM_ALF_ALTERNATIVES_CHROMA][MAX_NUM_ALF_CHROMA_COEFF];
-  short coeff_final[MAX_NUM_ALF_CLASSES * MAX_NUM_ALF_LUMA_COEFF];
-  short coeff_aps_luma[ALF_CTB_MAX_NUM_APS][MAX_NUM_ALF_CLASSES * MAX_NUM_ALF_LUMA_COEFF];
-
-  int16_t chroma_clipp_final[MAX_NUM_ALF_ALTERNATIVES_CHROMA][MAX_NUM_ALF_CHROMA_COEFF];
-  int16_t clip_default[MAX_NUM_ALF_CLASSES * MAX_NUM_ALF_LUMA_COEFF];
-  int16_t clipp_final[MAX_NUM_ALF_CLASSES * MAX_NUM_ALF_LUMA_COEFF];
-  int16_t clipp_aps_luma[ALF_CTB_MAX_NUM_APS][MAX_NUM_ALF_CLASSES * MAX_NUM_ALF_LUMA_COEFF];
-
-  short filter_indices[MAX_NUM_ALF_CLASSES][MAX_NUM_ALF_CLASSES];
-
-  unsigned bits_new_filter[MAX_NUM_CHANNEL_TYPE];
-  short alf_clipping_values[MAX_NUM_CHANNEL_TYPE][MAX_ALF_NUM_CLIPPING_VALUES];
-  int cc_reuse_aps_id[2];
-
-  int filter_coeff_set[MAX_NUM_ALF_CLASSES][MAX_NUM_ALF_LUMA_COEFF];
-  int filter_clipp_set[MAX_NUM_ALF_CLASSES][MAX_NUM_ALF_LUMA_COEFF];
-
-  struct clp_rngs clp_rngs;
-
-} array_variables;
-
 //inits aps parameter set in videoframe
 void uvg_set_aps_map(videoframe_t* frame, enum uvg_alf alf_type);
 
 //resets cc alf parameter
 void uvg_reset_cc_alf_aps_param(cc_alf_filter_param *cc_alf);
 
-//starts alf encoding process
+//starts alf encoding process, runs all of the steps below for the whole frame
 void uvg_alf_enc_process(encoder_state_t *const state);
 
+//allocates the per frame alf buffers, must be called before the steps below
+void uvg_alf_enc_init(encoder_state_t *const state);
+//classification and statistics of a ctu, needs the final reconstruction of the ctus within two ctus below and right of it
+void uvg_alf_enc_ctu_stats(encoder_state_t *const state, const int ctu_x, const int ctu_y);
+//derives the filters and the ctu on/off decisions from the statistics of all ctus
+void uvg_alf_enc_derive(encoder_state_t *const state);
+//filters a ctu with the derived filters
+void uvg_alf_enc_filter_ctu(encoder_state_t *const state, const int ctu_x, const int ctu_y);
+//cc alf steps, only with UVG_ALF_FULL and after all ctus have been filtered
+void uvg_alf_enc_cc_prepare(encoder_state_t *const state);
+void uvg_alf_enc_cc_ctu_stats(encoder_state_t *const state, const int ctu_x, const int ctu_y);
+void uvg_alf_enc_cc_derive(encoder_state_t *const state);
+void uvg_alf_enc_cc_filter_ctu(encoder_state_t *const state, const int ctu_x, const int ctu_y);
+//frees the per frame alf buffers
+void uvg_alf_enc_finish(encoder_state_t *const state);
+
 //creates variables for alf_info_t structure in videoframe_t 
 void uvg_alf_create(videoframe_t *frame, enum uvg_chroma_format chroma_format);
 //frees allocated memory in alf_info_t structure
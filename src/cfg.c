@@ -243,6 +243,15 @@ int uvg_config_init(uvg_config *cfg)
   cfg->ibc = 0;
 
   cfg->dep_quant = 0;
+
+  cfg->lookahead = 0;
+  cfg->scenecut = 40;
+  cfg->cutree = 0;
+
+  cfg->ref_padding = 0;
+  cfg->me_ref_skip = 0;
+  cfg->bipred_refine = 0;
+  cfg->global_motion = 0;
   return 1;
 }
 
@@ -565,7 +574,7 @@ static int parse_slice_specification(const char* const arg, int32_t * const nsli
 
 int uvg_config_parse(uvg_config *cfg, const char *name, const char *value)
 {
-  static const char * const me_names[]          = { "hexbs", "tz", "full", "full8", "full16", "full32", "full64", "dia", NULL };
+  static const char * const me_names[]          = { "hexbs", "tz", "full", "full8", "full16", "full32", "full64", "dia", "pyramid", NULL };
   static const char * const source_scan_type_names[] = { "progressive", "tff", "bff", NULL };
 
   static const char * const overscan_names[]    = { "undef", "show", "crop", NULL };
@@ -1625,6 +1634,27 @@ int uvg_config_parse(uvg_config *cfg, const char *name, const char *value)
   else if OPT("dep-quant") {
     cfg->dep_quant = (bool)atobool(value);
   }
+  else if OPT("lookahead") {
+    cfg->lookahead = atoi(value);
+  }
+  else if OPT("scenecut") {
+    cfg->scenecut = (int8_t)atoi(value);
+  }
+  else if OPT("cutree") {
+    cfg->cutree = (bool)atobool(value);
+  }
+  else if OPT("ref-padding") {
+    cfg->ref_padding = (bool)atobool(value);
+  }
+  else if OPT("me-ref-skip") {
+    cfg->me_ref_skip = (bool)atobool(value);
+  }
+  else if OPT("bipred-refine") {
+    cfg->bipred_refine = atoi(value);
+  }
+  else if OPT("global-motion") {
+    cfg->global_motion = (bool)atobool(value);
+  }
   else {
     return 0;
   }
@@ -1832,6 +1862,26 @@ int uvg_config_validate(const uvg_config *const cfg)
     error = 1;
   }
 
+  if (cfg->lookahead < 0 || cfg->lookahead > 250) {
+    fprintf(stderr, "Input error: --lookahead out of range [0..250]\n");
+    error = 1;
+  }
+
+  if (cfg->scenecut < 0 || cfg->scenecut > 100) {
+    fprintf(stderr, "Input error: --scenecut out of range [0..100]\n");
+    error = 1;
+  }
+
+  if (cfg->bipred_refine < 0 || cfg->bipred_refine > 8) {
+    fprintf(stderr, "Input error: --bipred-refine out of range [0..8]\n");
+    error = 1;
+  }
+
+  if (cfg->cutree && cfg->lookahead == 0) {
+    fprintf(stderr, "Input error: --cutree requires --lookahead\n");
+    error = 1;
+  }
+
   if (cfg->qp != CLIP_TO_QP(cfg->qp)) {
       fprintf(stderr, "Input error: --qp parameter out of range [0..51]\n");
       error = 1;
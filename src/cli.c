@@ -201,6 +201,17 @@ static const struct option long_options[] = {
   { "ibc",                required_argument, NULL, 0 },
   { "dep-quant",                no_argument, NULL, 0 },
   { "no-dep-quant",             no_argument, NULL, 0 },
+  { "lookahead",          required_argument, NULL, 0 },
+  { "scenecut",           required_argument, NULL, 0 },
+  { "cutree",                   no_argument, NULL, 0 },
+  { "no-cutree",                no_argument, NULL, 0 },
+  { "ref-padding",              no_argument, NULL, 0 },
+  { "no-ref-padding",           no_argument, NULL, 0 },
+  { "me-ref-skip",              no_argument, NULL, 0 },
+  { "no-me-ref-skip",           no_argument, NULL, 0 },
+  { "bipred-refine",            required_argument, NULL, 0 },
+  { "global-motion",            no_argument, NULL, 0 },
+  { "no-global-motion",         no_argument, NULL, 0 },
   {0, 0, 0, 0}
 };
 
@@ -495,6 +506,17 @@ void print_help(void)
     "                                   - 16: B-frame pyramid of length 16\n"
     "                                   - lp-<string>: Low-delay P/B-frame GOP\n"
     "                                     (e.g. lp-g8d4t2, see README)\n"
+    "      --lookahead <integer>  : Number of frames analyzed ahead of encoding\n"
+    "                               for scene cuts and rate control. [0]\n"
+    "                                   - 0: Disable lookahead.\n"
+    "      --scenecut <integer>   : Threshold for starting a new intra period at\n"
+    "                               scene cuts detected by the lookahead. A cut\n"
+    "                               is only used if the next frame confirms it,\n"
+    "                               so single-frame flashes are ignored. Cuts\n"
+    "                               are not detected with B-frame pyramid\n"
+    "                               (random access) GOPs, which keep a fixed\n"
+    "                               intra period. [40]\n"
+    "                                   - 0: Disable scene cut detection.\n"
     "      --intra-qp-offset <int>: QP offset for intra frames [-51..51] [auto]\n"
     "                                   - N: Set QP offset to N.\n"
     "                                   - auto: Select offset automatically based\n"
@@ -552,6 +574,9 @@ void print_help(void)
     "      --(no-)vaq <integer>   : Enable variance adaptive quantization with given\n"
     "                               strength, in range 1..20. Recommended: 5.\n"
     "                               [disabled]\n"
+    "      --(no-)cutree          : Lower the QP of CTUs that later frames refer\n"
+    "                               to, as estimated by the lookahead. Requires\n"
+    "                               --lookahead. [disabled]\n"
     "      --chroma-qp-in         : List of input values used for mapping the luma\n"
     "                               QP into chroma qp. [17,27,32,44]\n"
     "      --chroma-qp-out        : List of output values used for mapping the luma\n"
@@ -603,14 +628,26 @@ void print_help(void)
     "                                   - full:  Full Search\n"
     "                                   - full8, full16, full32, full64\n"
     "                                   - dia:   Diamond Search\n"
+    "                                   - pyramid: Coarse-to-fine search on\n"
+    "                                              downscaled frames\n"
     "      --me-steps <integer>   : Motion estimation search step limit. Only\n"
-    "                               affects 'hexbs' and 'dia'. [-1]\n"
+    "                               affects 'hexbs', 'dia' and 'pyramid'. [-1]\n"
     "      --subme <integer>      : Fractional pixel motion estimation level [4]\n"
     "                                   - 0: Integer motion estimation only\n"
     "                                   - 1: + 1/2-pixel horizontal and vertical\n"
     "                                   - 2: + 1/2-pixel diagonal\n"
     "                                   - 3: + 1/4-pixel horizontal and vertical\n"
     "                                   - 4: + 1/4-pixel diagonal\n"
+    "      --(no-)ref-padding     : Keep a copy of each reference frame with a\n"
+    "                               wide replicated border so that blocks\n"
+    "                               crossing the frame border need no\n"
+    "                               extrapolation in inter prediction and motion\n"
+    "                               estimation. Uses more memory. Not used with\n"
+    "                               tiles or LMCS. [disabled]\n"
+    "      --(no-)global-motion   : Estimate the global motion of each frame\n"
+    "                               relative to its reference frames and use\n"
+    "                               it as a starting point of the integer\n"
+    "                               motion search. [disabled]\n"
     "      --pu-depth-inter <int>-<int> : Maximum and minimum split depths where\n"
     "                                     inter search is performed 0..8. [0-3]\n"
     "                                   - Accepts a list of values separated by ','\n"
@@ -630,8 +667,7 @@ void print_help(void)
     "      --mtt-depth-intra-chroma : Depth of mtt for chroma dual tree in\n"
     "                                      intra slices 0..3.[0]\n"
     "      --mtt-depth-inter      : Depth of mtt for inter slices 0..3.[0]\n"
-    "                              All MTTs are currently experimental and\n"
-    "                              require disabling some avx2 optimizations.\n"
+    "                              All MTTs are currently experimental.\n"
     "      --max-bt-size          : maximum size for a CU resulting from\n"
     "                                   a bt split. A singular value shared for all\n"
     "                                   or a list of three values for the different\n"
@@ -660,6 +696,11 @@ void print_help(void)
     "                               guaranteed to produce sensible bitstream or\n"
     "                               work at all. [disabled]\n"
     "      --(no-)bipred          : Bi-prediction [disabled]\n"
+    "      --bipred-refine <int>  : Refine the vectors of bi-prediction\n"
+    "                               one list at a time with the other list\n"
+    "                               fixed, for at most <int> iterations\n"
+    "                               of quarter-pixel steps. 0 disables.\n"
+    "                               Needs --bipred. [0]\n"
     "      --cu-split-termination <string> : CU split search termination [zero]\n"
     "                                   - off: Don't terminate early.\n"
     "                                   - zero: Terminate when residual is zero.\n"
@@ -667,6 +708,15 @@ void print_help(void)
     "                                   - off: Don't terminate early.\n"
     "                                   - on: Terminate early.\n"
     "                                   - sensitive: Terminate even earlier.\n"
+    "      --(no-)me-ref-skip     : Skip the integer motion search of a\n"
+    "                               reference frame when the vectors found\n"
+    "                               for it at other depths and in other\n"
+    "                               references cost over 3 times the best\n"
+    "                               vector already found in another reference\n"
+    "                               for the same block. With --me tz --ref 4\n"
+    "                               this skips about a third of the searches\n"
+    "                               and costs up to 1% in bit rate at medium\n"
+    "                               and slower presets. [disabled]\n"
     "      --fast-residual-cost <int> : Skip CABAC cost for residual coefficients\n"
     "                                   when QP is below the limit. [0]\n"
     "      --fast-coeff-table <string> : Read custom weights for residual\n"
@@ -696,8 +746,7 @@ void print_help(void)
     "      --(no-)lfnst           : Enable low frequency non-separable transform.\n"
     "                                 [disabled]\n"
     "      --(no-)isp             : Enable intra sub partitions. [disabled]\n"
-    "                               Experimental, requires disabling some avx2\n"
-    "                               optimizations.\n"
+    "                               Experimental.\n"
     "      --mts <string>         : Multiple Transform Selection [off].\n"
     "                               (Currently only implemented for intra\n"
     "                               and has effect only when rd >= 2)\n"
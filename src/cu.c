@@ -266,6 +266,62 @@ cu_array_t * uvg_cu_array_copy_ref(cu_array_t* cua)
 }
 
 
+/**
+ * \brief Allocate a collocated motion field.
+ *
+ * \param width   width of the picture in luma pixels
+ * \param height  height of the picture in luma pixels
+ */
+col_motion_field_t * uvg_col_motion_field_alloc(const int width, const int height)
+{
+  col_motion_field_t *field = MALLOC(col_motion_field_t, 1);
+  if (field == NULL) return NULL;
+
+  field->width    = CEILDIV(width,  1 << COL_MOTION_LOG2_SIZE);
+  field->height   = CEILDIV(height, 1 << COL_MOTION_LOG2_SIZE);
+  field->data     = calloc(field->width * field->height, sizeof(col_motion_t));
+  if (field->data == NULL) {
+    FREE_POINTER(field);
+    return NULL;
+  }
+  field->refcount = 1;
+
+  return field;
+}
+
+void uvg_col_motion_field_free(col_motion_field_t **field_ptr)
+{
+  col_motion_field_t *field = *field_ptr;
+  if (field == NULL) return;
+  *field_ptr = NULL;
+
+  int new_refcount = UVG_ATOMIC_DEC(&field->refcount);
+  if (new_refcount > 0) {
+    // Still we have some references, do nothing.
+    return;
+  }
+
+  assert(new_refcount == 0);
+
+  FREE_POINTER(field->data);
+  FREE_POINTER(field);
+}
+
+
+/**
+ * \brief Get a new pointer to a collocated motion field.
+ *
+ * Increment reference count and return the field.
+ */
+col_motion_field_t * uvg_col_motion_field_copy_ref(col_motion_field_t *field)
+{
+  int32_t new_refcount = UVG_ATOMIC_INC(&field->refcount);
+  assert(new_refcount >= 2);
+  (void)new_refcount;
+  return field;
+}
+
+
 /**
  * \brief Copy an lcu to a cu array.
  *
@@ -258,6 +258,49 @@ cu_array_t * uvg_cu_subarray(cu_array_t *base,
 void uvg_cu_array_free(cu_array_t **cua_ptr);
 cu_array_t * uvg_cu_array_copy_ref(cu_array_t* cua);
 
+//! \brief Log2 of the block size at which motion is kept for TMVP.
+#define COL_MOTION_LOG2_SIZE 3
+
+/**
+ * \brief Motion of a block of a reference picture as seen by TMVP.
+ */
+typedef struct {
+  mv_t mv[2][2];      //!< \brief L0 and L1 motion vectors
+  int32_t ref_poc[2]; //!< \brief POC of the picture each MV points to
+  uint8_t mv_dir;     //!< \brief 1 = L0, 2 = L1, 3 = both, 0 = not inter
+} col_motion_t;
+
+/**
+ * \brief Motion of a whole picture on the 8x8 grid read by TMVP.
+ *
+ * Kept in the reference picture lists instead of the full cu_array_t,
+ * which is about five times the size and only needed while the picture
+ * itself is being encoded.
+ */
+typedef struct {
+  col_motion_t *data; //!< \brief one entry per 8x8 block in raster order
+  uint32_t width;     //!< \brief width of the field in blocks
+  uint32_t height;    //!< \brief height of the field in blocks
+  uint32_t refcount;  //!< \brief number of references to this field
+} col_motion_field_t;
+
+col_motion_field_t * uvg_col_motion_field_alloc(const int width, const int height);
+void uvg_col_motion_field_free(col_motion_field_t **field_ptr);
+col_motion_field_t * uvg_col_motion_field_copy_ref(col_motion_field_t *field);
+
+/**
+ * \brief Get the motion of the block containing a luma pixel.
+ */
+static INLINE const col_motion_t * uvg_col_motion_at(const col_motion_field_t *field,
+                                                     unsigned x_px,
+                                                     unsigned y_px)
+{
+  assert((x_px >> COL_MOTION_LOG2_SIZE) < field->width);
+  assert((y_px >> COL_MOTION_LOG2_SIZE) < field->height);
+  return &field->data[(x_px >> COL_MOTION_LOG2_SIZE) +
+                      (y_px >> COL_MOTION_LOG2_SIZE) * field->width];
+}
+
 
 /**
  * \brief Return the 7 lowest-order bits of the pixel coordinate.
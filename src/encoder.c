@@ -40,6 +40,7 @@
 #include "cfg.h"
 #include "gop.h"
 #include "rdo.h"
+#include "search.h"
 #include "strategyselector.h"
 #include "uvg_math.h"
 #include "fast_coeff_cost.h"
@@ -158,7 +159,8 @@ static int8_t* derive_chroma_QP_mapping_table(const uvg_config* const cfg, int i
   }
 
   table[qpInVal[0]] = qpOutVal[0];
-  for (int k = qpInVal[0] - 1; k >= -qpBdOffsetC; k--)
+  // The table only has entries for non-negative QPs.
+  for (int k = qpInVal[0] - 1; k >= 0; k--)
   {
     table[k] = CLIP(-qpBdOffsetC, MAX_QP, table[k + 1] - 1);
   }
@@ -292,6 +294,12 @@ encoder_control_t* uvg_encoder_control_init(const uvg_config *const cfg)
     goto init_failed;
   }
 
+  encoder->work_tree_pool = uvg_work_tree_pool_alloc();
+  if (!encoder->work_tree_pool) {
+    fprintf(stderr, "Could not initialize work tree pool.\n");
+    goto init_failed;
+  }
+
   encoder->bitdepth = UVG_BIT_DEPTH;
 
   encoder->chroma_format = UVG_FORMAT2CSP(encoder->cfg.input_format);
@@ -694,6 +702,10 @@ void uvg_encoder_control_free(encoder_control_t *const encoder)
 
   uvg_threadqueue_free(encoder->threadqueue);
   encoder->threadqueue = NULL;
+
+  uvg_work_tree_pool_free(encoder->work_tree_pool);
+  encoder->work_tree_pool = NULL;
+
   for (int i = 0; i < encoder->cfg.num_used_table; i++) {
     if (encoder->qp_map[i]) FREE_POINTER(encoder->qp_map[i]);
   }
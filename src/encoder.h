@@ -45,6 +45,8 @@
 #include "threadqueue.h"
 #include "fast_coeff_cost.h"
 
+struct work_tree_pool_t;
+
 /* Encoder control options, the main struct */
 typedef struct encoder_control_t
 {
@@ -126,6 +128,9 @@ typedef struct encoder_control_t
 
   threadqueue_queue_t *threadqueue;
 
+  //! Work trees reused by the CTU searches of all threads.
+  struct work_tree_pool_t *work_tree_pool;
+
   //! Target average bits per picture.
   double target_avg_bppic;
 
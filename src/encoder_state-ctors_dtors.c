@@ -61,6 +61,7 @@ static int encoder_state_config_frame_init(encoder_state_t * const state) {
   state->frame->ref_list = REF_PIC_LIST_0;
   state->frame->num = 0;
   state->frame->poc = 0;
+  state->frame->irap_num = 0;
   state->frame->total_bits_coded = 0;
   state->frame->cur_frame_bits_coded = 0;
   state->frame->cur_gop_bits_coded = 0;
@@ -131,16 +132,32 @@ static int encoder_state_config_tile_init(encoder_state_t * const state,
     state->tile->frame->ibc_buffer_y = malloc(sizeof(uvg_pixel*) * state->tile->frame->height_in_lcu);
     state->tile->frame->ibc_buffer_u = malloc(sizeof(uvg_pixel*) * state->tile->frame->height_in_lcu);
     state->tile->frame->ibc_buffer_v = malloc(sizeof(uvg_pixel*) * state->tile->frame->height_in_lcu);
-    state->tile->frame->ibc_hashmap_row = malloc(sizeof(uvg_hashmap_t) * state->tile->frame->height_in_lcu);
+    state->tile->frame->ibc_hashmap_row = calloc(state->tile->frame->height_in_lcu, sizeof(uvg_hashmap_t*));
+    state->tile->frame->ibc_hashmap_row_prev = calloc(state->tile->frame->height_in_lcu, sizeof(uvg_hashmap_t*));
+    if (!state->tile->frame->ibc_hashmap_row || !state->tile->frame->ibc_hashmap_row_prev) {
+      fprintf(stderr, "Failed to allocate the IBC hashmaps.\n");
+      return 0;
+    }
 
     if (state->encoder_control->cfg.ibc & 2) {
       state->tile->frame->ibc_hashmap_pos_to_hash_stride = ((state->tile->frame->width+UVG_HASHMAP_BLOCKSIZE-1)/ UVG_HASHMAP_BLOCKSIZE);
       state->tile->frame->ibc_hashmap_pos_to_hash = malloc(sizeof(uint32_t) *
         ((state->tile->frame->height+UVG_HASHMAP_BLOCKSIZE-1)/ UVG_HASHMAP_BLOCKSIZE) * state->tile->frame->ibc_hashmap_pos_to_hash_stride);
+      state->tile->frame->ibc_hashmap_pos_to_hash_prev = malloc(sizeof(uint32_t) *
+        ((state->tile->frame->height+UVG_HASHMAP_BLOCKSIZE-1)/ UVG_HASHMAP_BLOCKSIZE) * state->tile->frame->ibc_hashmap_pos_to_hash_stride);
+      if (!state->tile->frame->ibc_hashmap_pos_to_hash || !state->tile->frame->ibc_hashmap_pos_to_hash_prev) {
+        fprintf(stderr, "Failed to allocate the IBC block hashes.\n");
+        return 0;
+      }
     }
 
     for (uint32_t i = 0; i < state->tile->frame->height_in_lcu; i++) {
       state->tile->frame->ibc_hashmap_row[i] = uvg_hashmap_create((LCU_WIDTH * IBC_BUFFER_WIDTH)>>2);
+      state->tile->frame->ibc_hashmap_row_prev[i] = uvg_hashmap_create((LCU_WIDTH * IBC_BUFFER_WIDTH)>>2);
+      if (!state->tile->frame->ibc_hashmap_row[i] || !state->tile->frame->ibc_hashmap_row_prev[i]) {
+        fprintf(stderr, "Failed to allocate the IBC hashmaps.\n");
+        return 0;
+      }
       state->tile->frame->ibc_buffer_y[i] = (uvg_pixel*)malloc(IBC_BUFFER_SIZE * 3); // ToDo: we don't need this much, but it would also support 4:4:4
       state->tile->frame->ibc_buffer_u[i] = &state->tile->frame->ibc_buffer_y[i][IBC_BUFFER_SIZE];
       state->tile->frame->ibc_buffer_v[i] = &state->tile->frame->ibc_buffer_y[i][IBC_BUFFER_SIZE * 2];
@@ -199,6 +216,41 @@ static int encoder_state_config_tile_init(encoder_state_t * const state,
     state->tile->wf_jobs = NULL;
     state->tile->wf_recon_jobs = NULL;
   }
+
+  if (encoder->cfg.wpp && encoder->cfg.alf_type) {
+    int num_jobs = state->tile->frame->width_in_lcu * state->tile->frame->height_in_lcu;
+    state->tile->wf_alf_stats_jobs = MALLOC(threadqueue_job_t*, num_jobs);
+    if (!state->tile->wf_alf_stats_jobs) {
+      printf("Error allocating wf_alf_stats_jobs array!\n");
+      return 0;
+    }
+    for (int i = 0; i < num_jobs; ++i) {
+      state->tile->wf_alf_stats_jobs[i] = NULL;
+    }
+  } else {
+    state->tile->wf_alf_stats_jobs = NULL;
+  }
+
+  if (encoder->cfg.wpp && (encoder->cfg.ibc & 2)) {
+    state->tile->wf_ibc_hash_jobs = MALLOC(threadqueue_job_t*, state->tile->frame->height_in_lcu);
+    if (!state->tile->wf_ibc_hash_jobs) {
+      printf("Error allocating wf_ibc_hash_jobs array!\n");
+      return 0;
+    }
+    for (uint32_t i = 0; i < state->tile->frame->height_in_lcu; ++i) {
+      state->tile->wf_ibc_hash_jobs[i] = NULL;
+    }
+  } else {
+    state->tile->wf_ibc_hash_jobs = NULL;
+  }
+
+  state->tile->coeff_pool = MALLOC(lcu_coeff_t*, state->tile->frame->width_in_lcu * state->tile->frame->height_in_lcu);
+  state->tile->coeff_pool_count = 0;
+  if (!state->tile->coeff_pool || pthread_mutex_init(&state->tile->coeff_pool_lock, NULL) != 0) {
+    printf("Error allocating coeff_pool!\n");
+    return 0;
+  }
+
   state->tile->id = encoder->tiles_tile_id[state->tile->lcu_offset_in_ts];
   return 1;
 }
@@ -216,6 +268,14 @@ static void encoder_state_config_tile_finalize(encoder_state_t * const state) {
     for (int i = 0; i < num_jobs; ++i) {
       uvg_threadqueue_free_job(&state->tile->wf_jobs[i]);
       uvg_threadqueue_free_job(&state->tile->wf_recon_jobs[i]);
+      if (state->tile->wf_alf_stats_jobs) {
+        uvg_threadqueue_free_job(&state->tile->wf_alf_stats_jobs[i]);
+      }
+    }
+    if (state->tile->wf_ibc_hash_jobs) {
+      for (uint32_t i = 0; i < state->tile->frame->height_in_lcu; ++i) {
+        uvg_threadqueue_free_job(&state->tile->wf_ibc_hash_jobs[i]);
+      }
     }
   }
 
@@ -228,13 +288,20 @@ static void encoder_state_config_tile_finalize(encoder_state_t * const state) {
   if (state->encoder_control->cfg.ibc) {
     if (state->encoder_control->cfg.ibc & 2) {
       FREE_POINTER(state->tile->frame->ibc_hashmap_pos_to_hash);
+      FREE_POINTER(state->tile->frame->ibc_hashmap_pos_to_hash_prev);
     }
 
     for (uint32_t i = 0; i < state->tile->frame->height_in_lcu; i++) {
       FREE_POINTER(state->tile->frame->ibc_buffer_y[i]);
-      uvg_hashmap_free(state->tile->frame->ibc_hashmap_row[i]);
+      if (state->tile->frame->ibc_hashmap_row) {
+        uvg_hashmap_free(state->tile->frame->ibc_hashmap_row[i]);
+      }
+      if (state->tile->frame->ibc_hashmap_row_prev) {
+        uvg_hashmap_free(state->tile->frame->ibc_hashmap_row_prev[i]);
+      }
     }
     FREE_POINTER(state->tile->frame->ibc_hashmap_row);
+    FREE_POINTER(state->tile->frame->ibc_hashmap_row_prev);
     FREE_POINTER(state->tile->frame->ibc_buffer_y);
     FREE_POINTER(state->tile->frame->ibc_buffer_u);
     FREE_POINTER(state->tile->frame->ibc_buffer_v);
@@ -244,6 +311,14 @@ static void encoder_state_config_tile_finalize(encoder_state_t * const state) {
   state->tile->frame = NULL;
   FREE_POINTER(state->tile->wf_jobs);
   FREE_POINTER(state->tile->wf_recon_jobs);
+  FREE_POINTER(state->tile->wf_alf_stats_jobs);
+  FREE_POINTER(state->tile->wf_ibc_hash_jobs);
+
+  for (int i = 0; i < state->tile->coeff_pool_count; ++i) {
+    FREE_POINTER(state->tile->coeff_pool[i]);
+  }
+  FREE_POINTER(state->tile->coeff_pool);
+  pthread_mutex_destroy(&state->tile->coeff_pool_lock);
 }
 
 static int encoder_state_config_slice_init(encoder_state_t * const state,
@@ -360,6 +435,7 @@ int uvg_encoder_state_init(encoder_state_t * const child_state, encoder_state_t
   child_state->tqj_bitstream_written = NULL;
   child_state->tqj_recon_done = NULL;
   child_state->tqj_alf_process = NULL;
+  child_state->tqj_alf_derive = NULL;
   
   if (!parent_state) {
     const encoder_control_t * const encoder = child_state->encoder_control;
@@ -773,5 +849,6 @@ void uvg_encoder_state_finalize(encoder_state_t * const state) {
     encoder_state_t* parent = state;
     while (parent->parent) parent = parent->parent;
     uvg_threadqueue_free_job(&parent->tqj_alf_process);
+    uvg_threadqueue_free_job(&parent->tqj_alf_derive);
   }
 }
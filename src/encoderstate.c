@@ -45,8 +45,10 @@
 #include "encode_coding_tree.h"
 #include "encoder_state-bitstream.h"
 #include "filter.h"
+#include "ref_padding.h"
 #include "hashmap.h"
 #include "image.h"
+#include "inter.h"
 #include "rate_control.h"
 #include "sao.h"
 #include "search.h"
@@ -731,6 +733,165 @@ static void set_joint_cb_cr_modes(encoder_state_t* state, uvg_picture* pic)
 
 static void encoder_state_worker_encode_lcu_bitstream(void* opaque);
 
+/**
+ * \brief Get a coefficient buffer for an LCU from the pool of the tile.
+ *
+ * Buffers are zeroed only when allocated. The search overwrites the luma
+ * and chroma coefficients of the whole LCU and the joint chroma
+ * coefficients when JCCR is enabled, so a reused buffer needs no clearing.
+ */
+static lcu_coeff_t * encoder_state_coeff_take(encoder_state_t * const state)
+{
+  encoder_state_config_tile_t * const tile = state->tile;
+  lcu_coeff_t *coeff = NULL;
+
+  pthread_mutex_lock(&tile->coeff_pool_lock);
+  if (tile->coeff_pool_count > 0) {
+    coeff = tile->coeff_pool[--tile->coeff_pool_count];
+  }
+  pthread_mutex_unlock(&tile->coeff_pool_lock);
+
+  if (!coeff) {
+    coeff = calloc(1, sizeof(lcu_coeff_t));
+  }
+  return coeff;
+}
+
+/**
+ * \brief Return a coefficient buffer to the pool of the tile.
+ */
+static void encoder_state_coeff_release(encoder_state_t * const state, lcu_coeff_t *coeff)
+{
+  encoder_state_config_tile_t * const tile = state->tile;
+
+  pthread_mutex_lock(&tile->coeff_pool_lock);
+  // Each LCU holds at most one buffer so the pool never overflows.
+  assert(tile->coeff_pool_count < tile->frame->width_in_lcu * tile->frame->height_in_lcu);
+  tile->coeff_pool[tile->coeff_pool_count++] = coeff;
+  pthread_mutex_unlock(&tile->coeff_pool_lock);
+}
+
+/**
+ * \brief Add the blocks of an LCU to the IBC hashmap of its row.
+ *
+ * The 8x8 blocks are taken at every UVG_HASHMAP_BLOCKSIZE / 2 pixels. Blocks
+ * that are aligned to UVG_HASHMAP_BLOCKSIZE are also stored in the position
+ * to hash map.
+ */
+static void encoder_state_ibc_hash_lcu(encoder_state_t * const state,
+                                       const lcu_order_element_t * const lcu)
+{
+  videoframe_t * const frame = state->tile->frame;
+  const uvg_picture * const source = frame->source;
+  const uint32_t ctu_row = (lcu->position_px.y >> LOG2_LCU_WIDTH);
+  const int32_t step = UVG_HASHMAP_BLOCKSIZE >> 1;
+  const int32_t stride = source->stride;
+  const int32_t stride_c = source->stride >> 1;
+  const int32_t ibc_block_width = MIN(LCU_WIDTH, (frame->width - lcu->position_px.x));
+  const int32_t ibc_block_height = MIN(LCU_WIDTH, (frame->height - lcu->position_px.y));
+  const int32_t blocks_x = ibc_block_width < 8 ? 0 : (ibc_block_width - 8) / step + 1;
+  const int32_t blocks_y = ibc_block_height < 8 ? 0 : (ibc_block_height - 8) / step + 1;
+  const bool has_chroma = state->encoder_control->chroma_format != UVG_CSP_400;
+
+  // Checksums of the blocks, four horizontally adjacent blocks at a time.
+  uint32_t crcs[LCU_WIDTH / 4][LCU_WIDTH / 4];
+  for (int32_t by = 0; by < blocks_y; ++by) {
+    const int32_t cur_y = lcu->position_px.y + by * step;
+    int32_t bx = 0;
+    for (; bx + 4 <= blocks_x; bx += 4) {
+      const int32_t cur_x = lcu->position_px.x + bx * step;
+      uvg_crc32c_8x8_x4(&source->y[cur_y * stride + cur_x], stride, step, &crcs[by][bx]);
+      if (has_chroma) {
+        uint32_t crc_u[4];
+        uint32_t crc_v[4];
+        uvg_crc32c_4x4_x4(&source->u[(cur_y >> 1) * stride_c + (cur_x >> 1)], stride_c, step >> 1, crc_u);
+        uvg_crc32c_4x4_x4(&source->v[(cur_y >> 1) * stride_c + (cur_x >> 1)], stride_c, step >> 1, crc_v);
+        for (int i = 0; i < 4; ++i) {
+          crcs[by][bx + i] += crc_u[i] + crc_v[i];
+        }
+      }
+    }
+    for (; bx < blocks_x; ++bx) {
+      const int32_t cur_x = lcu->position_px.x + bx * step;
+      crcs[by][bx] = uvg_crc32c_8x8(&source->y[cur_y * stride + cur_x], stride);
+      if (has_chroma) {
+        crcs[by][bx] += uvg_crc32c_4x4(&source->u[(cur_y >> 1) * stride_c + (cur_x >> 1)], stride_c);
+        crcs[by][bx] += uvg_crc32c_4x4(&source->v[(cur_y >> 1) * stride_c + (cur_x >> 1)], stride_c);
+      }
+    }
+  }
+
+  for (int32_t bx = 0; bx < blocks_x; ++bx) {
+    for (int32_t by = 0; by < blocks_y; ++by) {
+      const int32_t xx = bx * step;
+      const int32_t yy = by * step;
+      const int32_t cur_x = lcu->position_px.x + xx;
+      const int32_t cur_y = lcu->position_px.y + yy;
+      const bool aligned = xx % UVG_HASHMAP_BLOCKSIZE == 0 && yy % UVG_HASHMAP_BLOCKSIZE == 0;
+
+      // Skip blocks that seem to be the same value for the whole block
+      uint64_t first_line = *(uint64_t *)&source->y[cur_y * stride + cur_x];
+      bool same_data = true;
+      for (int y_temp = 1; y_temp < 8; y_temp++) {
+        if (*(uint64_t *)&source->y[(cur_y + y_temp) * stride + cur_x] != first_line) {
+          same_data = false;
+          break;
+        }
+      }
+
+      if (!same_data || aligned) {
+        const uint32_t crc = crcs[by][bx];
+        if (aligned) {
+          frame->ibc_hashmap_pos_to_hash[(cur_y / UVG_HASHMAP_BLOCKSIZE) * frame->ibc_hashmap_pos_to_hash_stride + cur_x / UVG_HASHMAP_BLOCKSIZE] = crc;
+        }
+        // The map only provides search candidates, so a block that does not
+        // fit in when memory runs out is simply not found.
+        uvg_hashmap_insert(frame->ibc_hashmap_row[ctu_row], crc, ((cur_x & 0xffff) << 16) | (cur_y & 0xffff));
+      }
+    }
+  }
+}
+
+/**
+ * \brief Hash the LCU row that starts from lcu for the IBC hash search.
+ *
+ * Only the source frame is read, so the rows can be hashed before the
+ * search of the frame starts. The search of an LCU row reads the hashes of
+ * its own row and the row below it.
+ */
+static void encoder_state_ibc_hash_row(const lcu_order_element_t *lcu)
+{
+  encoder_state_t * const state = lcu->encoder_state;
+  videoframe_t * const frame = state->tile->frame;
+  const uint32_t ctu_row = (lcu->position_px.y >> LOG2_LCU_WIDTH);
+
+  // The hashmap of each LCU row holds the blocks of the current frame.
+  // The one of the previous frame is kept for the motion search, along
+  // with the hashes of its positions that its entries are checked with.
+  // Entries of older frames are not kept, since they could only be checked
+  // against the hashes of the current frame, whose blocks are already in
+  // the map of the current frame.
+  uvg_hashmap_t *prev = frame->ibc_hashmap_row_prev[ctu_row];
+  frame->ibc_hashmap_row_prev[ctu_row] = frame->ibc_hashmap_row[ctu_row];
+  frame->ibc_hashmap_row[ctu_row] = prev;
+  uvg_hashmap_clear(prev);
+
+  const uint32_t first_line = lcu->position_px.y / UVG_HASHMAP_BLOCKSIZE;
+  const uint32_t num_lines = (MIN(LCU_WIDTH, frame->height - lcu->position_px.y) + UVG_HASHMAP_BLOCKSIZE - 1) / UVG_HASHMAP_BLOCKSIZE;
+  memcpy(&frame->ibc_hashmap_pos_to_hash_prev[first_line * frame->ibc_hashmap_pos_to_hash_stride],
+         &frame->ibc_hashmap_pos_to_hash[first_line * frame->ibc_hashmap_pos_to_hash_stride],
+         sizeof(uint32_t) * num_lines * frame->ibc_hashmap_pos_to_hash_stride);
+
+  for (; lcu; lcu = lcu->right) {
+    encoder_state_ibc_hash_lcu(state, lcu);
+  }
+}
+
+static void encoder_state_worker_ibc_hash_row(void *opaque)
+{
+  encoder_state_ibc_hash_row(opaque);
+}
+
 static void encoder_state_worker_encode_lcu_search(void * opaque)
 {
   lcu_order_element_t * const lcu = opaque;
@@ -749,7 +910,7 @@ static void encoder_state_worker_encode_lcu_search(void * opaque)
     assert(0);
   }
 
-  lcu->coeff = calloc(1, sizeof(lcu_coeff_t));
+  lcu->coeff = encoder_state_coeff_take(state);
 
   const uint32_t ctu_row = (lcu->position_px.y >> LOG2_LCU_WIDTH);
   const uint32_t ctu_row_mul_five = ctu_row * MAX_NUM_HMVP_CANDS;
@@ -763,47 +924,6 @@ static void encoder_state_worker_encode_lcu_search(void * opaque)
   if(state->frame->slicetype != UVG_SLICE_I) memcpy(original_lut, &state->tile->frame->hmvp_lut[ctu_row_mul_five], sizeof(cu_info_t) * MAX_NUM_HMVP_CANDS);
   if(state->encoder_control->cfg.ibc) memcpy(original_lut_ibc, &state->tile->frame->hmvp_lut_ibc[ctu_row_mul_five], sizeof(cu_info_t) * MAX_NUM_HMVP_CANDS);
 
-
-  if (state->encoder_control->cfg.ibc & 2) {
-    videoframe_t * const frame      = state->tile->frame;
-    const uint32_t ibc_block_width  = MIN(LCU_WIDTH, (state->tile->frame->width-lcu->position_px.x));
-    const uint32_t ibc_block_height = MIN(LCU_WIDTH, (state->tile->frame->height-lcu->position_px.y));
-    int items = 0;
-    // Hash the current LCU to the IBC hashmap
-    for (int32_t xx = 0; xx < (int32_t)(ibc_block_width)-7; xx+=UVG_HASHMAP_BLOCKSIZE>>1) {
-      for (int32_t yy = 0; yy < (int32_t)(ibc_block_height)-7; yy+=UVG_HASHMAP_BLOCKSIZE>>1) {
-        int cur_x = lcu->position_px.x + xx;
-        int cur_y = lcu->position_px.y + yy;
-        
-        // Skip blocks that seem to be the same value for the whole block
-        uint64_t first_line =
-          *(uint64_t *)&frame->source->y[cur_y * frame->source->stride + cur_x];
-        bool same_data = true;
-        for (int y_temp = 1; y_temp < 8; y_temp++) {
-          if (*(uint64_t *)&frame->source->y[(cur_y+y_temp) * frame->source->stride + cur_x] != first_line) {
-            same_data = false;
-            break;
-          }
-        }
-        
-        if (!same_data || (xx % UVG_HASHMAP_BLOCKSIZE == 0 && yy % UVG_HASHMAP_BLOCKSIZE == 0)) {
-          uint32_t crc = uvg_crc32c_8x8(&frame->source->y[cur_y * frame->source->stride + cur_x],frame->source->stride);
-          if (state->encoder_control->chroma_format != UVG_CSP_400) {
-            crc += uvg_crc32c_4x4(&frame->source->u[(cur_y>>1) * (frame->source->stride>>1) + (cur_x>>1)],frame->source->stride>>1);
-            crc += uvg_crc32c_4x4(&frame->source->v[(cur_y>>1) * (frame->source->stride>>1) + (cur_x>>1)],frame->source->stride>>1);
-          }
-          if (xx % UVG_HASHMAP_BLOCKSIZE == 0 && yy % UVG_HASHMAP_BLOCKSIZE == 0) {
-            state->tile->frame->ibc_hashmap_pos_to_hash[(cur_y / UVG_HASHMAP_BLOCKSIZE)*state->tile->frame->ibc_hashmap_pos_to_hash_stride + cur_x / UVG_HASHMAP_BLOCKSIZE] = crc;
-          }
-          uvg_hashmap_insert(frame->ibc_hashmap_row[ctu_row], crc, ((cur_x&0xffff)<<16) | (cur_y&0xffff));
-          items++;
-        }
-      }
-    }
-  }
-  //fprintf(stderr, "Inserted %d items to %dx%d at %dx%d\r\n", items, ibc_block_width, ibc_block_height, lcu->position_px.x, lcu->position_px.y);
-
-
   //This part doesn't write to bitstream, it's only search, deblock and sao
   uvg_search_lcu(state, lcu->position_px.x, lcu->position_px.y, state->tile->hor_buf_search, state->tile->ver_buf_search, lcu->coeff);
 
@@ -826,6 +946,8 @@ static void encoder_state_worker_encode_lcu_search(void * opaque)
     set_cu_qps(state, &cu_loc, &last_qp, &prev_qp, 0);
   }
 
+  uvg_inter_store_col_motion(state, lcu->position_px.x, lcu->position_px.y);
+
   if (state->tile->frame->lmcs_aps->m_sliceReshapeInfo.sliceReshaperEnableFlag) {
     uvg_pixel* luma = &state->tile->frame->rec->y[lcu->position_px.x + lcu->position_px.y * state->tile->frame->rec->stride];
     for (int y = 0; y < LCU_WIDTH; y++) {
@@ -895,7 +1017,7 @@ static void encoder_state_worker_encode_lcu_bitstream(void * opaque)
 
   if (!state->cabac.only_count) {
     // Coeffs are not needed anymore.
-    free(lcu->coeff);
+    encoder_state_coeff_release(state, lcu->coeff);
     lcu->coeff = NULL;
   }
 
@@ -1001,6 +1123,228 @@ void uvg_alf_enc_process_job(void* opaque) {
   encoder_state_init_children_after_simulation(parent);
 }
 
+/**
+ * \brief Number of priority levels used by the jobs of one frame.
+ */
+static int64_t encoder_state_frame_span(const encoder_state_t * const state)
+{
+  return state->encoder_control->in.width_in_lcu +
+         2 * state->encoder_control->in.height_in_lcu;
+}
+
+/**
+ * \brief Scheduling priority of the jobs of an LCU.
+ *
+ * LCUs of older frames come first so that OWF does not let later frames
+ * starve the frames they depend on. Within a frame, LCUs are ordered by
+ * their wavefront diagonal, which is the critical path of WPP.
+ */
+static int64_t encoder_state_lcu_priority(const encoder_state_t * const state,
+                                          const lcu_order_element_t * const lcu)
+{
+  const int64_t diagonal = lcu->position.x + 2 * lcu->position.y;
+  return -(state->frame->num * encoder_state_frame_span(state) + diagonal);
+}
+
+/**
+ * \brief Scheduling priority of the jobs done once per frame or tile.
+ *
+ * These run after the LCUs of the same frame and before those of later
+ * frames.
+ */
+static int64_t encoder_state_frame_priority(const encoder_state_t * const state)
+{
+  const int64_t frame_span = encoder_state_frame_span(state);
+  return -(state->frame->num * frame_span + frame_span - 1);
+}
+
+/**
+ * \brief Return the leaf state that the ALF of the frame is run with.
+ */
+static encoder_state_t * encoder_state_alf_leaf(encoder_state_t *state)
+{
+  while (state->parent) state = state->parent;
+  while (state->lcu_order == NULL) state = &state->children[0];
+  return state;
+}
+
+/**
+ * \brief Run a job for every LCU of the frame and then the next ALF step.
+ *
+ * Called from the job of the previous step, so the jobs are created only
+ * after the previous step is done. The ALF process job of the frame waits
+ * for the next step, or for the LCU jobs if there is no next step.
+ *
+ * \param state     leaf state of the ALF
+ * \param lcu_fptr  function to run for each lcu_order_element_t
+ * \param next_fptr function to run with the state after the LCU jobs
+ */
+static void encoder_state_alf_spawn_lcu_jobs(encoder_state_t * const state,
+                                             void (*lcu_fptr)(void *),
+                                             void (*next_fptr)(void *))
+{
+  encoder_state_t *root = state;
+  while (root->parent) root = root->parent;
+  threadqueue_queue_t * const threadqueue = state->encoder_control->threadqueue;
+
+  threadqueue_job_t *next_job = NULL;
+  if (next_fptr) {
+    next_job = uvg_threadqueue_job_create(next_fptr, state);
+    uvg_threadqueue_job_set_priority(next_job, encoder_state_frame_priority(state));
+    uvg_threadqueue_job_dep_add(root->tqj_alf_process, next_job);
+  }
+  threadqueue_job_t *wait_job = next_job ? next_job : root->tqj_alf_process;
+
+  for (const lcu_order_element_t *row = &state->lcu_order[0]; row; row = row->below) {
+    for (const lcu_order_element_t *lcu = row; lcu; lcu = lcu->right) {
+      threadqueue_job_t *job = uvg_threadqueue_job_create(lcu_fptr, (void*)lcu);
+      uvg_threadqueue_job_set_priority(job, encoder_state_lcu_priority(state, lcu));
+      uvg_threadqueue_job_dep_add(wait_job, job);
+      uvg_threadqueue_submit(threadqueue, job);
+      uvg_threadqueue_free_job(&job);
+    }
+  }
+
+  if (next_job) {
+    uvg_threadqueue_submit(threadqueue, next_job);
+    uvg_threadqueue_free_job(&next_job);
+  }
+}
+
+static void encoder_state_worker_alf_ctu_stats(void *opaque)
+{
+  const lcu_order_element_t * const lcu = opaque;
+  uvg_alf_enc_ctu_stats(encoder_state_alf_leaf(lcu->encoder_state), lcu->position.x, lcu->position.y);
+}
+
+static void encoder_state_worker_alf_filter_ctu(void *opaque)
+{
+  const lcu_order_element_t * const lcu = opaque;
+  uvg_alf_enc_filter_ctu(encoder_state_alf_leaf(lcu->encoder_state), lcu->position.x, lcu->position.y);
+}
+
+static void encoder_state_worker_cc_alf_ctu_stats(void *opaque)
+{
+  const lcu_order_element_t * const lcu = opaque;
+  uvg_alf_enc_cc_ctu_stats(encoder_state_alf_leaf(lcu->encoder_state), lcu->position.x, lcu->position.y);
+}
+
+static void encoder_state_worker_cc_alf_filter_ctu(void *opaque)
+{
+  const lcu_order_element_t * const lcu = opaque;
+  uvg_alf_enc_cc_filter_ctu(encoder_state_alf_leaf(lcu->encoder_state), lcu->position.x, lcu->position.y);
+}
+
+static void encoder_state_worker_cc_alf_derive(void *opaque)
+{
+  encoder_state_t * const state = opaque;
+  uvg_alf_enc_cc_derive(state);
+  encoder_state_alf_spawn_lcu_jobs(state, encoder_state_worker_cc_alf_filter_ctu, NULL);
+}
+
+static void encoder_state_worker_cc_alf_prepare(void *opaque)
+{
+  encoder_state_t * const state = opaque;
+  uvg_alf_enc_cc_prepare(state);
+  encoder_state_alf_spawn_lcu_jobs(state, encoder_state_worker_cc_alf_ctu_stats, encoder_state_worker_cc_alf_derive);
+}
+
+/**
+ * \brief Derive the ALF of the frame once the statistics of every LCU are done.
+ */
+static void encoder_state_worker_alf_derive(void *opaque)
+{
+  encoder_state_t * const state = opaque;
+  uvg_alf_enc_derive(state);
+  encoder_state_alf_spawn_lcu_jobs(state, encoder_state_worker_alf_filter_ctu,
+                                   state->encoder_control->cfg.alf_type == UVG_ALF_FULL ? encoder_state_worker_cc_alf_prepare : NULL);
+}
+
+static void encoder_state_worker_alf_finish(void *opaque)
+{
+  encoder_state_t * const state = opaque;
+  uvg_alf_enc_finish(state);
+
+  encoder_state_t* parent = state;
+  while (parent->parent) parent = parent->parent;
+
+  // If ALF was used the bitstream coding was simulated in search, reset the cabac/stream
+  encoder_state_init_children_after_simulation(parent);
+}
+
+/**
+ * \brief Create the ALF statistics jobs that can start after an LCU.
+ *
+ * The statistics of an LCU read the pixels next to it, which are final
+ * once the LCUs two to the right and two below have been reconstructed.
+ * Since the reconstruction of each LCU waits for the LCUs on the left and
+ * above, the statistics wait only for that LCU, and for the statistics of
+ * the LCUs on the left and above that pad the same picture borders.
+ */
+static void encoder_state_add_alf_stats_jobs(encoder_state_t * const state,
+                                             const lcu_order_element_t * const lcu)
+{
+  encoder_state_t *root = state;
+  while (root->parent) root = root->parent;
+  const int width_in_lcu = state->tile->frame->width_in_lcu;
+  const int height_in_lcu = state->tile->frame->height_in_lcu;
+  threadqueue_job_t **stats_jobs = state->tile->wf_alf_stats_jobs;
+
+  const int first_x = MAX(0, lcu->position.x - 2);
+  const int last_x = lcu->position.x == width_in_lcu - 1 ? lcu->position.x : lcu->position.x - 2;
+  const int first_y = MAX(0, lcu->position.y - 2);
+  const int last_y = lcu->position.y == height_in_lcu - 1 ? lcu->position.y : lcu->position.y - 2;
+
+  const lcu_order_element_t *row = lcu;
+  for (int y = lcu->position.y; y > first_y; --y) row = row->above;
+  for (int x = lcu->position.x; x > first_x; --x) row = row->left;
+
+  for (int y = first_y; y <= last_y; ++y, row = row->below) {
+    const lcu_order_element_t *stats_lcu = row;
+    for (int x = first_x; x <= last_x; ++x, stats_lcu = stats_lcu->right) {
+      threadqueue_job_t *job = uvg_threadqueue_job_recycle(&stats_jobs[stats_lcu->id], encoder_state_worker_alf_ctu_stats, (void*)stats_lcu);
+      uvg_threadqueue_job_set_priority(job, encoder_state_lcu_priority(state, stats_lcu));
+      uvg_threadqueue_job_dep_add(job, state->tile->wf_recon_jobs[lcu->id]);
+      if (stats_lcu->left) {
+        uvg_threadqueue_job_dep_add(job, stats_jobs[stats_lcu->left->id]);
+      }
+      if (stats_lcu->above) {
+        uvg_threadqueue_job_dep_add(job, stats_jobs[stats_lcu->above->id]);
+      }
+      uvg_threadqueue_job_dep_add(root->tqj_alf_derive, job);
+      uvg_threadqueue_submit(state->encoder_control->threadqueue, job);
+    }
+  }
+}
+
+/**
+ * \brief Create the IBC hashing jobs needed by the search of an LCU row.
+ *
+ * Each row is hashed by a job created for the row above it, or for the row
+ * itself if it is the first one, so that the row below can be hashed while
+ * the search of the row is waiting for its turn.
+ */
+static void encoder_state_add_ibc_hash_jobs(encoder_state_t * const state,
+                                            const lcu_order_element_t * const lcu,
+                                            threadqueue_job_t * const search_job,
+                                            int64_t priority)
+{
+  threadqueue_job_t **hash_jobs = state->tile->wf_ibc_hash_jobs;
+  const lcu_order_element_t * const rows[2] = { lcu->above ? NULL : lcu, lcu->below };
+
+  for (int i = 0; i < 2; ++i) {
+    if (!rows[i]) continue;
+    threadqueue_job_t *job = uvg_threadqueue_job_recycle(&hash_jobs[rows[i]->position.y], encoder_state_worker_ibc_hash_row, (void*)rows[i]);
+    uvg_threadqueue_job_set_priority(job, priority);
+    uvg_threadqueue_submit(state->encoder_control->threadqueue, job);
+  }
+
+  uvg_threadqueue_job_dep_add(search_job, hash_jobs[lcu->position.y]);
+  if (lcu->below) {
+    uvg_threadqueue_job_dep_add(search_job, hash_jobs[lcu->below->position.y]);
+  }
+}
+
 static void encoder_state_encode_leaf(encoder_state_t * const state)
 {
   const encoder_control_t * const encoder = state->encoder_control;
@@ -1033,6 +1377,12 @@ static void encoder_state_encode_leaf(encoder_state_t * const state)
     // Encode every LCU in order and perform SAO reconstruction after every
     // frame is encoded. Deblocking and SAO search is done during LCU encoding.
     for (uint32_t i = 0; i < state->lcu_order_count; ++i) {
+      const lcu_order_element_t * const lcu = &state->lcu_order[i];
+      // Hash the rows for IBC in the same order as the wavefront jobs.
+      if ((cfg->ibc & 2) && lcu->position.x == 0) {
+        if (!lcu->above) encoder_state_ibc_hash_row(lcu);
+        if (lcu->below) encoder_state_ibc_hash_row(lcu->below);
+      }
       encoder_state_worker_encode_lcu_search(&state->lcu_order[i]);
       // Without alf we can code the bitstream right after each LCU to update cabac contexts
       if (encoder->cfg.alf_type == 0) {
@@ -1085,17 +1435,25 @@ static void encoder_state_encode_leaf(encoder_state_t * const state)
     for (uint32_t i = 0; i < state->lcu_order_count; ++i) {
       const lcu_order_element_t * const lcu = &state->lcu_order[i];
 
-      uvg_threadqueue_free_job(&state->tile->wf_jobs[lcu->id]);
-      uvg_threadqueue_free_job(&state->tile->wf_recon_jobs[lcu->id]);
-      state->tile->wf_jobs[lcu->id] = uvg_threadqueue_job_create(encoder_state_worker_encode_lcu_bitstream, (void*)lcu);
+      // The jobs of the previous frame are reused when nothing refers to
+      // them any more.
+      uvg_threadqueue_job_recycle(&state->tile->wf_jobs[lcu->id], encoder_state_worker_encode_lcu_bitstream, (void*)lcu);
       threadqueue_job_t **bitstream_job = &state->tile->wf_jobs[lcu->id];
 
       // Use a separate job for bitstream writing, first process search and recon
-      state->tile->wf_recon_jobs[lcu->id] = uvg_threadqueue_job_create(encoder_state_worker_encode_lcu_search, (void*)lcu);
+      uvg_threadqueue_job_recycle(&state->tile->wf_recon_jobs[lcu->id], encoder_state_worker_encode_lcu_search, (void*)lcu);
       threadqueue_job_t **job = &state->tile->wf_recon_jobs[lcu->id];
 
       // If job object was returned, add dependancies and allow it to run.
       if (job[0]) {
+        const int64_t priority = encoder_state_lcu_priority(state, lcu);
+        uvg_threadqueue_job_set_priority(job[0], priority);
+        uvg_threadqueue_job_set_priority(bitstream_job[0], priority);
+
+        if ((cfg->ibc & 2) && lcu->position.x == 0) {
+          encoder_state_add_ibc_hash_jobs(state, lcu, job[0], priority);
+        }
+
         // Add inter frame dependancies when ecoding more than one frame at
         // once. The added dependancy is for the first LCU of each wavefront
         // row to depend on the reconstruction status of the row below in the
@@ -1115,6 +1473,16 @@ static void encoder_state_encode_leaf(encoder_state_t * const state)
           }
           uvg_threadqueue_job_dep_add(job[0], ref_state->tile->wf_recon_jobs[dep_lcu->id]);
 
+          // With ALF the reference pixels are final only after the ALF of the
+          // whole frame. The other LCUs wait for the first one.
+          if (state->encoder_control->cfg.alf_type && !lcu->left && !lcu->above) {
+            const encoder_state_t *ref_root = ref_state;
+            while (ref_root->parent) ref_root = ref_root->parent;
+            if (ref_root->tqj_alf_process) {
+              uvg_threadqueue_job_dep_add(job[0], ref_root->tqj_alf_process);
+            }
+          }
+
           //TODO: Preparation for the lock free implementation of the new rc
           if (ref_state->frame->slicetype == UVG_SLICE_I && ref_state->frame->num != 0 && state->encoder_control->cfg.owf > 1 && true) {
             uvg_threadqueue_job_dep_add(job[0], ref_state->previous_encoder_state->tile->wf_recon_jobs[dep_lcu->id]);
@@ -1154,7 +1522,11 @@ static void encoder_state_encode_leaf(encoder_state_t * const state)
           uvg_threadqueue_submit(state->encoder_control->threadqueue, job[0]);
 
           uvg_threadqueue_job_dep_add(state->tile->wf_jobs[lcu->id], parent->tqj_alf_process);
-          uvg_threadqueue_job_dep_add(parent->tqj_alf_process, state->tile->wf_recon_jobs[lcu->id]);
+          if (parent->tqj_alf_derive) {
+            encoder_state_add_alf_stats_jobs(state, lcu);
+          } else {
+            uvg_threadqueue_job_dep_add(parent->tqj_alf_process, state->tile->wf_recon_jobs[lcu->id]);
+          }
         } else {
 
           // Add local WPP dependancy to the LCU on the left.
@@ -1252,6 +1624,8 @@ static void encoder_state_encode(encoder_state_t * const main_state) {
         if(sub_state->tile->frame->chroma_cu_array) {
           uvg_cu_array_free(&sub_state->tile->frame->chroma_cu_array);
         }
+        uvg_col_motion_field_free(&sub_state->tile->frame->col_motion);
+        uvg_image_pyramid_free(&sub_state->tile->frame->pyramid);
 
         sub_state->tile->frame->source = uvg_image_make_subimage(
             main_state->tile->frame->source,
@@ -1304,6 +1678,12 @@ static void encoder_state_encode(encoder_state_t * const main_state) {
             sub_state->tile->frame->width_in_lcu * LCU_WIDTH,
             sub_state->tile->frame->height_in_lcu * LCU_WIDTH
         );
+        sub_state->tile->frame->col_motion =
+          uvg_col_motion_field_copy_ref(main_state->tile->frame->col_motion);
+        if (main_state->tile->frame->pyramid) {
+          sub_state->tile->frame->pyramid =
+            uvg_image_pyramid_copy_ref(main_state->tile->frame->pyramid);
+        }
         if(main_state->encoder_control->cfg.dual_tree && main_state->frame->is_irap){
           sub_state->tile->frame->chroma_cu_array = uvg_cu_subarray(
               main_state->tile->frame->chroma_cu_array,
@@ -1328,6 +1708,8 @@ static void encoder_state_encode(encoder_state_t * const main_state) {
           uvg_threadqueue_free_job(&main_state->children[i].tqj_recon_done);
           main_state->children[i].tqj_recon_done =
             uvg_threadqueue_job_create(encoder_state_worker_encode_children, &main_state->children[i]);
+          uvg_threadqueue_job_set_priority(main_state->children[i].tqj_recon_done,
+                                           encoder_state_frame_priority(main_state));
           if (main_state->children[i].previous_encoder_state != &main_state->children[i] &&
               main_state->children[i].previous_encoder_state->tqj_recon_done &&
               !main_state->children[i].frame->is_irap)
@@ -1550,6 +1932,26 @@ static void encoder_set_source_picture(encoder_state_t * const state, uvg_pictur
   }
   state->tile->frame->rec_lmcs = state->tile->frame->rec;
 
+  if (state->encoder_control->cfg.ime_algorithm == UVG_IME_PYRAMID ||
+      state->encoder_control->cfg.global_motion)
+  {
+    // Motion estimation of later frames refers to the pyramid of the
+    // source through the reference list.
+    assert(!state->tile->frame->pyramid);
+    state->tile->frame->pyramid = uvg_image_pyramid_alloc(frame);
+  }
+
+  const uvg_config *const cfg = &state->encoder_control->cfg;
+  const bool is_ref = !cfg->gop_len || !state->frame->poc ||
+                      cfg->gop[state->frame->gop_offset].is_ref;
+  const bool final_rows = !state->encoder_control->tiles_enable && !cfg->lmcs_enable;
+  if (cfg->ref_padding && final_rows && is_ref) {
+    // Padded once the reconstruction is done, see
+    // encoder_state_add_padding_jobs.
+    assert(!state->tile->frame->padding);
+    state->tile->frame->padding = uvg_ref_padding_alloc(state->tile->frame->rec);
+  }
+
   if (state->encoder_control->cfg.lmcs_enable) {
     state->tile->frame->rec_lmcs = uvg_image_alloc(state->encoder_control->chroma_format, frame->width, frame->height);
     state->tile->frame->source_lmcs = uvg_image_alloc(state->encoder_control->chroma_format, frame->width, frame->height);
@@ -1772,6 +2174,11 @@ static void encoder_state_init_new_frame(encoder_state_t * const state, uvg_pict
       state->tile->frame->width,
       state->tile->frame->height
   );
+  assert(!state->tile->frame->col_motion);
+  state->tile->frame->col_motion = uvg_col_motion_field_alloc(
+      state->tile->frame->width,
+      state->tile->frame->height
+  );
 
   if (!state->encoder_control->tiles_enable) {
     memset(state->tile->frame->hmvp_size, 0, sizeof(uint8_t) * state->tile->frame->height_in_lcu);
@@ -1879,7 +2286,17 @@ static void encoder_state_init_new_frame(encoder_state_t * const state, uvg_pict
   }
   // Variance adaptive quantization - END
 
-  if (cfg->target_bitrate > 0 || frame->roi.roi_array || cfg->set_qp_in_cu || cfg->vaq) {
+  // QP offsets from the lookahead CU-tree are added to the VAQ offsets.
+  if (cfg->cutree) {
+    const double *cutree_offsets = state->tile->frame->source->lookahead.cutree_offsets;
+    const int num_lcus = state->tile->frame->width_in_lcu * state->tile->frame->height_in_lcu;
+    for (int id = 0; id < num_lcus; ++id) {
+      const double vaq_offset = cfg->vaq ? state->frame->aq_offsets[id] : 0.0;
+      state->frame->aq_offsets[id] = vaq_offset + (cutree_offsets ? cutree_offsets[id] : 0.0);
+    }
+  }
+
+  if (cfg->target_bitrate > 0 || frame->roi.roi_array || cfg->set_qp_in_cu || cfg->vaq || cfg->cutree) {
     state->frame->max_qp_delta_depth = 0;
   } else {
     state->frame->max_qp_delta_depth = -1;
@@ -1930,9 +2347,9 @@ static void encoder_state_init_new_frame(encoder_state_t * const state, uvg_pict
     
     uvg_videoframe_set_poc(state->tile->frame, state->frame->poc);
   } else if (cfg->intra_period > 1) {
-    state->frame->poc = state->frame->num % cfg->intra_period;
+    state->frame->poc = (state->frame->num - state->frame->irap_num) % cfg->intra_period;
   } else {
-    state->frame->poc = state->frame->num;
+    state->frame->poc = state->frame->num - state->frame->irap_num;
   }
 
   // Check whether the frame is a keyframe or not.
@@ -1976,6 +2393,12 @@ static void encoder_state_init_new_frame(encoder_state_t * const state, uvg_pict
   encoder_state_remove_refs(state);
   uvg_encoder_create_ref_lists(state);
 
+  if (cfg->global_motion) {
+    uvg_global_motion_estimate(state->tile->frame->source, state->tile->frame->pyramid,
+                               state->frame->poc,
+                               state->frame->ref, state->frame->global_motion);
+  }
+
   // Set slicetype.
   if (state->frame->is_irap) {
     state->frame->slicetype = UVG_SLICE_I;
@@ -2048,6 +2471,56 @@ static void _encode_one_frame_add_bitstream_deps(const encoder_state_t * const s
 }
 
 
+static void encoder_state_add_recon_deps(const encoder_state_t * const state, threadqueue_job_t * const job) {
+  for (int i = 0; state->children[i].encoder_control; ++i) {
+    encoder_state_add_recon_deps(&state->children[i], job);
+  }
+  if (state->tqj_recon_done) {
+    uvg_threadqueue_job_dep_add(job, state->tqj_recon_done);
+  }
+}
+
+/**
+ * \brief Create the jobs that pad the reconstruction of the frame.
+ *
+ * Each LCU row is padded once the pixels it reads are final,
+ * which is after the reconstruction of the LCU rows two below it like in
+ * encoder_state_add_alf_stats_jobs, or after ALF. The jobs of the rows
+ * are added as dependencies of bitstream_job so that the reconstruction
+ * is not freed before they are done.
+ */
+static void encoder_state_add_padding_jobs(encoder_state_t * const state,
+                                           threadqueue_job_t * const bitstream_job)
+{
+  uvg_ref_padding_t *const padding = state->tile->frame->padding;
+  if (!padding) return;
+
+  const encoder_state_t *leaf = state;
+  while (leaf->lcu_order == NULL) leaf = &leaf->children[0];
+  const bool parallel_rows = leaf->type == ENCODER_STATE_TYPE_WAVEFRONT_ROW &&
+                             leaf->parent->children[1].encoder_control;
+
+  // The tile of the leaves holds the wavefront jobs.
+  const int width_in_lcu = leaf->tile->frame->width_in_lcu;
+  const int height_in_lcu = leaf->tile->frame->height_in_lcu;
+  for (int y = 0; y < height_in_lcu; ++y) {
+    threadqueue_job_t *job = uvg_threadqueue_job_create(uvg_ref_padding_worker_row, &padding->rows[y]);
+    uvg_threadqueue_job_set_priority(job, encoder_state_frame_priority(state));
+    if (!parallel_rows) {
+      encoder_state_add_recon_deps(state, job);
+    } else if (!state->tqj_alf_process) {
+      const int dep_y = MIN(y + 2, height_in_lcu - 1);
+      uvg_threadqueue_job_dep_add(job, leaf->tile->wf_recon_jobs[dep_y * width_in_lcu + width_in_lcu - 1]);
+    }
+    if (state->tqj_alf_process) {
+      uvg_threadqueue_job_dep_add(job, state->tqj_alf_process);
+    }
+    uvg_threadqueue_job_dep_add(bitstream_job, job);
+    uvg_threadqueue_submit(state->encoder_control->threadqueue, job);
+    uvg_threadqueue_free_job(&job);
+  }
+}
+
 void uvg_encode_one_frame(encoder_state_t * const state, uvg_picture* frame)
 {
 #if UVG_DEBUG_PRINT_CABAC == 1
@@ -2063,22 +2536,45 @@ void uvg_encode_one_frame(encoder_state_t * const state, uvg_picture* frame)
   // Create a separate job for ALF done after everything else, and only then do final bitstream writing (for ALF parameters)
   if (state->encoder_control->cfg.alf_type && state->encoder_control->cfg.wpp) {
     uvg_threadqueue_free_job(&state->tqj_alf_process);
+    uvg_threadqueue_free_job(&state->tqj_alf_derive);
     encoder_state_t* child_state = state;
     while (child_state->lcu_order == NULL) child_state = &child_state->children[0];
-    state->tqj_alf_process = uvg_threadqueue_job_create(uvg_alf_enc_process_job, child_state);
+
+    // When the wavefront rows are run in parallel without tiles, the ALF
+    // statistics and filtering of each LCU are separate jobs and only the
+    // filter derivation is done for the whole frame at once.
+    const bool parallel_rows = child_state->type == ENCODER_STATE_TYPE_WAVEFRONT_ROW &&
+                               child_state->parent->children[1].encoder_control;
+    if (parallel_rows && !state->encoder_control->tiles_enable) {
+      // The leaves share the ALF info of the frame only after
+      // encoder_state_encode, so initialize it through this state.
+      uvg_alf_enc_init(state);
+      state->tqj_alf_derive = uvg_threadqueue_job_create(encoder_state_worker_alf_derive, child_state);
+      state->tqj_alf_process = uvg_threadqueue_job_create(encoder_state_worker_alf_finish, child_state);
+      uvg_threadqueue_job_set_priority(state->tqj_alf_derive, encoder_state_frame_priority(state));
+      uvg_threadqueue_job_dep_add(state->tqj_alf_process, state->tqj_alf_derive);
+    } else {
+      state->tqj_alf_process = uvg_threadqueue_job_create(uvg_alf_enc_process_job, child_state);
+    }
+    uvg_threadqueue_job_set_priority(state->tqj_alf_process, encoder_state_frame_priority(state));
   }
 
   encoder_state_encode(state);
 
   threadqueue_job_t *job =
     uvg_threadqueue_job_create(uvg_encoder_state_worker_write_bitstream, state);
+  uvg_threadqueue_job_set_priority(job, encoder_state_frame_priority(state));
 
 
   if (state->encoder_control->cfg.alf_type && state->encoder_control->cfg.wpp) {
+    if (state->tqj_alf_derive) {
+      uvg_threadqueue_submit(state->encoder_control->threadqueue, state->tqj_alf_derive);
+    }
     uvg_threadqueue_submit(state->encoder_control->threadqueue, state->tqj_alf_process);    
   }
 
   _encode_one_frame_add_bitstream_deps(state, job);
+  encoder_state_add_padding_jobs(state, job);
   if (state->previous_encoder_state != state && state->previous_encoder_state->tqj_bitstream_written) {
     //We need to depend on previous bitstream generation
     uvg_threadqueue_job_dep_add(job, state->previous_encoder_state->tqj_bitstream_written);
@@ -2138,15 +2634,16 @@ void uvg_encoder_prepare(encoder_state_t *state)
       !prev_state->frame->poc ||
       encoder->cfg.gop[prev_state->frame->gop_offset].is_ref) {
 
-    // Store current list of POCs for use in TMVP derivation
+    // Store current list of POCs in the picture
     memcpy(prev_state->tile->frame->rec->ref_pocs, state->frame->ref->pocs, sizeof(int32_t)*state->frame->ref->used_size);
 
     // Add previous reconstructed picture as a reference
     uvg_image_list_add(state->frame->ref,
                    prev_state->tile->frame->rec,
-                   prev_state->tile->frame->cu_array,
-                   prev_state->frame->poc,
-                   prev_state->frame->ref_LX);
+                   prev_state->tile->frame->col_motion,
+                   prev_state->tile->frame->pyramid,
+                   prev_state->tile->frame->padding,
+                   prev_state->frame->poc);
     uvg_cu_array_free(&state->tile->frame->cu_array);
     if (state->tile->frame->chroma_cu_array) {
       uvg_cu_array_free(&state->tile->frame->chroma_cu_array);
@@ -2175,6 +2672,9 @@ void uvg_encoder_prepare(encoder_state_t *state)
   if (state->tile->frame->chroma_cu_array) {
     uvg_cu_array_free(&state->tile->frame->chroma_cu_array);
   }
+  uvg_col_motion_field_free(&state->tile->frame->col_motion);
+  uvg_image_pyramid_free(&state->tile->frame->pyramid);
+  uvg_ref_padding_free(&state->tile->frame->padding);
 
   // Update POC and frame count.
   state->frame->num = prev_state->frame->num + 1;
@@ -43,6 +43,7 @@
 #include "cu.h"
 #include "encoder.h"
 #include "global.h" // IWYU pragma: keep
+#include "global_motion.h"
 #include "image.h"
 #include "imagelist.h"
 #include "uvg266.h"
@@ -106,6 +107,7 @@ typedef struct encoder_state_config_frame_t {
   int32_t poc;       /*!< \brief Picture order count */
   int8_t gop_offset; /*!< \brief Offset in the gop structure */
   int32_t irap_poc;  /*!< \brief POC of the associated IRAP picture */
+  int32_t irap_num;  /*!< \brief Frame number of the latest scene cut IRAP picture */
 
   /**
    * \brief Frame-level quantization parameter
@@ -125,6 +127,9 @@ typedef struct encoder_state_config_frame_t {
   //! L0 reference index list size
   uint8_t ref_LX_size[2];
 
+  //! Global motion to each picture in ref, if enabled
+  uvg_global_motion_t global_motion[MAX_REF_PIC_COUNT];
+
   bool is_irap;
   uint8_t pictype;
   enum uvg_slice_type slicetype;
@@ -235,6 +240,17 @@ typedef struct encoder_state_config_tile_t {
   //Jobs for each individual LCU of a wavefront row.
   threadqueue_job_t **wf_jobs;
   threadqueue_job_t **wf_recon_jobs;
+  // ALF statistics of each LCU, only used with WPP and ALF.
+  threadqueue_job_t **wf_alf_stats_jobs;
+  // IBC hashing of each LCU row, only used with WPP and IBC hash search.
+  threadqueue_job_t **wf_ibc_hash_jobs;
+
+  // Coefficient buffers of LCUs that have been written to the bitstream,
+  // reused for the following LCUs. There is room for one buffer per LCU of
+  // the tile.
+  pthread_mutex_t coeff_pool_lock;
+  lcu_coeff_t **coeff_pool;
+  int32_t coeff_pool_count;
 
 } encoder_state_config_tile_t;
 
@@ -356,6 +372,7 @@ typedef struct encoder_state_t {
   threadqueue_job_t * tqj_recon_done; //Reconstruction is done
   threadqueue_job_t * tqj_bitstream_written; //Bitstream is written
   threadqueue_job_t*  tqj_alf_process; //ALF processed for the slice
+  threadqueue_job_t*  tqj_alf_derive; //ALF filters derived for the slice
 
   //Constraint structure  
   void * constraint;
@@ -0,0 +1,653 @@
+/*****************************************************************************
+ * This file is part of uvg266 VVC encoder.
+ *
+ * Copyright (c) 2021, Tampere University, ITU/ISO/IEC, project contributors
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ * * Neither the name of the Tampere University or ITU/ISO/IEC nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * INCLUDING NEGLIGENCE OR OTHERWISE ARISING IN ANY WAY OUT OF THE USE OF THIS
+ ****************************************************************************/
+
+#include "global_motion.h"
+
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "strategies/strategies-picture.h"
+
+
+// The model is estimated on the quarter resolution luma of the pyramid.
+#define GM_LEVEL 1
+#define GM_SCALE 4
+
+// The translation of the picture is first searched exhaustively on a picture
+// downscaled by GM_COARSE_SCALE from the quarter resolution, up to
+// GM_COARSE_RANGE coarse samples in each direction.
+#define GM_COARSE_SCALE 4
+#define GM_COARSE_RANGE 8
+
+// Repeating textures can look alike at several shifts of the coarse
+// pictures, so the best few candidates are refined and compared on every
+// GM_VERIFY_ROW_STEP row of the quarter resolution pictures.
+#define GM_COARSE_CANDS 3
+#define GM_VERIFY_ROW_STEP 2
+// Cost of the translation per quarter resolution sample in the mean absolute
+// difference of 8-bit pictures. Prefers the shorter of equally good shifts.
+#define GM_MV_COST 0.05
+
+// Size of the blocks matched on the quarter resolution pictures and how far
+// around the translation of the picture they are searched.
+#define GM_BLOCK_SIZE 8
+#define GM_BLOCK_RANGE 4
+
+// Blocks with a smaller mean absolute gradient are too flat to be matched.
+#define GM_MIN_ACTIVITY 3
+
+// Rounds of refitting the model to the blocks that agree with it.
+#define GM_FIT_ROUNDS 3
+// Blocks further from the model than GM_OUTLIER_RATIO times the median
+// distance, clipped to the range of full samples below, do not agree with it.
+#define GM_OUTLIER_RATIO 2.5
+#define GM_OUTLIER_MIN_DIST 3.0
+#define GM_OUTLIER_MAX_DIST 8.0
+// Least number of blocks and least fraction of the matched blocks that must
+// agree with the model.
+#define GM_MIN_INLIERS 8
+#define GM_MIN_INLIER_FRACTION 2
+
+// Larger zoom or rotation per picture is taken as a failed fit.
+#define GM_MAX_AFFINE 0.05
+
+// Models of distant references whose motion at the center differs from that
+// of the nearest reference scaled by the POC distance by more than this many
+// full samples, or this fraction of the scaled motion, are discarded.
+#define GM_MAX_INCONSISTENCY_DIST 8.0
+#define GM_MAX_INCONSISTENCY_RATIO 0.25
+
+
+typedef struct {
+  double x; //!< \brief horizontal position of the block in full samples
+  double y; //!< \brief vertical position of the block in full samples
+  double u; //!< \brief horizontal motion of the block in full samples
+  double v; //!< \brief vertical motion of the block in full samples
+} gm_sample_t;
+
+
+/**
+ * \brief Downscale the luma of a picture by averaging blocks of samples.
+ *
+ * \return downscaled samples, width / GM_COARSE_SCALE per row
+ */
+static uvg_pixel *downscale_coarse(const uvg_picture *pic, int width, int height)
+{
+  const int scale = GM_COARSE_SCALE;
+  uvg_pixel *coarse = MALLOC(uvg_pixel, width * height);
+  if (!coarse) return NULL;
+
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      int sum = 0;
+      for (int j = 0; j < scale; ++j) {
+        const uvg_pixel *line = &pic->y[(y * scale + j) * pic->stride + x * scale];
+        for (int i = 0; i < scale; ++i) {
+          sum += line[i];
+        }
+      }
+      coarse[y * width + x] = (uvg_pixel)((sum + scale * scale / 2) / (scale * scale));
+    }
+  }
+  return coarse;
+}
+
+
+/**
+ * \brief Find the candidates for the translation of a picture by searching
+ *         all shifts of the coarse pictures in the range.
+ *
+ * The candidates are the local minima of the mean difference of the
+ * overlapping parts of the pictures plus the cost of the shift.
+ *
+ * \param cands   returns the candidates in coarse samples, best first
+ * \return number of candidates, at most GM_COARSE_CANDS
+ */
+static int coarse_translations(const uvg_pixel *cur,
+                               const uvg_pixel *ref,
+                               int width,
+                               int height,
+                               int range_x,
+                               int range_y,
+                               double mv_cost,
+                               vector2d_t *cands)
+{
+  const int diff_stride = 2 * GM_COARSE_RANGE + 1;
+  double diffs[(2 * GM_COARSE_RANGE + 1) * (2 * GM_COARSE_RANGE + 1)];
+  for (int mv_y = -range_y; mv_y <= range_y; ++mv_y) {
+    for (int mv_x = -range_x; mv_x <= range_x; ++mv_x) {
+      const int left = MAX(0, -mv_x);
+      const int top = MAX(0, -mv_y);
+      const int right = MIN(width, width - mv_x);
+      const int bottom = MIN(height, height - mv_y);
+
+      int64_t sad = 0;
+      for (int y = top; y < bottom; ++y) {
+        const uvg_pixel *cur_line = &cur[y * width];
+        const uvg_pixel *ref_line = &ref[(y + mv_y) * width + mv_x];
+        for (int x = left; x < right; ++x) {
+          sad += abs(cur_line[x] - ref_line[x]);
+        }
+      }
+      diffs[(mv_y + range_y) * diff_stride + mv_x + range_x] =
+        (double)sad / ((right - left) * (bottom - top)) +
+        mv_cost * GM_COARSE_SCALE * (abs(mv_x) + abs(mv_y));
+    }
+  }
+
+  double cand_diffs[GM_COARSE_CANDS];
+  int num_cands = 0;
+  for (int y = 0; y <= 2 * range_y; ++y) {
+    for (int x = 0; x <= 2 * range_x; ++x) {
+      const double diff = diffs[y * diff_stride + x];
+
+      bool is_minimum = true;
+      for (int j = MAX(0, y - 1); j <= MIN(2 * range_y, y + 1); ++j) {
+        for (int i = MAX(0, x - 1); i <= MIN(2 * range_x, x + 1); ++i) {
+          if (diffs[j * diff_stride + i] < diff) is_minimum = false;
+        }
+      }
+      if (!is_minimum) continue;
+
+      // Insert to the list of the best candidates.
+      int pos = num_cands;
+      if (num_cands == GM_COARSE_CANDS) {
+        if (cand_diffs[GM_COARSE_CANDS - 1] <= diff) continue;
+        pos = GM_COARSE_CANDS - 1;
+      } else {
+        num_cands++;
+      }
+      for (; pos > 0 && cand_diffs[pos - 1] > diff; --pos) {
+        cand_diffs[pos] = cand_diffs[pos - 1];
+        cands[pos] = cands[pos - 1];
+      }
+      cand_diffs[pos] = diff;
+      cands[pos].x = x - range_x;
+      cands[pos].y = y - range_y;
+    }
+  }
+  return num_cands;
+}
+
+
+/**
+ * \brief Mean absolute difference of the overlapping parts of the pictures
+ *         when the reference is shifted by mv.
+ *
+ * Only every GM_VERIFY_ROW_STEP row is compared.
+ */
+static double picture_difference(const uvg_picture *cur,
+                                 const uvg_picture *ref,
+                                 vector2d_t mv)
+{
+  const int left = MAX(0, -mv.x);
+  const int top = MAX(0, -mv.y);
+  const int width = MIN(cur->width, cur->width - mv.x) - left;
+  const int height = (MIN(cur->height, cur->height - mv.y) - top) / GM_VERIFY_ROW_STEP;
+
+  const unsigned sad = uvg_reg_sad(&cur->y[top * cur->stride + left],
+                                   &ref->y[(top + mv.y) * ref->stride + left + mv.x],
+                                   width, height,
+                                   GM_VERIFY_ROW_STEP * cur->stride,
+                                   GM_VERIFY_ROW_STEP * ref->stride);
+  return (double)sad / (width * height);
+}
+
+
+/**
+ * \brief Sum of absolute differences of neighbouring pixels in a block.
+ */
+static unsigned block_activity(const uvg_pixel *block, int stride)
+{
+  unsigned activity = 0;
+  for (int y = 0; y < GM_BLOCK_SIZE; ++y) {
+    for (int x = 0; x < GM_BLOCK_SIZE; ++x) {
+      const int pixel = block[y * stride + x];
+      if (x + 1 < GM_BLOCK_SIZE) activity += abs(block[y * stride + x + 1] - pixel);
+      if (y + 1 < GM_BLOCK_SIZE) activity += abs(block[(y + 1) * stride + x] - pixel);
+    }
+  }
+  return activity;
+}
+
+
+/**
+ * \brief Sub-sample offset of the minimum of a parabola through three costs.
+ */
+static double parabola_offset(unsigned left, unsigned mid, unsigned right)
+{
+  const double denom = (double)left - 2.0 * mid + right;
+  if (denom <= 0) return 0;
+  return CLIP(-0.5, 0.5, 0.5 * ((double)left - right) / denom);
+}
+
+
+/**
+ * \brief Match the blocks of the picture around the translation.
+ *
+ * \return number of samples written
+ */
+static int match_blocks(const uvg_picture *cur,
+                        const uvg_picture *ref,
+                        vector2d_t translation,
+                        gm_sample_t *samples)
+{
+  const int range = GM_BLOCK_RANGE;
+  const int size = GM_BLOCK_SIZE;
+  const unsigned min_activity =
+    (GM_MIN_ACTIVITY * 2 * size * (size - 1)) << (UVG_BIT_DEPTH - 8);
+
+  int num_samples = 0;
+  for (int y = 0; y + size <= cur->height; y += size) {
+    for (int x = 0; x + size <= cur->width; x += size) {
+      const uvg_pixel *block = &cur->y[y * cur->stride + x];
+      if (block_activity(block, cur->stride) < min_activity) continue;
+
+      unsigned sads[2 * GM_BLOCK_RANGE + 1][2 * GM_BLOCK_RANGE + 1];
+      unsigned best_sad = UINT_MAX;
+      int best_x = 0;
+      int best_y = 0;
+      for (int dy = -range; dy <= range; ++dy) {
+        for (int dx = -range; dx <= range; ++dx) {
+          const int ref_x = x + translation.x + dx;
+          const int ref_y = y + translation.y + dy;
+          unsigned sad = UINT_MAX;
+          if (ref_x >= 0 && ref_y >= 0 &&
+              ref_x + size <= ref->width && ref_y + size <= ref->height)
+          {
+            sad = uvg_reg_sad(block, &ref->y[ref_y * ref->stride + ref_x],
+                              size, size, cur->stride, ref->stride);
+          }
+          sads[dy + range][dx + range] = sad;
+          if (sad < best_sad) {
+            best_sad = sad;
+            best_x = dx;
+            best_y = dy;
+          }
+        }
+      }
+      // Blocks that moved further than the window, or did not match any
+      // position, do not tell the motion.
+      if (best_sad == UINT_MAX || abs(best_x) == range || abs(best_y) == range) continue;
+
+      // Refine the match with the costs of the neighbours when they are
+      // known.
+      const unsigned *row = sads[best_y + range];
+      double off_x = 0;
+      double off_y = 0;
+      if (best_x > -range && best_x < range &&
+          row[best_x + range - 1] != UINT_MAX && row[best_x + range + 1] != UINT_MAX)
+      {
+        off_x = parabola_offset(row[best_x + range - 1], best_sad, row[best_x + range + 1]);
+      }
+      if (best_y > -range && best_y < range &&
+          sads[best_y + range - 1][best_x + range] != UINT_MAX &&
+          sads[best_y + range + 1][best_x + range] != UINT_MAX)
+      {
+        off_y = parabola_offset(sads[best_y + range - 1][best_x + range], best_sad,
+                                sads[best_y + range + 1][best_x + range]);
+      }
+
+      gm_sample_t *sample = &samples[num_samples++];
+      sample->x = (x + size / 2) * GM_SCALE;
+      sample->y = (y + size / 2) * GM_SCALE;
+      sample->u = (translation.x + best_x + off_x) * GM_SCALE;
+      sample->v = (translation.y + best_y + off_y) * GM_SCALE;
+    }
+  }
+  return num_samples;
+}
+
+
+/**
+ * \brief Fit the model to the samples marked as inliers.
+ *
+ * Fits an affine model by least squares and falls back to the mean
+ * translation if the samples do not determine a plausible affine model.
+ *
+ * \return false if there are no inliers
+ */
+static bool fit_model(const gm_sample_t *samples,
+                      const bool *inlier,
+                      int num_samples,
+                      double center_x,
+                      double center_y,
+                      uvg_global_motion_t *gm)
+{
+  // Normalize the positions to keep the normal equations well conditioned.
+  const double norm = MAX(1.0, MAX(center_x, center_y));
+
+  // Normal equations M * c = r for the positions (1, x, y).
+  double m[3][3] = { { 0 } };
+  double r_u[3] = { 0 };
+  double r_v[3] = { 0 };
+  int num_inliers = 0;
+  for (int i = 0; i < num_samples; ++i) {
+    if (!inlier[i]) continue;
+    const double p[3] = {
+      1.0,
+      (samples[i].x - center_x) / norm,
+      (samples[i].y - center_y) / norm,
+    };
+    for (int j = 0; j < 3; ++j) {
+      for (int k = 0; k < 3; ++k) {
+        m[j][k] += p[j] * p[k];
+      }
+      r_u[j] += p[j] * samples[i].u;
+      r_v[j] += p[j] * samples[i].v;
+    }
+    num_inliers++;
+  }
+  if (num_inliers == 0) return false;
+
+  // Translation of the center.
+  double c_u[3] = { r_u[0] / m[0][0], 0, 0 };
+  double c_v[3] = { r_v[0] / m[0][0], 0, 0 };
+
+  const double det =
+    m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+    m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+    m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+
+  if (fabs(det) > 1e-6 * num_inliers * num_inliers * num_inliers) {
+    // Solve with Cramer's rule.
+    double a_u[3];
+    double a_v[3];
+    for (int j = 0; j < 3; ++j) {
+      double mu[3][3];
+      double mv[3][3];
+      memcpy(mu, m, sizeof(m));
+      memcpy(mv, m, sizeof(m));
+      for (int k = 0; k < 3; ++k) {
+        mu[k][j] = r_u[k];
+        mv[k][j] = r_v[k];
+      }
+      a_u[j] = (mu[0][0] * (mu[1][1] * mu[2][2] - mu[1][2] * mu[2][1]) -
+                mu[0][1] * (mu[1][0] * mu[2][2] - mu[1][2] * mu[2][0]) +
+                mu[0][2] * (mu[1][0] * mu[2][1] - mu[1][1] * mu[2][0])) / det;
+      a_v[j] = (mv[0][0] * (mv[1][1] * mv[2][2] - mv[1][2] * mv[2][1]) -
+                mv[0][1] * (mv[1][0] * mv[2][2] - mv[1][2] * mv[2][0]) +
+                mv[0][2] * (mv[1][0] * mv[2][1] - mv[1][1] * mv[2][0])) / det;
+    }
+
+    if (fabs(a_u[1]) < GM_MAX_AFFINE * norm && fabs(a_u[2]) < GM_MAX_AFFINE * norm &&
+        fabs(a_v[1]) < GM_MAX_AFFINE * norm && fabs(a_v[2]) < GM_MAX_AFFINE * norm)
+    {
+      memcpy(c_u, a_u, sizeof(c_u));
+      memcpy(c_v, a_v, sizeof(c_v));
+    }
+  }
+
+  // Convert back to picture coordinates.
+  gm->a[1] = c_u[1] / norm;
+  gm->a[2] = c_u[2] / norm;
+  gm->a[0] = c_u[0] - gm->a[1] * center_x - gm->a[2] * center_y;
+  gm->b[1] = c_v[1] / norm;
+  gm->b[2] = c_v[2] / norm;
+  gm->b[0] = c_v[0] - gm->b[1] * center_x - gm->b[2] * center_y;
+  return true;
+}
+
+
+static int compare_doubles(const void *a, const void *b)
+{
+  const double x = *(const double *)a;
+  const double y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+
+/**
+ * \brief Mark the samples close enough to the model as inliers.
+ *
+ * \return number of inliers
+ */
+static int select_inliers(const gm_sample_t *samples,
+                          int num_samples,
+                          const uvg_global_motion_t *gm,
+                          bool *inlier,
+                          double *dist,
+                          double *sorted)
+{
+  int num_inliers = 0;
+  for (int i = 0; i < num_samples; ++i) {
+    const double du = gm->a[0] + gm->a[1] * samples[i].x + gm->a[2] * samples[i].y - samples[i].u;
+    const double dv = gm->b[0] + gm->b[1] * samples[i].x + gm->b[2] * samples[i].y - samples[i].v;
+    dist[i] = sqrt(du * du + dv * dv);
+    if (inlier[i]) sorted[num_inliers++] = dist[i];
+  }
+  qsort(sorted, num_inliers, sizeof(double), compare_doubles);
+  const double threshold = CLIP(GM_OUTLIER_MIN_DIST, GM_OUTLIER_MAX_DIST,
+                                GM_OUTLIER_RATIO * sorted[num_inliers / 2]);
+
+  num_inliers = 0;
+  for (int i = 0; i < num_samples; ++i) {
+    inlier[i] = dist[i] <= threshold;
+    num_inliers += inlier[i];
+  }
+  return num_inliers;
+}
+
+
+/**
+ * \brief Estimate the global motion from a picture to a reference.
+ *
+ * First finds the translation of the picture on coarse versions of the
+ * pictures. Blocks of the picture are then searched
+ * around the translation and a model is fitted to the motion of the blocks,
+ * leaving out the blocks that move differently, such as foreground objects.
+ *
+ * \param pyramid      pyramid of the picture
+ * \param ref_pyramid  pyramid of the reference picture
+ * \param gm           returns the model
+ */
+static void estimate_model(const uvg_image_pyramid_t *pyramid,
+                           const uvg_image_pyramid_t *ref_pyramid,
+                           uvg_global_motion_t *gm)
+{
+  memset(gm, 0, sizeof(*gm));
+  if (!pyramid || !ref_pyramid) return;
+
+  const uvg_picture *cur = pyramid->levels[GM_LEVEL];
+  const uvg_picture *ref_level = ref_pyramid->levels[GM_LEVEL];
+  if (cur->width != ref_level->width || cur->height != ref_level->height ||
+      cur->width < GM_BLOCK_SIZE || cur->height < GM_BLOCK_SIZE)
+  {
+    return;
+  }
+  const int width = cur->width;
+  const int height = cur->height;
+
+  // Translation of the whole picture from the coarse pictures.
+  const int coarse_width = width / GM_COARSE_SCALE;
+  const int coarse_height = height / GM_COARSE_SCALE;
+  const int range_x = MIN(GM_COARSE_RANGE, coarse_width / 4);
+  const int range_y = MIN(GM_COARSE_RANGE, coarse_height / 4);
+  if (range_x < 1 || range_y < 1) return;
+
+  const double mv_cost = GM_MV_COST * (1 << (UVG_BIT_DEPTH - 8));
+  uvg_pixel *coarse_cur = downscale_coarse(cur, coarse_width, coarse_height);
+  uvg_pixel *coarse_ref = downscale_coarse(ref_level, coarse_width, coarse_height);
+  vector2d_t cands[GM_COARSE_CANDS];
+  int num_cands = 0;
+  if (coarse_cur && coarse_ref) {
+    num_cands = coarse_translations(coarse_cur, coarse_ref, coarse_width, coarse_height,
+                                    range_x, range_y, mv_cost, cands);
+  }
+  FREE_POINTER(coarse_cur);
+  FREE_POINTER(coarse_ref);
+
+  vector2d_t translation = { 0, 0 };
+  double best_diff = picture_difference(cur, ref_level, translation);
+  bool at_edge = false;
+  const int refine = GM_COARSE_SCALE / 2;
+  for (int i = 0; i < num_cands; ++i) {
+    for (int dy = -refine; dy <= refine; ++dy) {
+      for (int dx = -refine; dx <= refine; ++dx) {
+        const vector2d_t mv = {
+          cands[i].x * GM_COARSE_SCALE + dx,
+          cands[i].y * GM_COARSE_SCALE + dy,
+        };
+        if (abs(mv.x) >= width / 2 || abs(mv.y) >= height / 2) continue;
+        const double diff = picture_difference(cur, ref_level, mv) +
+                            mv_cost * (abs(mv.x) + abs(mv.y));
+        if (diff < best_diff) {
+          best_diff = diff;
+          translation = mv;
+          at_edge = abs(cands[i].x) == range_x || abs(cands[i].y) == range_y;
+        }
+      }
+    }
+  }
+  // The motion is likely larger than the range.
+  if (at_edge) return;
+
+  const int max_samples = (width / GM_BLOCK_SIZE) * (height / GM_BLOCK_SIZE);
+  gm_sample_t *samples = MALLOC(gm_sample_t, max_samples);
+  bool *inlier = MALLOC(bool, max_samples);
+  double *dist = MALLOC(double, 2 * max_samples);
+  if (!samples || !inlier || !dist) goto done;
+
+  const int num_samples = match_blocks(cur, ref_level, translation, samples);
+  const int min_inliers = MAX(GM_MIN_INLIERS, num_samples / GM_MIN_INLIER_FRACTION);
+  if (num_samples < min_inliers) goto done;
+
+  for (int i = 0; i < num_samples; ++i) inlier[i] = true;
+
+  const double center_x = 0.5 * width * GM_SCALE;
+  const double center_y = 0.5 * height * GM_SCALE;
+  for (int round = 0; ; ++round) {
+    if (!fit_model(samples, inlier, num_samples, center_x, center_y, gm)) goto done;
+    if (round == GM_FIT_ROUNDS) break;
+
+    const int num_inliers = select_inliers(samples, num_samples, gm, inlier,
+                                           dist, dist + max_samples);
+    if (num_inliers < min_inliers) goto done;
+  }
+  gm->valid = true;
+
+done:
+  FREE_POINTER(samples);
+  FREE_POINTER(inlier);
+  FREE_POINTER(dist);
+}
+
+
+/**
+ * \brief Motion of the model at the center of the picture.
+ */
+static void center_motion(const uvg_global_motion_t *gm,
+                          const uvg_picture *pic,
+                          double *u,
+                          double *v)
+{
+  const double x = 0.5 * pic->width;
+  const double y = 0.5 * pic->height;
+  *u = gm->a[0] + gm->a[1] * x + gm->a[2] * y;
+  *v = gm->b[0] + gm->b[1] * x + gm->b[2] * y;
+}
+
+
+/**
+ * \brief Estimate the global motion from a picture to each reference.
+ *
+ * Uses the pyramids of the picture and the references. A model is
+ * marked as invalid if they are missing or if it cannot be
+ * estimated reliably. Since repeating textures can match at the wrong
+ * position in distant references, the models must also agree with the
+ * model of the nearest reference when scaled by the POC distances.
+ *
+ * \param pic      picture
+ * \param pyramid  pyramid of the picture, or NULL
+ * \param poc      POC of the picture
+ * \param refs     reference pictures
+ * \param gms      returns the model for each reference
+ */
+void uvg_global_motion_estimate(const uvg_picture *pic,
+                                const uvg_image_pyramid_t *pyramid,
+                                int32_t poc,
+                                const image_list_t *refs,
+                                uvg_global_motion_t *gms)
+{
+  int nearest = -1;
+  for (uint32_t i = 0; i < refs->used_size; ++i) {
+    estimate_model(pyramid, refs->pyramids[i], &gms[i]);
+    if (gms[i].valid &&
+        (nearest < 0 || abs(refs->pocs[i] - poc) < abs(refs->pocs[nearest] - poc)))
+    {
+      nearest = i;
+    }
+  }
+  if (nearest < 0) return;
+
+  double nearest_u, nearest_v;
+  center_motion(&gms[nearest], pic, &nearest_u, &nearest_v);
+  const double nearest_dist = refs->pocs[nearest] - poc;
+  for (uint32_t i = 0; i < refs->used_size; ++i) {
+    if (!gms[i].valid || (int)i == nearest) continue;
+
+    const double scale = (refs->pocs[i] - poc) / nearest_dist;
+    const double expected_u = scale * nearest_u;
+    const double expected_v = scale * nearest_v;
+    double u, v;
+    center_motion(&gms[i], pic, &u, &v);
+    const double max_diff = MAX(GM_MAX_INCONSISTENCY_DIST,
+                                GM_MAX_INCONSISTENCY_RATIO * sqrt(expected_u * expected_u +
+                                                                  expected_v * expected_v));
+    if (sqrt((u - expected_u) * (u - expected_u) + (v - expected_v) * (v - expected_v)) > max_diff) {
+      gms[i].valid = false;
+    }
+  }
+}
+
+
+/**
+ * \brief Get the motion of the model at a position.
+ *
+ * \param gm    model
+ * \param x     horizontal luma position in the picture
+ * \param y     vertical luma position in the picture
+ * \param mv    returns the motion vector in full samples
+ * \return true if the model is valid
+ */
+bool uvg_global_motion_at(const uvg_global_motion_t *gm,
+                          int32_t x,
+                          int32_t y,
+                          vector2d_t *mv)
+{
+  if (!gm->valid) return false;
+  mv->x = (int32_t)floor(gm->a[0] + gm->a[1] * x + gm->a[2] * y + 0.5);
+  mv->y = (int32_t)floor(gm->b[0] + gm->b[1] * x + gm->b[2] * y + 0.5);
+  return true;
+}
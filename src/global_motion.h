@@ -0,0 +1,70 @@
+#ifndef GLOBAL_MOTION_H_
+#define GLOBAL_MOTION_H_
+/*****************************************************************************
+ * This file is part of uvg266 VVC encoder.
+ *
+ * Copyright (c) 2021, Tampere University, ITU/ISO/IEC, project contributors
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ * * Neither the name of the Tampere University or ITU/ISO/IEC nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * INCLUDING NEGLIGENCE OR OTHERWISE ARISING IN ANY WAY OUT OF THE USE OF THIS
+ ****************************************************************************/
+
+/**
+ * \ingroup Compression
+ * \file
+ * Estimation of the global motion between a picture and its references.
+ */
+
+#include "cu.h"
+#include "global.h" // IWYU pragma: keep
+#include "imagelist.h"
+#include "uvg266.h"
+
+
+/**
+ * \brief Affine model of the motion of a whole picture.
+ *
+ * The motion vector at luma position (x, y) in full samples is
+ * (a[0] + a[1] * x + a[2] * y, b[0] + b[1] * x + b[2] * y).
+ */
+typedef struct uvg_global_motion_t {
+  bool valid; //!< \brief Whether the picture moved consistently enough for a model.
+  double a[3];
+  double b[3];
+} uvg_global_motion_t;
+
+void uvg_global_motion_estimate(const uvg_picture *pic,
+                                const uvg_image_pyramid_t *pyramid,
+                                int32_t poc,
+                                const image_list_t *refs,
+                                uvg_global_motion_t *gms);
+
+bool uvg_global_motion_at(const uvg_global_motion_t *gm,
+                          int32_t x,
+                          int32_t y,
+                          vector2d_t *mv);
+
+#endif
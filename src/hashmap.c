@@ -32,107 +32,171 @@
 
 #include "hashmap.h"
 
-/**
- * \brief This function creates a node for the uvg_hashmap.
- * 
- * \param key   the key of the node to be created
- * \param value the value of the node to be created
- * \return uvg_hashmap_node a node with the given key and value
- */
-uvg_hashmap_node_t* uvg_hashmap_create_node(uint32_t key, uint32_t value) {
-  uvg_hashmap_node_t* new_node = (uvg_hashmap_node_t*)malloc(sizeof(uvg_hashmap_node_t));
-  new_node->key = key;
-  new_node->value = value;
-  new_node->next = NULL;
-  new_node->size  = 1;
-  return new_node;
-}
+#include <string.h>
+
+#include "global.h"
 
 /**
- * \brief This function creates a new uvg_hashmap with a given bucket size.
+ * \brief This function creates a new uvg_hashmap.
  * 
- * \param bucket_size the size of the hashmap bucket
- * \return uvg_hashmap a new uvg_hashmap with the given bucket size
+ * \param bucket_size the expected number of keys, the map grows as needed
+ * \return uvg_hashmap a new empty uvg_hashmap, NULL if out of memory
  */
 uvg_hashmap_t* uvg_hashmap_create(uint32_t bucket_size)
 {
-  uvg_hashmap_t* new_hashmap = (uvg_hashmap_t*)malloc(sizeof(uvg_hashmap_t));
-  new_hashmap->bucket_size = bucket_size;
-  new_hashmap->table = (uvg_hashmap_node_t**)malloc(sizeof(uvg_hashmap_node_t*) * bucket_size);
-  for (int i = 0; i < bucket_size; i++) {
-    new_hashmap->table[i] = NULL;
+  uvg_hashmap_t* new_hashmap = MALLOC(uvg_hashmap_t, 1);
+  if (!new_hashmap) return NULL;
+
+  // Keep the table at most half full.
+  new_hashmap->bucket_size = 16;
+  while (new_hashmap->bucket_size < bucket_size * 2) {
+    new_hashmap->bucket_size <<= 1;
+  }
+  new_hashmap->num_keys = 0;
+  new_hashmap->table = MALLOC(uvg_hashmap_slot_t, new_hashmap->bucket_size);
+
+  new_hashmap->nodes_size = MAX(bucket_size, 16);
+  new_hashmap->num_nodes = 0;
+  new_hashmap->nodes = MALLOC(uvg_hashmap_node_t, new_hashmap->nodes_size);
+
+  if (!new_hashmap->table || !new_hashmap->nodes) {
+    uvg_hashmap_free(new_hashmap);
+    return NULL;
+  }
+  for (uint32_t i = 0; i < new_hashmap->bucket_size; i++) {
+    new_hashmap->table[i].first = UVG_HASHMAP_END;
   }
   return new_hashmap;
 }
 
 /**
- * \brief This function calculates the hash index for a given 
- *        key and bucket size using the Jenkins hash function.
+ * \brief This function calculates the hash index for a given key.
+ *
+ * Mixes all bits of the key with the finalizer of MurmurHash3, since the
+ * low bits of the keys alone are not well distributed.
  *
  * \param key         the key to be hashed
- * \param bucket_size the size of the hashmap bucket
+ * \param bucket_size the size of the hashmap table, a power of two
  * \return the hashed index for the given key and bucket size. 
  */
 static uint32_t uvg_hashmap_hash(uint32_t key, uint32_t bucket_size)
 {
-  //key ^= (key >> 20) ^ (key >> 12);
-  //return (key ^ (key >> 7) ^ (key >> 4) ^ 2654435769U) % bucket_size;
-  return key % bucket_size;
+  key ^= key >> 16;
+  key *= 0x85ebca6b;
+  key ^= key >> 13;
+  key *= 0xc2b2ae35;
+  key ^= key >> 16;
+  return key & (bucket_size - 1);
+}
+
+/**
+ * \brief Find the slot of a key, or the empty slot where it belongs.
+ */
+static uvg_hashmap_slot_t* uvg_hashmap_find_slot(const uvg_hashmap_t* map, uint32_t key)
+{
+  uint32_t index = uvg_hashmap_hash(key, map->bucket_size);
+  while (map->table[index].first != UVG_HASHMAP_END && map->table[index].key != key) {
+    index = (index + 1) & (map->bucket_size - 1);
+  }
+  return &map->table[index];
+}
+
+/**
+ * \brief Double the size of the table and move the keys to the new one.
+ *
+ * \return false if out of memory, in which case the map is unchanged
+ */
+static bool uvg_hashmap_grow(uvg_hashmap_t* map)
+{
+  uvg_hashmap_slot_t* old_table = map->table;
+  const uint32_t old_size = map->bucket_size;
+
+  uvg_hashmap_slot_t* new_table = MALLOC(uvg_hashmap_slot_t, old_size * 2);
+  if (!new_table) return false;
+
+  map->bucket_size = old_size * 2;
+  map->table = new_table;
+  for (uint32_t i = 0; i < map->bucket_size; i++) {
+    map->table[i].first = UVG_HASHMAP_END;
+  }
+  for (uint32_t i = 0; i < old_size; i++) {
+    if (old_table[i].first != UVG_HASHMAP_END) {
+      *uvg_hashmap_find_slot(map, old_table[i].key) = old_table[i];
+    }
+  }
+  FREE_POINTER(old_table);
+  return true;
 }
 
 /**
- * \brief This function inserts a new node into the hashmap.
+ * \brief This function inserts a new value into the hashmap.
  * 
- * \param map   the hashmap to insert the new node into
- * \param key   the key of the new node
- * \param value the value of the new node
+ * \param map   the hashmap to insert the new value into
+ * \param key   the key of the new value
+ * \param value the new value
+ * \return false if the map could not grow and the value was not inserted
  */
-void uvg_hashmap_insert(uvg_hashmap_t* map, uint32_t key, uint32_t value) {
-    uint32_t hash_index = uvg_hashmap_hash(key, map->bucket_size);
-    uvg_hashmap_node_t* new_node = uvg_hashmap_create_node(key, value);
-    new_node->next = (void*)map->table[hash_index];
-    if (new_node->next != NULL) new_node->size = ((uvg_hashmap_node_t*)new_node->next)->size + 1;
-    map->table[hash_index] = new_node;
+bool uvg_hashmap_insert(uvg_hashmap_t* map, uint32_t key, uint32_t value) {
+  if (map->num_nodes == map->nodes_size) {
+    const uint32_t nodes_size = map->nodes_size * 2;
+    uvg_hashmap_node_t* nodes = realloc(map->nodes, sizeof(uvg_hashmap_node_t) * nodes_size);
+    if (!nodes) return false;
+    map->nodes = nodes;
+    map->nodes_size = nodes_size;
+  }
+
+  uvg_hashmap_slot_t* slot = uvg_hashmap_find_slot(map, key);
+  if (slot->first == UVG_HASHMAP_END) {
+    if ((map->num_keys + 1) * 2 > map->bucket_size) {
+      if (!uvg_hashmap_grow(map)) return false;
+      slot = uvg_hashmap_find_slot(map, key);
+    }
+    slot->key = key;
+    map->num_keys++;
+  }
+
+  uvg_hashmap_node_t* new_node = &map->nodes[map->num_nodes];
+  new_node->value = value;
+  new_node->next = slot->first;
+  slot->first = map->num_nodes++;
+  return true;
 }
 
 /**
  * \brief This function searches the hashmap for the given key.
  * 
+ * The rest of the values with the key are found with uvg_hashmap_next.
+ *
  * \param map the hashmap to search in
  * \param key the key to search for
- * \return uvg_hashmap_node the node with the given key, NULL if not found.
+ * \return the last value inserted with the given key, NULL if not found.
  */
-uvg_hashmap_node_t* uvg_hashmap_search(uvg_hashmap_t* map, uint32_t key) {
-  uint32_t hashIndex = uvg_hashmap_hash(key, map->bucket_size);
-  return map->table[hashIndex];
+const uvg_hashmap_node_t* uvg_hashmap_search(const uvg_hashmap_t* map, uint32_t key) {
+  const uvg_hashmap_slot_t* slot = uvg_hashmap_find_slot(map, key);
+  return slot->first != UVG_HASHMAP_END ? &map->nodes[slot->first] : NULL;
 }
 
-uint32_t uvg_hashmap_search_return_first(uvg_hashmap_t* map, uint32_t key)
+uint32_t uvg_hashmap_search_return_first(const uvg_hashmap_t* map, uint32_t key)
 {
-  uint32_t            hashIndex   = uvg_hashmap_hash(key, map->bucket_size);
-  uvg_hashmap_node_t* temp        = map->table[hashIndex];  
-  // Search key in chain and return the first match
-  while (temp) {
-    if (temp->key == key) {
-      return temp->value;
-    }
-    temp = (uvg_hashmap_node_t*)temp->next;
-  }
-  return -1;
+  const uvg_hashmap_node_t* node = uvg_hashmap_search(map, key);
+  return node ? node->value : UVG_HASHMAP_END;
 }
 
 /**
- * \brief This function frees the memory of a given hashmap node.
- * 
- * \param node the node to free the memory of.
+ * \brief Remove all keys and values from the hashmap.
+ *
+ * The memory is kept for the values inserted after this.
+ *
+ * \param map the hashmap to clear
  */
-void uvg_hashmap_node_free(uvg_hashmap_node_t* node)
+void uvg_hashmap_clear(uvg_hashmap_t* map)
 {
-  while (node) {
-    uvg_hashmap_node_t* to_delete = node;
-    node                        = (uvg_hashmap_node_t*)node->next;
-    free(to_delete);
+  if (map->num_keys == 0) return;
+  for (uint32_t i = 0; i < map->bucket_size; i++) {
+    map->table[i].first = UVG_HASHMAP_END;
   }
+  map->num_keys = 0;
+  map->num_nodes = 0;
 }
 
 /**
@@ -141,10 +205,8 @@ void uvg_hashmap_node_free(uvg_hashmap_node_t* node)
  * \param map the hashmap to free the memory of.
  */
 void uvg_hashmap_free(uvg_hashmap_t* map) {
-  for (int i = 0; i < map->bucket_size; i++) {
-    uvg_hashmap_node_t* temp = map->table[i];
-    uvg_hashmap_node_free(temp);
-  }
-  free(map->table);
+  if (map == NULL) return;
+  FREE_POINTER(map->table);
+  FREE_POINTER(map->nodes);
   free(map);
 }
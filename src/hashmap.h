@@ -32,6 +32,7 @@
  * INCLUDING NEGLIGENCE OR OTHERWISE ARISING IN ANY WAY OUT OF THE USE OF THIS
  ****************************************************************************/
 
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
@@ -40,31 +41,62 @@
 #define UVG_HASHMAP_RATIO 12.0
 // Use Hashmap for 4x4 blocks
 #define UVG_HASHMAP_BLOCKSIZE 8
+// Index of a missing entry
+#define UVG_HASHMAP_END UINT32_MAX
 
+/**
+ * \brief A value in the hashmap.
+ *
+ * The values with the same key are linked through the next index, most
+ * recently inserted first.
+ */
 typedef struct uvg_hashmap_node {
-    void*    next;  
-    uint32_t key;
     uint32_t value;
-    uint32_t size;
+    uint32_t next;
 } uvg_hashmap_node_t;
 
+/**
+ * \brief A key in the hashmap and the index of its first value.
+ */
+typedef struct uvg_hashmap_slot {
+    uint32_t key;
+    uint32_t first;
+} uvg_hashmap_slot_t;
+
+/**
+ * \brief Multimap from 32-bit keys to 32-bit values.
+ *
+ * Keys are stored in an open addressing table with linear probing. The
+ * values are allocated from an array that is reused after
+ * uvg_hashmap_clear, so inserting does not allocate memory once the map
+ * has grown to its working size.
+ */
 typedef struct uvg_hashmap {
-  uint32_t bucket_size;
-  uvg_hashmap_node_t** table;
-} uvg_hashmap_t;
+  uint32_t bucket_size;   //!< \brief Number of slots, a power of two.
+  uint32_t num_keys;
+  uvg_hashmap_slot_t* table;
 
-uvg_hashmap_node_t* uvg_hashmap_create_node(uint32_t key, uint32_t value);
+  uvg_hashmap_node_t* nodes;
+  uint32_t num_nodes;
+  uint32_t nodes_size;
+} uvg_hashmap_t;
 
 uvg_hashmap_t* uvg_hashmap_create(uint32_t bucket_size);
 
-//uint32_t uvg_hashmap_hash(uint32_t key, uint32_t bucket_size);
+bool uvg_hashmap_insert(uvg_hashmap_t* map, uint32_t key, uint32_t value);
 
-void uvg_hashmap_insert(uvg_hashmap_t* map, uint32_t key, uint32_t value);
+const uvg_hashmap_node_t* uvg_hashmap_search(const uvg_hashmap_t* map, uint32_t key);
 
-uvg_hashmap_node_t* uvg_hashmap_search(uvg_hashmap_t* map, uint32_t key);
+/**
+ * \brief Return the next value with the same key, or NULL.
+ */
+static inline const uvg_hashmap_node_t* uvg_hashmap_next(const uvg_hashmap_t* map, const uvg_hashmap_node_t* node)
+{
+  return node->next != UVG_HASHMAP_END ? &map->nodes[node->next] : NULL;
+}
 
-uint32_t uvg_hashmap_search_return_first(uvg_hashmap_t* map, uint32_t key);
+uint32_t uvg_hashmap_search_return_first(const uvg_hashmap_t* map, uint32_t key);
 
-void uvg_hashmap_node_free(uvg_hashmap_node_t* node);
+void uvg_hashmap_clear(uvg_hashmap_t* map);
 
 void uvg_hashmap_free(uvg_hashmap_t* map);
@@ -35,6 +35,7 @@
 #include <limits.h>
 #include <stdlib.h>
 
+#include "ref_padding.h"
 #include "strategies/strategies-ipol.h"
 #include "strategies/strategies-picture.h"
 #include "threads.h"
@@ -110,6 +111,10 @@ uvg_picture * uvg_image_alloc(enum uvg_chroma_format chroma_format, const int32_
   im->roi.width = 0;
   im->roi.height = 0;
 
+  im->lookahead.scene_cut = 0;
+  im->lookahead.complexity = 1.0;
+  im->lookahead.cutree_offsets = NULL;
+
   return im;
 }
 
@@ -137,6 +142,7 @@ void uvg_image_free(uvg_picture *const im)
   } else {
     free(im->fulldata_buf);
     if (im->roi.roi_array) FREE_POINTER(im->roi.roi_array);
+    if (im->lookahead.cutree_offsets) FREE_POINTER(im->lookahead.cutree_offsets);
   }
 
   // Make sure freed data won't be used.
@@ -198,10 +204,86 @@ uvg_picture *uvg_image_make_subimage(uvg_picture *const orig_image,
   im->dts = 0;
 
   im->roi = orig_image->roi;
+  im->lookahead = orig_image->lookahead;
 
   return im;
 }
 
+/**
+ * \brief Downscale luma by two in both directions by averaging.
+ */
+static uvg_picture *image_downscale_luma(const uvg_picture *const im)
+{
+  const int32_t width = (im->width / 2) & ~1;
+  const int32_t height = (im->height / 2) & ~1;
+  if (width < 2 || height < 2) return NULL;
+
+  uvg_picture *scaled = uvg_image_alloc(UVG_CSP_400, width, height);
+  if (!scaled) return NULL;
+
+  for (int32_t y = 0; y < height; ++y) {
+    const uvg_pixel *src = &im->y[2 * y * im->stride];
+    uvg_pixel *dst = &scaled->y[y * scaled->stride];
+    for (int32_t x = 0; x < width; ++x) {
+      dst[x] = (uvg_pixel)((src[2 * x] + src[2 * x + 1] +
+                            src[im->stride + 2 * x] + src[im->stride + 2 * x + 1] + 2) >> 2);
+    }
+  }
+  return scaled;
+}
+
+/**
+ * \brief Build the luma pyramid of an image for motion estimation.
+ *
+ * \param im   image
+ * \return the pyramid, NULL on failure or if the image is too small
+ */
+uvg_image_pyramid_t *uvg_image_pyramid_alloc(const uvg_picture *const im)
+{
+  uvg_image_pyramid_t *pyramid = MALLOC(uvg_image_pyramid_t, 1);
+  if (pyramid == NULL) return NULL;
+
+  pyramid->refcount = 1;
+  pyramid->levels[0] = image_downscale_luma(im);
+  pyramid->levels[1] = pyramid->levels[0] ? image_downscale_luma(pyramid->levels[0]) : NULL;
+  if (!pyramid->levels[1]) {
+    uvg_image_pyramid_free(&pyramid);
+  }
+  return pyramid;
+}
+
+void uvg_image_pyramid_free(uvg_image_pyramid_t **pyramid_ptr)
+{
+  uvg_image_pyramid_t *pyramid = *pyramid_ptr;
+  if (pyramid == NULL) return;
+  *pyramid_ptr = NULL;
+
+  int32_t new_refcount = UVG_ATOMIC_DEC(&pyramid->refcount);
+  if (new_refcount > 0) {
+    // Still we have some references, do nothing.
+    return;
+  }
+
+  assert(new_refcount == 0);
+
+  uvg_image_free(pyramid->levels[0]);
+  uvg_image_free(pyramid->levels[1]);
+  FREE_POINTER(pyramid);
+}
+
+/**
+ * \brief Get a new pointer to a pyramid.
+ *
+ * Increment reference count and return the pyramid.
+ */
+uvg_image_pyramid_t *uvg_image_pyramid_copy_ref(uvg_image_pyramid_t *pyramid)
+{
+  int32_t new_refcount = UVG_ATOMIC_INC(&pyramid->refcount);
+  assert(new_refcount >= 2);
+  (void)new_refcount;
+  return pyramid;
+}
+
 yuv_t * uvg_yuv_t_alloc(int luma_size, int chroma_size)
 {
   yuv_t *yuv = (yuv_t *)malloc(sizeof(*yuv));
@@ -432,11 +514,13 @@ static unsigned image_interpolated_sad(const uvg_picture *pic, const uvg_picture
 *
 * \param pic        Image for the block we are trying to find.
 * \param ref        Image where we are trying to find the block.
+* \param ref_padding Padded copy of ref, or NULL.
 *
 * \returns          Sum of absolute differences
 */
 unsigned uvg_image_calc_sad(const uvg_picture *pic,
                             const uvg_picture *ref,
+                            const uvg_ref_padding_t *ref_padding,
                             int pic_x,
                             int pic_y,
                             int ref_x,
@@ -466,21 +550,118 @@ unsigned uvg_image_calc_sad(const uvg_picture *pic,
                                   ref->stride,
                                   optimized_sad);
   } else {
-    // Call a routine that knows how to interpolate pixels outside the frame.
-    res = image_interpolated_sad(pic, ref, pic_x, pic_y, ref_x, ref_y, block_width, block_height, optimized_sad);
+    int32_t padded_stride = 0;
+    const uvg_pixel *padded = uvg_ref_padding_block(ref_padding, COLOR_Y,
+                                                    ref_x, ref_y,
+                                                    block_width, block_height,
+                                                    &padded_stride);
+    if (padded) {
+      // The pixels outside the frame have already been extrapolated.
+      res = reg_sad_maybe_optimized(&pic->y[pic_y * pic->stride + pic_x],
+                                    padded,
+                                    block_width,
+                                    block_height,
+                                    pic->stride,
+                                    padded_stride,
+                                    optimized_sad);
+    } else {
+      // Call a routine that knows how to interpolate pixels outside the frame.
+      res = image_interpolated_sad(pic, ref, pic_x, pic_y, ref_x, ref_y, block_width, block_height, optimized_sad);
+    }
   }
   return res >> (UVG_BIT_DEPTH - 8);
 }
 
 
+/**
+* \brief Calculate SADs between a block and four blocks of a reference.
+*
+* Gives the same SADs as calling uvg_image_calc_sad for each position, but
+* reads the block of pic only once when all four blocks are inside the
+* reference or its padded copy.
+*
+* \param pic        Image for the block we are trying to find.
+* \param ref        Image where we are trying to find the block.
+* \param ref_padding Padded copy of ref, or NULL.
+* \param ref_x      Horizontal positions of the four blocks in ref.
+* \param ref_y      Vertical positions of the four blocks in ref.
+* \param sad_out    Returns the four SADs.
+*/
+void uvg_image_calc_sad_x4(const uvg_picture *pic,
+                           const uvg_picture *ref,
+                           const uvg_ref_padding_t *ref_padding,
+                           int pic_x,
+                           int pic_y,
+                           const int ref_x[4],
+                           const int ref_y[4],
+                           int block_width,
+                           int block_height,
+                           optimized_sad_func_ptr_t optimized_sad,
+                           unsigned sad_out[4])
+{
+  assert(pic_x >= 0 && pic_x <= pic->width - block_width);
+  assert(pic_y >= 0 && pic_y <= pic->height - block_height);
+
+  int min_x = ref_x[0];
+  int min_y = ref_y[0];
+  int max_x = ref_x[0];
+  int max_y = ref_y[0];
+  for (int i = 1; i < 4; ++i) {
+    min_x = MIN(min_x, ref_x[i]);
+    min_y = MIN(min_y, ref_y[i]);
+    max_x = MAX(max_x, ref_x[i]);
+    max_y = MAX(max_y, ref_y[i]);
+  }
+
+  const uvg_pixel *ref_origin = NULL;
+  int32_t ref_stride = 0;
+  if (min_x >= 0 && max_x <= ref->width  - block_width &&
+      min_y >= 0 && max_y <= ref->height - block_height)
+  {
+    ref_origin = ref->y;
+    ref_stride = ref->stride;
+  } else {
+    const uvg_pixel *block = uvg_ref_padding_block(ref_padding, COLOR_Y,
+                                                   min_x, min_y,
+                                                   max_x - min_x + block_width,
+                                                   max_y - min_y + block_height,
+                                                   &ref_stride);
+    if (block) ref_origin = block - min_y * ref_stride - min_x;
+  }
+
+  if (!ref_origin) {
+    for (int i = 0; i < 4; ++i) {
+      sad_out[i] = uvg_image_calc_sad(pic, ref, ref_padding, pic_x, pic_y,
+                                      ref_x[i], ref_y[i],
+                                      block_width, block_height,
+                                      optimized_sad);
+    }
+    return;
+  }
+
+  const uvg_pixel *ref_data[4];
+  for (int i = 0; i < 4; ++i) {
+    ref_data[i] = &ref_origin[ref_y[i] * ref_stride + ref_x[i]];
+  }
+  uvg_reg_sad_x4(&pic->y[pic_y * pic->stride + pic_x], ref_data,
+                 block_width, block_height,
+                 pic->stride, ref_stride, sad_out);
+  for (int i = 0; i < 4; ++i) {
+    sad_out[i] >>= UVG_BIT_DEPTH - 8;
+  }
+}
+
+
 /**
 * \brief Calculate interpolated SATD between two blocks.
 *
 * \param pic        Image for the block we are trying to find.
 * \param ref        Image where we are trying to find the block.
+* \param ref_padding Padded copy of ref, or NULL.
 */
 unsigned uvg_image_calc_satd(const uvg_picture *pic,
                              const uvg_picture *ref,
+                             const uvg_ref_padding_t *ref_padding,
                              int pic_x,
                              int pic_y,
                              int ref_x,
@@ -536,7 +717,7 @@ unsigned uvg_image_calc_satd(const uvg_picture *pic,
     epol_args.ext_origin = &ext_origin;
     epol_args.ext_s = &ext_s;
 
-    uvg_get_extended_block(&epol_args);
+    uvg_get_padded_block(ref_padding, COLOR_Y, &epol_args);
 
     const uvg_pixel *pic_data = &pic->y[pic_y * pic->stride + pic_x];
 
@@ -43,6 +43,8 @@
 #include "uvg266.h"
 #include "strategies/optimized_sad_func_ptr_t.h"
 
+// Forward declarations.
+struct uvg_ref_padding;
 
 typedef struct {
   uvg_pixel y[LCU_LUMA_SIZE];
@@ -76,6 +78,14 @@ typedef struct {
   uvg_pixel_im *v;
 } yuv_im_t;
 
+/**
+ * \brief Luma of a picture downscaled by 2 and 4 for motion estimation.
+ */
+typedef struct uvg_image_pyramid_t {
+  uvg_picture *levels[2]; //!< \brief Luma downscaled by 2 and by 4.
+  int32_t refcount;
+} uvg_image_pyramid_t;
+
 uvg_picture *uvg_image_alloc_420(const int32_t width, const int32_t height);
 uvg_picture *uvg_image_alloc(enum uvg_chroma_format chroma_format, const int32_t width, const int32_t height);
 
@@ -89,6 +99,10 @@ uvg_picture *uvg_image_make_subimage(uvg_picture *const orig_image,
                              const unsigned width,
                              const unsigned height);
 
+uvg_image_pyramid_t *uvg_image_pyramid_alloc(const uvg_picture *const im);
+void uvg_image_pyramid_free(uvg_image_pyramid_t **pyramid_ptr);
+uvg_image_pyramid_t *uvg_image_pyramid_copy_ref(uvg_image_pyramid_t *pyramid);
+
 yuv_t * uvg_yuv_t_alloc(int luma_size, int chroma_size);
 void uvg_yuv_t_free(yuv_t * yuv);
 
@@ -96,6 +110,7 @@ void uvg_yuv_t_free(yuv_t * yuv);
 //Algorithms
 unsigned uvg_image_calc_sad(const uvg_picture *pic,
                             const uvg_picture *ref,
+                            const struct uvg_ref_padding *ref_padding,
                             int pic_x,
                             int pic_y,
                             int ref_x,
@@ -104,9 +119,22 @@ unsigned uvg_image_calc_sad(const uvg_picture *pic,
                             int block_height,
                             optimized_sad_func_ptr_t optimized_sad);
 
+void uvg_image_calc_sad_x4(const uvg_picture *pic,
+                           const uvg_picture *ref,
+                           const struct uvg_ref_padding *ref_padding,
+                           int pic_x,
+                           int pic_y,
+                           const int ref_x[4],
+                           const int ref_y[4],
+                           int block_width,
+                           int block_height,
+                           optimized_sad_func_ptr_t optimized_sad,
+                           unsigned sad_out[4]);
+
 
 unsigned uvg_image_calc_satd(const uvg_picture *pic,
                              const uvg_picture *ref,
+                             const struct uvg_ref_padding *ref_padding,
                              int pic_x,
                              int pic_y,
                              int ref_x,
@@ -36,6 +36,7 @@
 #include <stdlib.h>
 
 #include "image.h"
+#include "ref_padding.h"
 #include "threads.h"
 
 
@@ -49,9 +50,10 @@ image_list_t * uvg_image_list_alloc(int size)
   image_list_t *list = (image_list_t *)malloc(sizeof(image_list_t));
   list->size      = size;
   list->images    = malloc(sizeof(uvg_picture*)  * size);
-  list->cu_arrays = malloc(sizeof(cu_array_t*)   * size);
+  list->col_motions = malloc(sizeof(col_motion_field_t*) * size);
+  list->pyramids  = malloc(sizeof(uvg_image_pyramid_t*) * size);
+  list->paddings  = malloc(sizeof(uvg_ref_padding_t*) * size);
   list->pocs      = malloc(sizeof(int32_t)       * size);
-  list->ref_LXs   = malloc(sizeof(*list->ref_LXs) * size);
   list->used_size = 0;
 
   return list;
@@ -66,11 +68,13 @@ image_list_t * uvg_image_list_alloc(int size)
 int uvg_image_list_resize(image_list_t *list, unsigned size)
 {
   list->images = (uvg_picture**)realloc(list->images, sizeof(uvg_picture*) * size);
-  list->cu_arrays = (cu_array_t**)realloc(list->cu_arrays, sizeof(cu_array_t*) * size);
+  list->col_motions = (col_motion_field_t**)realloc(list->col_motions, sizeof(col_motion_field_t*) * size);
+  list->pyramids = (uvg_image_pyramid_t**)realloc(list->pyramids, sizeof(uvg_image_pyramid_t*) * size);
+  list->paddings = (uvg_ref_padding_t**)realloc(list->paddings, sizeof(uvg_ref_padding_t*) * size);
   list->pocs = realloc(list->pocs, sizeof(int32_t) * size);
-  list->ref_LXs = realloc(list->ref_LXs, sizeof(*list->ref_LXs) * size);
   list->size = size;
-  return size == 0 || (list->images && list->cu_arrays && list->pocs);
+  return size == 0 ||
+         (list->images && list->col_motions && list->pyramids && list->paddings && list->pocs);
 }
 
 /**
@@ -85,26 +89,25 @@ int uvg_image_list_destroy(image_list_t *list)
     for (i = 0; i < list->used_size; ++i) {
       uvg_image_free(list->images[i]);
       list->images[i] = NULL;
-      uvg_cu_array_free(&list->cu_arrays[i]);
-      list->cu_arrays[i] = NULL;
+      uvg_col_motion_field_free(&list->col_motions[i]);
+      uvg_image_pyramid_free(&list->pyramids[i]);
+      uvg_ref_padding_free(&list->paddings[i]);
       list->pocs[i] = 0;
-      for (int j = 0; j < 16; j++) {
-        list->ref_LXs[i][0][j] = 0;
-        list->ref_LXs[i][1][j] = 0;
-      }
     }
   }
 
   if (list->size > 0) {
     free(list->images);
-    free(list->cu_arrays);
+    free(list->col_motions);
+    free(list->pyramids);
+    free(list->paddings);
     free(list->pocs);
-    free(list->ref_LXs);
   }
   list->images = NULL;
-  list->cu_arrays = NULL;
+  list->col_motions = NULL;
+  list->pyramids = NULL;
+  list->paddings = NULL;
   list->pocs = NULL;
-  list->ref_LXs = NULL;
   free(list);
   return 1;
 }
@@ -115,7 +118,9 @@ int uvg_image_list_destroy(image_list_t *list)
  * \param picture_list list to use
  * \return 1 on success
  */
-int uvg_image_list_add(image_list_t *list, uvg_picture *im, cu_array_t *cua, int32_t poc, uint8_t ref_LX[2][16])
+int uvg_image_list_add(image_list_t *list, uvg_picture *im, col_motion_field_t *col_motion,
+                       uvg_image_pyramid_t *pyramid, uvg_ref_padding_t *padding,
+                       int32_t poc)
 {
   int i = 0;
   if (UVG_ATOMIC_INC(&(im->refcount)) == 1) {
@@ -124,12 +129,19 @@ int uvg_image_list_add(image_list_t *list, uvg_picture *im, cu_array_t *cua, int
     return 0;
   }
   
-  if (UVG_ATOMIC_INC(&(cua->refcount)) == 1) {
-    fprintf(stderr, "Tried to add an unreferenced cu_array. This is a bug!\n");
+  if (UVG_ATOMIC_INC(&(col_motion->refcount)) == 1) {
+    fprintf(stderr, "Tried to add an unreferenced motion field. This is a bug!\n");
     assert(0); //Stop for debugging
     return 0;
   }
 
+  if (pyramid) {
+    pyramid = uvg_image_pyramid_copy_ref(pyramid);
+  }
+  if (padding) {
+    padding = uvg_ref_padding_copy_ref(padding);
+  }
+
   if (list->size == list->used_size) {
     unsigned new_size = MAX(list->size + 1, list->size * 2);
     if (!uvg_image_list_resize(list, new_size)) return 0;
@@ -137,22 +149,18 @@ int uvg_image_list_add(image_list_t *list, uvg_picture *im, cu_array_t *cua, int
   
   for (i = list->used_size; i > 0; i--) {
     list->images[i] = list->images[i - 1];
-    list->cu_arrays[i] = list->cu_arrays[i - 1];
+    list->col_motions[i] = list->col_motions[i - 1];
+    list->pyramids[i] = list->pyramids[i - 1];
+    list->paddings[i] = list->paddings[i - 1];
     list->pocs[i] = list->pocs[i - 1];
-    for (int j = 0; j < 16; j++) {
-      list->ref_LXs[i][0][j] = list->ref_LXs[i - 1][0][j];
-      list->ref_LXs[i][1][j] = list->ref_LXs[i - 1][1][j];
-    }
   }
 
   list->images[0] = im;
-  list->cu_arrays[0] = cua;
+  list->col_motions[0] = col_motion;
+  list->pyramids[0] = pyramid;
+  list->paddings[0] = padding;
   list->pocs[0] = poc;
-  for (int j = 0; j < 16; j++) {
-    list->ref_LXs[0][0][j] = ref_LX[0][j];
-    list->ref_LXs[0][1][j] = ref_LX[1][j];
-  }
-  
+
   list->used_size++;
   return 1;
 }
@@ -173,37 +181,30 @@ int uvg_image_list_rem(image_list_t * const list, const unsigned n)
 
   uvg_image_free(list->images[n]);
 
-  uvg_cu_array_free(&list->cu_arrays[n]);
+  uvg_col_motion_field_free(&list->col_motions[n]);
+  uvg_image_pyramid_free(&list->pyramids[n]);
+  uvg_ref_padding_free(&list->paddings[n]);
 
   // The last item is easy to remove
   if (n == list->used_size - 1) {
     list->images[n] = NULL;
-    list->cu_arrays[n] = NULL;
     list->pocs[n] = 0;
-    for (int j = 0; j < 16; j++) {
-      list->ref_LXs[n][0][j] = 0;
-      list->ref_LXs[n][1][j] = 0;
-    }
     list->used_size--;
   } else {
     uint32_t i = n;
     // Shift all following pics one backward in the list
     for (i = n; i < list->used_size - 1; ++i) {
       list->images[i] = list->images[i + 1];
-      list->cu_arrays[i] = list->cu_arrays[i + 1];
+      list->col_motions[i] = list->col_motions[i + 1];
+      list->pyramids[i] = list->pyramids[i + 1];
+      list->paddings[i] = list->paddings[i + 1];
       list->pocs[i] = list->pocs[i + 1];
-      for (uint32_t j = 0; j < 16; j++) {
-        list->ref_LXs[i][0][j] = list->ref_LXs[i + 1][0][j];
-        list->ref_LXs[i][1][j] = list->ref_LXs[i + 1][1][j];
-      }
     }
     list->images[list->used_size - 1] = NULL;
-    list->cu_arrays[list->used_size - 1] = NULL;
+    list->col_motions[list->used_size - 1] = NULL;
+    list->pyramids[list->used_size - 1] = NULL;
+    list->paddings[list->used_size - 1] = NULL;
     list->pocs[list->used_size - 1] = 0;
-    for (int j = 0; j < 16; j++) {
-      list->ref_LXs[list->used_size - 1][0][j] = 0;
-      list->ref_LXs[list->used_size - 1][1][j] = 0;
-    }
     list->used_size--;
   }
 
@@ -217,7 +218,8 @@ int uvg_image_list_copy_contents(image_list_t *target, image_list_t *source) {
   }
   
   for (i = source->used_size - 1; i >= 0; --i) {
-    uvg_image_list_add(target, source->images[i], source->cu_arrays[i], source->pocs[i], source->ref_LXs[i]);
+    uvg_image_list_add(target, source->images[i], source->col_motions[i],
+                       source->pyramids[i], source->paddings[i], source->pocs[i]);
   }
   return 1;
 }
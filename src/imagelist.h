@@ -40,6 +40,7 @@
 
 #include "cu.h"
 #include "global.h" // IWYU pragma: keep
+#include "image.h"
 #include "uvg266.h"
 
 
@@ -49,9 +50,10 @@
 typedef struct
 {
   struct uvg_picture* *images;          //!< \brief Pointer to array of picture pointers.
-  cu_array_t* *cu_arrays;
+  col_motion_field_t* *col_motions; //!< \brief Motion of each picture for TMVP.
+  uvg_image_pyramid_t* *pyramids; //!< \brief Pyramid of each picture for motion estimation, or NULL.
+  struct uvg_ref_padding* *paddings; //!< \brief Padded copy of each picture, or NULL.
   int32_t *pocs;
-  uint8_t (*ref_LXs)[2][16]; //!< L0 and L1 reference index list for each image
   uint32_t size;       //!< \brief Array size.
   uint32_t used_size;
 
@@ -61,7 +63,9 @@ typedef struct
 image_list_t * uvg_image_list_alloc(int size);
 int uvg_image_list_resize(image_list_t *list, unsigned size);
 int uvg_image_list_destroy(image_list_t *list);
-int uvg_image_list_add(image_list_t *list, uvg_picture *im, cu_array_t* cua, int32_t poc, uint8_t ref_LX[2][16]);
+int uvg_image_list_add(image_list_t *list, uvg_picture *im, col_motion_field_t *col_motion,
+                       uvg_image_pyramid_t *pyramid, struct uvg_ref_padding *padding,
+                       int32_t poc);
 int uvg_image_list_rem(image_list_t *list, unsigned n);
 
 int uvg_image_list_copy_contents(image_list_t *target, image_list_t *source);
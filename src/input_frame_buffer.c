@@ -43,6 +43,7 @@ void uvg_init_input_frame_buffer(input_frame_buffer_t *input_buffer)
   FILL(input_buffer->pts_buffer, 0);
   input_buffer->num_in = 0;
   input_buffer->num_out = 0;
+  input_buffer->irap_num = 0;
   input_buffer->delay = 0;
   input_buffer->gop_skipped = 0;
 }
@@ -84,10 +85,15 @@ uvg_picture* uvg_encoder_feed_frame(input_frame_buffer_t *buf,
     if (img_in == NULL) return NULL;
 
     img_in->dts = img_in->pts;
+    if (img_in->lookahead.scene_cut && cfg->intra_period != 1) {
+      // Start a new intra period at the scene cut.
+      buf->irap_num = buf->num_out;
+    }
+    state->frame->irap_num = buf->irap_num;
     state->frame->gop_offset = 0;
     if (cfg->gop_len > 0) {
       // Using a low delay GOP structure.
-      uint64_t frame_num = buf->num_out;
+      uint64_t frame_num = buf->num_out - buf->irap_num;
       if (cfg->intra_period) {
         frame_num %= cfg->intra_period;
       }
@@ -98,6 +104,9 @@ uvg_picture* uvg_encoder_feed_frame(input_frame_buffer_t *buf,
     return uvg_image_copy_ref(img_in);
   }
   
+  // With reordering of output pictures the intra period is fixed. The
+  // lookahead does not mark scene cuts for these GOP structures, since an
+  // IRAP in the middle of a GOP would need the GOP to be cut short.
   if (img_in != NULL) {
     // Index of the next input picture, in range [-1, +inf). Values
     // i and j refer to the same indices in buf->pic_buffer iff
@@ -58,6 +58,13 @@ typedef struct input_frame_buffer_t {
   /** \brief Number of pictures output. */
   uint64_t num_out;
 
+  /** \brief Number of pictures output before the latest scene cut IRAP.
+   *
+   * Only used without reordering, where the intra period is restarted at
+   * scene cuts detected by the lookahead.
+   */
+  uint64_t irap_num;
+
   /** \brief Value to subtract from the DTS values of the first frames.
    *
    * This will be set to the difference of the PTS values of the first and
@@ -38,6 +38,7 @@
 
 #include "encoder.h"
 #include "imagelist.h"
+#include "ref_padding.h"
 #include "uvg_math.h"
 #include "strategies/generic/picture-generic.h"
 #include "strategies/strategies-ipol.h"
@@ -50,14 +51,15 @@ const int8_t uvg_g_imv_to_prec[4] = { 2, 0, -2, 1 }; // Convert AMVR imv to prec
 typedef struct {
   const cu_info_t *a[2];
   const cu_info_t *b[3];
-  const cu_info_t *c0;
-  const cu_info_t *c1;
+  const col_motion_t *c0;
+  const col_motion_t *c1;
 
 } merge_candidates_t;
 
 
 static void inter_recon_frac_luma(const encoder_state_t * const state,
                                   const uvg_picture * const ref,
+                                  const uvg_ref_padding_t *const padding,
                                   int32_t xpos,
                                   int32_t ypos,
                                   int32_t block_width,
@@ -99,7 +101,7 @@ static void inter_recon_frac_luma(const encoder_state_t * const state,
   epol_args.ext_origin = &ext_origin;
   epol_args.ext_s = &ext_s;
 
-  uvg_get_extended_block(&epol_args);
+  uvg_get_padded_block(padding, COLOR_Y, &epol_args);
   uvg_sample_quarterpel_luma(state->encoder_control,
     ext_origin,
     ext_s,
@@ -114,6 +116,7 @@ static void inter_recon_frac_luma(const encoder_state_t * const state,
 
 static void inter_recon_frac_luma_hi(const encoder_state_t *const state,
   const uvg_picture *const ref,
+  const uvg_ref_padding_t *const padding,
   int32_t xpos,
   int32_t ypos,
   int32_t block_width,
@@ -155,7 +158,7 @@ static void inter_recon_frac_luma_hi(const encoder_state_t *const state,
   epol_args.ext_origin = &ext_origin;
   epol_args.ext_s = &ext_s;
 
-  uvg_get_extended_block(&epol_args);
+  uvg_get_padded_block(padding, COLOR_Y, &epol_args);
   uvg_sample_quarterpel_luma_hi(state->encoder_control,
     ext_origin,
     ext_s,
@@ -170,6 +173,7 @@ static void inter_recon_frac_luma_hi(const encoder_state_t *const state,
 
 static void inter_recon_frac_chroma(const encoder_state_t *const state,
   const uvg_picture *const ref,
+  const uvg_ref_padding_t *const padding,
   int32_t pu_x,
   int32_t pu_y,
   int32_t pu_w,
@@ -218,7 +222,7 @@ static void inter_recon_frac_chroma(const encoder_state_t *const state,
   epol_args.ext_origin = &ext_origin;
   epol_args.ext_s = &ext_s;
 
-  uvg_get_extended_block(&epol_args);
+  uvg_get_padded_block(padding, COLOR_U, &epol_args);
   uvg_sample_octpel_chroma(state->encoder_control,
     ext_origin,
     ext_s,
@@ -232,7 +236,7 @@ static void inter_recon_frac_chroma(const encoder_state_t *const state,
 
   // Chroma V
   epol_args.src = ref->v;
-  uvg_get_extended_block(&epol_args);
+  uvg_get_padded_block(padding, COLOR_V, &epol_args);
   uvg_sample_octpel_chroma(state->encoder_control,
     ext_origin,
     ext_s,
@@ -247,6 +251,7 @@ static void inter_recon_frac_chroma(const encoder_state_t *const state,
 
 static void inter_recon_frac_chroma_hi(const encoder_state_t *const state,
   const uvg_picture *const ref,
+  const uvg_ref_padding_t *const padding,
   int32_t pu_x,
   int32_t pu_y,
   int32_t pu_w,
@@ -295,7 +300,7 @@ static void inter_recon_frac_chroma_hi(const encoder_state_t *const state,
   epol_args.ext_origin = &ext_origin;
   epol_args.ext_s = &ext_s;
 
-  uvg_get_extended_block(&epol_args);
+  uvg_get_padded_block(padding, COLOR_U, &epol_args);
   uvg_sample_octpel_chroma_hi(state->encoder_control,
     ext_origin,
     ext_s,
@@ -309,7 +314,7 @@ static void inter_recon_frac_chroma_hi(const encoder_state_t *const state,
 
   // Chroma V
   epol_args.src = ref->v;
-  uvg_get_extended_block(&epol_args);
+  uvg_get_padded_block(padding, COLOR_V, &epol_args);
   uvg_sample_octpel_chroma_hi(state->encoder_control,
     ext_origin,
     ext_s,
@@ -335,28 +340,29 @@ static void inter_recon_frac_chroma_hi(const encoder_state_t *const state,
 * \param width        width of copied block
 * \param height       height of copied block
 * \param mv_in_frame  coordinates of copied block in frame coordinates
+* \param padding      padded copy of the frame, or NULL
+* \param color        plane of ref buffer
 */
 static void inter_cp_with_ext_border(const uvg_pixel *ref_buf, int ref_stride,
                                      int ref_width, int ref_height,
                                      uvg_pixel *rec_buf, int rec_stride,
                                      int width, int height,
-                                     const vector2d_t *mv_in_frame)
+                                     const vector2d_t *mv_in_frame,
+                                     const uvg_ref_padding_t *padding,
+                                     color_t color)
 {
-  for (int y = mv_in_frame->y; y < mv_in_frame->y + height; ++y) {
-    for (int x = mv_in_frame->x; x < mv_in_frame->x + width; ++x) {
-      vector2d_t in_frame = {
-        CLIP(0, ref_width - 1, x),
-        CLIP(0, ref_height - 1, y),
-      };
-      vector2d_t in_pu = {
-        x - mv_in_frame->x,
-        y - mv_in_frame->y,
-      };
-      int pu_index = in_pu.y * rec_stride + in_pu.x;
-      int frame_index = in_frame.y * ref_stride + in_frame.x;
-      rec_buf[pu_index] = ref_buf[frame_index];
-    }
+  int32_t padded_stride = 0;
+  const uvg_pixel *padded = uvg_ref_padding_block(padding, color,
+                                                  mv_in_frame->x, mv_in_frame->y,
+                                                  width, height, &padded_stride);
+  if (padded) {
+    uvg_pixels_blit(padded, rec_buf, width, height, padded_stride, rec_stride);
+    return;
   }
+
+  uvg_copy_extended_block(ref_buf, ref_width, ref_height, ref_stride,
+                          mv_in_frame->x, mv_in_frame->y, width, height,
+                          rec_buf, rec_stride);
 }
 
 
@@ -365,6 +371,7 @@ static void inter_cp_with_ext_border(const uvg_pixel *ref_buf, int ref_stride,
  *
  * \param state          encoder state
  * \param ref            picture to copy the data from
+ * \param padding        padded copy of ref, or NULL
  * \param pu_x           PU x position
  * \param pu_y           PU y position
  * \param width          PU width
@@ -378,6 +385,7 @@ static void inter_cp_with_ext_border(const uvg_pixel *ref_buf, int ref_stride,
 static unsigned inter_recon_unipred(
   const encoder_state_t * const state,
   const uvg_picture * const ref,
+  const uvg_ref_padding_t * const padding,
   int32_t out_stride_luma,
   const mv_t mv_param[2],
   yuv_t *yuv_px,
@@ -414,13 +422,13 @@ static unsigned inter_recon_unipred(
     if (fractional_luma) {
       // With a fractional MV, do interpolation.
       if (state->encoder_control->cfg.bipred && yuv_im) {
-        inter_recon_frac_luma_hi(state, ref,
+        inter_recon_frac_luma_hi(state, ref, padding,
           pu_x, pu_y,
           pu_w, pu_h,
           mv_param, yuv_im, out_stride_luma);
       }
       else {
-        inter_recon_frac_luma(state, ref,
+        inter_recon_frac_luma(state, ref, padding,
           pu_x, pu_y,
           pu_w, pu_h,
           mv_param, yuv_px, out_stride_luma);
@@ -432,7 +440,8 @@ static unsigned inter_recon_unipred(
           ref->width, ref->height,
           yuv_px->y, out_stride_luma,
           pu_w, pu_h,
-          &int_mv_in_frame);
+          &int_mv_in_frame,
+          padding, COLOR_Y);
       }
       else {
         const int frame_mv_index = int_mv_in_frame.y * ref->stride + int_mv_in_frame.x;
@@ -454,12 +463,12 @@ static unsigned inter_recon_unipred(
   if (fractional_luma || fractional_chroma) {
     // With a fractional MV, do interpolation.
     if (state->encoder_control->cfg.bipred && yuv_im) {
-      inter_recon_frac_chroma_hi(state, ref,
+      inter_recon_frac_chroma_hi(state, ref, padding,
                                     pu_x, pu_y,
                                     pu_w, pu_h, 
                                     mv_param, yuv_im, out_stride_c);
     } else {
-      inter_recon_frac_chroma(state, ref,
+      inter_recon_frac_chroma(state, ref, padding,
                               pu_x, pu_y,
                               pu_w, pu_h,
                               mv_param, yuv_px, out_stride_c);
@@ -473,12 +482,14 @@ static unsigned inter_recon_unipred(
                                ref->width / 2, ref->height / 2,
                                yuv_px->u, out_stride_c,
                                pu_w / 2, pu_h / 2,
-                               &int_mv_in_frame_c);
+                               &int_mv_in_frame_c,
+                               padding, COLOR_U);
       inter_cp_with_ext_border(ref->v, ref->stride / 2,
                                ref->width / 2, ref->height / 2,
                                yuv_px->v, out_stride_c,
                                pu_w / 2, pu_h / 2,
-                               &int_mv_in_frame_c);
+                               &int_mv_in_frame_c,
+                               padding, COLOR_V);
     } else {
       const int frame_mv_index = int_mv_in_frame_c.y * ref->stride / 2 + int_mv_in_frame_c.x;
 
@@ -501,6 +512,8 @@ static unsigned inter_recon_unipred(
  * \param state          encoder state
  * \param ref1           reference picture to copy the data from
  * \param ref2           other reference picture to copy the data from
+ * \param padding1       padded copy of ref1, or NULL
+ * \param padding2       padded copy of ref2, or NULL
  * \param pu_x           PU x position
  * \param pu_y           PU y position
  * \param width          PU width
@@ -514,6 +527,8 @@ void uvg_inter_recon_bipred(
   const encoder_state_t *const state,
   const uvg_picture *ref1,
   const uvg_picture *ref2,
+  const uvg_ref_padding_t *padding1,
+  const uvg_ref_padding_t *padding2,
   mv_t mv_param[2][2],
   lcu_t *lcu,
   bool predict_luma,
@@ -557,9 +572,9 @@ void uvg_inter_recon_bipred(
 
   // Sample blocks from both reference picture lists.
   // Flags state if the outputs were written to high-precision / interpolated sample buffers.
-  unsigned im_flags_L0 = inter_recon_unipred(state, ref1, pu_w, mv_param[0], &px_L0, &im_L0, predict_luma, predict_chroma,
+  unsigned im_flags_L0 = inter_recon_unipred(state, ref1, padding1, pu_w, mv_param[0], &px_L0, &im_L0, predict_luma, predict_chroma,
                                              cu_loc);
-  unsigned im_flags_L1 = inter_recon_unipred(state, ref2, pu_w, mv_param[1], &px_L1, &im_L1, predict_luma, predict_chroma,
+  unsigned im_flags_L1 = inter_recon_unipred(state, ref2, padding2, pu_w, mv_param[1], &px_L1, &im_L1, predict_luma, predict_chroma,
                                              cu_loc);
 
   // After reconstruction, merge the predictors by taking an average of each pixel
@@ -570,6 +585,66 @@ void uvg_inter_recon_bipred(
 }
 
 
+/**
+ * \brief Predict the luma of a PU from one reference for bi-prediction.
+ *
+ * Produces the same samples uvg_inter_recon_bipred uses for one of its two
+ * lists, so that search can keep them and average them with
+ * uvg_inter_bipred_average_luma instead of predicting both lists again.
+ * Samples are written with a stride equal to the PU width.
+ *
+ * \param state   encoder state
+ * \param ref     reference picture
+ * \param padding padded copy of ref, or NULL
+ * \param mv      motion vector
+ * \param px      destination for integer motion vectors
+ * \param im      destination for fractional motion vectors
+ * \param cu_loc  location of the PU
+ *
+ * \return 1 if the samples were written to im, 0 if to px
+ */
+unsigned uvg_inter_pred_unipred_luma(
+  const encoder_state_t * const state,
+  const uvg_picture * const ref,
+  const uvg_ref_padding_t * const padding,
+  const mv_t mv[2],
+  uvg_pixel *px,
+  uvg_pixel_im *im,
+  const cu_loc_t* const cu_loc)
+{
+  yuv_t px_yuv = { .size = cu_loc->width * cu_loc->height, .y = px };
+  yuv_im_t im_yuv = { .size = cu_loc->width * cu_loc->height, .y = im };
+  return inter_recon_unipred(state, ref, padding, cu_loc->width, mv, &px_yuv, &im_yuv,
+                             true, false, cu_loc) & 1;
+}
+
+
+/**
+ * \brief Average two luma predictions from uvg_inter_pred_unipred_luma into
+ * lcu->rec.
+ */
+void uvg_inter_bipred_average_luma(
+  lcu_t *lcu,
+  uvg_pixel *px_L0,
+  uvg_pixel_im *im_L0,
+  unsigned im_flags_L0,
+  uvg_pixel *px_L1,
+  uvg_pixel_im *im_L1,
+  unsigned im_flags_L1,
+  const cu_loc_t* const cu_loc)
+{
+  const int size = cu_loc->width * cu_loc->height;
+  yuv_t px_yuv_L0 = { .size = size, .y = px_L0 };
+  yuv_t px_yuv_L1 = { .size = size, .y = px_L1 };
+  yuv_im_t im_yuv_L0 = { .size = size, .y = im_L0 };
+  yuv_im_t im_yuv_L1 = { .size = size, .y = im_L1 };
+  uvg_bipred_average(lcu, &px_yuv_L0, &px_yuv_L1, &im_yuv_L0, &im_yuv_L1,
+                     cu_loc->x, cu_loc->y, cu_loc->width, cu_loc->height,
+                     im_flags_L0, im_flags_L1,
+                     true, false);
+}
+
+
 /**
  * Reconstruct a single CU.
  *
@@ -681,16 +756,18 @@ void uvg_inter_pred_pu(
   cu_info_t *pu = LCU_GET_CU_AT_PX(lcu, x_scu, y_scu);
 
   if (pu->inter.mv_dir == 3) {
+    const int ref_idx[2] = {
+      state->frame->ref_LX[0][pu->inter.mv_ref[0]],
+      state->frame->ref_LX[1][pu->inter.mv_ref[1]],
+    };
     const uvg_picture *const refs[2] = {
-      state->frame->ref->images[
-        state->frame->ref_LX[0][
-          pu->inter.mv_ref[0]]],
-      state->frame->ref->images[
-        state->frame->ref_LX[1][
-          pu->inter.mv_ref[1]]],
+      state->frame->ref->images[ref_idx[0]],
+      state->frame->ref->images[ref_idx[1]],
     };
     uvg_inter_recon_bipred(state,
                            refs[0], refs[1],
+                           state->frame->ref->paddings[ref_idx[0]],
+                           state->frame->ref->paddings[ref_idx[1]],
                            pu->inter.mv, lcu,
                            predict_luma, predict_chroma,
                            cu_loc);
@@ -699,10 +776,8 @@ void uvg_inter_pred_pu(
     ibc_recon_cu(state, lcu, cu_loc->x, cu_loc->y, cu_loc->width, predict_luma, predict_chroma);
   } else{
     const int mv_idx = pu->inter.mv_dir - 1;
-    const uvg_picture *const ref =
-      state->frame->ref->images[
-        state->frame->ref_LX[mv_idx][
-          pu->inter.mv_ref[mv_idx]]];
+    const int ref_idx = state->frame->ref_LX[mv_idx][pu->inter.mv_ref[mv_idx]];
+    const uvg_picture *const ref = state->frame->ref->images[ref_idx];
 
     const unsigned offset_luma = SUB_SCU(cu_loc->y) * LCU_WIDTH + SUB_SCU(cu_loc->x);
     const unsigned offset_chroma = SUB_SCU(cu_loc->y) / 2 * LCU_WIDTH_C + SUB_SCU(cu_loc->x) / 2;
@@ -714,6 +789,7 @@ void uvg_inter_pred_pu(
 
     inter_recon_unipred(state,
                         ref,
+                        state->frame->ref->paddings[ref_idx],
                         LCU_WIDTH, pu->inter.mv[mv_idx],
                         &lcu_adapter,
                         NULL,
@@ -930,28 +1006,20 @@ static void get_temporal_merge_candidates(
       return;
     }
 
-    cu_array_t *ref_cu_array = state->frame->ref->cu_arrays[colocated_ref];
-    int cu_per_width = ref_cu_array->width / SCU_WIDTH;
+    const col_motion_field_t *col_motion = state->frame->ref->col_motions[colocated_ref];
 
     int32_t xColBr = cu_loc->x + cu_loc->width;
     int32_t yColBr = cu_loc->y + cu_loc->height;
 
     // C0 must be available
+    // Y must also be inside the current CTU / LCU
     if (xColBr < state->encoder_control->in.width &&
-        yColBr < state->encoder_control->in.height) {
-      int32_t C0_offset = -1;
-
-      // Y inside the current CTU / LCU
-      if (yColBr % LCU_WIDTH != 0) {
-        C0_offset = ((xColBr >> 3) << 3) / SCU_WIDTH +
-                  (((yColBr >> 3) << 3) / SCU_WIDTH) * cu_per_width;
-      }
-
-      if (C0_offset >= 0) {
-        // Only use when it's inter block
-        if (ref_cu_array->data[C0_offset].type == CU_INTER) {
-          cand_out->c0 = &ref_cu_array->data[C0_offset];
-        }
+        yColBr < state->encoder_control->in.height &&
+        yColBr % LCU_WIDTH != 0) {
+      // Only use when it's inter block
+      const col_motion_t *c0 = uvg_col_motion_at(col_motion, xColBr, yColBr);
+      if (c0->mv_dir) {
+        cand_out->c0 = c0;
       }
     }
     int32_t xColCtr = cu_loc->x + (cu_loc->width / 2);
@@ -959,9 +1027,9 @@ static void get_temporal_merge_candidates(
 
     // C1 must be inside the LCU, in the center position of current CU
     if (xColCtr < state->encoder_control->in.width && yColCtr < state->encoder_control->in.height) {
-      uint32_t C1_offset = ((xColCtr >> 3) << 3) / SCU_WIDTH + ((((yColCtr >> 3) << 3) / SCU_WIDTH) * cu_per_width);
-      if (ref_cu_array->data[C1_offset].type == CU_INTER) {
-        cand_out->c1 = &ref_cu_array->data[C1_offset];
+      const col_motion_t *c1 = uvg_col_motion_at(col_motion, xColCtr, yColCtr);
+      if (c1->mv_dir) {
+        cand_out->c1 = c1;
       }
     }
   }
@@ -1405,7 +1473,7 @@ static void get_spatial_merge_candidates_cua(
  *
  * \param state         encoder state
  * \param current_ref   index of the picture referenced by the current CU
- * \param colocated     colocated CU
+ * \param colocated     motion of the colocated block
  * \param reflist       either 0 (for L0) or 1 (for L1)
  * \param[out] mv_out   Returns the motion vector
  *
@@ -1413,7 +1481,7 @@ static void get_spatial_merge_candidates_cua(
  */
 static bool add_temporal_candidate(const encoder_state_t *state,
                                    uint8_t current_ref,
-                                   const cu_info_t *colocated,
+                                   const col_motion_t *colocated,
                                    int32_t reflist,
                                    mv_t mv_out[2])
 {
@@ -1442,14 +1510,14 @@ static bool add_temporal_candidate(const encoder_state_t *state,
     }
   }
   
-  if ((colocated->inter.mv_dir & (col_list + 1)) == 0) {
+  if ((colocated->mv_dir & (col_list + 1)) == 0) {
     // Use the other list if the colocated PU does not have a MV for the
     // primary list.
     col_list = 1 - col_list;
   }
 
-  mv_out[0] = colocated->inter.mv[col_list][0];
-  mv_out[1] = colocated->inter.mv[col_list][1];
+  mv_out[0] = colocated->mv[col_list][0];
+  mv_out[1] = colocated->mv[col_list][1];
 
   mv_out[0] = round_mv_comp(mv_out[0]);
   mv_out[1] = round_mv_comp(mv_out[1]);
@@ -1458,9 +1526,7 @@ static bool add_temporal_candidate(const encoder_state_t *state,
     state->frame->poc,
     state->frame->ref->pocs[current_ref],
     state->frame->ref->pocs[colocated_ref],
-    state->frame->ref->images[colocated_ref]->ref_pocs[
-      state->frame->ref->ref_LXs[colocated_ref]
-        [col_list][colocated->inter.mv_ref[col_list]]],
+    colocated->ref_poc[col_list],
     mv_out
   );
 
@@ -1480,8 +1546,8 @@ static void get_mv_cand_from_candidates(
 {
   const cu_info_t *const *a = merge_cand->a;
   const cu_info_t *const *b = merge_cand->b;
-  const cu_info_t *c0 = merge_cand->c0;
-  const cu_info_t *c1  = merge_cand->c1;
+  const col_motion_t *c0 = merge_cand->c0;
+  const col_motion_t *c1  = merge_cand->c1;
 
   uint8_t candidates = 0;
   uint8_t b_candidates = 0;
@@ -1922,7 +1988,7 @@ uint8_t uvg_inter_get_merge_cand(
       // TODO: enable L1 TMVP candidate
       // get_temporal_merge_candidates(state, x, y, width, height, 2, 0, &merge_cand);
 
-      const cu_info_t *temporal_cand =
+      const col_motion_t *temporal_cand =
         (merge_cand.c0 != NULL) ? merge_cand.c0 : merge_cand.c1;
 
       if (add_temporal_candidate(state,
@@ -2068,3 +2134,45 @@ uint8_t uvg_inter_get_merge_cand(
 
   return candidates;
 }
+
+/**
+ * \brief Store the motion of an LCU to the collocated motion field of the frame.
+ *
+ * Must be called once the CUs of the LCU are final. Later frames read the
+ * field for TMVP and motion search starting points.
+ *
+ * \param state  encoder state
+ * \param x_px   x-coordinate of the LCU in the tile in luma pixels
+ * \param y_px   y-coordinate of the LCU in the tile in luma pixels
+ */
+void uvg_inter_store_col_motion(
+  const encoder_state_t * const state,
+  int x_px,
+  int y_px)
+{
+  const videoframe_t *const frame = state->tile->frame;
+  col_motion_field_t *col_motion = frame->col_motion;
+  const int x_end = MIN(x_px + LCU_WIDTH, frame->width);
+  const int y_end = MIN(y_px + LCU_WIDTH, frame->height);
+  const int block_size = 1 << COL_MOTION_LOG2_SIZE;
+
+  for (int y = y_px; y < y_end; y += block_size) {
+    for (int x = x_px; x < x_end; x += block_size) {
+      const cu_info_t *cu = uvg_cu_array_at_const(frame->cu_array, x, y);
+      col_motion_t *col = &col_motion->data[
+        ((state->tile->offset_x + x) >> COL_MOTION_LOG2_SIZE) +
+        ((state->tile->offset_y + y) >> COL_MOTION_LOG2_SIZE) * col_motion->width];
+      memset(col, 0, sizeof(*col));
+      if (cu->type != CU_INTER) continue;
+
+      col->mv_dir = cu->inter.mv_dir;
+      for (int list = 0; list < 2; list++) {
+        if (!(cu->inter.mv_dir & (1 << list))) continue;
+        col->mv[list][0] = cu->inter.mv[list][0];
+        col->mv[list][1] = cu->inter.mv[list][1];
+        col->ref_poc[list] =
+          state->frame->ref->pocs[state->frame->ref_LX[list][cu->inter.mv_ref[list]]];
+      }
+    }
+  }
+}
@@ -78,12 +78,33 @@ void uvg_inter_recon_bipred(
   const encoder_state_t * const state,
   const uvg_picture * ref1,
   const uvg_picture * ref2,
+  const struct uvg_ref_padding * padding1,
+  const struct uvg_ref_padding * padding2,
   mv_t mv_param[2][2],
   lcu_t* lcu,
   bool predict_luma,
   bool predict_chroma,
   const cu_loc_t* const cu_loc);
 
+unsigned uvg_inter_pred_unipred_luma(
+  const encoder_state_t * const state,
+  const uvg_picture * const ref,
+  const struct uvg_ref_padding * const padding,
+  const mv_t mv[2],
+  uvg_pixel *px,
+  uvg_pixel_im *im,
+  const cu_loc_t* const cu_loc);
+
+void uvg_inter_bipred_average_luma(
+  lcu_t *lcu,
+  uvg_pixel *px_L0,
+  uvg_pixel_im *im_L0,
+  unsigned im_flags_L0,
+  uvg_pixel *px_L1,
+  uvg_pixel_im *im_L1,
+  unsigned im_flags_L1,
+  const cu_loc_t* const cu_loc);
+
 
 void uvg_inter_get_mv_cand(
   const encoder_state_t * const state,
@@ -105,4 +126,9 @@ uint8_t uvg_inter_get_merge_cand(
   const cu_loc_t* const cu_loc,
   inter_merge_cand_t mv_cand[MRG_MAX_NUM_CANDS],
   lcu_t *lcu);
+
+void uvg_inter_store_col_motion(
+  const encoder_state_t * const state,
+  int x_px,
+  int y_px);
 #endif
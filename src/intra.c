@@ -960,36 +960,29 @@ int8_t uvg_wide_angle_correction(
   return pred_mode;
 }
 
-static void intra_predict_regular(
+/**
+ * \brief Select between filtered and unfiltered references for a prediction.
+ *
+ * The filtered references are built on first use.
+ *
+ * \param mode       Intra mode before wide angle correction.
+ * \param pred_mode  Intra mode after wide angle correction.
+ */
+static const uvg_intra_ref* select_intra_reference(
   const encoder_state_t* const state,
   uvg_intra_references *refs,
-  const cu_info_t* const       cur_cu,
-  const cu_loc_t* const cu_loc,
-  const cu_loc_t* const pu_loc,
-  int_fast8_t mode,
-  color_t color,
-  uvg_pixel *dst,
-  const uint8_t multi_ref_idx,
+  const int width,
+  const int height,
+  const int_fast8_t mode,
+  const int_fast8_t pred_mode,
+  const color_t color,
+  const uint8_t multi_ref_index,
   const uint8_t isp_mode)
 {
-  const int width = color == COLOR_Y ? pu_loc->width : pu_loc->chroma_width;
-  const int height = color == COLOR_Y ? pu_loc->height : pu_loc->chroma_height;
   const int log2_width = uvg_g_convert_to_log2[width];
   const int log2_height = uvg_g_convert_to_log2[height];
   const uvg_config *cfg = &state->encoder_control->cfg;
 
-  // MRL only for luma
-  uint8_t multi_ref_index = color == COLOR_Y ? multi_ref_idx : 0;
-  uint8_t isp = color == COLOR_Y ? isp_mode : 0;
-
-  // Wide angle correction
-  int8_t pred_mode = uvg_wide_angle_correction(
-    mode,
-    color == COLOR_Y ? cur_cu->log2_width : log2_width,
-    color == COLOR_Y ? cur_cu->log2_height : log2_height,
-    false
-    );
-
   const uvg_intra_ref *used_ref = &refs->ref;
   if (cfg->intra_smoothing_disabled || color != COLOR_Y || mode == 1 || (width == 4 && height == 4) || multi_ref_index || isp_mode /*ISP_TODO: replace this fake ISP check*/) {
     // For chroma, DC and 4x4 blocks, always use unfiltered reference.
@@ -1019,6 +1012,40 @@ static void intra_predict_regular(
     intra_filter_reference(log2_width, log2_height, refs);
   }
 
+  return used_ref;
+}
+
+static void intra_predict_regular(
+  const encoder_state_t* const state,
+  uvg_intra_references *refs,
+  const cu_info_t* const       cur_cu,
+  const cu_loc_t* const cu_loc,
+  const cu_loc_t* const pu_loc,
+  int_fast8_t mode,
+  color_t color,
+  uvg_pixel *dst,
+  const uint8_t multi_ref_idx,
+  const uint8_t isp_mode)
+{
+  const int width = color == COLOR_Y ? pu_loc->width : pu_loc->chroma_width;
+  const int height = color == COLOR_Y ? pu_loc->height : pu_loc->chroma_height;
+  const int log2_width = uvg_g_convert_to_log2[width];
+  const int log2_height = uvg_g_convert_to_log2[height];
+
+  // MRL only for luma
+  uint8_t multi_ref_index = color == COLOR_Y ? multi_ref_idx : 0;
+  uint8_t isp = color == COLOR_Y ? isp_mode : 0;
+
+  // Wide angle correction
+  int8_t pred_mode = uvg_wide_angle_correction(
+    mode,
+    color == COLOR_Y ? cur_cu->log2_width : log2_width,
+    color == COLOR_Y ? cur_cu->log2_height : log2_height,
+    false
+    );
+
+  const uvg_intra_ref *used_ref = select_intra_reference(state, refs, width, height, mode, pred_mode, color, multi_ref_index, isp_mode);
+
   if (mode == 0) {
     uvg_intra_pred_planar(pu_loc, color, used_ref->top, used_ref->left, dst);
   } else if (mode == 1) {
@@ -1636,6 +1663,56 @@ void uvg_intra_predict(
   }
 }
 
+void uvg_intra_predict_multi(
+  const encoder_state_t* const state,
+  uvg_intra_references* const refs,
+  const cu_loc_t* const cu_loc,
+  const intra_search_data_t* data,
+  const int8_t* const modes,
+  const int num_modes,
+  uvg_pixel* const* const dst)
+{
+  const int width = cu_loc->width;
+  const int height = cu_loc->height;
+  const uint8_t multi_ref_index = data->pred_cu.intra.multi_ref_idx;
+  assert(!data->pred_cu.intra.mip_flag && data->pred_cu.intra.isp_mode == ISP_MODE_NO_ISP);
+  assert(num_modes <= UVG_NUM_INTRA_MODES);
+
+  // Angular modes split by whether they use the unfiltered or the filtered
+  // reference.
+  int8_t pred_modes[2][UVG_NUM_INTRA_MODES];
+  uvg_pixel* pred_dst[2][UVG_NUM_INTRA_MODES];
+  int num_pred_modes[2] = { 0, 0 };
+  const uvg_intra_ref* used_refs[2] = { &refs->ref, &refs->filtered_ref };
+
+  for (int i = 0; i < num_modes; ++i) {
+    const int8_t mode = modes[i];
+    if (mode < 2) {
+      intra_predict_regular(state, refs, &data->pred_cu, cu_loc, cu_loc, mode, COLOR_Y, dst[i], multi_ref_index, ISP_MODE_NO_ISP);
+      continue;
+    }
+    const int8_t pred_mode = uvg_wide_angle_correction(mode, data->pred_cu.log2_width, data->pred_cu.log2_height, false);
+    const uvg_intra_ref* used_ref = select_intra_reference(state, refs, width, height, mode, pred_mode, COLOR_Y, multi_ref_index, ISP_MODE_NO_ISP);
+    const int group = used_ref == &refs->filtered_ref;
+    pred_modes[group][num_pred_modes[group]] = pred_mode;
+    pred_dst[group][num_pred_modes[group]] = dst[i];
+    num_pred_modes[group]++;
+  }
+
+  for (int group = 0; group < 2; ++group) {
+    if (num_pred_modes[group] > 0) {
+      uvg_angular_pred_multi(
+        cu_loc,
+        pred_modes[group],
+        num_pred_modes[group],
+        used_refs[group]->top,
+        used_refs[group]->left,
+        pred_dst[group],
+        multi_ref_index);
+    }
+  }
+}
+
 // This function works on luma coordinates 
 int8_t uvg_get_co_located_luma_mode(
   const cu_loc_t* const chroma_loc,
@@ -141,6 +141,30 @@ void uvg_intra_predict(
   const lcu_t* lcu
 );
 
+/**
+ * \brief Generate luma intra predictions for several modes at once.
+ *
+ * Angular modes sharing a reference are predicted with a single call to
+ * uvg_angular_pred_multi. Planar and DC are predicted one by one. MIP and
+ * ISP are not supported.
+ *
+ * \param refs       Reference pixels used for the prediction.
+ * \param cu_loc     Location and size of the block.
+ * \param data       Search data, the prediction CU and reference line are
+ *                   taken from here.
+ * \param modes      Intra modes to predict.
+ * \param num_modes  Number of modes.
+ * \param dst        Buffer for the predicted pixels of each mode.
+ */
+void uvg_intra_predict_multi(
+  const encoder_state_t* const state,
+  uvg_intra_references* const refs,
+  const cu_loc_t* const cu_loc,
+  const intra_search_data_t* data,
+  const int8_t* const modes,
+  const int num_modes,
+  uvg_pixel* const* const dst);
+
 void uvg_intra_recon_cu(
   encoder_state_t* const state,
   intra_search_data_t* search_data,
@@ -0,0 +1,561 @@
+/*****************************************************************************
+ * This file is part of uvg266 VVC encoder.
+ *
+ * Copyright (c) 2021, Tampere University, ITU/ISO/IEC, project contributors
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ * * Neither the name of the Tampere University or ITU/ISO/IEC nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * INCLUDING NEGLIGENCE OR OTHERWISE ARISING IN ANY WAY OUT OF THE USE OF THIS
+ ****************************************************************************/
+
+#include "lookahead.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "cu.h"
+#include "encoder.h"
+#include "image.h"
+#include "strategies/strategies-picture.h"
+#include "threadqueue.h"
+
+
+#define LOOKAHEAD_BLOCK 8
+#define LOOKAHEAD_SEARCH_RANGE 16
+#define LOOKAHEAD_SEARCH_STEPS 8
+// Distance over which the scene cut threshold grows without an intra period.
+#define LOOKAHEAD_MAX_CUT_DISTANCE 256
+// Delta QP per doubling of the cost that depends on a block, 5 * (1 - qcomp)
+// with the usual qcomp of 0.6.
+#define LOOKAHEAD_CUTREE_STRENGTH 2.0
+
+// The i:th frame waiting to be output.
+#define LOOKAHEAD_WINDOW_FRAME(lookahead, i) \
+  (&(lookahead)->frames[((lookahead)->num_out + (i)) % (lookahead)->num_frames])
+
+
+/**
+ * \brief Intra cost of a block of the downscaled frame.
+ *
+ * The DC, horizontal and vertical predictions are formed from the
+ * neighbouring pixels of the downscaled source and the lowest SATD is
+ * returned.
+ */
+static int32_t lookahead_intra_block_cost(const lookahead_t *lookahead,
+                                          const uvg_pixel *lowres,
+                                          int32_t x,
+                                          int32_t y)
+{
+  const int32_t stride = lookahead->lowres_width;
+  const uvg_pixel *block = &lowres[y * stride + x];
+  const uvg_pixel *top = y > 0 ? block - stride : NULL;
+  const uvg_pixel *left = x > 0 ? block - 1 : NULL;
+
+  uvg_pixel pred[LOOKAHEAD_BLOCK * LOOKAHEAD_BLOCK];
+
+  int32_t sum = 0;
+  int32_t count = 0;
+  for (int i = 0; i < LOOKAHEAD_BLOCK; ++i) {
+    if (top) sum += top[i];
+    if (left) sum += left[i * stride];
+  }
+  if (top) count += LOOKAHEAD_BLOCK;
+  if (left) count += LOOKAHEAD_BLOCK;
+  const uvg_pixel dc = count ? (uvg_pixel)((sum + count / 2) / count) : (uvg_pixel)(1 << (UVG_BIT_DEPTH - 1));
+  for (int i = 0; i < LOOKAHEAD_BLOCK * LOOKAHEAD_BLOCK; ++i) {
+    pred[i] = dc;
+  }
+  int32_t best = uvg_satd_any_size(LOOKAHEAD_BLOCK, LOOKAHEAD_BLOCK, block, stride, pred, LOOKAHEAD_BLOCK);
+
+  if (top) {
+    for (int i = 0; i < LOOKAHEAD_BLOCK; ++i) {
+      memcpy(&pred[i * LOOKAHEAD_BLOCK], top, LOOKAHEAD_BLOCK * sizeof(uvg_pixel));
+    }
+    best = MIN(best, (int32_t)uvg_satd_any_size(LOOKAHEAD_BLOCK, LOOKAHEAD_BLOCK, block, stride, pred, LOOKAHEAD_BLOCK));
+  }
+  if (left) {
+    for (int i = 0; i < LOOKAHEAD_BLOCK; ++i) {
+      for (int j = 0; j < LOOKAHEAD_BLOCK; ++j) {
+        pred[i * LOOKAHEAD_BLOCK + j] = left[i * stride];
+      }
+    }
+    best = MIN(best, (int32_t)uvg_satd_any_size(LOOKAHEAD_BLOCK, LOOKAHEAD_BLOCK, block, stride, pred, LOOKAHEAD_BLOCK));
+  }
+  return best;
+}
+
+/**
+ * \brief Downscale the luma of a frame and compute its intra costs.
+ */
+static void lookahead_worker_intra(void *opaque)
+{
+  lookahead_frame_t * const frame = opaque;
+  const lookahead_t * const lookahead = frame->lookahead;
+  const uvg_picture * const pic = frame->pic;
+  const int32_t width = lookahead->lowres_width;
+
+  for (int32_t y = 0; y < lookahead->lowres_height; ++y) {
+    const uvg_pixel *src = &pic->y[2 * y * pic->stride];
+    uvg_pixel *dst = &frame->lowres[y * width];
+    for (int32_t x = 0; x < width; ++x) {
+      dst[x] = (uvg_pixel)((src[2 * x] + src[2 * x + 1] +
+                            src[pic->stride + 2 * x] + src[pic->stride + 2 * x + 1] + 2) >> 2);
+    }
+  }
+
+  frame->intra_cost = 0;
+  for (int32_t by = 0; by < lookahead->height_in_blocks; ++by) {
+    for (int32_t bx = 0; bx < lookahead->width_in_blocks; ++bx) {
+      const int32_t cost = lookahead_intra_block_cost(lookahead, frame->lowres,
+                                                      bx * LOOKAHEAD_BLOCK,
+                                                      by * LOOKAHEAD_BLOCK);
+      frame->block_intra_cost[by * lookahead->width_in_blocks + bx] = cost;
+      frame->intra_cost += cost;
+    }
+  }
+
+  if (!frame->prev) {
+    // Without a previous frame every block is coded as intra.
+    const int32_t num_blocks = lookahead->width_in_blocks * lookahead->height_in_blocks;
+    memcpy(frame->block_inter_cost, frame->block_intra_cost, num_blocks * sizeof(int32_t));
+    memset(frame->block_mvs, 0, num_blocks * sizeof(vector2d_t));
+    frame->inter_cost = frame->intra_cost;
+  }
+}
+
+/**
+ * \brief SAD of a block against the previous frame, or UINT32_MAX if the
+ * vector points outside the frame or the search range.
+ */
+static uint32_t lookahead_block_sad(const lookahead_t *lookahead,
+                                    const uvg_pixel *cur,
+                                    const uvg_pixel *ref,
+                                    int32_t x,
+                                    int32_t y,
+                                    vector2d_t mv)
+{
+  if (abs(mv.x) > LOOKAHEAD_SEARCH_RANGE || abs(mv.y) > LOOKAHEAD_SEARCH_RANGE ||
+      x + mv.x < 0 || x + mv.x + LOOKAHEAD_BLOCK > lookahead->lowres_width ||
+      y + mv.y < 0 || y + mv.y + LOOKAHEAD_BLOCK > lookahead->lowres_height)
+  {
+    return UINT32_MAX;
+  }
+  const int32_t stride = lookahead->lowres_width;
+  return uvg_reg_sad(&cur[y * stride + x], &ref[(y + mv.y) * stride + x + mv.x],
+                     LOOKAHEAD_BLOCK, LOOKAHEAD_BLOCK, stride, stride);
+}
+
+/**
+ * \brief Compute the inter cost of a frame against a reference frame.
+ *
+ * Each block starts from the zero vector and the vectors of the blocks on
+ * the left and above, and refines the best one with a small diamond search.
+ *
+ * \param lookahead     the lookahead
+ * \param frame         frame whose intra costs have been computed
+ * \param ref           downscaled luma of the reference frame
+ * \param mvs           output for the motion vector of each block
+ * \param block_costs   output for the cost of each block, or NULL
+ * \return sum of the block costs, each at most the intra cost of the block
+ */
+static int64_t lookahead_inter_cost(const lookahead_t *lookahead,
+                                    const lookahead_frame_t *frame,
+                                    const uvg_pixel *ref,
+                                    vector2d_t *mvs,
+                                    int32_t *block_costs)
+{
+  const int32_t width_in_blocks = lookahead->width_in_blocks;
+  const int32_t stride = lookahead->lowres_width;
+  const uvg_pixel * const cur = frame->lowres;
+
+  static const vector2d_t diamond[4] = { { 0, -1 }, { -1, 0 }, { 1, 0 }, { 0, 1 } };
+
+  int64_t total_cost = 0;
+  for (int32_t by = 0; by < lookahead->height_in_blocks; ++by) {
+    for (int32_t bx = 0; bx < width_in_blocks; ++bx) {
+      const int32_t x = bx * LOOKAHEAD_BLOCK;
+      const int32_t y = by * LOOKAHEAD_BLOCK;
+
+      vector2d_t candidates[3] = { { 0, 0 }, { 0, 0 }, { 0, 0 } };
+      int num_candidates = 1;
+      if (bx > 0) candidates[num_candidates++] = mvs[by * width_in_blocks + bx - 1];
+      if (by > 0) candidates[num_candidates++] = mvs[(by - 1) * width_in_blocks + bx];
+
+      vector2d_t best_mv = candidates[0];
+      uint32_t best_sad = lookahead_block_sad(lookahead, cur, ref, x, y, best_mv);
+      for (int i = 1; i < num_candidates; ++i) {
+        const uint32_t sad = lookahead_block_sad(lookahead, cur, ref, x, y, candidates[i]);
+        if (sad < best_sad) {
+          best_sad = sad;
+          best_mv = candidates[i];
+        }
+      }
+
+      for (int step = 0; step < LOOKAHEAD_SEARCH_STEPS; ++step) {
+        const vector2d_t center = best_mv;
+        for (int i = 0; i < 4; ++i) {
+          const vector2d_t mv = { center.x + diamond[i].x, center.y + diamond[i].y };
+          const uint32_t sad = lookahead_block_sad(lookahead, cur, ref, x, y, mv);
+          if (sad < best_sad) {
+            best_sad = sad;
+            best_mv = mv;
+          }
+        }
+        if (best_mv.x == center.x && best_mv.y == center.y) break;
+      }
+      mvs[by * width_in_blocks + bx] = best_mv;
+
+      const int32_t inter = uvg_satd_any_size(LOOKAHEAD_BLOCK, LOOKAHEAD_BLOCK,
+                                              &cur[y * stride + x], stride,
+                                              &ref[(y + best_mv.y) * stride + x + best_mv.x], stride);
+      const int32_t cost = MIN(inter, frame->block_intra_cost[by * width_in_blocks + bx]);
+      if (block_costs) block_costs[by * width_in_blocks + bx] = cost;
+      total_cost += cost;
+    }
+  }
+  return total_cost;
+}
+
+/**
+ * \brief Compute the inter costs of a frame against the previous frame.
+ */
+static void lookahead_worker_inter(void *opaque)
+{
+  lookahead_frame_t * const frame = opaque;
+  frame->inter_cost = lookahead_inter_cost(frame->lookahead, frame, frame->prev->lowres,
+                                           frame->block_mvs, frame->block_inter_cost);
+}
+
+/**
+ * \brief Allocate the lookahead for an encoder.
+ *
+ * \return the lookahead, or NULL on failure
+ */
+lookahead_t * uvg_lookahead_alloc(const encoder_control_t *encoder)
+{
+  lookahead_t *lookahead = calloc(1, sizeof(lookahead_t));
+  if (!lookahead) return NULL;
+
+  lookahead->encoder = encoder;
+  lookahead->num_frames = encoder->cfg.lookahead + 2;
+  lookahead->lowres_width = encoder->in.width / 2;
+  lookahead->lowres_height = encoder->in.height / 2;
+  lookahead->width_in_blocks = lookahead->lowres_width / LOOKAHEAD_BLOCK;
+  lookahead->height_in_blocks = lookahead->lowres_height / LOOKAHEAD_BLOCK;
+
+  lookahead->cut_mvs = MALLOC(vector2d_t, MAX(1, lookahead->width_in_blocks * lookahead->height_in_blocks));
+  lookahead->frames = calloc(lookahead->num_frames, sizeof(lookahead_frame_t));
+  if (!lookahead->cut_mvs || !lookahead->frames) goto lookahead_alloc_failure;
+
+  for (int i = 0; i < lookahead->num_frames; ++i) {
+    lookahead_frame_t *frame = &lookahead->frames[i];
+    frame->lookahead = lookahead;
+    frame->lowres = MALLOC(uvg_pixel, lookahead->lowres_width * lookahead->lowres_height);
+    const int32_t num_blocks = MAX(1, lookahead->width_in_blocks * lookahead->height_in_blocks);
+    frame->block_intra_cost = MALLOC(int32_t, num_blocks);
+    frame->block_inter_cost = MALLOC(int32_t, num_blocks);
+    frame->block_mvs = MALLOC(vector2d_t, num_blocks);
+    frame->block_propagate_cost = MALLOC(double, num_blocks);
+    if (!frame->lowres || !frame->block_intra_cost || !frame->block_inter_cost ||
+        !frame->block_mvs || !frame->block_propagate_cost)
+    {
+      goto lookahead_alloc_failure;
+    }
+  }
+
+  return lookahead;
+
+lookahead_alloc_failure:
+  uvg_lookahead_free(lookahead);
+  return NULL;
+}
+
+/**
+ * \brief Free the lookahead and the pictures in it.
+ *
+ * The threadqueue must have been stopped.
+ */
+void uvg_lookahead_free(lookahead_t *lookahead)
+{
+  if (!lookahead) return;
+
+  if (lookahead->frames) {
+    for (int i = 0; i < lookahead->num_frames; ++i) {
+      lookahead_frame_t *frame = &lookahead->frames[i];
+      uvg_threadqueue_free_job(&frame->intra_job);
+      uvg_threadqueue_free_job(&frame->inter_job);
+      uvg_image_free(frame->pic);
+      FREE_POINTER(frame->lowres);
+      FREE_POINTER(frame->block_intra_cost);
+      FREE_POINTER(frame->block_inter_cost);
+      FREE_POINTER(frame->block_mvs);
+      FREE_POINTER(frame->block_propagate_cost);
+    }
+    FREE_POINTER(lookahead->frames);
+  }
+  FREE_POINTER(lookahead->cut_mvs);
+  FREE_POINTER(lookahead);
+}
+
+/**
+ * \brief Pass an input picture to the lookahead.
+ *
+ * The analysis of the picture is started on the threadqueue of the
+ * encoder. The picture is output by uvg_lookahead_pop once cfg.lookahead
+ * pictures after it have been pushed, or when flushing.
+ *
+ * \param lookahead   the lookahead
+ * \param pic         input picture, the lookahead takes a new reference
+ */
+void uvg_lookahead_push(lookahead_t *lookahead, uvg_picture *pic)
+{
+  threadqueue_queue_t * const threadqueue = lookahead->encoder->threadqueue;
+  lookahead_frame_t * const frame = &lookahead->frames[lookahead->num_in % lookahead->num_frames];
+
+  // The ring buffer has room for one more frame than can be waiting, so the
+  // frame in this slot and the one after it have been output.
+  assert(frame->pic == NULL);
+
+  frame->pic = uvg_image_copy_ref(pic);
+  frame->prev = lookahead->num_in > 0
+    ? &lookahead->frames[(lookahead->num_in - 1) % lookahead->num_frames]
+    : NULL;
+
+  // The encoder waits for the analysis before it can start the next frames.
+  threadqueue_job_t *intra_job = uvg_threadqueue_job_recycle(&frame->intra_job, lookahead_worker_intra, frame);
+  uvg_threadqueue_job_set_priority(intra_job, THREADQUEUE_PRIORITY_URGENT);
+  uvg_threadqueue_submit(threadqueue, intra_job);
+
+  if (frame->prev) {
+    threadqueue_job_t *inter_job = uvg_threadqueue_job_recycle(&frame->inter_job, lookahead_worker_inter, frame);
+    uvg_threadqueue_job_dep_add(inter_job, intra_job);
+    uvg_threadqueue_job_dep_add(inter_job, frame->prev->intra_job);
+    uvg_threadqueue_job_set_priority(inter_job, THREADQUEUE_PRIORITY_URGENT);
+    uvg_threadqueue_submit(threadqueue, inter_job);
+  } else {
+    uvg_threadqueue_free_job(&frame->inter_job);
+  }
+
+  lookahead->num_in++;
+}
+
+/**
+ * \brief Wait until the analysis of a frame is done.
+ */
+static void lookahead_wait(const lookahead_t *lookahead, lookahead_frame_t *frame)
+{
+  threadqueue_queue_t * const threadqueue = lookahead->encoder->threadqueue;
+  uvg_threadqueue_waitfor(threadqueue, frame->intra_job);
+  if (frame->inter_job) {
+    uvg_threadqueue_waitfor(threadqueue, frame->inter_job);
+  }
+}
+
+
+/**
+ * \brief Compute the CU-tree QP offsets of the oldest frame in the lookahead.
+ *
+ * Starting from the newest frame, the part of the cost of each block that
+ * is saved by predicting it from the previous frame is propagated to the
+ * blocks it refers to, together with the cost propagated to the block
+ * itself. Blocks that much of the future depends on get a lower QP and
+ * the rest of the frame a higher one, as the offsets average to zero.
+ *
+ * \param lookahead     the lookahead
+ * \param num_frames    number of frames in the window, all of them analyzed
+ * \param offsets       delta QP of each CTU of the frame
+ */
+static void lookahead_cutree(const lookahead_t *lookahead, int num_frames, double *offsets)
+{
+  const encoder_control_t * const encoder = lookahead->encoder;
+  const int32_t width_in_blocks = lookahead->width_in_blocks;
+  const int32_t height_in_blocks = lookahead->height_in_blocks;
+  const int32_t num_blocks = width_in_blocks * height_in_blocks;
+
+  for (int i = 0; i < num_frames; ++i) {
+    FILL_ARRAY(LOOKAHEAD_WINDOW_FRAME(lookahead, i)->block_propagate_cost, 0.0, num_blocks);
+  }
+
+  for (int i = num_frames - 1; i > 0; --i) {
+    const lookahead_frame_t * const frame = LOOKAHEAD_WINDOW_FRAME(lookahead, i);
+    double * const ref_propagate = LOOKAHEAD_WINDOW_FRAME(lookahead, i - 1)->block_propagate_cost;
+
+    for (int32_t by = 0; by < height_in_blocks; ++by) {
+      for (int32_t bx = 0; bx < width_in_blocks; ++bx) {
+        const int32_t b = by * width_in_blocks + bx;
+        const int32_t intra = frame->block_intra_cost[b];
+        const int32_t inter = frame->block_inter_cost[b];
+        if (intra <= 0 || inter >= intra) continue;
+
+        const double amount = (intra + frame->block_propagate_cost[b]) * (intra - inter) / intra;
+
+        // Split the amount between the blocks the reference area overlaps.
+        const vector2d_t mv = frame->block_mvs[b];
+        const int32_t ref_x = bx * LOOKAHEAD_BLOCK + mv.x;
+        const int32_t ref_y = by * LOOKAHEAD_BLOCK + mv.y;
+        const int32_t ref_bx = ref_x / LOOKAHEAD_BLOCK;
+        const int32_t ref_by = ref_y / LOOKAHEAD_BLOCK;
+        const int32_t frac_x = ref_x % LOOKAHEAD_BLOCK;
+        const int32_t frac_y = ref_y % LOOKAHEAD_BLOCK;
+        const int32_t weights[4] = {
+          (LOOKAHEAD_BLOCK - frac_x) * (LOOKAHEAD_BLOCK - frac_y),
+          frac_x * (LOOKAHEAD_BLOCK - frac_y),
+          (LOOKAHEAD_BLOCK - frac_x) * frac_y,
+          frac_x * frac_y,
+        };
+        for (int j = 0; j < 4; ++j) {
+          const int32_t x = ref_bx + (j & 1);
+          const int32_t y = ref_by + (j >> 1);
+          if (weights[j] == 0 || x >= width_in_blocks || y >= height_in_blocks) continue;
+          ref_propagate[y * width_in_blocks + x] +=
+            amount * weights[j] / (LOOKAHEAD_BLOCK * LOOKAHEAD_BLOCK);
+        }
+      }
+    }
+  }
+
+  // Average the block offsets over each CTU. A CTU covers LCU_WIDTH / 2
+  // pixels of the downscaled frame.
+  const lookahead_frame_t * const frame = LOOKAHEAD_WINDOW_FRAME(lookahead, 0);
+  const int32_t lcu_blocks = LCU_WIDTH / 2 / LOOKAHEAD_BLOCK;
+  const int32_t width_in_lcu = encoder->in.width_in_lcu;
+  const int32_t height_in_lcu = encoder->in.height_in_lcu;
+  const int32_t num_lcus = width_in_lcu * height_in_lcu;
+  double frame_sum = 0.0;
+  for (int32_t lcu_y = 0; lcu_y < height_in_lcu; ++lcu_y) {
+    for (int32_t lcu_x = 0; lcu_x < width_in_lcu; ++lcu_x) {
+      double sum = 0.0;
+      int32_t count = 0;
+      for (int32_t by = lcu_y * lcu_blocks; by < MIN((lcu_y + 1) * lcu_blocks, height_in_blocks); ++by) {
+        for (int32_t bx = lcu_x * lcu_blocks; bx < MIN((lcu_x + 1) * lcu_blocks, width_in_blocks); ++bx) {
+          const int32_t b = by * width_in_blocks + bx;
+          const int32_t intra = frame->block_intra_cost[b];
+          if (intra > 0) {
+            sum -= LOOKAHEAD_CUTREE_STRENGTH * log2((intra + frame->block_propagate_cost[b]) / intra);
+          }
+          count++;
+        }
+      }
+      offsets[lcu_y * width_in_lcu + lcu_x] = count ? sum / count : 0.0;
+      frame_sum += offsets[lcu_y * width_in_lcu + lcu_x];
+    }
+  }
+
+  // The offsets are never positive. Remove their mean so that they only
+  // move bits between the CTUs of the frame and the frame QP chosen by the
+  // GOP structure or the rate control stays the average.
+  const double frame_mean = frame_sum / num_lcus;
+  for (int32_t i = 0; i < num_lcus; ++i) {
+    offsets[i] -= frame_mean;
+  }
+}
+
+/**
+ * \brief Get the next analyzed picture from the lookahead.
+ *
+ * Sets the lookahead fields of the picture. A picture is a scene cut when
+ * predicting it from the previous picture saves less than a fraction of
+ * its intra cost given by cfg.scenecut, and the same holds for predicting
+ * the next picture from that previous picture. Its complexity is its cost
+ * relative to the average cost of the pictures in the lookahead.
+ *
+ * \param lookahead   the lookahead
+ * \param flush       whether to output pictures before the lookahead is full
+ * \return the next picture, or NULL if no picture is available
+ */
+uvg_picture * uvg_lookahead_pop(lookahead_t *lookahead, bool flush)
+{
+  const uint64_t num_waiting = lookahead->num_in - lookahead->num_out;
+  if (num_waiting == 0 || (!flush && num_waiting <= (uint64_t)lookahead->encoder->cfg.lookahead)) {
+    return NULL;
+  }
+
+  lookahead_frame_t * const frame = LOOKAHEAD_WINDOW_FRAME(lookahead, 0);
+
+  int64_t window_cost = 0;
+  for (uint64_t i = 0; i < num_waiting; ++i) {
+    lookahead_frame_t *next = LOOKAHEAD_WINDOW_FRAME(lookahead, i);
+    lookahead_wait(lookahead, next);
+    window_cost += next->inter_cost;
+  }
+
+  uvg_picture *pic = frame->pic;
+  frame->pic = NULL;
+
+  // The threshold starts at a quarter of cfg.scenecut right after a cut
+  // and grows to cfg.scenecut over an intra period, so that cuts are not
+  // inserted close to each other unless the content changes completely.
+  const uvg_config * const cfg = &lookahead->encoder->cfg;
+  const double max_bias = cfg->scenecut / 100.0;
+  const double min_bias = max_bias / 4;
+  const uint64_t period = cfg->intra_period > 0 ? cfg->intra_period : LOOKAHEAD_MAX_CUT_DISTANCE;
+  const double bias = min_bias + (max_bias - min_bias) * MIN(lookahead->num_since_cut, period) / period;
+
+  // Cuts only restart the intra period without reordering of pictures.
+  // After a flash, the cost against the previous picture says nothing.
+  const bool looks_like_cut =
+    cfg->scenecut > 0 &&
+    (cfg->gop_len == 0 || cfg->gop_lowdelay) &&
+    frame->prev &&
+    !lookahead->after_flash &&
+    lookahead->num_since_cut > 1 &&
+    frame->intra_cost > 0 &&
+    frame->inter_cost >= frame->intra_cost * (1.0 - bias);
+
+  // Confirm the cut with the next picture. If it can be predicted from the
+  // picture before this one, this one is a flash or some other disturbance
+  // of a single picture and not worth an intra picture.
+  bool confirmed = false;
+  if (looks_like_cut && num_waiting > 1) {
+    const lookahead_frame_t * const next = LOOKAHEAD_WINDOW_FRAME(lookahead, 1);
+    const int64_t skip_cost = lookahead_inter_cost(lookahead, next, frame->prev->lowres,
+                                                   lookahead->cut_mvs, NULL);
+    confirmed = skip_cost >= next->intra_cost * (1.0 - bias);
+  }
+
+  pic->lookahead.scene_cut = looks_like_cut && confirmed;
+  lookahead->after_flash = looks_like_cut && !confirmed;
+  lookahead->num_since_cut = pic->lookahead.scene_cut ? 0 : lookahead->num_since_cut + 1;
+
+  if (window_cost > 0) {
+    const double average_cost = window_cost / (double)num_waiting;
+    pic->lookahead.complexity = CLIP(0.5, 2.0, frame->inter_cost / average_cost);
+  } else {
+    pic->lookahead.complexity = 1.0;
+  }
+
+  if (lookahead->encoder->cfg.cutree) {
+    const encoder_control_t * const encoder = lookahead->encoder;
+    if (!pic->lookahead.cutree_offsets) {
+      pic->lookahead.cutree_offsets = MALLOC(double, encoder->in.width_in_lcu * encoder->in.height_in_lcu);
+    }
+    if (pic->lookahead.cutree_offsets) {
+      lookahead_cutree(lookahead, (int)num_waiting, pic->lookahead.cutree_offsets);
+    }
+  }
+
+  lookahead->num_out++;
+  return pic;
+}
@@ -0,0 +1,131 @@
+#ifndef LOOKAHEAD_H_
+#define LOOKAHEAD_H_
+/*****************************************************************************
+ * This file is part of uvg266 VVC encoder.
+ *
+ * Copyright (c) 2021, Tampere University, ITU/ISO/IEC, project contributors
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ * * Neither the name of the Tampere University or ITU/ISO/IEC nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * INCLUDING NEGLIGENCE OR OTHERWISE ARISING IN ANY WAY OUT OF THE USE OF THIS
+ ****************************************************************************/
+
+/**
+ * \ingroup Control
+ * \file
+ * Analysis of input frames before they are encoded.
+ */
+
+#include "global.h" // IWYU pragma: keep
+#include "cu.h"
+#include "uvg266.h"
+
+
+// Forward declarations.
+struct encoder_control_t;
+struct threadqueue_job_t;
+struct lookahead_t;
+
+typedef struct lookahead_frame_t {
+  /** \brief The lookahead this frame belongs to. */
+  const struct lookahead_t *lookahead;
+
+  /** \brief Input picture, NULL once it has been output. */
+  uvg_picture *pic;
+
+  /** \brief Previous input frame, NULL for the first frame. */
+  const struct lookahead_frame_t *prev;
+
+  /** \brief Luma of the picture downscaled by two in both directions. */
+  uvg_pixel *lowres;
+
+  /** \brief Intra cost of each block of the downscaled frame. */
+  int32_t *block_intra_cost;
+
+  /** \brief Inter cost of each block, never larger than the intra cost. */
+  int32_t *block_inter_cost;
+
+  /** \brief Motion vector of each block to the previous frame. */
+  vector2d_t *block_mvs;
+
+  /** \brief Cost of the blocks of later frames propagated to each block. */
+  double *block_propagate_cost;
+
+  /** \brief Sum of the intra costs of the blocks. */
+  int64_t intra_cost;
+
+  /** \brief Sum of the costs of the blocks predicted from the previous frame.
+   *
+   * The intra cost is used for blocks that are cheaper to code as intra, so
+   * this is never larger than intra_cost.
+   */
+  int64_t inter_cost;
+
+  /** \brief Job for downscaling the frame and computing the intra costs. */
+  struct threadqueue_job_t *intra_job;
+
+  /** \brief Job for computing the inter costs. */
+  struct threadqueue_job_t *inter_job;
+} lookahead_frame_t;
+
+typedef struct lookahead_t {
+  const struct encoder_control_t *encoder;
+
+  /** \brief Ring buffer of the frames being analyzed.
+   *
+   * There is room for cfg.lookahead + 2 frames, since the previous frame of
+   * the oldest frame is still needed for the inter costs.
+   */
+  lookahead_frame_t *frames;
+  int num_frames;
+
+  int32_t lowres_width;
+  int32_t lowres_height;
+  int32_t width_in_blocks;
+  int32_t height_in_blocks;
+
+  /** \brief Number of pictures input. */
+  uint64_t num_in;
+
+  /** \brief Number of pictures output. */
+  uint64_t num_out;
+
+  /** \brief Number of pictures output since the last scene cut. */
+  uint64_t num_since_cut;
+
+  /** \brief Whether the last picture output looked like a cut but was a flash. */
+  bool after_flash;
+
+  /** \brief Motion vectors of the blocks for confirming scene cuts. */
+  vector2d_t *cut_mvs;
+} lookahead_t;
+
+lookahead_t * uvg_lookahead_alloc(const struct encoder_control_t *encoder);
+void uvg_lookahead_free(lookahead_t *lookahead);
+
+void uvg_lookahead_push(lookahead_t *lookahead, uvg_picture *pic);
+uvg_picture * uvg_lookahead_pop(lookahead_t *lookahead, bool flush);
+
+#endif // LOOKAHEAD_H_
@@ -378,14 +378,20 @@ static double pic_allocate_bits(encoder_state_t * const state)
     return MAX(100, alpha*pow(state->frame->icost * 4 / bits, beta)*bits);
   }
 
+  // Frames that the lookahead found harder than their neighbours get
+  // a larger share of the bits.
+  const double complexity = encoder->cfg.lookahead > 0
+    ? state->tile->frame->source->lookahead.complexity
+    : 1.0;
+
   if (encoder->cfg.gop_len <= 0) {
-    return state->frame->cur_gop_target_bits;
+    return state->frame->cur_gop_target_bits * complexity;
   }
 
   const double pic_weight = encoder->gop_layer_weights[
     encoder->cfg.gop[state->frame->gop_offset].layer - 1];
   const double pic_target_bits =
-    state->frame->cur_gop_target_bits * pic_weight - pic_header_bits(state);
+    state->frame->cur_gop_target_bits * pic_weight * complexity - pic_header_bits(state);
   // Allocate at least 100 bits for each picture like HM does.
   return MAX(100, pic_target_bits);
 }
@@ -814,8 +820,8 @@ static double qp_to_lambda(encoder_state_t* const state, int qp)
   ctu->lambda = est_lambda;
   ctu->i_cost = 0;
 
-  // Apply variance adaptive quantization
-  if (encoder->cfg.vaq) {
+  // Apply variance adaptive quantization and CU-tree offsets
+  if (encoder->cfg.vaq || encoder->cfg.cutree) {
     vector2d_t lcu = {
       pos.x + state->tile->lcu_offset_x,
       pos.y + state->tile->lcu_offset_y
@@ -1186,8 +1192,8 @@ void uvg_set_lcu_lambda_and_qp(encoder_state_t * const state,
   state->chroma_weights[1] = state->chroma_weights[2] = state->chroma_weights[3] = tmpWeight;
   state->c_lambda = state->lambda / tmpWeight;
 
-  // Apply variance adaptive quantization
-  if (ctrl->cfg.vaq) {
+  // Apply variance adaptive quantization and CU-tree offsets
+  if (ctrl->cfg.vaq || ctrl->cfg.cutree) {
     vector2d_t lcu_pos = {
       pos.x + state->tile->lcu_offset_x,
       pos.y + state->tile->lcu_offset_y
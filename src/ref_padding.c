@@ -0,0 +1,290 @@
+/*****************************************************************************
+ * This file is part of uvg266 VVC encoder.
+ *
+ * Copyright (c) 2021, Tampere University, ITU/ISO/IEC, project contributors
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ * * Neither the name of the Tampere University or ITU/ISO/IEC nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * INCLUDING NEGLIGENCE OR OTHERWISE ARISING IN ANY WAY OUT OF THE USE OF THIS
+ ****************************************************************************/
+
+
+
+#include "ref_padding.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "threads.h"
+
+
+/**
+ * \brief Allocate a padded copy of a picture.
+ *
+ * The copy is made by calling uvg_ref_padding_worker_row for each LCU row
+ * once the pixels of the picture around the row are final.
+ *
+ * \param pic       picture to copy
+ * \return padded copy or NULL on failure
+ */
+uvg_ref_padding_t *uvg_ref_padding_alloc(const uvg_picture *pic)
+{
+  uvg_ref_padding_t *padding = calloc(1, sizeof(uvg_ref_padding_t));
+  if (!padding) return NULL;
+
+  const int32_t margin = UVG_REF_PADDING_MARGIN;
+  const bool has_chroma = pic->chroma_format == UVG_CSP_420;
+  padding->width = pic->width;
+  padding->height = pic->height;
+  padding->stride = pic->width + 2 * margin;
+  padding->pic = pic;
+  padding->height_in_lcu = (pic->height + LCU_WIDTH - 1) / LCU_WIDTH;
+  padding->refcount = 1;
+
+  const size_t luma_size = (size_t)padding->stride * (pic->height + 2 * margin);
+  const size_t chroma_size = has_chroma ? luma_size / 4 : 0;
+  // SIMD interpolation may read up to a row past the bottom margin.
+  padding->buffer = MALLOC(uvg_pixel, luma_size + 2 * chroma_size + padding->stride + SIMD_ALIGNMENT);
+  padding->rows = MALLOC(uvg_ref_padding_row_t, padding->height_in_lcu);
+  if (!padding->buffer || !padding->rows) {
+    uvg_ref_padding_free(&padding);
+    return NULL;
+  }
+
+  padding->y = &padding->buffer[margin * padding->stride + margin];
+  if (has_chroma) {
+    const int32_t origin_c = (margin / 2) * (padding->stride / 2) + margin / 2;
+    padding->u = &padding->buffer[luma_size + origin_c];
+    padding->v = &padding->buffer[luma_size + chroma_size + origin_c];
+  }
+
+  for (int32_t i = 0; i < padding->height_in_lcu; ++i) {
+    padding->rows[i].padding = padding;
+    padding->rows[i].lcu_row = i;
+    padding->rows[i].done = 0;
+  }
+
+  return padding;
+}
+
+
+void uvg_ref_padding_free(uvg_ref_padding_t **padding_ptr)
+{
+  uvg_ref_padding_t *padding = *padding_ptr;
+  if (!padding) return;
+  *padding_ptr = NULL;
+
+  int32_t new_refcount = UVG_ATOMIC_DEC(&padding->refcount);
+  if (new_refcount > 0) {
+    // Still we have some references, do nothing.
+    return;
+  }
+
+  assert(new_refcount == 0);
+
+  FREE_POINTER(padding->buffer);
+  FREE_POINTER(padding->rows);
+  free(padding);
+}
+
+
+/**
+ * \brief Get a new pointer to a padded copy.
+ *
+ * Increment reference count and return the padded copy.
+ */
+uvg_ref_padding_t *uvg_ref_padding_copy_ref(uvg_ref_padding_t *padding)
+{
+  int32_t new_refcount = UVG_ATOMIC_INC(&padding->refcount);
+  assert(new_refcount >= 2);
+  (void)new_refcount;
+  return padding;
+}
+
+
+/**
+ * \brief Copy rows of a plane and replicate their edge pixels.
+ *
+ * The first and the last row of the plane are also replicated to the
+ * margins above and below the plane.
+ */
+static void pad_rows(const uvg_pixel *src, int32_t src_stride,
+                     uvg_pixel *dst, int32_t dst_stride,
+                     int32_t width, int32_t height, int32_t margin,
+                     int32_t first_y, int32_t end_y)
+{
+  uvg_copy_extended_block(src, width, height, src_stride,
+                          -margin, first_y, width + 2 * margin, end_y - first_y,
+                          &dst[first_y * dst_stride - margin], dst_stride);
+
+  const size_t row_size = dst_stride * sizeof(uvg_pixel);
+  if (first_y == 0) {
+    for (int32_t y = 1; y <= margin; ++y) {
+      memcpy(&dst[-y * dst_stride - margin], &dst[-margin], row_size);
+    }
+  }
+  if (end_y == height) {
+    const uvg_pixel *last = &dst[(height - 1) * dst_stride - margin];
+    for (int32_t y = 0; y < margin; ++y) {
+      memcpy(&dst[(height + y) * dst_stride - margin], last, row_size);
+    }
+  }
+}
+
+
+/**
+ * \brief Copy and pad an LCU row.
+ *
+ * \param opaque   uvg_ref_padding_row_t of the row
+ */
+void uvg_ref_padding_worker_row(void *opaque)
+{
+  uvg_ref_padding_row_t *const row = opaque;
+  uvg_ref_padding_t *const padding = row->padding;
+  const uvg_picture *const pic = padding->pic;
+
+  const int32_t first_y = row->lcu_row * LCU_WIDTH;
+  const int32_t end_y = MIN(first_y + LCU_WIDTH, padding->height);
+  pad_rows(pic->y, pic->stride, padding->y, padding->stride,
+           padding->width, padding->height, UVG_REF_PADDING_MARGIN,
+           first_y, end_y);
+
+  if (padding->u) {
+    const int32_t stride_c = padding->stride / 2;
+    const int32_t width_c = padding->width / 2;
+    const int32_t height_c = padding->height / 2;
+    const int32_t margin_c = UVG_REF_PADDING_MARGIN / 2;
+    pad_rows(pic->u, pic->stride / 2, padding->u, stride_c,
+             width_c, height_c, margin_c, first_y / 2, end_y / 2);
+    pad_rows(pic->v, pic->stride / 2, padding->v, stride_c,
+             width_c, height_c, margin_c, first_y / 2, end_y / 2);
+  }
+
+  UVG_ATOMIC_INC(&row->done);
+}
+
+
+/**
+ * \brief Check whether an area can be read from the padded copy.
+ *
+ * \param padding   padded copy
+ * \param color     plane of the area
+ * \param x         left edge of the area in pixels of the plane
+ * \param y         top edge of the area in pixels of the plane
+ * \param width     width of the area
+ * \param height    height of the area
+ * \return 1 if every pixel of the area has been copied
+ */
+int uvg_ref_padding_ready(const uvg_ref_padding_t *padding,
+                          color_t color,
+                          int32_t x, int32_t y,
+                          int32_t width, int32_t height)
+{
+  const int32_t shift = color == COLOR_Y ? 0 : 1;
+  const int32_t margin = UVG_REF_PADDING_MARGIN >> shift;
+  const int32_t plane_width = padding->width >> shift;
+  const int32_t plane_height = padding->height >> shift;
+  if ((shift && !padding->u) ||
+      x < -margin || y < -margin ||
+      x + width > plane_width + margin ||
+      y + height > plane_height + margin)
+  {
+    return 0;
+  }
+
+  const int32_t lcu_height = LCU_WIDTH >> shift;
+  const int32_t first_row = CLIP(0, plane_height - 1, y) / lcu_height;
+  const int32_t last_row = CLIP(0, plane_height - 1, y + height - 1) / lcu_height;
+  for (int32_t i = first_row; i <= last_row; ++i) {
+    if (!UVG_ATOMIC_LOAD(&padding->rows[i].done)) return 0;
+  }
+  return 1;
+}
+
+
+/**
+ * \brief Get a block from the padded copy.
+ *
+ * \param padding   padded copy
+ * \param color     plane of the block
+ * \param x         left edge of the block in pixels of the plane
+ * \param y         top edge of the block in pixels of the plane
+ * \param width     width of the block
+ * \param height    height of the block
+ * \param stride    returns the stride of the plane
+ * \return pointer to the top-left pixel of the block, or NULL if some of
+ *         the block has not been copied
+ */
+const uvg_pixel *uvg_ref_padding_block(const uvg_ref_padding_t *padding,
+                                       color_t color,
+                                       int32_t x, int32_t y,
+                                       int32_t width, int32_t height,
+                                       int32_t *stride)
+{
+  if (!padding || !uvg_ref_padding_ready(padding, color, x, y, width, height)) {
+    return NULL;
+  }
+  const uvg_pixel *const plane = color == COLOR_Y ? padding->y :
+                                 color == COLOR_U ? padding->u : padding->v;
+  *stride = color == COLOR_Y ? padding->stride : padding->stride / 2;
+  return &plane[y * *stride + x];
+}
+
+
+/**
+ * \brief Get a block of a reference picture extended over its borders.
+ *
+ * Works like uvg_get_extended_block but reads blocks that cross the border
+ * of the picture directly from the padded copy when it has been made.
+ *
+ * \param padding   padded copy of args->src, or NULL
+ * \param color     plane of args->src
+ * \param args      same as for uvg_get_extended_block
+ */
+void uvg_get_padded_block(const uvg_ref_padding_t *padding,
+                          color_t color,
+                          uvg_epol_args *args)
+{
+  const int min_x = args->blk_x - args->pad_l;
+  const int min_y = args->blk_y - args->pad_t;
+  const int width = args->pad_l + args->blk_w + args->pad_r;
+  const int height = args->pad_t + args->blk_h + args->pad_b + args->pad_b_simd;
+  const bool inside = min_x >= 0 && min_y >= 0 &&
+                      min_x + width <= args->src_w &&
+                      min_y + height <= args->src_h;
+
+  int32_t stride = 0;
+  const uvg_pixel *block = inside ? NULL :
+    uvg_ref_padding_block(padding, color, min_x, min_y, width, height, &stride);
+  if (!block) {
+    uvg_get_extended_block(args);
+    return;
+  }
+
+  // The interpolation functions take the source as non-const.
+  *args->ext = (uvg_pixel *)block;
+  *args->ext_origin = *args->ext + args->pad_t * stride + args->pad_l;
+  *args->ext_s = stride;
+}
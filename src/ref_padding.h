@@ -0,0 +1,114 @@
+#ifndef REF_PADDING_H_
+#define REF_PADDING_H_
+/*****************************************************************************
+ * This file is part of uvg266 VVC encoder.
+ *
+ * Copyright (c) 2021, Tampere University, ITU/ISO/IEC, project contributors
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ * * Neither the name of the Tampere University or ITU/ISO/IEC nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * INCLUDING NEGLIGENCE OR OTHERWISE ARISING IN ANY WAY OUT OF THE USE OF THIS
+ ****************************************************************************/
+
+/**
+ * \ingroup Compression
+ * \file
+ * Copies of reference pictures with a wide replicated border.
+ */
+
+#include "global.h" // IWYU pragma: keep
+#include "strategies/strategies-ipol.h"
+#include "uvg266.h"
+
+
+/**
+ * \brief Number of luma samples the padding extends outside the picture.
+ *
+ * Covers the largest full search range with room for the interpolation
+ * filter taps. Blocks that refer to samples further out are extrapolated
+ * on the fly.
+ */
+#define UVG_REF_PADDING_MARGIN 80
+
+// Forward declarations.
+struct uvg_ref_padding;
+
+typedef struct uvg_ref_padding_row_t {
+  struct uvg_ref_padding *padding;
+  int32_t lcu_row;
+  //! \brief Nonzero once the row has been copied and padded.
+  volatile int32_t done;
+} uvg_ref_padding_row_t;
+
+/**
+ * \brief Copy of a picture with the border pixels replicated outwards.
+ *
+ * Pixels outside the picture have the value of the closest pixel inside
+ * it, which is what uvg_get_extended_block produces. The copy is made one
+ * LCU row at a time. Chroma is padded only for 4:2:0.
+ */
+typedef struct uvg_ref_padding {
+  uvg_pixel *y;
+  uvg_pixel *u;
+  uvg_pixel *v;
+
+  int32_t width;
+  int32_t height;
+  //! \brief Luma stride. Chroma stride is half of it.
+  int32_t stride;
+
+  //! \brief The picture the copy is made from.
+  const uvg_picture *pic;
+
+  int32_t height_in_lcu;
+  uvg_ref_padding_row_t *rows;
+
+  uvg_pixel *buffer;
+
+  int32_t refcount;
+} uvg_ref_padding_t;
+
+uvg_ref_padding_t *uvg_ref_padding_alloc(const uvg_picture *pic);
+void uvg_ref_padding_free(uvg_ref_padding_t **padding_ptr);
+uvg_ref_padding_t *uvg_ref_padding_copy_ref(uvg_ref_padding_t *padding);
+
+void uvg_ref_padding_worker_row(void *opaque);
+
+int uvg_ref_padding_ready(const uvg_ref_padding_t *padding,
+                          color_t color,
+                          int32_t x, int32_t y,
+                          int32_t width, int32_t height);
+
+const uvg_pixel *uvg_ref_padding_block(const uvg_ref_padding_t *padding,
+                                       color_t color,
+                                       int32_t x, int32_t y,
+                                       int32_t width, int32_t height,
+                                       int32_t *stride);
+
+void uvg_get_padded_block(const uvg_ref_padding_t *padding,
+                          color_t color,
+                          uvg_epol_args *args);
+
+#endif // REF_PADDING_H_
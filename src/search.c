@@ -78,6 +78,54 @@ static INLINE void copy_cu_info(lcu_t *from, lcu_t *to, const cu_loc_t* const cu
 }
 
 
+// Number of reconstructed lines next to a CU that intra prediction reads.
+// This covers MRL (MAX_REF_LINE_IDX lines plus the corner) and the two
+// luma lines used by CCLM.
+#define WORK_TREE_CONTEXT_BAND 4
+
+/**
+ * Copy the reconstructed pixels on the left and above of a block from one
+ * work tree level to the next.
+ *
+ * The references of any CU inside the block reach at most
+ * WORK_TREE_CONTEXT_BAND lines away from the block and twice its size to the
+ * right or down, so only that band is copied unless full_context is set.
+ */
+static INLINE void copy_context_pixels(
+  const uvg_pixel *from,
+  uvg_pixel *to,
+  const int x,
+  const int y,
+  const int width,
+  const int height,
+  const int lcu_width,
+  const bool full_context)
+{
+  if (x > 0) {
+    if (full_context) {
+      uvg_pixels_blit(from, to, x, lcu_width, lcu_width, lcu_width);
+    } else {
+      const int x_start = MAX(0, x - WORK_TREE_CONTEXT_BAND);
+      const int y_start = MAX(0, y - WORK_TREE_CONTEXT_BAND);
+      const int y_end = MIN(lcu_width, y + 2 * height + WORK_TREE_CONTEXT_BAND);
+      const int offset = x_start + y_start * lcu_width;
+      uvg_pixels_blit(&from[offset], &to[offset], x - x_start, y_end - y_start, lcu_width, lcu_width);
+    }
+  }
+
+  if (y > 0) {
+    if (full_context) {
+      uvg_pixels_blit(&from[x], &to[x], lcu_width - x, y, lcu_width, lcu_width);
+    } else {
+      const int y_start = MAX(0, y - WORK_TREE_CONTEXT_BAND);
+      const int x_end = MIN(lcu_width, x + 2 * width + WORK_TREE_CONTEXT_BAND);
+      const int offset = x + y_start * lcu_width;
+      uvg_pixels_blit(&from[offset], &to[offset], x_end - x, y - y_start, lcu_width, lcu_width);
+    }
+  }
+}
+
+
 static INLINE void initialize_partial_work_tree(
   const encoder_state_t* const state,
   lcu_t* from,
@@ -90,38 +138,39 @@ static INLINE void initialize_partial_work_tree(
   const int y_limit = MIN(LCU_WIDTH,  state->tile->frame->height - cu_loc->y / 64 * 64);
   const int x_limit = MIN(LCU_WIDTH, state->tile->frame->width - cu_loc->x / 64 * 64);
 
+  // IBC may reference anything reconstructed earlier in the CTU, everything
+  // else only needs the band next to the CU.
+  const bool full_context = state->encoder_control->cfg.ibc;
+
   if (cu_loc->local_x == 0) {
     to->left_ref = from->left_ref;
     *LCU_GET_TOP_RIGHT_CU(to) = *LCU_GET_TOP_RIGHT_CU(from);
   }
-  else {
-    if(tree_type != UVG_CHROMA_T) {
-      uvg_pixels_blit(from->rec.y, to->rec.y, cu_loc->local_x, LCU_WIDTH, LCU_WIDTH, LCU_WIDTH);
-    }
-    if(tree_type != UVG_LUMA_T && from->ref.chroma_format != UVG_CSP_400) {
-      uvg_pixels_blit(from->rec.u, to->rec.u, chroma_loc->local_x / 2, LCU_WIDTH_C, LCU_WIDTH_C, LCU_WIDTH_C);
-      uvg_pixels_blit(from->rec.v, to->rec.v, chroma_loc->local_x / 2, LCU_WIDTH_C, LCU_WIDTH_C, LCU_WIDTH_C);
-    }
-  }
-
   if (cu_loc->local_y == 0) {
     to->top_ref = from->top_ref;
     *LCU_GET_TOP_RIGHT_CU(to) = *LCU_GET_TOP_RIGHT_CU(from);
   }
-  else {
-    if (tree_type != UVG_CHROMA_T) {
-      uvg_pixels_blit(&from->rec.y[cu_loc->local_x], &to->rec.y[cu_loc->local_x], 
-        LCU_WIDTH - cu_loc->local_x, cu_loc->local_y,
-        LCU_WIDTH, LCU_WIDTH);
-    }
-    if (tree_type != UVG_LUMA_T && from->ref.chroma_format != UVG_CSP_400) {
-      uvg_pixels_blit(&from->rec.u[chroma_loc->local_x / 2], &to->rec.u[chroma_loc->local_x / 2],
-        LCU_WIDTH_C - chroma_loc->local_x / 2, chroma_loc->local_y / 2,
-        LCU_WIDTH_C, LCU_WIDTH_C);
-      uvg_pixels_blit(&from->rec.v[chroma_loc->local_x / 2], &to->rec.v[chroma_loc->local_x / 2],
-        LCU_WIDTH_C - chroma_loc->local_x / 2, chroma_loc->local_y / 2,
-        LCU_WIDTH_C, LCU_WIDTH_C);
-    }
+
+  if (tree_type != UVG_CHROMA_T) {
+    const cu_loc_t *luma_loc = cu_loc;
+    if (tree_type == UVG_BOTH_T && chroma_loc != cu_loc) {
+      // CCLM of a chroma block shared by several CUs reads the luma of the
+      // whole block, including the CUs coded before this one.
+      const int offset = chroma_loc->local_x + chroma_loc->local_y * LCU_WIDTH;
+      uvg_pixels_blit(&from->rec.y[offset], &to->rec.y[offset], chroma_loc->width, chroma_loc->height, LCU_WIDTH, LCU_WIDTH);
+      luma_loc = chroma_loc;
+    }
+    copy_context_pixels(from->rec.y, to->rec.y,
+                        luma_loc->local_x, luma_loc->local_y, luma_loc->width, luma_loc->height,
+                        LCU_WIDTH, full_context);
+  }
+  if (tree_type != UVG_LUMA_T && from->ref.chroma_format != UVG_CSP_400) {
+    copy_context_pixels(from->rec.u, to->rec.u,
+                        chroma_loc->local_x / 2, chroma_loc->local_y / 2, chroma_loc->chroma_width, chroma_loc->chroma_height,
+                        LCU_WIDTH_C, full_context);
+    copy_context_pixels(from->rec.v, to->rec.v,
+                        chroma_loc->local_x / 2, chroma_loc->local_y / 2, chroma_loc->chroma_width, chroma_loc->chroma_height,
+                        LCU_WIDTH_C, full_context);
   }
 
   if (tree_type == UVG_CHROMA_T) {
@@ -1194,6 +1243,102 @@ static bool check_for_early_termission(const int cu_width, const int cu_height,
   return false;
 }
 
+/**
+ * Return the five split work trees of the given depth, allocating them on
+ * the first visit.
+ */
+static lcu_t* work_tree_arena_get(work_tree_arena_t *arena, int depth)
+{
+  assert(depth < MAX_SEARCH_SPLIT_DEPTH);
+  arena->split_nodes++;
+  if (!arena->split_lcu[depth]) {
+    arena->split_lcu[depth] = MALLOC(lcu_t, 5);
+    if (!arena->split_lcu[depth]) {
+      // The search has no way to continue without them.
+      fprintf(stderr, "Failed to allocate the split search work trees.\n");
+      assert(0);
+      exit(1);
+    }
+    arena->allocations++;
+  }
+  return arena->split_lcu[depth];
+}
+
+
+static work_tree_arena_t* work_tree_pool_take(work_tree_pool_t *pool)
+{
+  pthread_mutex_lock(&pool->lock);
+  work_tree_arena_t *arena = pool->free_list;
+  if (arena) {
+    pool->free_list = arena->next;
+  }
+  pthread_mutex_unlock(&pool->lock);
+
+  if (!arena) {
+    arena = calloc(1, sizeof(work_tree_arena_t));
+    if (!arena) {
+      fprintf(stderr, "Failed to allocate a work tree arena.\n");
+      assert(0);
+      exit(1);
+    }
+  }
+  return arena;
+}
+
+
+static void work_tree_pool_release(work_tree_pool_t *pool, work_tree_arena_t *arena)
+{
+  pthread_mutex_lock(&pool->lock);
+  pool->ctus++;
+  pool->split_nodes += arena->split_nodes;
+  pool->allocations += arena->allocations;
+  arena->split_nodes = 0;
+  arena->allocations = 0;
+  arena->next = pool->free_list;
+  pool->free_list = arena;
+  pthread_mutex_unlock(&pool->lock);
+}
+
+
+work_tree_pool_t * uvg_work_tree_pool_alloc(void)
+{
+  work_tree_pool_t *pool = calloc(1, sizeof(work_tree_pool_t));
+  if (!pool) return NULL;
+
+  if (pthread_mutex_init(&pool->lock, NULL) != 0) {
+    free(pool);
+    return NULL;
+  }
+  return pool;
+}
+
+
+void uvg_work_tree_pool_free(work_tree_pool_t *pool)
+{
+  if (!pool) return;
+
+#ifdef UVG_DEBUG_PRINT_WORK_TREE_STATS
+  if (pool->ctus) {
+    fprintf(stderr, "Work tree: %llu CTUs, %.1f split searches/CTU (previously one allocation each), %.3f allocations/CTU\n",
+            (unsigned long long)pool->ctus,
+            (double)pool->split_nodes / pool->ctus,
+            (double)pool->allocations / pool->ctus);
+  }
+#endif
+
+  while (pool->free_list) {
+    work_tree_arena_t *arena = pool->free_list;
+    pool->free_list = arena->next;
+    for (int i = 0; i < MAX_SEARCH_SPLIT_DEPTH; ++i) {
+      FREE_POINTER(arena->split_lcu[i]);
+    }
+    free(arena);
+  }
+  pthread_mutex_destroy(&pool->lock);
+  free(pool);
+}
+
+
 /**
  * Search every mode from 0 to MAX_PU_DEPTH and return cost of best mode.
  * - The recursion is started at depth 0 and goes in Z-order to MAX_PU_DEPTH.
@@ -1209,6 +1354,7 @@ static double search_cu(
   const cu_loc_t* const cu_loc,
   const cu_loc_t* const chroma_loc,
   lcu_t* lcu,
+  work_tree_arena_t* arena,
   enum uvg_tree_type tree_type,
   const split_tree_t split_tree,
   bool has_chroma)
@@ -1315,6 +1461,9 @@ static double search_cu(
       double mode_bitcost;
       uvg_search_cu_inter(state,
                           cu_loc, lcu,
+                          ctrl->cfg.me_ref_skip ? &arena->motion_field : NULL,
+                          &arena->pred_cache,
+                          &arena->full_search,
                           &mode_cost,
                           &mode_bitcost);
       if (mode_cost < cost) {
@@ -1725,7 +1874,7 @@ static double search_cu(
   }
 
   if (can_split_cu && (cur_cu->type == CU_NOTSET || cbf || state->encoder_control->cfg.cu_split_termination == UVG_CU_SPLIT_TERMINATION_OFF || true)) {
-    lcu_t * split_lcu = MALLOC(lcu_t, 5);
+    lcu_t * split_lcu = work_tree_arena_get(arena, depth);
     enum split_type best_split = 0;
     double best_split_cost = MAX_DOUBLE;
     cabac_data_t post_seach_cabac;
@@ -1823,7 +1972,7 @@ static double search_cu(
         new_split.part_index = split;
         split_cost += search_cu(state, 
           &new_cu_loc[split], separate_chroma ? chroma_loc : &new_cu_loc[split],
-          &split_lcu[split_type -1], 
+          &split_lcu[split_type -1], arena,
           tree_type, new_split,
           !separate_chroma || (split == splits - 1 && has_chroma));
         // If there is no separate chroma the block will always have chroma, otherwise it is the last block of the split that has the chroma
@@ -1954,7 +2103,6 @@ static double search_cu(
         state, x, y, cu_width / 2, cu_height / 2, lcu->rec.y, lcu->left_ref.y[64]
       );      
     }
-    FREE_POINTER(split_lcu);
   } else if (cur_cu->log2_height + cur_cu->log2_width > 4) {
     // Need to copy modes down since the lower level of the work tree is used
     // when searching SMP and AMP blocks.
@@ -2159,6 +2307,13 @@ void uvg_search_lcu(encoder_state_t * const state, const int x, const int y, con
   lcu_t work_tree;
   init_lcu_t(state, x, y, &work_tree, hor_buf, ver_buf);
 
+  // Deeper levels of the work tree come from an arena that is reused
+  // between CTUs instead of being allocated at every split.
+  work_tree_pool_t *pool = state->encoder_control->work_tree_pool;
+  work_tree_arena_t *arena = work_tree_pool_take(pool);
+  // Vectors stored while searching the previous CTU are no longer valid.
+  arena->motion_field.generation++;
+
   // If the ML depth prediction is enabled, 
   // generate the depth prediction interval 
   // for the current lcu
@@ -2181,6 +2336,7 @@ void uvg_search_lcu(encoder_state_t * const state, const int x, const int y, con
     &start,
     &start,
     &work_tree,
+    arena,
     tree_type,
     split_tree,
     tree_type == UVG_BOTH_T);
@@ -2201,7 +2357,7 @@ void uvg_search_lcu(encoder_state_t * const state, const int x, const int y, con
     cost = search_cu(
       state, &start,
       &start,
-      &work_tree, UVG_CHROMA_T,
+      &work_tree, arena, UVG_CHROMA_T,
       split_tree,
       true);
 
@@ -2211,6 +2367,8 @@ void uvg_search_lcu(encoder_state_t * const state, const int x, const int y, con
     copy_lcu_to_cu_data(state, x, y, &work_tree, UVG_CHROMA_T);
   }
 
+  work_tree_pool_release(pool, arena);
+
   copy_coeffs(work_tree.coeff.u, coeff->u, LCU_WIDTH_C, LCU_WIDTH_C, LCU_WIDTH_C);
   copy_coeffs(work_tree.coeff.v, coeff->v, LCU_WIDTH_C, LCU_WIDTH_C, LCU_WIDTH_C);
   if (state->encoder_control->cfg.jccr) {
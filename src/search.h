@@ -43,6 +43,7 @@
 #include "global.h" // IWYU pragma: keep
 #include "image.h"
 #include "constraint.h"
+#include "search_inter.h"
 
 #define MAX_UNIT_STATS_MAP_SIZE MAX(MAX_REF_PIC_COUNT, MRG_MAX_NUM_CANDS)
 
@@ -74,6 +75,46 @@ typedef struct unit_stats_map_t {
 } unit_stats_map_t;
 
 
+// Split decisions are stored with three bits per depth in
+// split_tree_t::split_tree, which also bounds the recursion of search_cu.
+#define MAX_SEARCH_SPLIT_DEPTH (32 / 3)
+
+/**
+ *  \brief Preallocated work trees for the split search of a single CTU.
+ *
+ *         Every level of the search_cu recursion that tries a split needs
+ *         one lcu_t per split type. The levels are allocated the first time
+ *         they are reached and reused for every following CTU, so the
+ *         recursion itself never touches the heap.
+ */
+typedef struct work_tree_arena_t {
+  lcu_t *split_lcu[MAX_SEARCH_SPLIT_DEPTH]; //!< five lcu_t for each depth
+  inter_motion_field_t motion_field; //!< best motion vectors of the CTU
+  inter_pred_cache_t pred_cache; //!< list predictions of the current PU
+  inter_full_search_buffer_t full_search; //!< full search window buffers
+  struct work_tree_arena_t *next;
+  uint64_t split_nodes; //!< number of split searches started
+  uint64_t allocations; //!< number of lcu_t sets allocated
+} work_tree_arena_t;
+
+/**
+ *  \brief Free list of work tree arenas shared by the search threads.
+ *
+ *         An arena is taken for the duration of one uvg_search_lcu call,
+ *         so there are never more arenas than concurrently searched CTUs,
+ *         i.e. roughly one per worker thread.
+ */
+typedef struct work_tree_pool_t {
+  pthread_mutex_t lock;
+  work_tree_arena_t *free_list;
+  uint64_t ctus;        //!< number of CTUs searched
+  uint64_t split_nodes; //!< sum of split_nodes of released arenas
+  uint64_t allocations; //!< sum of allocations of released arenas
+} work_tree_pool_t;
+
+work_tree_pool_t * uvg_work_tree_pool_alloc(void);
+void uvg_work_tree_pool_free(work_tree_pool_t *pool);
+
 #define NUM_MIP_MODES_FULL(width, height) (((width) == 4 && (height) == 4) ? 32 : ((width) == 4 || (height) == 4 || ((width) == 8 && (height) == 8) ? 16 : 12))
 #define NUM_MIP_MODES_HALF(width, height) (NUM_MIP_MODES_FULL((width), (height)) >> 1)
 
@@ -361,11 +361,11 @@ static void select_starting_point(ibc_search_info_t *info,
                         info->state->tile->frame->ibc_hashmap_pos_to_hash_stride +
                       origin_x / UVG_HASHMAP_BLOCKSIZE];
 
-    uvg_hashmap_node_t *result = uvg_hashmap_search(
-      info->state->tile->frame->ibc_hashmap_row[ibc_buffer_row], crc);
+    const uvg_hashmap_t *hashmap = info->state->tile->frame->ibc_hashmap_row[ibc_buffer_row];
 
-    while (result != NULL) {
-      if (result->key == crc && result->value != own_location) {
+    for (const uvg_hashmap_node_t *result = uvg_hashmap_search(hashmap, crc); result != NULL;
+         result = uvg_hashmap_next(hashmap, result)) {
+      if (result->value != own_location) {
         int pos_x = result->value >> 16;
         int pos_y = result->value & 0xffff;
         int mv_x  = pos_x - origin_x;
@@ -390,7 +390,6 @@ static void select_starting_point(ibc_search_info_t *info,
         }
         if (full_block) check_mv_cost(info, mv_x, mv_y, best_cost, best_bits, best_mv);
       }
-      result = result->next;
     }
   }
 
@@ -1150,19 +1149,16 @@ static int uvg_search_hash_cu_ibc(encoder_state_t* const state,
 
   uint32_t crc = state->tile->frame->ibc_hashmap_pos_to_hash[(yy / UVG_HASHMAP_BLOCKSIZE)*state->tile->frame->ibc_hashmap_pos_to_hash_stride + xx / UVG_HASHMAP_BLOCKSIZE];
 
-  uvg_hashmap_node_t *result = uvg_hashmap_search(state->tile->frame->ibc_hashmap_row[ibc_buffer_row],crc);
+  const uvg_hashmap_t *hashmap = state->tile->frame->ibc_hashmap_row[ibc_buffer_row];
 
 
   bool found_block = false;
 
   int  hashes_found = 0;
 
-  while (result != NULL) {
-    if (hashes_found == 0 && result->size > 1000) {
-      //fprintf(stderr, "Found a block with %d elements\n", result->size);
-      //break;      
-    }
-    if (result->key == crc && result->value != own_location) {
+  for (const uvg_hashmap_node_t *result = uvg_hashmap_search(hashmap, crc); result != NULL;
+       result = uvg_hashmap_next(hashmap, result)) {
+    if (result->value != own_location) {
       hashes_found++;
       hits++;
       int pos_x = result->value >> 16;
@@ -1212,7 +1208,6 @@ static int uvg_search_hash_cu_ibc(encoder_state_t* const state,
         }
       }
     }
-    result = result->next;
   }
 
   
@@ -34,10 +34,12 @@
 
 #include <limits.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "cabac.h"
 #include "encoder.h"
 #include "encode_coding_tree.h"
+#include "ref_padding.h"
 #include "image.h"
 #include "imagelist.h"
 #include "inter.h"
@@ -49,6 +51,19 @@
 #include "transform.h"
 #include "videoframe.h"
 
+// Smallest block size searched on the pyramid, 4x4 at quarter resolution.
+#define PYRAMID_MIN_BLOCK 16
+// Search range around the zero vector at quarter resolution.
+#define PYRAMID_SEARCH_RANGE 16
+// Search range around the starting points of the finer searches.
+#define PYRAMID_REFINE_RANGE 2
+
+// With --me-ref-skip, the integer search of a reference is skipped when its
+// best seed vector costs this many times the best vector found in the
+// references already searched for the same PU. Lower values skip more
+// searches but lose more with the non-default --me tz and --ref 4 or more.
+#define ME_REF_SKIP_RATIO 3.0
+
 typedef struct {
   encoder_state_t *state;
 
@@ -60,6 +75,10 @@ typedef struct {
    * \brief Reference frame
    */
   const uvg_picture *ref;
+  /**
+   * \brief Padded copy of the reference frame, or NULL
+   */
+  const uvg_ref_padding_t *ref_padding;
 
   /**
    * \brief Index of the reference frame
@@ -85,6 +104,36 @@ typedef struct {
    */
   optimized_sad_func_ptr_t optimized_sad;
 
+  /**
+   * \brief Best vectors found so far in the CTU, or NULL
+   */
+  inter_motion_field_t *motion_field;
+
+  /**
+   * \brief Luma predictions of single lists for bi-prediction, or NULL
+   */
+  inter_pred_cache_t *pred_cache;
+
+  /**
+   * \brief Scratch buffers of the full search
+   */
+  inter_full_search_buffer_t *full_search;
+
+  /**
+   * \brief Integer search results of the references already searched for
+   *        the PU, indexed by reference index
+   */
+  bool ref_searched[MAX_REF_PIC_COUNT];
+  vector2d_t ref_best_mv[MAX_REF_PIC_COUNT];
+  double ref_best_cost[MAX_REF_PIC_COUNT];
+
+  /**
+   * \brief Global motion of the frame at the PU in integer precision, valid
+   *        if has_global_mv is set
+   */
+  bool has_global_mv;
+  vector2d_t global_mv;
+
 } inter_search_info_t;
 
 
@@ -190,6 +239,49 @@ static INLINE bool intmv_within_tile(const inter_search_info_t *info, int x, int
 }
 
 
+/**
+ * \brief Calculate cost for an integer motion vector from its SAD.
+ *
+ * Updates best_mv, best_cost and best_bitcost to the new
+ * motion vector if it yields a lower cost than the current one.
+ *
+ * \return true if best_mv was changed, false otherwise
+ */
+static bool update_mv_cost(inter_search_info_t *info,
+                           int x,
+                           int y,
+                           unsigned sad,
+                           double *best_cost,
+                           double* best_bits,
+                           vector2d_t *best_mv)
+{
+  double bitcost = 0;
+  double cost = sad;
+
+  if (cost >= *best_cost) return false;
+
+  cost += info->mvd_cost_func(
+      info->state,
+      x, y, INTERNAL_MV_PREC,
+      info->mv_cand,
+      NULL,
+      0,
+      info->ref_idx,
+      &bitcost
+  );
+
+  if (cost >= *best_cost) return false;
+
+  // Set to motion vector in internal pixel precision.
+  best_mv->x = x * (1 << INTERNAL_MV_PREC);
+  best_mv->y = y * (1 << INTERNAL_MV_PREC);
+  *best_cost = cost;
+  *best_bits = bitcost;
+
+  return true;
+}
+
+
 /**
  * \brief Calculate cost for an integer motion vector.
  *
@@ -210,10 +302,10 @@ static bool check_mv_cost(inter_search_info_t *info,
 {
   if (!intmv_within_tile(info, x, y)) return false;
 
-  double bitcost = 0;
-  double cost = uvg_image_calc_sad(
+  unsigned sad = uvg_image_calc_sad(
       info->pic,
       info->ref,
+      info->ref_padding,
       info->origin.x,
       info->origin.y,
       info->state->tile->offset_x + info->origin.x + x,
@@ -223,27 +315,84 @@ static bool check_mv_cost(inter_search_info_t *info,
       info->optimized_sad
   );
 
-  if (cost >= *best_cost) return false;
+  return update_mv_cost(info, x, y, sad, best_cost, best_bits, best_mv);
+}
 
-  cost += info->mvd_cost_func(
-      info->state,
-      x, y, INTERNAL_MV_PREC,
-      info->mv_cand,
-      NULL,
-      0,
-      info->ref_idx,
-      &bitcost
-  );
 
-  if (cost >= *best_cost) return false;
+/**
+ * \brief Calculate costs for a list of integer motion vectors.
+ *
+ * Same as calling check_mv_cost for each motion vector in order, but the
+ * SADs are calculated four at a time with uvg_image_calc_sad_x4.
+ *
+ * \param mvs     motion vectors, offset by center
+ * \param count   number of motion vectors
+ *
+ * \return index of the last motion vector that changed best_mv, or -1
+ */
+static int check_mv_costs(inter_search_info_t *info,
+                          vector2d_t center,
+                          const vector2d_t *mvs,
+                          int count,
+                          double *best_cost,
+                          double* best_bits,
+                          vector2d_t *best_mv)
+{
+  int best_index = -1;
 
-  // Set to motion vector in internal pixel precision.
-  best_mv->x = x * (1 << INTERNAL_MV_PREC);
-  best_mv->y = y * (1 << INTERNAL_MV_PREC);
-  *best_cost = cost;
-  *best_bits = bitcost;
+  for (int i = 0; i < count; i += 4) {
+    const int num = MIN(4, count - i);
+    vector2d_t mv[4];
+    bool valid[4];
+    int num_valid = 0;
+    for (int j = 0; j < num; ++j) {
+      mv[j].x = center.x + mvs[i + j].x;
+      mv[j].y = center.y + mvs[i + j].y;
+      valid[j] = intmv_within_tile(info, mv[j].x, mv[j].y);
+      num_valid += valid[j];
+    }
+    if (num_valid == 0) continue;
+
+    unsigned sads[4];
+    if (num_valid == 1) {
+      for (int j = 0; j < num; ++j) {
+        if (valid[j]) {
+          sads[j] = uvg_image_calc_sad(info->pic, info->ref, info->ref_padding,
+                                       info->origin.x, info->origin.y,
+                                       info->state->tile->offset_x + info->origin.x + mv[j].x,
+                                       info->state->tile->offset_y + info->origin.y + mv[j].y,
+                                       info->width, info->height,
+                                       info->optimized_sad);
+        }
+      }
+    } else {
+      // Unused slots repeat a valid position so that every block read is
+      // one check_mv_cost would read.
+      int first_valid = 0;
+      while (!valid[first_valid]) ++first_valid;
+      int ref_x[4];
+      int ref_y[4];
+      for (int j = 0; j < 4; ++j) {
+        const vector2d_t pos = j < num && valid[j] ? mv[j] : mv[first_valid];
+        ref_x[j] = info->state->tile->offset_x + info->origin.x + pos.x;
+        ref_y[j] = info->state->tile->offset_y + info->origin.y + pos.y;
+      }
+      uvg_image_calc_sad_x4(info->pic, info->ref, info->ref_padding,
+                            info->origin.x, info->origin.y,
+                            ref_x, ref_y, info->width, info->height,
+                            info->optimized_sad, sads);
+    }
 
-  return true;
+    for (int j = 0; j < num; ++j) {
+      if (valid[j] &&
+          update_mv_cost(info, mv[j].x, mv[j].y, sads[j], best_cost, best_bits, best_mv))
+      {
+        best_index = i + j;
+      }
+    }
+  }
+
+  return best_index;
 }
 
 
@@ -291,8 +440,8 @@ static bool mv_in_merge(const inter_search_info_t *info, vector2d_t mv)
 /**
  * \brief Select starting point for integer motion estimation search.
  *
- * Checks the zero vector, extra_mv and merge candidates and updates
- * best_mv to the best one.
+ * Checks the zero vector, extra_mv, the global motion of the frame and
+ * merge candidates and updates best_mv to the best one.
  */
 static void select_starting_point(inter_search_info_t *info,
                                   vector2d_t extra_mv,
@@ -312,6 +461,15 @@ static void select_starting_point(inter_search_info_t *info,
     check_mv_cost(info, extra_mv.x, extra_mv.y, best_cost, best_bits, best_mv);
   }
 
+  // Check the global motion of the frame.
+  const vector2d_t global_mv = info->global_mv;
+  if (info->has_global_mv && (global_mv.x != 0 || global_mv.y != 0) &&
+      (global_mv.x != extra_mv.x || global_mv.y != extra_mv.y) &&
+      !mv_in_merge(info, global_mv))
+  {
+    check_mv_cost(info, global_mv.x, global_mv.y, best_cost, best_bits, best_mv);
+  }
+
   if (info->state->encoder_control->cfg.ibc & 2) {
     int      origin_x       = info->origin.x;
     int      origin_y       = info->origin.y;
@@ -328,36 +486,48 @@ static void select_starting_point(inter_search_info_t *info,
                         info->state->tile->frame->ibc_hashmap_pos_to_hash_stride +
                       origin_x / UVG_HASHMAP_BLOCKSIZE];
 
-    uvg_hashmap_node_t *result = uvg_hashmap_search(
-      info->state->tile->frame->ibc_hashmap_row[ibc_buffer_row], crc);
-
-    while (result != NULL) {
-      if (result->key == crc && result->value != own_location) {
-        int pos_x = result->value >> 16;
-        int pos_y = result->value & 0xffff;
-        int mv_x  = pos_x - origin_x;
-        int mv_y  = pos_y - origin_y;
-
-        int ibc_pos_x = pos_x / UVG_HASHMAP_BLOCKSIZE;
-        int ibc_pos_y = pos_y / UVG_HASHMAP_BLOCKSIZE;
-
-        bool full_block = true;
-        for (int ibc_x = 0; ibc_x < info->width / UVG_HASHMAP_BLOCKSIZE; ibc_x++) {
-          for (int ibc_y = 0; ibc_y < info->height / UVG_HASHMAP_BLOCKSIZE; ibc_y++) {
-            uint32_t neighbor_crc = info->state->tile->frame->ibc_hashmap_pos_to_hash
-                      [(ibc_pos_y+ibc_y) * info->state->tile->frame->ibc_hashmap_pos_to_hash_stride + ibc_pos_x + ibc_x];
-            uint32_t other_crc = info->state->tile->frame->ibc_hashmap_pos_to_hash
-                      [(ibc_origin_y+ibc_y) * info->state->tile->frame->ibc_hashmap_pos_to_hash_stride + ibc_origin_x + ibc_x];
-            if (other_crc != neighbor_crc) {
-              full_block = false;
-              break;
+    // Blocks with the same content in the current and the previous frame
+    // are good candidates for the motion.
+    const uvg_hashmap_t *hashmaps[2] = {
+      info->state->tile->frame->ibc_hashmap_row[ibc_buffer_row],
+      info->state->tile->frame->ibc_hashmap_row_prev[ibc_buffer_row],
+    };
+
+    const uint32_t *pos_to_hash[2] = {
+      info->state->tile->frame->ibc_hashmap_pos_to_hash,
+      info->state->tile->frame->ibc_hashmap_pos_to_hash_prev,
+    };
+
+    for (int map_idx = 0; map_idx < 2; map_idx++) {
+      const uvg_hashmap_t *hashmap = hashmaps[map_idx];
+      for (const uvg_hashmap_node_t *result = uvg_hashmap_search(hashmap, crc); result != NULL;
+           result = uvg_hashmap_next(hashmap, result)) {
+        if (result->value != own_location) {
+          int pos_x = result->value >> 16;
+          int pos_y = result->value & 0xffff;
+          int mv_x  = pos_x - origin_x;
+          int mv_y  = pos_y - origin_y;
+
+          int ibc_pos_x = pos_x / UVG_HASHMAP_BLOCKSIZE;
+          int ibc_pos_y = pos_y / UVG_HASHMAP_BLOCKSIZE;
+
+          bool full_block = true;
+          for (int ibc_x = 0; ibc_x < info->width / UVG_HASHMAP_BLOCKSIZE; ibc_x++) {
+            for (int ibc_y = 0; ibc_y < info->height / UVG_HASHMAP_BLOCKSIZE; ibc_y++) {
+              uint32_t neighbor_crc = pos_to_hash[map_idx]
+                        [(ibc_pos_y+ibc_y) * info->state->tile->frame->ibc_hashmap_pos_to_hash_stride + ibc_pos_x + ibc_x];
+              uint32_t other_crc = info->state->tile->frame->ibc_hashmap_pos_to_hash
+                        [(ibc_origin_y+ibc_y) * info->state->tile->frame->ibc_hashmap_pos_to_hash_stride + ibc_origin_x + ibc_x];
+              if (other_crc != neighbor_crc) {
+                full_block = false;
+                break;
+              }
             }
+            if (!full_block) break;
           }
-          if (!full_block) break;
+          if (full_block) check_mv_cost(info, mv_x, mv_y, best_cost, best_bits, best_mv);
         }
-        if (full_block) check_mv_cost(info, mv_x, mv_y, best_cost, best_bits, best_mv);
       }
-      result = result->next;
     }
   }
 
@@ -514,13 +684,11 @@ static bool early_terminate(inter_search_info_t *info,
     }
 
     int best_index = 6;
-    for (int i = first_index; i <= last_index; i++) {
-      int x = mv.x + small_hexbs[i].x;
-      int y = mv.y + small_hexbs[i].y;
-
-      if (check_mv_cost(info, x, y, best_cost, best_bits, best_mv)) {
-        best_index = i;
-      }
+    const int changed = check_mv_costs(info, mv, &small_hexbs[first_index],
+                                       last_index - first_index + 1,
+                                       best_cost, best_bits, best_mv);
+    if (changed >= 0) {
+      best_index = first_index + changed;
     }
 
     // Adjust the movement vector
@@ -642,16 +810,8 @@ void uvg_tz_pattern_search(inter_search_info_t *info,
   }
 
   // Compute SAD values for all chosen points.
-  int best_index = -1;
-  for (int i = 0; i < n_points; i++) {
-    vector2d_t offset = pattern[pattern_type][i];
-    int x = mv.x + offset.x;
-    int y = mv.y + offset.y;
-
-    if (check_mv_cost(info, x, y, best_cost, best_bits, best_mv)) {
-      best_index = i;
-    }
-  }
+  const int best_index = check_mv_costs(info, mv, pattern[pattern_type], n_points,
+                                        best_cost, best_bits, best_mv);
 
   if (best_index >= 0) {
     *best_dist = iDist;
@@ -670,8 +830,15 @@ void uvg_tz_raster_search(inter_search_info_t *info,
 
   //compute SAD values for every point in the iRaster downsampled version of the current search area
   for (int y = iSearchRange; y >= -iSearchRange; y -= iRaster) {
-    for (int x = -iSearchRange; x <= iSearchRange; x += iRaster) {
-      check_mv_cost(info, mv.x + x, mv.y + y, best_cost, best_bits, best_mv);
+    for (int x = -iSearchRange; x <= iSearchRange; x += 4 * iRaster) {
+      vector2d_t offsets[4];
+      int num = 0;
+      for (int k = 0; k < 4 && x + k * iRaster <= iSearchRange; ++k) {
+        offsets[num].x = x + k * iRaster;
+        offsets[num].y = y;
+        ++num;
+      }
+      check_mv_costs(info, mv, offsets, num, best_cost, best_bits, best_mv);
     }
   }
 }
@@ -706,10 +873,15 @@ static void tz_search(inter_search_info_t *info,
     if (rounds_without_improvement >= 3) break;
   }
 
-  if (start.x != 0 || start.y != 0) {
-    // repeat step 2 starting from the zero MV
-    start.x = 0;
-    start.y = 0;
+  // Repeat step 2 starting from the global motion of the frame, which is
+  // usually close to the motion of the PU, or from the zero MV if there is
+  // no global motion.
+  vector2d_t second_start = { 0, 0 };
+  if (info->has_global_mv) {
+    second_start = info->global_mv;
+  }
+  if (start.x != second_start.x || start.y != second_start.y) {
+    start = second_start;
     rounds_without_improvement = 0;
     for (int iDist = 1; iDist <= iSearchRange/2; iDist *= 2) {
       uvg_tz_pattern_search(info, step2_type, iDist, start, &best_dist, best_cost, best_bits, best_mv);
@@ -800,10 +972,9 @@ static void hexagon_search(inter_search_info_t *info,
   int best_index = 0;
 
   // Search the initial 7 points of the hexagon.
-  for (int i = 1; i < 7; ++i) {
-    if (check_mv_cost(info, mv.x + large_hexbs[i].x, mv.y + large_hexbs[i].y, best_cost, best_bits, best_mv)) {
-      best_index = i;
-    }
+  const int changed = check_mv_costs(info, mv, &large_hexbs[1], 6, best_cost, best_bits, best_mv);
+  if (changed >= 0) {
+    best_index = 1 + changed;
   }
 
   // Iteratively search the 3 new points around the best match, until the best
@@ -828,11 +999,9 @@ static void hexagon_search(inter_search_info_t *info,
     best_index = 0;
 
     // Iterate through the next 3 points.
-    for (int i = 0; i < 3; ++i) {
-      vector2d_t offset = large_hexbs[start + i];
-      if (check_mv_cost(info, mv.x + offset.x, mv.y + offset.y, best_cost, best_bits, best_mv)) {
-        best_index = start + i;
-      }
+    const int next = check_mv_costs(info, mv, &large_hexbs[start], 3, best_cost, best_bits, best_mv);
+    if (next >= 0) {
+      best_index = start + next;
     }
   }
 
@@ -841,9 +1010,7 @@ static void hexagon_search(inter_search_info_t *info,
   //mv.y += large_hexbs[best_index].y;
 
   // Do the final step of the search with a small pattern.
-  for (int i = 1; i < 9; ++i) {
-    check_mv_cost(info, mv.x + small_hexbs[i].x, mv.y + small_hexbs[i].y, best_cost, best_bits, best_mv);
-  }
+  check_mv_costs(info, mv, &small_hexbs[1], 8, best_cost, best_bits, best_mv);
 }
 
 /**
@@ -893,10 +1060,9 @@ static void diamond_search(inter_search_info_t *info,
   enum diapos best_index = DIA_CENTER;
 
   // initial search of the points of the diamond
-  for (int i = 0; i < 5; ++i) {
-    if (check_mv_cost(info, mv.x + diamond[i].x, mv.y + diamond[i].y, best_cost, best_bits, best_mv)) {
-      best_index = i;
-    }
+  const int changed = check_mv_costs(info, mv, diamond, 5, best_cost, best_bits, best_mv);
+  if (changed >= 0) {
+    best_index = changed;
   }
 
   if (best_index == DIA_CENTER) {
@@ -920,14 +1086,22 @@ static void diamond_search(inter_search_info_t *info,
     if (steps > 0) steps -= 1;
 
     // search the points of the diamond
+    vector2d_t points[4];
+    enum diapos point_dirs[4];
+    int num_points = 0;
     for (int i = 0; i < 4; ++i) {
       // this is where we came from so it's checked already
       if (i == from_dir) continue;
 
-      if (check_mv_cost(info, mv.x + diamond[i].x, mv.y + diamond[i].y, best_cost, best_bits, best_mv)) {
-        best_index = i;
-        better_found = 1;
-      }
+      points[num_points] = diamond[i];
+      point_dirs[num_points] = i;
+      ++num_points;
+    }
+
+    const int next = check_mv_costs(info, mv, points, num_points, best_cost, best_bits, best_mv);
+    if (next >= 0) {
+      best_index = point_dirs[next];
+      better_found = 1;
     }
 
     if (better_found) {
@@ -944,6 +1118,305 @@ static void diamond_search(inter_search_info_t *info,
 }
 
 
+/**
+ * \brief Calculate the cost of an integer motion vector on a level of the
+ * downscaled frame pyramid.
+ *
+ * The SAD is scaled to full resolution so that the cost is comparable to
+ * the costs of check_mv_cost.
+ *
+ * \param info    search info
+ * \param level   pyramid level, 1 for half and 2 for quarter resolution
+ * \param x       horizontal motion vector at the resolution of the level
+ * \param y       vertical motion vector at the resolution of the level
+ * \return cost of the vector, or MAX_DOUBLE if the block is outside the frame
+ */
+static double pyramid_mv_cost(inter_search_info_t *info, int level, int x, int y)
+{
+  const uvg_picture *pic = info->state->tile->frame->pyramid->levels[level - 1];
+  const uvg_picture *ref = info->state->frame->ref->pyramids[info->ref_idx]->levels[level - 1];
+
+  const int pic_x = (info->state->tile->offset_x + info->origin.x) >> level;
+  const int pic_y = (info->state->tile->offset_y + info->origin.y) >> level;
+  const int width = info->width >> level;
+  const int height = info->height >> level;
+
+  if (pic_x + x < 0 || pic_y + y < 0 ||
+      pic_x + x + width > ref->width || pic_y + y + height > ref->height ||
+      pic_x + width > pic->width || pic_y + height > pic->height)
+  {
+    return MAX_DOUBLE;
+  }
+
+  double cost = (double)(uvg_reg_sad(&pic->y[pic_y * pic->stride + pic_x],
+                                     &ref->y[(pic_y + y) * ref->stride + pic_x + x],
+                                     width, height, pic->stride, ref->stride) << (2 * level));
+
+  double bitcost = 0;
+  cost += info->mvd_cost_func(
+      info->state,
+      x * (1 << level), y * (1 << level), INTERNAL_MV_PREC,
+      info->mv_cand,
+      NULL,
+      0,
+      info->ref_idx,
+      &bitcost
+  );
+  return cost;
+}
+
+
+/**
+ * \brief Search the best vector in a square on a pyramid level.
+ */
+static void pyramid_search_range(inter_search_info_t *info,
+                                 int level,
+                                 vector2d_t center,
+                                 int range,
+                                 double *best_cost,
+                                 vector2d_t *best_mv)
+{
+  for (int y = center.y - range; y <= center.y + range; ++y) {
+    for (int x = center.x - range; x <= center.x + range; ++x) {
+      const double cost = pyramid_mv_cost(info, level, x, y);
+      if (cost < *best_cost) {
+        *best_cost = cost;
+        best_mv->x = x;
+        best_mv->y = y;
+      }
+    }
+  }
+}
+
+
+/**
+ * \brief Do motion search on the downscaled frame pyramid.
+ *
+ * \param info      search info
+ * \param extra_mv  extra motion vector to check
+ * \param steps     how many steps the hexagon search does at maximum
+ *
+ * The vector is first searched around the zero vector and the current best
+ * vector on the frames downscaled by four, and refined on the frames
+ * downscaled by two. The result is checked at full resolution and the
+ * best vector is refined with the hexagon search. This finds large motion
+ * that the hexagon search alone misses when it gets stuck in a local
+ * minimum.
+ *
+ * Blocks smaller than 16x16 and frames without pyramids only use the
+ * hexagon search.
+ */
+static void pyramid_search(inter_search_info_t *info,
+                           vector2d_t extra_mv,
+                           uint32_t steps,
+                           double *best_cost,
+                           double* best_bits,
+                           vector2d_t *best_mv)
+{
+  const bool has_pyramid = info->state->tile->frame->pyramid != NULL &&
+                           info->state->frame->ref->pyramids[info->ref_idx] != NULL;
+
+  if (has_pyramid && info->width >= PYRAMID_MIN_BLOCK && info->height >= PYRAMID_MIN_BLOCK) {
+    // Quarter resolution. The start is rounded down to the quarter
+    // resolution pixel the vector points into, for negative vectors too.
+    const vector2d_t zero = { 0, 0 };
+    const vector2d_t start = {
+      best_mv->x >> (INTERNAL_MV_PREC + 2),
+      best_mv->y >> (INTERNAL_MV_PREC + 2),
+    };
+    double coarse_cost = MAX_DOUBLE;
+    vector2d_t coarse_mv = zero;
+    pyramid_search_range(info, 2, zero, PYRAMID_SEARCH_RANGE, &coarse_cost, &coarse_mv);
+    pyramid_search_range(info, 2, start, PYRAMID_REFINE_RANGE, &coarse_cost, &coarse_mv);
+
+    // Half resolution.
+    const vector2d_t half_start = { coarse_mv.x * 2, coarse_mv.y * 2 };
+    coarse_cost = MAX_DOUBLE;
+    pyramid_search_range(info, 1, half_start, PYRAMID_REFINE_RANGE, &coarse_cost, &coarse_mv);
+
+    if (coarse_cost < MAX_DOUBLE) {
+      check_mv_cost(info, coarse_mv.x * 2, coarse_mv.y * 2, best_cost, best_bits, best_mv);
+    }
+  }
+
+  hexagon_search(info, extra_mv, steps, best_cost, best_bits, best_mv);
+}
+
+
+/**
+ * \brief Flush the pending positions of a full search window.
+ *
+ * Calculates the SADs of up to four positions with one uvg_reg_sad_x4 call
+ * and updates the best motion vector in the order they were queued.
+ */
+static void full_search_flush(inter_search_info_t *info,
+                              const uvg_pixel *src,
+                              const uvg_pixel *const refs[4],
+                              int32_t ref_stride,
+                              const vector2d_t *mvs,
+                              int count,
+                              double *best_cost,
+                              double* best_bits,
+                              vector2d_t *best_mv)
+{
+  if (count == 0) return;
+
+  unsigned sads[4];
+  if (count == 1) {
+    sads[0] = uvg_reg_sad(src, refs[0], info->width, info->height,
+                          info->pic->stride, ref_stride);
+  } else {
+    // Unused slots repeat the first position.
+    const uvg_pixel *ref_data[4];
+    for (int i = 0; i < 4; ++i) {
+      ref_data[i] = i < count ? refs[i] : refs[0];
+    }
+    uvg_reg_sad_x4(src, ref_data, info->width, info->height,
+                   info->pic->stride, ref_stride, sads);
+  }
+
+  for (int i = 0; i < count; ++i) {
+    update_mv_cost(info, mvs[i].x, mvs[i].y, sads[i] >> (UVG_BIT_DEPTH - 8),
+                   best_cost, best_bits, best_mv);
+  }
+}
+
+
+/**
+ * \brief Exhaustively search a square window of integer motion vectors.
+ *
+ * Gives the same result as calling check_mv_cost for every position in
+ * raster order. The reference pixels of the whole window are gathered
+ * once, with the frame edges extended, and the sum of every block in the
+ * window is calculated with running sums. Since the SAD of a position can
+ * not be smaller than the difference of the block sums, positions whose
+ * sum difference already reaches the best cost are skipped. The remaining
+ * positions are measured four at a time with uvg_reg_sad_x4.
+ *
+ * \param center        center of the window
+ * \param search_range  window is center +- search_range in both directions
+ * \param skip_centers  centers of windows that have already been searched
+ *                      with the same range, positions in them are skipped
+ * \param num_skip      number of skip_centers
+ */
+static void full_search_window(inter_search_info_t *info,
+                               vector2d_t center,
+                               int32_t search_range,
+                               const vector2d_t *skip_centers,
+                               int num_skip,
+                               double *best_cost,
+                               double* best_bits,
+                               vector2d_t *best_mv)
+{
+  const int width = info->width;
+  const int height = info->height;
+  const int win_size = 2 * search_range + 1;
+  const int area_width = win_size + width - 1;
+  const int area_height = win_size + height - 1;
+
+  // Top-left corner of the block at the top-left position of the window.
+  const int ref_x = info->state->tile->offset_x + info->origin.x + center.x - search_range;
+  const int ref_y = info->state->tile->offset_y + info->origin.y + center.y - search_range;
+
+  const uvg_picture *ref = info->ref;
+  const uvg_pixel *area;
+  int32_t area_stride;
+  uvg_pixel *buffer = info->full_search->area;
+
+  assert(search_range <= FULL_SEARCH_MAX_RANGE);
+
+  if (ref_x >= 0 && ref_x + area_width <= ref->width &&
+      ref_y >= 0 && ref_y + area_height <= ref->height)
+  {
+    area = &ref->y[ref_y * ref->stride + ref_x];
+    area_stride = ref->stride;
+  } else {
+    // Copy the window with the frame edges extended, like
+    // uvg_image_calc_sad does for blocks crossing the border.
+    uvg_copy_extended_block(ref->y, ref->width, ref->height, ref->stride,
+                            ref_x, ref_y, area_width, area_height,
+                            buffer, area_width);
+    area = buffer;
+    area_stride = area_width;
+  }
+
+  // Block sums of one window row, from column sums over the block height.
+  uint32_t *col_sums = info->full_search->col_sums;
+  uint32_t block_sums[2 * FULL_SEARCH_MAX_RANGE + 1];
+
+  memset(col_sums, 0, area_width * sizeof(uint32_t));
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < area_width; ++x) {
+      col_sums[x] += area[y * area_stride + x];
+    }
+  }
+
+  const uvg_pixel *src = &info->pic->y[info->origin.y * info->pic->stride + info->origin.x];
+  uint32_t src_sum = 0;
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      src_sum += src[y * info->pic->stride + x];
+    }
+  }
+
+  for (int wy = 0; wy < win_size; ++wy) {
+    if (wy > 0) {
+      const uvg_pixel *out_row = &area[(wy - 1) * area_stride];
+      const uvg_pixel *in_row = &area[(wy - 1 + height) * area_stride];
+      for (int x = 0; x < area_width; ++x) {
+        col_sums[x] += in_row[x] - out_row[x];
+      }
+    }
+
+    uint32_t sum = 0;
+    for (int x = 0; x < width; ++x) sum += col_sums[x];
+    block_sums[0] = sum;
+    for (int wx = 1; wx < win_size; ++wx) {
+      sum += col_sums[wx - 1 + width] - col_sums[wx - 1];
+      block_sums[wx] = sum;
+    }
+
+    const int y = center.y - search_range + wy;
+    const uvg_pixel *refs[4];
+    vector2d_t mvs[4];
+    int pending = 0;
+
+    for (int wx = 0; wx < win_size; ++wx) {
+      const int x = center.x - search_range + wx;
+
+      bool already_tested = false;
+      for (int i = 0; i < num_skip; ++i) {
+        if (abs(x - skip_centers[i].x) <= search_range &&
+            abs(y - skip_centers[i].y) <= search_range)
+        {
+          already_tested = true;
+          break;
+        }
+      }
+      if (already_tested) continue;
+
+      if (!intmv_within_tile(info, x, y)) continue;
+
+      // Lower bound of the SAD, shifted the same way as the SAD.
+      const uint32_t sum_diff = src_sum > block_sums[wx] ?
+                                src_sum - block_sums[wx] : block_sums[wx] - src_sum;
+      if ((double)(sum_diff >> (UVG_BIT_DEPTH - 8)) >= *best_cost) continue;
+
+      refs[pending] = &area[wy * area_stride + wx];
+      mvs[pending].x = x;
+      mvs[pending].y = y;
+      if (++pending == 4) {
+        full_search_flush(info, src, refs, area_stride, mvs, pending,
+                          best_cost, best_bits, best_mv);
+        pending = 0;
+      }
+    }
+    full_search_flush(info, src, refs, area_stride, mvs, pending,
+                      best_cost, best_bits, best_mv);
+  }
+}
+
+
 static void search_mv_full(inter_search_info_t *info,
                            int32_t search_range,
                            vector2d_t extra_mv,
@@ -951,12 +1424,14 @@ static void search_mv_full(inter_search_info_t *info,
                            double* best_bits,
                            vector2d_t *best_mv)
 {
+  // Windows that have already been searched. The first one is around the
+  // 0-vector.
+  vector2d_t searched[MRG_MAX_NUM_CANDS + 1] = { { 0, 0 } };
+  int num_searched = 1;
+
   // Search around the 0-vector.
-  for (int y = -search_range; y <= search_range; y++) {
-    for (int x = -search_range; x <= search_range; x++) {
-      check_mv_cost(info, x, y, best_cost, best_bits, best_mv);
-    }
-  }
+  full_search_window(info, searched[0], search_range, NULL, 0,
+                     best_cost, best_bits, best_mv);
 
   // Change to integer precision.
   extra_mv.x >>= INTERNAL_MV_PREC;
@@ -964,11 +1439,8 @@ static void search_mv_full(inter_search_info_t *info,
 
   // Check around extra_mv if it's not one of the merge candidates.
   if (!mv_in_merge(info, extra_mv)) {
-    for (int y = -search_range; y <= search_range; y++) {
-      for (int x = -search_range; x <= search_range; x++) {
-        check_mv_cost(info, extra_mv.x + x, extra_mv.y + y, best_cost, best_bits, best_mv);
-      }
-    }
+    full_search_window(info, extra_mv, search_range, NULL, 0,
+                       best_cost, best_bits, best_mv);
   }
 
   // Select starting point from among merge candidates. These should include
@@ -982,40 +1454,12 @@ static void search_mv_full(inter_search_info_t *info,
     };
 
     // Ignore 0-vector because it has already been checked.
-    if (mv.x == 0 && mv.y == 0) continue;
-
-    vector2d_t min_mv = { mv.x - search_range, mv.y - search_range };
-    vector2d_t max_mv = { mv.x + search_range, mv.y + search_range };
-
-    for (int y = min_mv.y; y <= max_mv.y; ++y) {
-      for (int x = min_mv.x; x <= max_mv.x; ++x) {
-        if (!intmv_within_tile(info, x, y)) {
-          continue;
-        }
-
-        // Avoid calculating the same points over and over again.
-        bool already_tested = false;
-        for (int j = -1; j < i; ++j) {
-          int xx = 0;
-          int yy = 0;
-          if (j >= 0) {
-            if (info->merge_cand[j].dir == 3) continue;
-            xx = info->merge_cand[j].mv[info->merge_cand[j].dir - 1][0] >> INTERNAL_MV_PREC;
-            yy = info->merge_cand[j].mv[info->merge_cand[j].dir - 1][1] >> INTERNAL_MV_PREC;
-          }
-          if (x >= xx - search_range && x <= xx + search_range &&
-              y >= yy - search_range && y <= yy + search_range)
-          {
-            already_tested = true;
-            x = xx + search_range;
-            break;
-          }
-        }
-        if (already_tested) continue;
-
-        check_mv_cost(info, x, y, best_cost, best_bits, best_mv);
-      }
+    if (mv.x != 0 || mv.y != 0) {
+      // Avoid calculating the same points over and over again.
+      full_search_window(info, mv, search_range, searched, num_searched,
+                         best_cost, best_bits, best_mv);
     }
+    searched[num_searched++] = mv;
   }
 }
 
@@ -1102,7 +1546,7 @@ static void search_frac(inter_search_info_t *info,
   epol_args.ext_origin = &ext_origin;
   epol_args.ext_s = &ext_s;
 
-  uvg_get_extended_block(&epol_args);
+  uvg_get_padded_block(info->ref_padding, COLOR_Y, &epol_args);
 
   uvg_pixel *tmp_pic = pic->y + orig.y * pic->stride + orig.x;
   int tmp_stride = pic->stride;
@@ -1290,6 +1734,77 @@ static void apply_mv_scaling(int32_t current_poc,
 }
 
 
+/**
+ * \brief Get the vector stored in the CTU motion field for the center of the
+ * PU and the current reference.
+ *
+ * \return true if a vector was found
+ */
+static bool motion_field_get(const inter_search_info_t *info, vector2d_t *mv)
+{
+  const inter_motion_field_t *field = info->motion_field;
+  if (!field) return false;
+
+  const int x = SUB_SCU(info->origin.x + (info->width >> 1)) / SCU_WIDTH;
+  const int y = SUB_SCU(info->origin.y + (info->height >> 1)) / SCU_WIDTH;
+  const int index = y * LCU_CU_WIDTH + x;
+  if (field->entry_generation[info->ref_idx][index] != field->generation) {
+    return false;
+  }
+
+  mv->x = field->mv[info->ref_idx][index][0];
+  mv->y = field->mv[info->ref_idx][index][1];
+  return true;
+}
+
+
+/**
+ * \brief Store a vector of the current reference for every 4x4 block of the
+ * PU in the CTU motion field.
+ */
+static void motion_field_set(inter_search_info_t *info, vector2d_t mv)
+{
+  inter_motion_field_t *field = info->motion_field;
+  if (!field) return;
+
+  const int x0 = SUB_SCU(info->origin.x) / SCU_WIDTH;
+  const int y0 = SUB_SCU(info->origin.y) / SCU_WIDTH;
+  const int x1 = x0 + MAX(1, info->width / SCU_WIDTH);
+  const int y1 = y0 + MAX(1, info->height / SCU_WIDTH);
+  for (int y = y0; y < y1; ++y) {
+    for (int x = x0; x < x1; ++x) {
+      const int index = y * LCU_CU_WIDTH + x;
+      field->entry_generation[info->ref_idx][index] = field->generation;
+      field->mv[info->ref_idx][index][0] = mv.x;
+      field->mv[info->ref_idx][index][1] = mv.y;
+    }
+  }
+}
+
+
+/**
+ * \brief Find the reference closest in POC to the current frame among the
+ * references already searched for the PU.
+ *
+ * \return reference index, or -1 if no reference has been searched
+ */
+static int nearest_searched_ref(const inter_search_info_t *info)
+{
+  const encoder_state_t *state = info->state;
+  int nearest = -1;
+  int nearest_dist = INT_MAX;
+  for (uint32_t i = 0; i < state->frame->ref->used_size; ++i) {
+    if (!info->ref_searched[i]) continue;
+    const int dist = abs(state->frame->poc - state->frame->ref->pocs[i]);
+    if (dist < nearest_dist) {
+      nearest = i;
+      nearest_dist = dist;
+    }
+  }
+  return nearest;
+}
+
+
 /**
  * \brief Perform inter search for a single reference frame.
  */
@@ -1344,16 +1859,16 @@ static void search_pu_inter_ref(
   // no point to this anymore, but for now it helps.
   const int mid_x = info->state->tile->offset_x + info->origin.x + (info->width >> 1);
   const int mid_y = info->state->tile->offset_y + info->origin.y + (info->height >> 1);
-  const cu_array_t* ref_array = info->state->frame->ref->cu_arrays[info->ref_idx];
-  const cu_info_t* ref_cu = uvg_cu_array_at_const(ref_array, mid_x, mid_y);
-  if (ref_cu->type == CU_INTER) {
+  const col_motion_t *ref_motion =
+    uvg_col_motion_at(info->state->frame->ref->col_motions[info->ref_idx], mid_x, mid_y);
+  if (ref_motion->mv_dir) {
     vector2d_t mv_previous = { 0, 0 };
-    if (ref_cu->inter.mv_dir & 1) {
-      mv_previous.x = ref_cu->inter.mv[0][0];
-      mv_previous.y = ref_cu->inter.mv[0][1];
+    if (ref_motion->mv_dir & 1) {
+      mv_previous.x = ref_motion->mv[0][0];
+      mv_previous.y = ref_motion->mv[0][1];
     } else {
-      mv_previous.x = ref_cu->inter.mv[1][0];
-      mv_previous.y = ref_cu->inter.mv[1][1];
+      mv_previous.x = ref_motion->mv[1][0];
+      mv_previous.y = ref_motion->mv[1][1];
     }
     // Apply mv scaling if neighbor poc is available
     if (info->state->frame->ref_LX_size[ref_list] > 0) {
@@ -1370,7 +1885,7 @@ static void search_pu_inter_ref(
           break;
         }
       }
-      if ((ref_cu->inter.mv_dir & (col_list + 1)) == 0) {
+      if ((ref_motion->mv_dir & (col_list + 1)) == 0) {
         // Use the other list if the colocated PU does not have a MV for the
         // primary list.
         col_list = 1 - col_list;
@@ -1382,11 +1897,7 @@ static void search_pu_inter_ref(
         info->state->frame->poc,
         info->state->frame->ref->pocs[info->state->frame->ref_LX[ref_list][LX_idx]],
         info->state->frame->ref->pocs[neighbor_poc_index],
-        info->state->frame->ref->images[neighbor_poc_index]->ref_pocs[
-          info->state->frame->ref->ref_LXs[neighbor_poc_index]
-            [col_list]
-          [ref_cu->inter.mv_ref[col_list]]
-        ],
+        ref_motion->ref_poc[col_list],
         &mv_previous
           );
     }
@@ -1409,12 +1920,58 @@ static void search_pu_inter_ref(
   double best_cost = MAX_DOUBLE;
   double best_bits = MAX_INT;
 
+  info->has_global_mv = cfg->global_motion &&
+    uvg_global_motion_at(&info->state->frame->global_motion[info->ref_idx],
+                         mid_x, mid_y, &info->global_mv);
+
   // Select starting point from among merge candidates. These should
   // include both mv_cand vectors and (0, 0).
   select_starting_point(info, best_mv, &best_cost, &best_bits, &best_mv);
-  bool skip_me = early_terminate(info, &best_cost, &best_bits, &best_mv);
+
+  // With --me-ref-skip, skip the search if even the best of the vector found
+  // for this reference by an overlapping block at another depth and the
+  // vector of the nearest reference already searched for this PU, scaled by
+  // the POC distances, is clearly worse than what the other references gave.
+  // The search itself still starts from the merge candidates: starting it
+  // from these vectors makes the early termination stop at worse minima.
+  bool skip_ref = false;
+  if (cfg->me_ref_skip) {
+    double seed_cost = best_cost;
+    double seed_bits = best_bits;
+    vector2d_t seed_best = best_mv;
+    vector2d_t seed_mv;
+    if (motion_field_get(info, &seed_mv)) {
+      check_mv_cost(info, seed_mv.x >> INTERNAL_MV_PREC, seed_mv.y >> INTERNAL_MV_PREC,
+                    &seed_cost, &seed_bits, &seed_best);
+    }
+    const int nearest_ref = nearest_searched_ref(info);
+    if (nearest_ref >= 0) {
+      seed_mv = info->ref_best_mv[nearest_ref];
+      apply_mv_scaling(info->state->frame->poc,
+                       info->state->frame->ref->pocs[info->ref_idx],
+                       info->state->frame->poc,
+                       info->state->frame->ref->pocs[nearest_ref],
+                       &seed_mv);
+      check_mv_cost(info, seed_mv.x >> INTERNAL_MV_PREC, seed_mv.y >> INTERNAL_MV_PREC,
+                    &seed_cost, &seed_bits, &seed_best);
+    }
+
+    for (uint32_t i = 0; i < info->state->frame->ref->used_size; ++i) {
+      if (info->ref_searched[i] && seed_cost > ME_REF_SKIP_RATIO * info->ref_best_cost[i]) {
+        skip_ref = true;
+        break;
+      }
+    }
+    if (skip_ref) {
+      best_cost = seed_cost;
+      best_bits = seed_bits;
+      best_mv = seed_best;
+    }
+  }
+
+  bool skip_me = skip_ref || early_terminate(info, &best_cost, &best_bits, &best_mv);
       
-  if (!(info->state->encoder_control->cfg.me_early_termination && skip_me)) {
+  if (!skip_ref && !(info->state->encoder_control->cfg.me_early_termination && skip_me)) {
 
     switch (cfg->ime_algorithm) {
       case UVG_IME_TZ:
@@ -1434,6 +1991,11 @@ static void search_pu_inter_ref(
                        &best_cost, &best_bits, &best_mv);
         break;
 
+      case UVG_IME_PYRAMID:
+        pyramid_search(info, best_mv, info->state->encoder_control->cfg.me_max_steps,
+                       &best_cost, &best_bits, &best_mv);
+        break;
+
       default:
         hexagon_search(info, best_mv, info->state->encoder_control->cfg.me_max_steps,
                        &best_cost, &best_bits, &best_mv);
@@ -1441,11 +2003,19 @@ static void search_pu_inter_ref(
     }
   }
 
+  info->ref_searched[info->ref_idx] = true;
+  info->ref_best_mv[info->ref_idx] = best_mv;
+  info->ref_best_cost[info->ref_idx] = best_cost;
+  if (best_cost < MAX_DOUBLE) {
+    motion_field_set(info, best_mv);
+  }
+
   if (cfg->fme_level == 0 && best_cost < MAX_DOUBLE) {
     // Recalculate inter cost with SATD.
     best_cost = uvg_image_calc_satd(
       info->state->tile->frame->source,
       info->ref,
+      info->ref_padding,
       info->origin.x,
       info->origin.y,
       info->state->tile->offset_x + info->origin.x + (best_mv.x >> INTERNAL_MV_PREC),
@@ -1495,6 +2065,249 @@ static void search_pu_inter_ref(
 }
 
 
+/**
+ * \brief Get the luma prediction of the PU from one reference, predicting
+ * it only if it is not in the prediction cache yet.
+ *
+ * \param keep    entry that must not be replaced, or -1
+ *
+ * \return index of the cache entry
+ */
+static int pred_cache_get(inter_search_info_t *info,
+                          const cu_loc_t *cu_loc,
+                          int ref_idx,
+                          const mv_t mv[2],
+                          int keep)
+{
+  inter_pred_cache_t *cache = info->pred_cache;
+  for (int i = 0; i < cache->size; ++i) {
+    if (cache->entries[i].ref_idx == ref_idx &&
+        cache->entries[i].mv[0] == mv[0] &&
+        cache->entries[i].mv[1] == mv[1])
+    {
+      return i;
+    }
+  }
+
+  int index;
+  if (cache->size < INTER_PRED_CACHE_SIZE) {
+    index = cache->size++;
+  } else {
+    if (cache->next == keep) {
+      cache->next = (cache->next + 1) % INTER_PRED_CACHE_SIZE;
+    }
+    index = cache->next;
+    cache->next = (cache->next + 1) % INTER_PRED_CACHE_SIZE;
+  }
+
+  cache->entries[index].ref_idx = ref_idx;
+  cache->entries[index].mv[0] = mv[0];
+  cache->entries[index].mv[1] = mv[1];
+  cache->entries[index].im_flags = uvg_inter_pred_unipred_luma(
+    info->state,
+    info->state->frame->ref->images[ref_idx],
+    info->state->frame->ref->paddings[ref_idx],
+    mv,
+    cache->entries[index].pred.px,
+    cache->entries[index].pred.im,
+    cu_loc);
+  return index;
+}
+
+
+/**
+ * \brief Predict the luma of a bi-predicted PU into lcu->rec.
+ *
+ * Same as uvg_inter_recon_bipred for luma, but the predictions of the two
+ * lists come from the prediction cache.
+ *
+ * \param ref_idx   reference indices of L0 and L1
+ * \param mv        motion vectors of L0 and L1
+ */
+static void bipred_luma(inter_search_info_t *info,
+                        lcu_t *lcu,
+                        const cu_loc_t *cu_loc,
+                        const int ref_idx[2],
+                        mv_t mv[2][2])
+{
+  if (!info->pred_cache) {
+    const image_list_t *const ref = info->state->frame->ref;
+    uvg_inter_recon_bipred(info->state,
+                           ref->images[ref_idx[0]],
+                           ref->images[ref_idx[1]],
+                           ref->paddings[ref_idx[0]],
+                           ref->paddings[ref_idx[1]],
+                           mv, lcu, true, false, cu_loc);
+    return;
+  }
+
+  const int i0 = pred_cache_get(info, cu_loc, ref_idx[0], mv[0], -1);
+  const int i1 = pred_cache_get(info, cu_loc, ref_idx[1], mv[1], i0);
+  inter_pred_cache_t *cache = info->pred_cache;
+  uvg_inter_bipred_average_luma(lcu,
+                                cache->entries[i0].pred.px, cache->entries[i0].pred.im,
+                                cache->entries[i0].im_flags,
+                                cache->entries[i1].pred.px, cache->entries[i1].pred.im,
+                                cache->entries[i1].im_flags,
+                                cu_loc);
+}
+
+
+static void cu_cost_inter_rd2(encoder_state_t * const state,
+                              inter_search_info_t *info,
+                              cu_info_t* cur_cu,
+                              lcu_t *lcu,
+                              double *inter_cost,
+                              double* inter_bitcost,
+                              const cu_loc_t* const cu_loc);
+
+
+/**
+ * \brief Predict the luma of the PU at cu_loc in lcu into lcu->rec.
+ *
+ * Same as uvg_inter_pred_pu for luma, but bi-predicted PUs use the
+ * prediction cache.
+ */
+static void inter_pred_luma(inter_search_info_t *info,
+                            lcu_t *lcu,
+                            const cu_loc_t *cu_loc)
+{
+  cu_info_t *pu = LCU_GET_CU_AT_PX(lcu, SUB_SCU(cu_loc->x), SUB_SCU(cu_loc->y));
+  if (pu->inter.mv_dir == 3 && pu->type != CU_IBC && info->pred_cache) {
+    uint8_t(*ref_LX)[16] = info->state->frame->ref_LX;
+    const int ref_idx[2] = {
+      ref_LX[0][pu->inter.mv_ref[0]],
+      ref_LX[1][pu->inter.mv_ref[1]],
+    };
+    bipred_luma(info, lcu, cu_loc, ref_idx, pu->inter.mv);
+  } else {
+    uvg_inter_pred_pu(info->state, lcu, true, false, cu_loc);
+  }
+}
+
+
+/**
+ * \brief Calculate the cost of a bi-prediction vector pair for refinement.
+ *
+ * The SATD of the prediction plus the bits of both vectors, each against
+ * the candidates of its own list.
+ */
+static double bipred_pair_cost(inter_search_info_t *info,
+                               lcu_t *lcu,
+                               const cu_loc_t *cu_loc,
+                               const int ref_idx[2],
+                               mv_t mv[2][2],
+                               mv_t mv_cand[2][2][2],
+                               int extra_bits,
+                               double *bits)
+{
+  bipred_luma(info, lcu, cu_loc, ref_idx, mv);
+
+  const int offset = SUB_SCU(cu_loc->y) * LCU_WIDTH + SUB_SCU(cu_loc->x);
+  double cost = uvg_satd_any_size(cu_loc->width, cu_loc->height,
+                                  &lcu->rec.y[offset], LCU_WIDTH,
+                                  &lcu->ref.y[offset], LCU_WIDTH);
+
+  double bitcost[2] = { 0, 0 };
+  for (int list = 0; list < 2; ++list) {
+    cost += info->mvd_cost_func(info->state,
+                                mv[list][0], mv[list][1], 0,
+                                mv_cand[list],
+                                NULL, 0, 0,
+                                &bitcost[list]);
+  }
+  cost += info->state->lambda_sqrt * extra_bits;
+
+  *bits = bitcost[0] + bitcost[1] + extra_bits;
+  return cost;
+}
+
+
+/**
+ * \brief Refine a bi-prediction vector pair one list at a time.
+ *
+ * Each iteration tries the eight quarter-pixel neighbours of the L0 vector
+ * with L1 held fixed, and then the same for L1. The prediction of the fixed
+ * list comes from the prediction cache, so only the moving list is
+ * interpolated. Stops early when an iteration does not improve the cost.
+ *
+ * \param bipred_pu   PU with the starting pair, updated to the best pair
+ * \param iterations  maximum number of iterations
+ * \param cost        returns the cost of the best pair
+ * \param bits        returns the bits of the best pair
+ */
+static void bipred_refine(inter_search_info_t *info,
+                          lcu_t *lcu,
+                          const cu_loc_t *cu_loc,
+                          cu_info_t *bipred_pu,
+                          int iterations,
+                          double *cost,
+                          double *bits)
+{
+  static const vector2d_t pattern[8] = {
+    { -1, -1 }, { 0, -1 }, { 1, -1 }, { -1, 0 },
+    {  1,  0 }, { -1, 1 }, { 0,  1 }, {  1, 1 },
+  };
+  // Quarter-pixel step in internal precision.
+  const int step = 1 << (INTERNAL_MV_PREC - 2);
+
+  uint8_t(*ref_LX)[16] = info->state->frame->ref_LX;
+  const int ref_idx[2] = {
+    ref_LX[0][bipred_pu->inter.mv_ref[0]],
+    ref_LX[1][bipred_pu->inter.mv_ref[1]],
+  };
+  const int extra_bits = bipred_pu->inter.mv_ref[0] + bipred_pu->inter.mv_ref[1] + 2;
+
+  mv_t mv_cand[2][2][2];
+  for (int list = 0; list < 2; ++list) {
+    uvg_inter_get_mv_cand(info->state, mv_cand[list], bipred_pu, lcu, list, cu_loc);
+  }
+
+  mv_t best_mv[2][2];
+  memcpy(best_mv, bipred_pu->inter.mv, sizeof(best_mv));
+  double best_bits = 0;
+  double best_cost = bipred_pair_cost(info, lcu, cu_loc, ref_idx, best_mv, mv_cand,
+                                      extra_bits, &best_bits);
+
+  for (int iter = 0; iter < iterations; ++iter) {
+    bool improved = false;
+
+    for (int list = 0; list < 2; ++list) {
+      const mv_t center[2] = { best_mv[list][0], best_mv[list][1] };
+      for (int i = 0; i < 8; ++i) {
+        mv_t mv[2][2];
+        memcpy(mv, best_mv, sizeof(mv));
+        mv[list][0] = center[0] + pattern[i].x * step;
+        mv[list][1] = center[1] + pattern[i].y * step;
+        if (!fracmv_within_tile(info, mv[list][0], mv[list][1])) continue;
+
+        double mv_bits;
+        const double mv_cost = bipred_pair_cost(info, lcu, cu_loc, ref_idx, mv, mv_cand,
+                                                extra_bits, &mv_bits);
+        if (mv_cost < best_cost) {
+          best_cost = mv_cost;
+          best_bits = mv_bits;
+          best_mv[list][0] = mv[list][0];
+          best_mv[list][1] = mv[list][1];
+          improved = true;
+        }
+      }
+    }
+
+    if (!improved) break;
+  }
+
+  memcpy(bipred_pu->inter.mv, best_mv, sizeof(best_mv));
+  for (int list = 0; list < 2; ++list) {
+    int cu_mv_cand = select_mv_cand(info->state, mv_cand[list],
+                                    best_mv[list][0], best_mv[list][1], NULL);
+    CU_SET_MV_CAND(bipred_pu, list, cu_mv_cand);
+  }
+  *cost = best_cost;
+  *bits = best_bits;
+}
+
+
 /**
  * \brief Search bipred modes for a PU.
  */
@@ -1505,7 +2318,6 @@ static void search_pu_inter_bipred(
 {
   cu_loc_t cu_loc;
   uvg_cu_loc_ctor(&cu_loc, info->origin.x, info->origin.y, info->width, info->height);
-  const image_list_t *const ref = info->state->frame->ref;
   uint8_t (*ref_LX)[16] = info->state->frame->ref_LX;
   const videoframe_t * const frame = info->state->tile->frame;
   const int x         = info->origin.x;
@@ -1563,14 +2375,11 @@ static void search_pu_inter_bipred(
       continue;
     }
 
-    uvg_inter_recon_bipred(info->state,
-                           ref->images[ref_LX[0][merge_cand[i].ref[0]]],
-                           ref->images[ref_LX[1][merge_cand[j].ref[1]]],
-                           mv,
-                           lcu,
-                           true,
-                           false,
-                           &cu_loc);
+    const int ref_idx[2] = {
+      ref_LX[0][merge_cand[i].ref[0]],
+      ref_LX[1][merge_cand[j].ref[1]],
+    };
+    bipred_luma(info, lcu, &cu_loc, ref_idx, mv);
 
     const uvg_pixel *rec = &lcu->rec.y[SUB_SCU(y) * LCU_WIDTH + SUB_SCU(x)];
     const uvg_pixel *src = &frame->source->y[x + y * frame->source->stride];
@@ -1672,7 +2481,10 @@ static void search_pu_inter(
   lcu_t *lcu,
   unit_stats_map_t *amvp,
   unit_stats_map_t *merge,
-  inter_search_info_t *info)
+  inter_search_info_t *info,
+  inter_motion_field_t *motion_field,
+  inter_pred_cache_t *pred_cache,
+  inter_full_search_buffer_t *full_search)
 {
   const uvg_config *cfg = &state->encoder_control->cfg;
   const videoframe_t * const frame = state->tile->frame;
@@ -1700,6 +2512,10 @@ static void search_pu_inter(
   info->height         = height_cu;
   info->mvd_cost_func  = cfg->mv_rdo ? uvg_calc_mvd_cost_cabac : calc_mvd_cost;
   info->optimized_sad  = uvg_get_optimized_sad(width_cu);
+  info->motion_field   = motion_field;
+  info->pred_cache     = pred_cache;
+  if (pred_cache) pred_cache->size = 0;
+  info->full_search    = full_search;
 
   // Search for merge mode candidates
   info->num_merge_cand = uvg_inter_get_merge_cand(
@@ -1753,7 +2569,10 @@ static void search_pu_inter(
     {
       continue;
     }
-    uvg_inter_pred_pu(state, lcu, true, false, cu_loc);
+    if (state->encoder_control->cfg.rdo < 2) {
+      // With rdo >= 2, cu_cost_inter_rd2 makes its own prediction.
+      inter_pred_luma(info, lcu, cu_loc);
+    }
     merge->unit[merge->size] = *cur_pu;
     merge->unit[merge->size].type = CU_INTER;
     merge->unit[merge->size].merge_idx = merge_idx;
@@ -1762,7 +2581,7 @@ static void search_pu_inter(
 
     double bits = merge_flag_cost + merge_idx + CTX_ENTROPY_FBITS(&(state->search_cabac.ctx.cu_merge_idx_ext_model), merge_idx != 0);
     if(state->encoder_control->cfg.rdo >= 2) {
-      uvg_cu_cost_inter_rd2(state, &merge->unit[merge->size], lcu, &merge->cost[merge->size], &bits, cu_loc);
+      cu_cost_inter_rd2(state, info, &merge->unit[merge->size], lcu, &merge->cost[merge->size], &bits, cu_loc);
     }
     else {
       merge->cost[merge->size] = uvg_satd_any_size(cu_loc->width, cu_loc->height,
@@ -1857,6 +2676,7 @@ static void search_pu_inter(
   for (uint32_t ref_idx = 0; ref_idx < state->frame->ref->used_size; ref_idx++) {
     info->ref_idx = ref_idx;
     info->ref = state->frame->ref->images[ref_idx];
+    info->ref_padding = state->frame->ref->paddings[ref_idx];
 
     search_pu_inter_ref(info, lcu, cur_pu, amvp);
   }
@@ -1921,6 +2741,7 @@ static void search_pu_inter(
         int LX_idx = unipred_pu->inter.mv_ref[list];
         info->ref_idx = ref_LX[list][LX_idx];
         info->ref = ref->images[info->ref_idx];
+        info->ref_padding = ref->paddings[info->ref_idx];
 
         uvg_inter_get_mv_cand(info->state,
                               info->mv_cand,
@@ -1947,6 +2768,7 @@ static void search_pu_inter(
           unipred_pu->inter.mv[list][0] = frac_mv.x;
           unipred_pu->inter.mv[list][1] = frac_mv.y;
           CU_SET_MV_CAND(unipred_pu, list, cu_mv_cand);
+          motion_field_set(info, frac_mv);
 
           if (state->encoder_control->cfg.rdo >= 2) {
             uvg_cu_cost_inter_rd2(state, unipred_pu, lcu, &frac_cost, &frac_bits, cu_loc);
@@ -1992,7 +2814,6 @@ static void search_pu_inter(
 
       // TODO: logic is copy paste from search_pu_inter_bipred.
       // Get rid of duplicate code asap.
-      const image_list_t *const ref = info->state->frame->ref;
       uint8_t(*ref_LX)[16] = info->state->frame->ref_LX;
 
       bipred_pu->inter.mv_dir = 3;
@@ -2013,14 +2834,11 @@ static void search_pu_inter(
         uvg_inter_get_mv_cand(info->state, info->mv_cand, bipred_pu, lcu, reflist, cu_loc);
       }
 
-      uvg_inter_recon_bipred(info->state,
-                             ref->images[ref_LX[0][bipred_pu->inter.mv_ref[0]]],
-                             ref->images[ref_LX[1][bipred_pu->inter.mv_ref[1]]],
-                             mv, lcu,
-                             true,
-                             false,
-                             cu_loc
-        );
+      const int ref_idx[2] = {
+        ref_LX[0][bipred_pu->inter.mv_ref[0]],
+        ref_LX[1][bipred_pu->inter.mv_ref[1]],
+      };
+      bipred_luma(info, lcu, cu_loc, ref_idx, mv);
 
       const uvg_pixel *rec = &lcu->rec.y[SUB_SCU(cu_loc->y) * LCU_WIDTH + SUB_SCU(cu_loc->x)];
       const uvg_pixel *src = &lcu->ref.y[SUB_SCU(cu_loc->y) * LCU_WIDTH + SUB_SCU(cu_loc->x)];
@@ -2052,7 +2870,18 @@ static void search_pu_inter(
       const int extra_bits = mv_ref_coded[0] + mv_ref_coded[1] + 2 /* mv dir cost */;
       best_bipred_cost += info->state->lambda_sqrt * extra_bits;
 
-      if (best_bipred_cost < MAX_DOUBLE) {
+      double best_bipred_bits = bitcost[0] + bitcost[1] + extra_bits;
+
+      if (best_bipred_cost < MAX_DOUBLE && cfg->bipred_refine > 0) {
+        bipred_refine(info, lcu, cu_loc, bipred_pu, cfg->bipred_refine,
+                      &best_bipred_cost, &best_bipred_bits);
+
+        amvp[2].cost[amvp[2].size] = best_bipred_cost;
+        amvp[2].bits[amvp[2].size] = best_bipred_bits;
+        amvp[2].keys[amvp[2].size] = amvp[2].size;
+        amvp[2].size++;
+
+      } else if (best_bipred_cost < MAX_DOUBLE) {
 
         // Each motion vector has its own candidate
         for (int reflist = 0; reflist < 2; reflist++) {
@@ -2066,7 +2895,7 @@ static void search_pu_inter(
         }
 
         amvp[2].cost[amvp[2].size] = best_bipred_cost;
-        amvp[2].bits[amvp[2].size] = bitcost[0] + bitcost[1] + extra_bits;
+        amvp[2].bits[amvp[2].size] = best_bipred_bits;
         amvp[2].keys[amvp[2].size] = amvp[2].size;
         amvp[2].size++;
       }
@@ -2078,7 +2907,7 @@ static void search_pu_inter(
     assert(amvp[2].size <= MAX_UNIT_STATS_MAP_SIZE);
     uvg_sort_keys_by_cost(&amvp[2]);
     if (amvp[2].size > 0 && state->encoder_control->cfg.rdo >= 2) {
-      uvg_cu_cost_inter_rd2(state, &amvp[2].unit[amvp[2].keys[0]], lcu, &amvp[2].cost[amvp[2].keys[0]], &amvp[2].bits[amvp[2].keys[0]], cu_loc);
+      cu_cost_inter_rd2(state, info, &amvp[2].unit[amvp[2].keys[0]], lcu, &amvp[2].cost[amvp[2].keys[0]], &amvp[2].bits[amvp[2].keys[0]], cu_loc);
     }
   }
   if(cfg->rdo < 2) {
@@ -2124,6 +2953,22 @@ void uvg_cu_cost_inter_rd2(
   double   *inter_cost,
   double* inter_bitcost,
   const cu_loc_t* const cu_loc){
+  cu_cost_inter_rd2(state, NULL, cur_cu, lcu, inter_cost, inter_bitcost, cu_loc);
+}
+
+
+/**
+ * \brief Same as uvg_cu_cost_inter_rd2, but takes the luma of bi-predicted
+ * PUs from the prediction cache of info, if info is not NULL.
+ */
+static void cu_cost_inter_rd2(
+  encoder_state_t * const state,
+  inter_search_info_t *info,
+  cu_info_t* cur_cu,
+  lcu_t *lcu,
+  double   *inter_cost,
+  double* inter_bitcost,
+  const cu_loc_t* const cu_loc){
   
   const int x_px = SUB_SCU(cu_loc->x);
   const int y_px = SUB_SCU(cu_loc->y);
@@ -2139,7 +2984,12 @@ void uvg_cu_cost_inter_rd2(
   *cur_pu = *cur_cu;
 
   const bool reconstruct_chroma = state->encoder_control->chroma_format != UVG_CSP_400;
-  uvg_inter_recon_cu(state, lcu, true, reconstruct_chroma, cu_loc);
+  if (info) {
+    inter_pred_luma(info, lcu, cu_loc);
+    if (reconstruct_chroma) uvg_inter_recon_cu(state, lcu, false, true, cu_loc);
+  } else {
+    uvg_inter_recon_cu(state, lcu, true, reconstruct_chroma, cu_loc);
+  }
 
   int index = y_px * LCU_WIDTH + x_px;
   double ssd = uvg_pixels_calc_ssd(&lcu->ref.y[index], &lcu->rec.y[index],
@@ -2307,6 +3157,9 @@ void uvg_cu_cost_inter_rd2(
  * \param y           y-coordinate of the CU
  * \param depth       depth of the CU in the quadtree
  * \param lcu         containing LCU
+ * \param motion_field best vectors found so far in the CTU, or NULL
+ * \param pred_cache  buffers for list predictions of bi-prediction, or NULL
+ * \param full_search scratch buffers of the full search
  *
  * \param inter_cost    Return inter cost
  * \param inter_bitcost Return inter bitcost
@@ -2315,6 +3168,9 @@ void uvg_search_cu_inter(
   encoder_state_t * const state,
   const cu_loc_t* const cu_loc,
   lcu_t *lcu,
+  inter_motion_field_t *motion_field,
+  inter_pred_cache_t *pred_cache,
+  inter_full_search_buffer_t *full_search,
   double   *inter_cost,
   double* inter_bitcost)
 {
@@ -2330,7 +3186,7 @@ void uvg_search_cu_inter(
 
   search_pu_inter(state,
                   cu_loc, lcu, amvp,
-                  &merge, &info);
+                  &merge, &info, motion_field, pred_cache, full_search);
 
   // Early Skip CU decision
   if (merge.size == 1 && merge.unit[0].skipped) {
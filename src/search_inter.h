@@ -64,6 +64,63 @@ enum hpel_position {
   HPEL_POS_DIA = 2
 };
 
+/**
+ * \brief Best motion vectors found so far in the CTU being searched.
+ *
+ * One vector per 4x4 block and reference picture, written by every inter
+ * search in the CTU and read by later searches of overlapping blocks at
+ * other depths to decide whether to skip a reference. Entries whose
+ * generation differs from the current one belong to an earlier CTU and
+ * are treated as empty.
+ */
+typedef struct {
+  uint32_t generation;
+  uint32_t entry_generation[MAX_REF_PIC_COUNT][LCU_CU_WIDTH * LCU_CU_WIDTH];
+  mv_t mv[MAX_REF_PIC_COUNT][LCU_CU_WIDTH * LCU_CU_WIDTH][2];
+} inter_motion_field_t;
+
+#define INTER_PRED_CACHE_SIZE 24
+
+/**
+ * \brief Luma predictions of single lists made while searching
+ *        bi-prediction for one PU.
+ *
+ * Entries are keyed by reference index and motion vector, so each list
+ * prediction is interpolated once per PU no matter how many pairs it is
+ * tried in. The cache is emptied at the start of every PU.
+ */
+typedef struct {
+  struct {
+    uint8_t ref_idx;
+    mv_t mv[2];
+    unsigned im_flags; //!< 1 if the prediction is in pred.im, 0 if in pred.px
+    union {
+      uvg_pixel px[LCU_LUMA_SIZE];
+      uvg_pixel_im im[LCU_LUMA_SIZE];
+    } pred;
+  } entries[INTER_PRED_CACHE_SIZE];
+  int size; //!< number of valid entries
+  int next; //!< entry to replace when the cache is full
+} inter_pred_cache_t;
+
+// Largest search range of the full search, used by --me full64.
+#define FULL_SEARCH_MAX_RANGE 64
+// Side of the largest reference area gathered by the full search.
+#define FULL_SEARCH_MAX_AREA (2 * FULL_SEARCH_MAX_RANGE + LCU_WIDTH)
+
+/**
+ * \brief Scratch buffers of the full search window.
+ *
+ * Too large for the stack of a worker thread, so they are kept with the
+ * other per-CTU search buffers.
+ */
+typedef struct {
+  //! Reference area with the frame edges extended, if it crosses them.
+  uvg_pixel area[FULL_SEARCH_MAX_AREA * FULL_SEARCH_MAX_AREA];
+  //! Column sums over the block height of one window row.
+  uint32_t col_sums[FULL_SEARCH_MAX_AREA];
+} inter_full_search_buffer_t;
+
 typedef double uvg_mvd_cost_func(const encoder_state_t *state,
                                   int x, int y,
                                   int mv_shift,
@@ -77,6 +134,9 @@ void uvg_search_cu_inter(
   encoder_state_t * const state,
   const cu_loc_t* const cu_loc,
   lcu_t *lcu,
+  inter_motion_field_t *motion_field,
+  inter_pred_cache_t *pred_cache,
+  inter_full_search_buffer_t *full_search,
   double *inter_cost,
   double* inter_bitcost);
 
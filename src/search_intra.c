@@ -124,39 +124,48 @@ static INLINE uint8_t select_best_mode_index(const int8_t *modes, const double *
 
 
 /**
- * \brief Calculate quality of the reconstruction.
+ * \brief Calculate rough costs of up to four predictions at once.
  *
- * \param a  bc
+ * Square blocks use the fixed size quad kernels, the rest use the any size
+ * VTM SATD and uvg_reg_sad_x4.
  *
- * \return  
+ * \param num_modes  Number of valid predictions in preds, 1 to 4.
  */
-static void get_cost_dual(
+static void get_cost_quad(
   encoder_state_t * const state,
   const pred_buffer preds,
   const uvg_pixel *orig_block,
-  cost_pixel_nxn_multi_func *satd_twin_func,
-  cost_pixel_nxn_multi_func *sad_twin_func,
+  cost_pixel_nxn_multi_func *satd_quad_func,
+  cost_pixel_nxn_multi_func *sad_quad_func,
   int width,
   int height,
+  int num_modes,
   double *costs_out)
 {
-  #define PARALLEL_BLKS 2
+  #define PARALLEL_BLKS 4
+  assert(num_modes >= 1 && num_modes <= PARALLEL_BLKS);
+  // Point the unused slots at the first prediction to keep the any size
+  // kernels, which always handle four blocks, away from stale data.
+  const uvg_pixel *pred_ptrs[PARALLEL_BLKS];
+  for (int i = 0; i < PARALLEL_BLKS; ++i) {
+    pred_ptrs[i] = preds[i < num_modes ? i : 0];
+  }
+
   unsigned satd_costs[PARALLEL_BLKS] = { 0 };
-  if (satd_twin_func != NULL) {
-    satd_twin_func(preds, orig_block, PARALLEL_BLKS, satd_costs);
+  if (satd_quad_func != NULL) {
+    satd_quad_func(preds, orig_block, num_modes, satd_costs);
   } else {
-    satd_costs[0] = uvg_satd_any_size_vtm(width, height, orig_block, width, preds[0], width);
-    satd_costs[1] = uvg_satd_any_size_vtm(width, height, orig_block, width, preds[1], width);
+    uvg_satd_any_size_vtm_quad(width, height, pred_ptrs, width, orig_block, width, num_modes, satd_costs, NULL);
   }
   unsigned unsigned_sad_costs[PARALLEL_BLKS] = { 0 };
-  if (sad_twin_func != NULL) {
-    sad_twin_func(preds, orig_block, PARALLEL_BLKS, unsigned_sad_costs);
+  if (sad_quad_func != NULL) {
+    sad_quad_func(preds, orig_block, num_modes, unsigned_sad_costs);
   } else {
-    unsigned_sad_costs[0] = uvg_reg_sad(preds[0], orig_block, width, height, width, width);
-    unsigned_sad_costs[1] = uvg_reg_sad(preds[1], orig_block, width, height, width, width);
+    uvg_reg_sad_x4(orig_block, pred_ptrs, width, height, width, width, unsigned_sad_costs);
+  }
+  for (int i = 0; i < num_modes; ++i) {
+    costs_out[i] = (double)MIN(satd_costs[i], unsigned_sad_costs[i] * 2);
   }
-  costs_out[0] = (double)MIN(satd_costs[0], unsigned_sad_costs[0] * 2);
-  costs_out[1] = (double)MIN(satd_costs[1], unsigned_sad_costs[1] * 2);
 
   // TODO: width and height
   //if (TRSKIP_RATIO != 0 && width <= (1 << state->encoder_control->cfg.trskip_max_size) && state->encoder_control->cfg.trskip_enable) {
@@ -177,10 +186,8 @@ static void get_cost_dual(
   //  }
   //  
 
-  //  unsigned unsigned_sad_costs[PARALLEL_BLKS] = { 0 };
   //  double sad_costs[PARALLEL_BLKS] = { 0 };
-  //  sad_twin_func(preds, orig_block, PARALLEL_BLKS, unsigned_sad_costs);
-  //  for (int i = 0; i < PARALLEL_BLKS; ++i) {
+  //  for (int i = 0; i < num_modes; ++i) {
   //    sad_costs[i] = TRSKIP_RATIO * (double)unsigned_sad_costs[i] + state->lambda_sqrt * trskip_bits;
   //    if (sad_costs[i] < (double)satd_costs[i]) {
   //      costs_out[i] = sad_costs[i];
@@ -996,12 +1003,14 @@ static uint8_t search_intra_rough(
   cu_info_t* const pred_cu,
   uint8_t mip_ctx)
 {
-  #define PARALLEL_BLKS 2 // TODO: use 4 for AVX-512 in the future?
+  #define PARALLEL_BLKS 4
+  // Number of predictions generated from one build of the references.
+  #define PRED_BATCH (4 * PARALLEL_BLKS)
   assert(width >= 4 && width <= 32);
   // cost_pixel_nxn_func *satd_func = kvz_pixels_get_satd_func(width);
   // cost_pixel_nxn_func *sad_func = kvz_pixels_get_sad_func(width);
-  cost_pixel_nxn_multi_func *satd_dual_func = uvg_pixels_get_satd_dual_func(width, height);
-  cost_pixel_nxn_multi_func *sad_dual_func = uvg_pixels_get_sad_dual_func(width, height);
+  cost_pixel_nxn_multi_func *satd_quad_func = uvg_pixels_get_satd_quad_func(width, height);
+  cost_pixel_nxn_multi_func *sad_quad_func = uvg_pixels_get_sad_quad_func(width, height);
   bool mode_checked[UVG_NUM_INTRA_MODES] = {0};
   double costs[UVG_NUM_INTRA_MODES];
 
@@ -1009,8 +1018,12 @@ static uint8_t search_intra_rough(
   // const bool filter_boundary = !(cfg->lossless && cfg->implicit_rdpcm);
 
   // Temporary block arrays
-  uvg_pixel _preds[PARALLEL_BLKS * 32 * 32 + SIMD_ALIGNMENT];
+  uvg_pixel _preds[PRED_BATCH * 32 * 32 + SIMD_ALIGNMENT];
   pred_buffer preds = ALIGNED_POINTER(_preds, SIMD_ALIGNMENT);
+  uvg_pixel *pred_ptrs[PRED_BATCH];
+  for (int i = 0; i < PRED_BATCH; ++i) {
+    pred_ptrs[i] = preds[i];
+  }
   
   uvg_pixel _orig_block[32 * 32 + SIMD_ALIGNMENT];
   uvg_pixel *orig_block = ALIGNED_POINTER(_orig_block, SIMD_ALIGNMENT);
@@ -1019,7 +1032,7 @@ static uint8_t search_intra_rough(
   uvg_pixels_blit(orig, orig_block, width, height, origstride, width);
 
   int8_t modes_selected = 0;
-  // Note: get_cost and get_cost_dual may return negative costs.
+  // Note: get_cost and get_cost_quad may return negative costs.
   double min_cost;
   double max_cost;
 
@@ -1052,7 +1065,7 @@ static uint8_t search_intra_rough(
   uvg_intra_predict(state, refs, cu_loc, cu_loc, COLOR_Y, preds[0], &search_proxy, NULL);
   search_proxy.pred_cu.intra.mode = 1;
   uvg_intra_predict(state, refs, cu_loc, cu_loc, COLOR_Y, preds[1], &search_proxy, NULL);
-  get_cost_dual(state, preds, orig_block, satd_dual_func, sad_dual_func, width, height, costs);
+  get_cost_quad(state, preds, orig_block, satd_quad_func, sad_quad_func, width, height, 2, costs);
   mode_checked[0] = true;
   mode_checked[1] = true;
   costs[0] += count_bits(
@@ -1095,21 +1108,23 @@ static uint8_t search_intra_rough(
   best_six_modes[3].cost = MAX_DOUBLE;
   best_six_modes[4].cost = MAX_DOUBLE;
   best_six_modes[5].cost = MAX_DOUBLE;
-  for (int mode = 2 + offset / 2; mode <= 66; mode += PARALLEL_BLKS * offset) {
-    
-    double costs_out[PARALLEL_BLKS] = { 0 };
-    for (int i = 0; i < PARALLEL_BLKS; ++i) {
-      if (mode + i * offset <= 66) {
-        search_proxy.pred_cu.intra.mode = mode + i*offset;
-        uvg_intra_predict(state, refs, cu_loc, cu_loc, COLOR_Y, preds[i], &search_proxy, NULL);
-      }
-    }
-    
-    //TODO: add generic version of get cost  multi
-    get_cost_dual(state, preds, orig_block, satd_dual_func, sad_dual_func, width, height, costs_out);
-    for (int i = 0; i < PARALLEL_BLKS; ++i) {
-      if (mode + i * offset <= 66) {
-        costs_out[i] += count_bits(
+  int8_t coarse_modes[UVG_NUM_INTRA_MODES];
+  int num_coarse_modes = 0;
+  for (int mode = 2 + offset / 2; mode <= 66; mode += offset) {
+    coarse_modes[num_coarse_modes++] = mode;
+  }
+  for (int batch = 0; batch < num_coarse_modes; batch += PRED_BATCH) {
+    const int num_preds = MIN(PRED_BATCH, num_coarse_modes - batch);
+    uvg_intra_predict_multi(state, refs, cu_loc, &search_proxy, &coarse_modes[batch], num_preds, pred_ptrs);
+
+    for (int pred = 0; pred < num_preds; pred += PARALLEL_BLKS) {
+      double costs_out[PARALLEL_BLKS] = { 0 };
+      const int num_blocks = MIN(PARALLEL_BLKS, num_preds - pred);
+      get_cost_quad(state, preds + pred, orig_block, satd_quad_func, sad_quad_func, width, height, num_blocks, costs_out);
+
+      for (int i = 0; i < num_blocks; ++i) {
+        const int8_t mode_i = coarse_modes[batch + pred + i];
+        costs[mode_i] = costs_out[i] + count_bits(
           state,
           intra_preds,
           not_mrl,
@@ -1118,14 +1133,7 @@ static uint8_t search_intra_rough(
           not_mpm_mode_bit,
           planar_mode_flag,
           not_planar_mode_flag,
-          not_isp_flag, mode + i * offset) * state->lambda_sqrt;
-      }
-    }
-
-    for (int i = 0; i < PARALLEL_BLKS; ++i) {
-      int8_t mode_i = mode + i* offset;
-      if (mode_i <= 66) {
-        costs[mode_i] = costs_out[i];
+          not_isp_flag, mode_i) * state->lambda_sqrt;
         mode_checked[mode_i] = true;
         min_cost = MIN(min_cost, costs[mode_i]);
         max_cost = MAX(max_cost, costs[mode_i]);
@@ -1165,38 +1173,25 @@ static uint8_t search_intra_rough(
           }
         }
       }
-      while (num_modes_to_check & (PARALLEL_BLKS - 1)) {
-        modes_to_check[num_modes_to_check++] = 1;
-      } 
-      for (int i = 0; i < num_modes_to_check; i += PARALLEL_BLKS) {
-        double costs_out[PARALLEL_BLKS] = { 0 };        
-      
-        for (int block = 0; block < PARALLEL_BLKS; ++block) {
-          search_proxy.pred_cu.intra.mode = modes_to_check[block + i];
-          uvg_intra_predict(state, refs, cu_loc, cu_loc, COLOR_Y, preds[block], &search_proxy, NULL);
-        
-        }
+      uvg_intra_predict_multi(state, refs, cu_loc, &search_proxy, modes_to_check, num_modes_to_check, pred_ptrs);
 
-        //TODO: add generic version of get cost multi
-        get_cost_dual(state, preds, orig_block, satd_dual_func, sad_dual_func, width, height, costs_out);
-        for (int block = 0; block < PARALLEL_BLKS; ++block) {
-            costs_out[block] += count_bits(
-              state,
-              intra_preds,
-              not_mrl,
-              not_mip,
-              mpm_mode_bit,
-              not_mpm_mode_bit,
-              planar_mode_flag,
-              not_planar_mode_flag,
-              not_isp_flag, modes_to_check[block + i]) * state->lambda_sqrt;
-          
-        }
+      for (int i = 0; i < num_modes_to_check; i += PARALLEL_BLKS) {
+        double costs_out[PARALLEL_BLKS] = { 0 };
+        const int num_blocks = MIN(PARALLEL_BLKS, num_modes_to_check - i);
 
-        for (int block = 0; block < PARALLEL_BLKS; ++block) {
+        get_cost_quad(state, preds + i, orig_block, satd_quad_func, sad_quad_func, width, height, num_blocks, costs_out);
+        for (int block = 0; block < num_blocks; ++block) {
           int8_t mode = modes_to_check[i + block];
-          if (mode == 1) continue;
-          costs[mode] = costs_out[block];
+          costs[mode] = costs_out[block] + count_bits(
+            state,
+            intra_preds,
+            not_mrl,
+            not_mip,
+            mpm_mode_bit,
+            not_mpm_mode_bit,
+            planar_mode_flag,
+            not_planar_mode_flag,
+            not_isp_flag, mode) * state->lambda_sqrt;
           for (int j = 0; j < mode_list_size; j++) {
             if (costs[mode] < best_six_modes[j].cost) {
               for (int k = mode_list_size - 1; k > j; k--) {
@@ -1206,8 +1201,7 @@ static uint8_t search_intra_rough(
               best_six_modes[j].mode = mode;
               break;
             }
-          }          
-          
+          }
         }
       }
     }
@@ -1224,6 +1218,7 @@ static uint8_t search_intra_rough(
 
   }
   
+  #undef PRED_BATCH
   #undef PARALLEL_BLKS
   return mode_list_size;
 }
@@ -1239,14 +1234,14 @@ static void get_rough_cost_for_2n_modes(
   int num_modes,
   uint8_t mip_ctx)
 {
-#define PARALLEL_BLKS 2
+#define PARALLEL_BLKS 4
   assert(num_modes % 2 == 0 && "passing odd number of modes to get_rough_cost_for_2n_modes");
   const int width = cu_loc->width;
   const int height = cu_loc->height;
-  cost_pixel_nxn_multi_func* satd_dual_func;
-  cost_pixel_nxn_multi_func* sad_dual_func;
-  satd_dual_func = uvg_pixels_get_satd_dual_func(width, height);
-  sad_dual_func = uvg_pixels_get_sad_dual_func(width, height);
+  cost_pixel_nxn_multi_func* satd_quad_func;
+  cost_pixel_nxn_multi_func* sad_quad_func;
+  satd_quad_func = uvg_pixels_get_satd_quad_func(width, height);
+  sad_quad_func = uvg_pixels_get_sad_quad_func(width, height);
 
 
   uvg_pixel _preds[PARALLEL_BLKS * MIN(LCU_WIDTH, 64)* MIN(LCU_WIDTH, 64)+ SIMD_ALIGNMENT];
@@ -1263,12 +1258,30 @@ static void get_rough_cost_for_2n_modes(
   double costs_out[PARALLEL_BLKS] = { 0 };
   double bits[PARALLEL_BLKS] = { 0 };
   for(int mode = 0; mode < num_modes; mode += PARALLEL_BLKS) {
-    for (int i = 0; i < PARALLEL_BLKS; ++i) {
-      uvg_intra_predict(state, &refs[search_data[mode + i].pred_cu.intra.multi_ref_idx], cu_loc, cu_loc, COLOR_Y, preds[i], &search_data[mode + i], NULL);
+    const int num_blocks = MIN(PARALLEL_BLKS, num_modes - mode);
+    if (search_data[mode].pred_cu.intra.mip_flag) {
+      for (int i = 0; i < num_blocks; ++i) {
+        uvg_intra_predict(state, &refs[search_data[mode + i].pred_cu.intra.multi_ref_idx], cu_loc, cu_loc, COLOR_Y, preds[i], &search_data[mode + i], NULL);
+      }
     }
-    get_cost_dual(state, preds, orig_block, satd_dual_func, sad_dual_func, width, height, costs_out);
+    else {
+      // MRL modes are stored line by line, predict each run of modes using
+      // the same reference line with one call.
+      for (int i = 0; i < num_blocks; ) {
+        const int first = i;
+        const uint8_t multi_ref_idx = search_data[mode + first].pred_cu.intra.multi_ref_idx;
+        int8_t line_modes[PARALLEL_BLKS];
+        uvg_pixel *line_preds[PARALLEL_BLKS];
+        for (; i < num_blocks && search_data[mode + i].pred_cu.intra.multi_ref_idx == multi_ref_idx; ++i) {
+          line_modes[i - first] = search_data[mode + i].pred_cu.intra.mode;
+          line_preds[i - first] = preds[i];
+        }
+        uvg_intra_predict_multi(state, &refs[multi_ref_idx], cu_loc, &search_data[mode + first], line_modes, i - first, line_preds);
+      }
+    }
+    get_cost_quad(state, preds, orig_block, satd_quad_func, sad_quad_func, width, height, num_blocks, costs_out);
 
-    for(int i = 0; i < PARALLEL_BLKS; ++i) {
+    for(int i = 0; i < num_blocks; ++i) {
       uint8_t multi_ref_idx = search_data[mode + i].pred_cu.intra.multi_ref_idx;
       if(multi_ref_idx) {
         bits[i] = mrl + not_mip;
@@ -1283,11 +1296,9 @@ static void get_rough_cost_for_2n_modes(
         assert(0 && "get_rough_cost_for_2n_modes supports only mrl and mip mode cost calculation");
       }
     }
-    search_data[mode].cost = costs_out[0];
-    search_data[mode + 1].cost = costs_out[1];
-
-    search_data[mode].cost += bits[0] * state->lambda_sqrt;
-    search_data[mode + 1].cost += bits[1] * state->lambda_sqrt;
+    for (int i = 0; i < num_blocks; ++i) {
+      search_data[mode + i].cost = costs_out[i] + bits[i] * state->lambda_sqrt;
+    }
   }
 #undef PARALLEL_BLKS
 }
@@ -43,6 +43,8 @@
 
 #include "strategyselector.h"
 
+extern uvg_pixel uvg_fast_clip_32bit_to_pixel(int32_t value);
+
 #define ALF_CLIP_AND_ADD(VAL0,VAL1) __m128i clips = _mm_loadl_epi64((__m128i*) clip); \
 __m128i neg_clips = _mm_sign_epi16(clips, negate); \
 __m128i val0 = _mm_set1_epi16((VAL0 - curr));\
@@ -298,6 +300,759 @@ static void alf_get_blk_stats_avx2(encoder_state_t* const state,
   }
 }
 
+static void alf_derive_classification_blk_avx2(encoder_state_t * const state,
+  const int shift,
+  const int n_height,
+  const int n_width,
+  const int blk_pos_x,
+  const int blk_pos_y,
+  const int blk_dst_x,
+  const int blk_dst_y,
+  const int vb_ctu_height,
+  int vb_pos)
+{
+  videoframe_t* const frame = state->tile->frame;
+  const size_t img_stride = frame->rec->stride;
+  const uvg_pixel* src_ext = frame->rec->y;
+
+  const int img_h_extended = n_height + 4;
+  const int img_w_extended = n_width + 4;
+
+  // 18x48 array. Sums are written 16 columns at a time, so the rows are
+  // padded to a multiple of 16.
+  uint16_t col_sums[(CLASSIFICATION_BLK_SIZE + 4) >> 1]
+                   [CLASSIFICATION_BLK_SIZE + 16];
+
+  const __m256i swap_pairs = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                                              2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+
+  for (int i = 0; i < img_h_extended; i += 2)
+  {
+    const size_t offset = (i + blk_pos_y - 3) * img_stride + blk_pos_x - 3;
+
+    const uvg_pixel* img_y0 = &src_ext[offset];
+    const uvg_pixel* img_y1 = &src_ext[offset + img_stride];
+    const uvg_pixel* img_y2 = &src_ext[offset + img_stride * 2];
+    const uvg_pixel* img_y3 = &src_ext[offset + img_stride * 3];
+
+    // pixel padding for gradient calculation
+    int pos = blk_dst_y - 2 + i;
+    int pos_in_ctu = pos & (vb_ctu_height - 1);
+    if (pos > 0 && pos_in_ctu == vb_pos - 2)
+    {
+      img_y3 = img_y2;
+    }
+    else if (pos > 0 && pos_in_ctu == vb_pos)
+    {
+      img_y0 = img_y1;
+    }
+
+    __m256i prev = _mm256_setzero_si256();
+
+    // Each 128-bit lane does what one iteration of the sse41 loop does.
+    for (int j = 0; j < img_w_extended; j += 16)
+    {
+      const __m256i x0 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) (img_y0 + j)));
+      const __m256i x1 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) (img_y1 + j)));
+      const __m256i x2 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) (img_y2 + j)));
+      const __m256i x3 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) (img_y3 + j)));
+
+      const __m256i x4 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) (img_y0 + j + 2)));
+      const __m256i x5 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) (img_y1 + j + 2)));
+      const __m256i x6 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) (img_y2 + j + 2)));
+      const __m256i x7 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) (img_y3 + j + 2)));
+
+      const __m256i nw = _mm256_blend_epi16(x0, x1, 0xaa);
+      const __m256i n = _mm256_blend_epi16(x0, x5, 0x55);
+      const __m256i ne = _mm256_blend_epi16(x4, x5, 0xaa);
+      const __m256i w = _mm256_blend_epi16(x1, x2, 0xaa);
+      const __m256i e = _mm256_blend_epi16(x5, x6, 0xaa);
+      const __m256i sw = _mm256_blend_epi16(x2, x3, 0xaa);
+      const __m256i s = _mm256_blend_epi16(x2, x7, 0x55);
+      const __m256i se = _mm256_blend_epi16(x6, x7, 0xaa);
+
+      __m256i c = _mm256_blend_epi16(x1, x6, 0x55);
+      c = _mm256_add_epi16(c, c);
+      __m256i d = _mm256_shuffle_epi8(c, swap_pairs);
+
+      const __m256i ver = _mm256_abs_epi16(_mm256_sub_epi16(c, _mm256_add_epi16(n, s)));
+      const __m256i hor = _mm256_abs_epi16(_mm256_sub_epi16(d, _mm256_add_epi16(w, e)));
+      const __m256i di0 = _mm256_abs_epi16(_mm256_sub_epi16(d, _mm256_add_epi16(nw, se)));
+      const __m256i di1 = _mm256_abs_epi16(_mm256_sub_epi16(d, _mm256_add_epi16(ne, sw)));
+
+      const __m256i hv = _mm256_hadd_epi16(ver, hor);
+      const __m256i di = _mm256_hadd_epi16(di0, di1);
+      const __m256i all = _mm256_hadd_epi16(hv, di);
+
+      // The previous 8 columns are in the upper lane of the last iteration
+      // for the lower lane and in the lower lane of this one for the upper.
+      const __m256i prev_all = _mm256_permute2x128_si256(all, prev, 0x03);
+      const __m256i t = _mm256_blend_epi16(all, prev_all, 0xaa);
+      _mm256_storeu_si256((__m256i*) & col_sums[i >> 1][j], _mm256_hadd_epi16(t, all));
+      prev = all;
+    }
+  }
+
+  const __m256i th = _mm256_setr_epi8(0, 1, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 4,
+                                      0, 1, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 4);
+  const __m256i class_shuffle = _mm256_setr_epi8(0, 1, 0, 1, 0, 1, 0, 1, 8, 9, 8, 9, 8, 9, 8, 9,
+                                                 0, 1, 0, 1, 0, 1, 0, 1, 8, 9, 8, 9, 8, 9, 8, 9);
+  alf_classifier** classifier = state->tile->frame->alf_info->classifier;
+
+  for (int i = 0; i < (n_height >> 1); i += 4)
+  {
+    const int z = (2 * i + blk_dst_y) & (vb_ctu_height - 1);
+    const int z2 = (2 * i + 4 + blk_dst_y) & (vb_ctu_height - 1);
+
+    const int32_t scale = (z == vb_pos - 4 || z == vb_pos) ? 96 : 64;
+    const int32_t scale2 = (z2 == vb_pos - 4 || z2 == vb_pos) ? 96 : 64;
+    const __m256i scales = _mm256_setr_epi32(scale, scale, scale2, scale2, scale, scale, scale2, scale2);
+
+    for (int j = 0; j < n_width; j += 16)
+    {
+      __m256i x0, x1, x2, x3, x4, x5, x6, x7;
+
+      x0 = (z == vb_pos) ? _mm256_setzero_si256() : _mm256_loadu_si256((__m256i *) &col_sums[i + 0][j + 4]);
+      x1 = _mm256_loadu_si256((__m256i *) &col_sums[i + 1][j + 4]);
+      x2 = _mm256_loadu_si256((__m256i *) &col_sums[i + 2][j + 4]);
+      x3 = (z == vb_pos - 4) ? _mm256_setzero_si256() : _mm256_loadu_si256((__m256i *) &col_sums[i + 3][j + 4]);
+
+      x4 = (z2 == vb_pos) ? _mm256_setzero_si256() : _mm256_loadu_si256((__m256i *) &col_sums[i + 2][j + 4]);
+      x5 = _mm256_loadu_si256((__m256i *) &col_sums[i + 3][j + 4]);
+      x6 = _mm256_loadu_si256((__m256i *) &col_sums[i + 4][j + 4]);
+      x7 = (z2 == vb_pos - 4) ? _mm256_setzero_si256() : _mm256_loadu_si256((__m256i *) &col_sums[i + 5][j + 4]);
+
+      __m256i x0l = _mm256_unpacklo_epi16(x0, _mm256_setzero_si256());
+      __m256i x0h = _mm256_unpackhi_epi16(x0, _mm256_setzero_si256());
+      __m256i x1l = _mm256_unpacklo_epi16(x1, _mm256_setzero_si256());
+      __m256i x1h = _mm256_unpackhi_epi16(x1, _mm256_setzero_si256());
+      __m256i x2l = _mm256_unpacklo_epi16(x2, _mm256_setzero_si256());
+      __m256i x2h = _mm256_unpackhi_epi16(x2, _mm256_setzero_si256());
+      __m256i x3l = _mm256_unpacklo_epi16(x3, _mm256_setzero_si256());
+      __m256i x3h = _mm256_unpackhi_epi16(x3, _mm256_setzero_si256());
+      __m256i x4l = _mm256_unpacklo_epi16(x4, _mm256_setzero_si256());
+      __m256i x4h = _mm256_unpackhi_epi16(x4, _mm256_setzero_si256());
+      __m256i x5l = _mm256_unpacklo_epi16(x5, _mm256_setzero_si256());
+      __m256i x5h = _mm256_unpackhi_epi16(x5, _mm256_setzero_si256());
+      __m256i x6l = _mm256_unpacklo_epi16(x6, _mm256_setzero_si256());
+      __m256i x6h = _mm256_unpackhi_epi16(x6, _mm256_setzero_si256());
+      __m256i x7l = _mm256_unpacklo_epi16(x7, _mm256_setzero_si256());
+      __m256i x7h = _mm256_unpackhi_epi16(x7, _mm256_setzero_si256());
+
+      x0l = _mm256_add_epi32(x0l, x1l);
+      x2l = _mm256_add_epi32(x2l, x3l);
+      x4l = _mm256_add_epi32(x4l, x5l);
+      x6l = _mm256_add_epi32(x6l, x7l);
+      x0h = _mm256_add_epi32(x0h, x1h);
+      x2h = _mm256_add_epi32(x2h, x3h);
+      x4h = _mm256_add_epi32(x4h, x5h);
+      x6h = _mm256_add_epi32(x6h, x7h);
+
+      x0l = _mm256_add_epi32(x0l, x2l);
+      x4l = _mm256_add_epi32(x4l, x6l);
+      x0h = _mm256_add_epi32(x0h, x2h);
+      x4h = _mm256_add_epi32(x4h, x6h);
+
+      x2l = _mm256_unpacklo_epi32(x0l, x4l);
+      x2h = _mm256_unpackhi_epi32(x0l, x4l);
+      x6l = _mm256_unpacklo_epi32(x0h, x4h);
+      x6h = _mm256_unpackhi_epi32(x0h, x4h);
+
+      __m256i sum_v  = _mm256_unpacklo_epi32(x2l, x6l);
+      __m256i sum_h  = _mm256_unpackhi_epi32(x2l, x6l);
+      __m256i sum_d0 = _mm256_unpacklo_epi32(x2h, x6h);
+      __m256i sum_d1 = _mm256_unpackhi_epi32(x2h, x6h);
+
+      __m256i temp_act = _mm256_add_epi32(sum_v, sum_h);
+
+      __m256i activity = _mm256_mullo_epi32(temp_act, scales);
+      activity = _mm256_srl_epi32(activity, _mm_cvtsi32_si128(shift));
+      activity = _mm256_min_epi32(activity, _mm256_set1_epi32(15));
+      __m256i class_idx = _mm256_shuffle_epi8(th, activity);
+
+      __m256i dir_temp_hv_minus1 = _mm256_cmpgt_epi32(sum_v, sum_h);
+      __m256i hv1 = _mm256_max_epi32(sum_v, sum_h);
+      __m256i hv0 = _mm256_min_epi32(sum_v, sum_h);
+
+      __m256i dir_temp_d_minus1 = _mm256_cmpgt_epi32(sum_d0, sum_d1);
+      __m256i d1 = _mm256_max_epi32(sum_d0, sum_d1);
+      __m256i d0 = _mm256_min_epi32(sum_d0, sum_d1);
+
+      __m256i a = _mm256_xor_si256(_mm256_mullo_epi32(d1, hv0), _mm256_set1_epi32(0x80000000));
+      __m256i b = _mm256_xor_si256(_mm256_mullo_epi32(hv1, d0), _mm256_set1_epi32(0x80000000));
+      __m256i dir_idx = _mm256_cmpgt_epi32(a, b);
+      __m256i hvd1 = _mm256_blendv_epi8(hv1, d1, dir_idx);
+      __m256i hvd0 = _mm256_blendv_epi8(hv0, d0, dir_idx);
+
+      __m256i strength1 = _mm256_cmpgt_epi32(hvd1, _mm256_add_epi32(hvd0, hvd0));
+      __m256i strength2 = _mm256_cmpgt_epi32(_mm256_add_epi32(hvd1, hvd1), _mm256_add_epi32(hvd0, _mm256_slli_epi32(hvd0, 3)));
+      __m256i offset = _mm256_and_si256(strength1, _mm256_set1_epi32(5));
+      class_idx = _mm256_add_epi32(class_idx, offset);
+      class_idx = _mm256_add_epi32(class_idx, _mm256_and_si256(strength2, _mm256_set1_epi32(5)));
+      offset = _mm256_andnot_si256(dir_idx, offset);
+      offset = _mm256_add_epi32(offset, offset);
+      class_idx = _mm256_add_epi32(class_idx, offset);
+
+      __m256i transpose_idx = _mm256_set1_epi32(3);
+      transpose_idx = _mm256_add_epi32(transpose_idx, dir_temp_hv_minus1);
+      transpose_idx = _mm256_add_epi32(transpose_idx, dir_temp_d_minus1);
+      transpose_idx = _mm256_add_epi32(transpose_idx, dir_temp_d_minus1);
+
+      int y_offset = 2 * i + blk_dst_y;
+      int x_offset = j + blk_dst_x;
+
+      static_assert(sizeof(alf_classifier) == 2, "alf_classifier type must be 16 bits wide");
+      __m256i v_lo = _mm256_shuffle_epi8(_mm256_unpacklo_epi8(class_idx, transpose_idx), class_shuffle);
+      __m256i v_hi = _mm256_shuffle_epi8(_mm256_unpackhi_epi8(class_idx, transpose_idx), class_shuffle);
+      if (j + 16 <= n_width) {
+        for (int k = 0; k < 4; ++k) {
+          _mm256_storeu_si256((__m256i *) (classifier[y_offset + k] + x_offset), v_lo);
+          _mm256_storeu_si256((__m256i *) (classifier[y_offset + 4 + k] + x_offset), v_hi);
+        }
+      }
+      else {
+        for (int k = 0; k < 4; ++k) {
+          _mm_storeu_si128((__m128i *) (classifier[y_offset + k] + x_offset), _mm256_castsi256_si128(v_lo));
+          _mm_storeu_si128((__m128i *) (classifier[y_offset + 4 + k] + x_offset), _mm256_castsi256_si128(v_hi));
+        }
+      }
+    }
+  }
+}
+
+
+/**
+ * \brief Store the first width pixels of a 16 pixel row, width being a
+ *        multiple of 4.
+ */
+static INLINE void store_alf_row_avx2(uvg_pixel* dst, __m256i pixels_epi16, const int width)
+{
+  __m256i packed = _mm256_packus_epi16(pixels_epi16, pixels_epi16);
+  __m128i row = _mm256_castsi256_si128(_mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+  if (width >= 16) {
+    _mm_storeu_si128((__m128i*)dst, row);
+    return;
+  }
+  if (width & 8) {
+    _mm_storel_epi64((__m128i*)dst, row);
+    row = _mm_srli_si128(row, 8);
+    dst += 8;
+  }
+  if (width & 4) {
+    *(int32_t*)dst = _mm_cvtsi128_si32(row);
+  }
+}
+
+
+INLINE static void process2coeffs_5x5_avx2(__m256i params[2][3], __m256i *cur, __m256i *accum_a, __m256i *accum_b, const int i, const uvg_pixel* ptr0, const uvg_pixel* ptr1, const uvg_pixel* ptr2, const uvg_pixel* ptr3)
+{
+  const __m256i val00 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) ptr0)), *cur);
+  const __m256i val10 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) ptr2)), *cur);
+  const __m256i val01 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) ptr1)), *cur);
+  const __m256i val11 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) ptr3)), *cur);
+  __m256i val01a = _mm256_unpacklo_epi16(val00, val10);
+  __m256i val01b = _mm256_unpackhi_epi16(val00, val10);
+  __m256i val01c = _mm256_unpacklo_epi16(val01, val11);
+  __m256i val01d = _mm256_unpackhi_epi16(val01, val11);
+
+  __m256i limit = params[1][i];
+
+  val01a = _mm256_min_epi16(val01a, limit);
+  val01b = _mm256_min_epi16(val01b, limit);
+  val01c = _mm256_min_epi16(val01c, limit);
+  val01d = _mm256_min_epi16(val01d, limit);
+
+  limit = _mm256_sub_epi16(_mm256_setzero_si256(), limit);
+
+  val01a = _mm256_max_epi16(val01a, limit);
+  val01b = _mm256_max_epi16(val01b, limit);
+  val01c = _mm256_max_epi16(val01c, limit);
+  val01d = _mm256_max_epi16(val01d, limit);
+
+  val01a = _mm256_add_epi16(val01a, val01c);
+  val01b = _mm256_add_epi16(val01b, val01d);
+
+  const __m256i coeff = params[0][i];
+
+  *accum_a = _mm256_add_epi32(*accum_a, _mm256_madd_epi16(val01a, coeff));
+  *accum_b = _mm256_add_epi32(*accum_b, _mm256_madd_epi16(val01b, coeff));
+}
+
+
+static void alf_filter_5x5_block_avx2(encoder_state_t* const state,
+  const uvg_pixel* src_pixels,
+  uvg_pixel* dst_pixels,
+  const int src_stride,
+  const int dst_stride,
+  const short* filter_set,
+  const int16_t* fClipSet,
+  clp_rng clp_rng,
+  const int width,
+  const int height,
+  int x_pos,
+  int y_pos,
+  int blk_dst_x,
+  int blk_dst_y,
+  int vb_pos,
+  const int vb_ctu_height)
+{
+  assert((vb_ctu_height & (vb_ctu_height - 1)) == 0 && "vb_ctu_height must be a power of 2");
+
+  const int shift = state->encoder_control->bitdepth - 1;
+  const int round = 1 << (shift - 1);
+
+  const int step_x = 16;
+  const int step_y = 4;
+
+  assert(y_pos % step_y == 0 && "Wrong startHeight in filtering");
+  assert(height % step_y == 0 && "Wrong endHeight in filtering");
+  assert(width % 4 == 0 && "Wrong endWidth in filtering");
+
+  const uvg_pixel* src = src_pixels + y_pos * src_stride + x_pos;
+  uvg_pixel* dst = dst_pixels + blk_dst_y * dst_stride + blk_dst_x;
+
+  const __m256i offset = _mm256_set1_epi32(round);
+  const __m256i offset_vb = _mm256_set1_epi32((1 << ((shift + 3) - 1)) - round);
+  const __m256i min_val = _mm256_set1_epi16(clp_rng.min);
+  const __m256i max_val = _mm256_set1_epi16(clp_rng.max);
+
+  // The chroma filter is the same for every pixel.
+  __m256i params[2][3];
+  const __m256i fs = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) filter_set));
+  params[0][0] = _mm256_shuffle_epi32(fs, 0x00);
+  params[0][1] = _mm256_shuffle_epi32(fs, 0x55);
+  params[0][2] = _mm256_shuffle_epi32(fs, 0xaa);
+  const __m256i fc = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) fClipSet));
+  params[1][0] = _mm256_shuffle_epi32(fc, 0x00);
+  params[1][1] = _mm256_shuffle_epi32(fc, 0x55);
+  params[1][2] = _mm256_shuffle_epi32(fc, 0xaa);
+
+  for (int i = 0; i < height; i += step_y)
+  {
+    for (int j = 0; j < width; j += step_x)
+    {
+      for (int ii = 0; ii < step_y; ii++)
+      {
+        const uvg_pixel* img0, * img1, * img2, * img3, * img4;
+
+        img0 = src + j + ii * src_stride;
+        img1 = img0 + src_stride;
+        img2 = img0 - src_stride;
+        img3 = img1 + src_stride;
+        img4 = img2 - src_stride;
+
+        const int y_vb = (blk_dst_y + i + ii) & (vb_ctu_height - 1);
+        if (y_vb < vb_pos && (y_vb >= vb_pos - 2))   // above
+        {
+          img1 = (y_vb == vb_pos - 1) ? img0 : img1;
+          img3 = (y_vb >= vb_pos - 2) ? img1 : img3;
+
+          img2 = (y_vb == vb_pos - 1) ? img0 : img2;
+          img4 = (y_vb >= vb_pos - 2) ? img2 : img4;
+        }
+        else if (y_vb >= vb_pos && (y_vb <= vb_pos + 1))   // bottom
+        {
+          img2 = (y_vb == vb_pos) ? img0 : img2;
+          img4 = (y_vb <= vb_pos + 1) ? img2 : img4;
+
+          img1 = (y_vb == vb_pos) ? img0 : img1;
+          img3 = (y_vb <= vb_pos + 1) ? img1 : img3;
+        }
+        __m256i cur = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) img0));
+
+        __m256i accum_a = offset;
+        __m256i accum_b = offset;
+
+        process2coeffs_5x5_avx2(params, &cur, &accum_a, &accum_b, 0, img3 + 0, img4 + 0, img1 + 1, img2 - 1);
+        process2coeffs_5x5_avx2(params, &cur, &accum_a, &accum_b, 1, img1 + 0, img2 + 0, img1 - 1, img2 + 1);
+        process2coeffs_5x5_avx2(params, &cur, &accum_a, &accum_b, 2, img0 + 2, img0 - 2, img0 + 1, img0 - 1);
+
+        bool is_near_vb_above = y_vb < vb_pos && (y_vb >= vb_pos - 1);
+        bool is_near_vb_below = y_vb >= vb_pos && (y_vb <= vb_pos);
+        if (!(is_near_vb_above || is_near_vb_below))
+        {
+          accum_a = _mm256_srai_epi32(accum_a, shift);
+          accum_b = _mm256_srai_epi32(accum_b, shift);
+        }
+        else
+        {
+          accum_a = _mm256_srai_epi32(_mm256_add_epi32(accum_a, offset_vb), shift + 3);
+          accum_b = _mm256_srai_epi32(_mm256_add_epi32(accum_b, offset_vb), shift + 3);
+        }
+        accum_a = _mm256_packs_epi32(accum_a, accum_b);
+        accum_a = _mm256_add_epi16(accum_a, cur);
+        accum_a = _mm256_min_epi16(max_val, _mm256_max_epi16(accum_a, min_val));
+
+        store_alf_row_avx2(dst + ii * dst_stride + j, accum_a, width - j);
+      }
+    }
+
+    src += src_stride * step_y;
+    dst += dst_stride * step_y;
+  }
+}
+
+
+#define sh(x) 0x0202 * (x & 7) + 0x0100 + 0x1010 * (x & 8)
+
+static const uint16_t shuffle_tab[4][2][8] = {
+  {
+    { sh(0), sh(1), sh(2), sh(3), sh(4), sh(5), sh(6), sh(7) },
+    { sh(8), sh(9), sh(10), sh(11), sh(12), sh(13), sh(14), sh(15) },
+  },
+  {
+    { sh(9), sh(4), sh(10), sh(8), sh(1), sh(5), sh(11), sh(7) },
+    { sh(3), sh(0), sh(2), sh(6), sh(12), sh(13), sh(14), sh(15) },
+  },
+  {
+    { sh(0), sh(3), sh(2), sh(1), sh(8), sh(7), sh(6), sh(5) },
+    { sh(4), sh(9), sh(10), sh(11), sh(12), sh(13), sh(14), sh(15) },
+  },
+  {
+    { sh(9), sh(8), sh(10), sh(4), sh(3), sh(7), sh(11), sh(5) },
+    { sh(1), sh(0), sh(2), sh(6), sh(12), sh(13), sh(14), sh(15) },
+  },
+};
+
+#undef sh
+
+
+/**
+ * \brief Load the transposed coefficients and clipping values of the class
+ *        of a 4x4 block. The first 8 of the 13 values go to lo, the rest to hi.
+ */
+static INLINE void load_class_params_7x7(const alf_classifier* cl, const short* filter_set, const int16_t* clip_set,
+  __m128i* coeff_lo, __m128i* coeff_hi, __m128i* clip_lo, __m128i* clip_hi)
+{
+  const int transpose_idx = cl->transpose_idx;
+  const int class_idx = cl->class_idx;
+
+  static_assert(sizeof(*filter_set) == 2, "ALF coeffs must be 16-bit wide");
+  static_assert(sizeof(*clip_set) == 2, "ALF clip values must be 16-bit wide");
+
+  const __m128i raw_coeff0 = _mm_loadu_si128((const __m128i*) (filter_set + class_idx * MAX_NUM_ALF_LUMA_COEFF));
+  const __m128i raw_coeff1 = _mm_loadl_epi64((const __m128i*) (filter_set + class_idx * MAX_NUM_ALF_LUMA_COEFF + 8));
+  const __m128i raw_clip0 = _mm_loadu_si128((const __m128i*) (clip_set + class_idx * MAX_NUM_ALF_LUMA_COEFF));
+  const __m128i raw_clip1 = _mm_loadl_epi64((const __m128i*) (clip_set + class_idx * MAX_NUM_ALF_LUMA_COEFF + 8));
+
+  const __m128i s0 = _mm_loadu_si128((const __m128i*) shuffle_tab[transpose_idx][0]);
+  const __m128i s1 = _mm_xor_si128(s0, _mm_set1_epi8((char)0x80));
+  const __m128i s2 = _mm_loadu_si128((const __m128i*) shuffle_tab[transpose_idx][1]);
+  const __m128i s3 = _mm_xor_si128(s2, _mm_set1_epi8((char)0x80));
+
+  *coeff_lo = _mm_or_si128(_mm_shuffle_epi8(raw_coeff0, s0), _mm_shuffle_epi8(raw_coeff1, s1));
+  *coeff_hi = _mm_or_si128(_mm_shuffle_epi8(raw_coeff0, s2), _mm_shuffle_epi8(raw_coeff1, s3));
+  *clip_lo = _mm_or_si128(_mm_shuffle_epi8(raw_clip0, s0), _mm_shuffle_epi8(raw_clip1, s1));
+  *clip_hi = _mm_or_si128(_mm_shuffle_epi8(raw_clip0, s2), _mm_shuffle_epi8(raw_clip1, s3));
+}
+
+
+INLINE static void process2coeffs_7x7_avx2(__m256i params[2][2][6], __m256i *cur, __m256i *accum_a, __m256i *accum_b, const int i, const uvg_pixel* ptr0, const uvg_pixel* ptr1, const uvg_pixel* ptr2, const uvg_pixel* ptr3)
+{
+  const __m256i val00 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) ptr0)), *cur);
+  const __m256i val10 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) ptr2)), *cur);
+  const __m256i val01 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) ptr1)), *cur);
+  const __m256i val11 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) ptr3)), *cur);
+
+  __m256i val01a = _mm256_unpacklo_epi16(val00, val10);
+  __m256i val01b = _mm256_unpackhi_epi16(val00, val10);
+  __m256i val01c = _mm256_unpacklo_epi16(val01, val11);
+  __m256i val01d = _mm256_unpackhi_epi16(val01, val11);
+
+  __m256i limit_a = params[0][1][i];
+  __m256i limit_b = params[1][1][i];
+
+  val01a = _mm256_min_epi16(val01a, limit_a);
+  val01b = _mm256_min_epi16(val01b, limit_b);
+  val01c = _mm256_min_epi16(val01c, limit_a);
+  val01d = _mm256_min_epi16(val01d, limit_b);
+
+  limit_a = _mm256_sub_epi16(_mm256_setzero_si256(), limit_a);
+  limit_b = _mm256_sub_epi16(_mm256_setzero_si256(), limit_b);
+
+  val01a = _mm256_max_epi16(val01a, limit_a);
+  val01b = _mm256_max_epi16(val01b, limit_b);
+  val01c = _mm256_max_epi16(val01c, limit_a);
+  val01d = _mm256_max_epi16(val01d, limit_b);
+
+  val01a = _mm256_add_epi16(val01a, val01c);
+  val01b = _mm256_add_epi16(val01b, val01d);
+
+  *accum_a = _mm256_add_epi32(*accum_a, _mm256_madd_epi16(val01a, params[0][0][i]));
+  *accum_b = _mm256_add_epi32(*accum_b, _mm256_madd_epi16(val01b, params[1][0][i]));
+}
+
+
+static void alf_filter_7x7_block_avx2(encoder_state_t* const state,
+  const uvg_pixel* src_pixels,
+  uvg_pixel* dst_pixels,
+  const int src_stride,
+  const int dst_stride,
+  const short* filter_set,
+  const int16_t* fClipSet,
+  clp_rng clp_rng,
+  const int width,
+  const int height,
+  int x_pos,
+  int y_pos,
+  int blk_dst_x,
+  int blk_dst_y,
+  int vb_pos,
+  const int vb_ctu_height)
+{
+  assert((vb_ctu_height & (vb_ctu_height - 1)) == 0 && "vb_ctu_height must be a power of 2");
+
+  const int shift = state->encoder_control->bitdepth - 1;
+  const int round = 1 << (shift - 1);
+
+  const int step_x = 16;
+  const int step_y = 4;
+
+  assert(y_pos % step_y == 0 && "Wrong startHeight in filtering");
+  assert(height % step_y == 0 && "Wrong endHeight in filtering");
+  assert(width % 8 == 0 && "Wrong endWidth in filtering");
+
+  const uvg_pixel* src = src_pixels + y_pos * src_stride + x_pos;
+  uvg_pixel* dst = dst_pixels + blk_dst_y * dst_stride + blk_dst_x;
+
+  const __m256i offset = _mm256_set1_epi32(round);
+  const __m256i offset_vb = _mm256_set1_epi32((1 << ((shift + 3) - 1)) - round);
+  const __m256i min_val = _mm256_set1_epi16(clp_rng.min);
+  const __m256i max_val = _mm256_set1_epi16(clp_rng.max);
+
+  for (int i = 0; i < height; i += step_y)
+  {
+    const alf_classifier* p_class = state->tile->frame->alf_info->classifier[blk_dst_y + i] + blk_dst_x;
+
+    for (int j = 0; j < width; j += step_x)
+    {
+      // Pixels 0-3 and 8-11 are filtered with params[0], pixels 4-7 and
+      // 12-15 with params[1]. If only 8 pixels are left, the upper lane
+      // repeats the lower one instead of reading past the block.
+      const int j_hi = (j + step_x <= width) ? j + 8 : j;
+      __m256i params[2][2][6];
+
+      for (int k = 0; k < 2; ++k)
+      {
+        __m128i coeff_lo[2], coeff_hi[2], clip_lo[2], clip_hi[2];
+        load_class_params_7x7(&p_class[j + 4 * k], filter_set, fClipSet, &coeff_lo[0], &coeff_hi[0], &clip_lo[0], &clip_hi[0]);
+        load_class_params_7x7(&p_class[j_hi + 4 * k], filter_set, fClipSet, &coeff_lo[1], &coeff_hi[1], &clip_lo[1], &clip_hi[1]);
+
+        const __m256i raw_coeff_lo = _mm256_inserti128_si256(_mm256_castsi128_si256(coeff_lo[0]), coeff_lo[1], 1);
+        const __m256i raw_coeff_hi = _mm256_inserti128_si256(_mm256_castsi128_si256(coeff_hi[0]), coeff_hi[1], 1);
+        const __m256i raw_clip_lo = _mm256_inserti128_si256(_mm256_castsi128_si256(clip_lo[0]), clip_lo[1], 1);
+        const __m256i raw_clip_hi = _mm256_inserti128_si256(_mm256_castsi128_si256(clip_hi[0]), clip_hi[1], 1);
+
+        params[k][0][0] = _mm256_shuffle_epi32(raw_coeff_lo, 0x00);
+        params[k][0][1] = _mm256_shuffle_epi32(raw_coeff_lo, 0x55);
+        params[k][0][2] = _mm256_shuffle_epi32(raw_coeff_lo, 0xaa);
+        params[k][0][3] = _mm256_shuffle_epi32(raw_coeff_lo, 0xff);
+        params[k][0][4] = _mm256_shuffle_epi32(raw_coeff_hi, 0x00);
+        params[k][0][5] = _mm256_shuffle_epi32(raw_coeff_hi, 0x55);
+        params[k][1][0] = _mm256_shuffle_epi32(raw_clip_lo, 0x00);
+        params[k][1][1] = _mm256_shuffle_epi32(raw_clip_lo, 0x55);
+        params[k][1][2] = _mm256_shuffle_epi32(raw_clip_lo, 0xaa);
+        params[k][1][3] = _mm256_shuffle_epi32(raw_clip_lo, 0xff);
+        params[k][1][4] = _mm256_shuffle_epi32(raw_clip_hi, 0x00);
+        params[k][1][5] = _mm256_shuffle_epi32(raw_clip_hi, 0x55);
+      }
+
+      for (int ii = 0; ii < step_y; ii++)
+      {
+        const uvg_pixel* img0, * img1, * img2, * img3, * img4, * img5, * img6;
+
+        img0 = src + j + ii * src_stride;
+        img1 = img0 + src_stride;
+        img2 = img0 - src_stride;
+        img3 = img1 + src_stride;
+        img4 = img2 - src_stride;
+        img5 = img3 + src_stride;
+        img6 = img4 - src_stride;
+
+        const int y_vb = (blk_dst_y + i + ii) & (vb_ctu_height - 1);
+        if (y_vb < vb_pos && (y_vb >= vb_pos - 4))   // above
+        {
+          img1 = (y_vb == vb_pos - 1) ? img0 : img1;
+          img3 = (y_vb >= vb_pos - 2) ? img1 : img3;
+          img5 = (y_vb >= vb_pos - 3) ? img3 : img5;
+
+          img2 = (y_vb == vb_pos - 1) ? img0 : img2;
+          img4 = (y_vb >= vb_pos - 2) ? img2 : img4;
+          img6 = (y_vb >= vb_pos - 3) ? img4 : img6;
+        }
+        else if (y_vb >= vb_pos && (y_vb <= vb_pos + 3))   // bottom
+        {
+          img2 = (y_vb == vb_pos) ? img0 : img2;
+          img4 = (y_vb <= vb_pos + 1) ? img2 : img4;
+          img6 = (y_vb <= vb_pos + 2) ? img4 : img6;
+
+          img1 = (y_vb == vb_pos) ? img0 : img1;
+          img3 = (y_vb <= vb_pos + 1) ? img1 : img3;
+          img5 = (y_vb <= vb_pos + 2) ? img3 : img5;
+        }
+        __m256i cur = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) img0));
+
+        __m256i accum_a = offset;
+        __m256i accum_b = offset;
+
+        process2coeffs_7x7_avx2(params, &cur, &accum_a, &accum_b, 0, img5 + 0, img6 + 0, img3 + 1, img4 - 1);
+        process2coeffs_7x7_avx2(params, &cur, &accum_a, &accum_b, 1, img3 + 0, img4 + 0, img3 - 1, img4 + 1);
+        process2coeffs_7x7_avx2(params, &cur, &accum_a, &accum_b, 2, img1 + 2, img2 - 2, img1 + 1, img2 - 1);
+        process2coeffs_7x7_avx2(params, &cur, &accum_a, &accum_b, 3, img1 + 0, img2 + 0, img1 - 1, img2 + 1);
+        process2coeffs_7x7_avx2(params, &cur, &accum_a, &accum_b, 4, img1 - 2, img2 + 2, img0 + 3, img0 - 3);
+        process2coeffs_7x7_avx2(params, &cur, &accum_a, &accum_b, 5, img0 + 2, img0 - 2, img0 + 1, img0 - 1);
+
+        bool is_near_vb_above = y_vb < vb_pos && (y_vb >= vb_pos - 1);
+        bool is_near_vb_below = y_vb >= vb_pos && (y_vb <= vb_pos);
+        if (!(is_near_vb_above || is_near_vb_below))
+        {
+          accum_a = _mm256_srai_epi32(accum_a, shift);
+          accum_b = _mm256_srai_epi32(accum_b, shift);
+        }
+        else
+        {
+          accum_a = _mm256_srai_epi32(_mm256_add_epi32(accum_a, offset_vb), shift + 3);
+          accum_b = _mm256_srai_epi32(_mm256_add_epi32(accum_b, offset_vb), shift + 3);
+        }
+        accum_a = _mm256_packs_epi32(accum_a, accum_b);
+        accum_a = _mm256_add_epi16(accum_a, cur);
+        accum_a = _mm256_min_epi16(max_val, _mm256_max_epi16(accum_a, min_val));
+
+        store_alf_row_avx2(dst + ii * dst_stride + j, accum_a, width - j);
+      }
+    }
+
+    src += src_stride * step_y;
+    dst += dst_stride * step_y;
+  }
+}
+
+
+static void alf_filter_cc_block_avx2(encoder_state_t * const state,
+  uvg_pixel *dst_buf, const uvg_pixel *rec_src,
+  const int rec_luma_stride,
+  const alf_component_id comp_id, const int16_t *filter_coeff,
+  const clp_rngs clp_rngs, int vb_ctu_height, int vb_pos,
+  const int x_pos, const int y_pos,
+  const int blk_width,
+  const int blk_height)
+{
+  assert((vb_ctu_height & (vb_ctu_height - 1)) == 0 && "vb_ctu_height must be a power of 2");
+  assert(comp_id != COMPONENT_Y && "Must be chroma");
+  assert(x_pos % 4 == 0 && y_pos % 4 == 0 && "Wrong start position in filtering");
+  assert(blk_width % 4 == 0 && blk_height % 4 == 0 && "Wrong block size in filtering");
+
+  enum uvg_chroma_format chroma_format = state->encoder_control->chroma_format;
+  const uint8_t scale_y = (chroma_format != UVG_CSP_420) ? 0 : 1;
+  const uint8_t scale_x = (chroma_format == UVG_CSP_444) ? 0 : 1;
+
+  const uvg_pixel* luma_ptr = rec_src + (y_pos << scale_y) * rec_luma_stride + (x_pos << scale_x);
+  const int chroma_stride = rec_luma_stride >> scale_x;
+  uvg_pixel* chroma_ptr = dst_buf + y_pos * chroma_stride + x_pos;
+
+  const int offset = 1 << clp_rngs.comp[comp_id].bd >> 1;
+
+  // 16 chroma pixels are filtered at a time in 4:2:0. The remaining columns
+  // and the other chroma formats use the scalar filter.
+  const int simd_width = (scale_x && scale_y) ? (blk_width & ~15) : 0;
+
+  const __m256i coeff01 = _mm256_set1_epi32((uint16_t)filter_coeff[0] | ((uint32_t)(uint16_t)filter_coeff[1] << 16));
+  const __m256i coeff23 = _mm256_set1_epi32((uint16_t)filter_coeff[2] | ((uint32_t)(uint16_t)filter_coeff[3] << 16));
+  const __m256i coeff45 = _mm256_set1_epi32((uint16_t)filter_coeff[4] | ((uint32_t)(uint16_t)filter_coeff[5] << 16));
+  const __m256i coeff6 = _mm256_set1_epi32((uint16_t)filter_coeff[6]);
+  const __m256i round = _mm256_set1_epi32(1 << 6);
+  const __m256i min_val = _mm256_set1_epi32(-offset);
+  const __m256i max_val = _mm256_set1_epi32(PIXEL_MAX - offset);
+  const __m256i even_mask = _mm256_set1_epi16(0x00ff);
+
+  for (int y = 0; y < blk_height; ++y)
+  {
+    int offset1 = rec_luma_stride;
+    int offset2 = -rec_luma_stride;
+    int offset3 = 2 * rec_luma_stride;
+
+    const int pos = ((y_pos + y) << scale_y) & (vb_ctu_height - 1);
+    if (scale_y == 0 && (pos == vb_pos || pos == vb_pos + 1))
+    {
+      continue;
+    }
+    if (pos == (vb_pos - 2) || pos == (vb_pos + 1))
+    {
+      offset3 = offset1;
+    }
+    else if (pos == (vb_pos - 1) || pos == vb_pos)
+    {
+      offset1 = 0;
+      offset2 = 0;
+      offset3 = 0;
+    }
+
+    const uvg_pixel* src_cross = luma_ptr + (y << scale_y) * rec_luma_stride;
+    uvg_pixel* src_self = chroma_ptr + y * chroma_stride;
+
+    for (int x = 0; x < simd_width; x += 16)
+    {
+      // The even luma samples are the centers, the odd ones their right
+      // neighbours. Loading one sample earlier gives the left neighbours.
+      const uvg_pixel* p = src_cross + 2 * x;
+      const __m256i row0 = _mm256_loadu_si256((const __m256i*) p);
+      const __m256i row0_left = _mm256_loadu_si256((const __m256i*) (p - 1));
+      const __m256i row1 = _mm256_loadu_si256((const __m256i*) (p + offset1));
+      const __m256i row1_left = _mm256_loadu_si256((const __m256i*) (p + offset1 - 1));
+      const __m256i above = _mm256_loadu_si256((const __m256i*) (p + offset2));
+      const __m256i below2 = _mm256_loadu_si256((const __m256i*) (p + offset3));
+
+      const __m256i cur = _mm256_and_si256(row0, even_mask);
+      const __m256i d0 = _mm256_sub_epi16(_mm256_and_si256(above, even_mask), cur);
+      const __m256i d1 = _mm256_sub_epi16(_mm256_and_si256(row0_left, even_mask), cur);
+      const __m256i d2 = _mm256_sub_epi16(_mm256_srli_epi16(row0, 8), cur);
+      const __m256i d3 = _mm256_sub_epi16(_mm256_and_si256(row1_left, even_mask), cur);
+      const __m256i d4 = _mm256_sub_epi16(_mm256_and_si256(row1, even_mask), cur);
+      const __m256i d5 = _mm256_sub_epi16(_mm256_srli_epi16(row1, 8), cur);
+      const __m256i d6 = _mm256_sub_epi16(_mm256_and_si256(below2, even_mask), cur);
+
+      __m256i sum_lo = _mm256_madd_epi16(_mm256_unpacklo_epi16(d0, d1), coeff01);
+      sum_lo = _mm256_add_epi32(sum_lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(d2, d3), coeff23));
+      sum_lo = _mm256_add_epi32(sum_lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(d4, d5), coeff45));
+      sum_lo = _mm256_add_epi32(sum_lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(d6, _mm256_setzero_si256()), coeff6));
+
+      __m256i sum_hi = _mm256_madd_epi16(_mm256_unpackhi_epi16(d0, d1), coeff01);
+      sum_hi = _mm256_add_epi32(sum_hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(d2, d3), coeff23));
+      sum_hi = _mm256_add_epi32(sum_hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(d4, d5), coeff45));
+      sum_hi = _mm256_add_epi32(sum_hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(d6, _mm256_setzero_si256()), coeff6));
+
+      sum_lo = _mm256_srai_epi32(_mm256_add_epi32(sum_lo, round), 7);
+      sum_hi = _mm256_srai_epi32(_mm256_add_epi32(sum_hi, round), 7);
+      sum_lo = _mm256_min_epi32(_mm256_max_epi32(sum_lo, min_val), max_val);
+      sum_hi = _mm256_min_epi32(_mm256_max_epi32(sum_hi, min_val), max_val);
+
+      __m256i sum = _mm256_packs_epi32(sum_lo, sum_hi);
+      sum = _mm256_add_epi16(sum, _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) (src_self + x))));
+      store_alf_row_avx2(src_self + x, sum, 16);
+    }
+
+    for (int x = simd_width; x < blk_width; ++x)
+    {
+      const int x2 = x << scale_x;
+      const uvg_pixel curr_src_cross = src_cross[x2];
+
+      int sum = 0;
+      sum += filter_coeff[0] * (src_cross[offset2 + x2] - curr_src_cross);
+      sum += filter_coeff[1] * (src_cross[x2 - 1] - curr_src_cross);
+      sum += filter_coeff[2] * (src_cross[x2 + 1] - curr_src_cross);
+      sum += filter_coeff[3] * (src_cross[offset1 + x2 - 1] - curr_src_cross);
+      sum += filter_coeff[4] * (src_cross[offset1 + x2] - curr_src_cross);
+      sum += filter_coeff[5] * (src_cross[offset1 + x2 + 1] - curr_src_cross);
+      sum += filter_coeff[6] * (src_cross[offset3 + x2] - curr_src_cross);
+
+      sum = (sum + ((1 << 7) >> 1)) >> 7;
+      sum = uvg_fast_clip_32bit_to_pixel(sum + offset) - offset;
+      sum += src_self[x];
+      src_self[x] = uvg_fast_clip_32bit_to_pixel(sum);
+    }
+  }
+}
+
 #endif // UVG_BIT_DEPTH == 8
 #endif //COMPILE_INTEL_AVX2
 
@@ -307,6 +1062,10 @@ int uvg_strategy_register_alf_avx2(void* opaque, uint8_t bitdepth) {
 #if COMPILE_INTEL_AVX2
 #if UVG_BIT_DEPTH == 8
   if (bitdepth == 8){
+    success &= uvg_strategyselector_register(opaque, "alf_derive_classification_blk", "avx2", 40, &alf_derive_classification_blk_avx2);
+    success &= uvg_strategyselector_register(opaque, "alf_filter_5x5_blk", "avx2", 40, &alf_filter_5x5_block_avx2);
+    success &= uvg_strategyselector_register(opaque, "alf_filter_7x7_blk", "avx2", 40, &alf_filter_7x7_block_avx2);
+    success &= uvg_strategyselector_register(opaque, "alf_filter_cc_blk", "avx2", 40, &alf_filter_cc_block_avx2);
     success &= uvg_strategyselector_register(opaque, "alf_get_blk_stats", "avx2", 40, &alf_get_blk_stats_avx2);
   }
 #endif // UVG_BIT_DEPTH == 8
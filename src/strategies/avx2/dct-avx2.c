@@ -54,7 +54,6 @@ extern const int16_t uvg_g_dct_32_t[32][32];
 
 #if COMPILE_INTEL_AVX2 
 #include "uvg266.h"
-#if UVG_BIT_DEPTH == 8
 #include <immintrin.h>
 #include "strategies/avx2/dct_avx2_tables.h"
 #define MAX_LOG2_TR_DYNAMIC_RANGE 15
@@ -82,6 +81,7 @@ static INLINE __m256i truncate_avx2(__m256i v, __m256i debias, int32_t shift)
 // TODO: find avx2 solution for transpose
 // TODO: attempt to make a generic transpose for avx2. Needs some extra logic for different widths and heights.
 // TODO: make a few solutions for exact sizes and see if some pattern emerges...
+#if 0
 static void transpose_matrix(const int16_t* src, int16_t* dst, const int width, const int height) {
   const int sample_num = width * height;
   const int vectors = sample_num / 16;
@@ -158,6 +158,7 @@ static void transpose_generic(const int16_t* src, int16_t* dst, const int width,
     }
   }
 }
+#endif
 
 
 typedef void (transpose_func)(const __m256i* src, __m256i* dst);
@@ -689,6 +690,7 @@ static __m256i mul_clip_matrix_4x4_avx2(const __m256i left, const __m256i right,
   return result;
 }
 
+#if 0
 static void matrix_dst_4x4_avx2(int8_t bitdepth, const int16_t *input, int16_t *output)
 {
   int32_t shift_1st = uvg_g_convert_to_bit[4] + 1 + (bitdepth - 8);
@@ -723,6 +725,7 @@ static void matrix_idst_4x4_avx2(int8_t bitdepth, const int16_t *input, int16_t
 
   _mm256_store_si256((__m256i *)output, result);
 }
+#endif
 
 static void matrix_dct_4x4_avx2(int8_t bitdepth, const int16_t *input, int16_t *output)
 {
@@ -1636,6 +1639,7 @@ const int16_t* uvg_g_mts_input[2][3][5] = {
   },
 };
 
+#if 0
 static void mts_dct_4x4_avx2(const int16_t* input, int16_t* output, tr_type_t type_hor, tr_type_t type_ver, uint8_t bitdepth, uint8_t lfnst_idx)
 {
   //const int height = 4;
@@ -1976,6 +1980,7 @@ static tr_func* dct_table[5] = {
 static tr_func* idct_table[5] = {
   mts_idct_4x4_avx2, mts_idct_8x8_avx2, mts_idct_16x16_avx2, mts_idct_32x32_avx2, NULL/*fastInverseDCT2_B64*/
 };
+#endif
 
 typedef void (dct_full_pass)(const int16_t* src, int16_t* dst, tr_type_t hor, tr_type_t ver);
 
@@ -6032,6 +6037,7 @@ static void fast_forward_DCT8_B32_avx2_hor(const int16_t* src, __m256i* dst, con
 }
 
 
+#if 0
 static void fast_forward_DCT2_32x2_avx2_ver(const __m256i* src, int16_t* dst, int32_t shift, int line, int skip_line, int skip_line2)
 {
   const int32_t    add = (shift > 0) ? (1 << (shift - 1)) : 0; // ISP_TODO: optimize (shift > 0) check out if shift is always gt 0
@@ -6208,6 +6214,7 @@ static void fast_forward_DCT2_32x8_avx2_ver(const __m256i* src, int16_t* dst, in
   }
 
 }
+#endif
 
 
 static void fast_forward_tr_32x2_avx2(const int16_t* src, int16_t* dst, tr_type_t hor, tr_type_t ver)
@@ -6816,7 +6823,9 @@ static void fast_inverse_tr_32x4_avx2(const int16_t* src, int16_t* dst, tr_type_
   }
 
   __m256i v_ver_pass_out[8];
-  if(ver == DCT2) {
+  // The mts variant only produces the left half, which is all there is
+  // when the horizontal transform is not DCT2.
+  if(ver == DCT2 || skip_width == 0) {
     fast_inverse_tr_32x4_avx2_ver(src, v_ver_pass_out, ver_coeff, shift_1st, width, skip_width, skip_height);
   }
   else {
@@ -7315,6 +7324,7 @@ static void fast_inverse_tr_32x16_avx2_ver(const int16_t* src, __m256i* dst, con
   transpose_avx2(temp, dst, 16, 32);
 }
 
+#if 0
 static void fast_inverse_tr_32x16_avx2_hor(const __m256i* src, int16_t* dst, const int16_t* coeff, int32_t shift, int line, int skip_line, int skip_line2)
 {
   const int32_t    add = 1 << (shift - 1);
@@ -7501,6 +7511,7 @@ static void fast_inverse_tr_32x16_avx2_hor(const __m256i* src, int16_t* dst, con
 
   // TODO: MTS cutoff
 }
+#endif
 
 static void fast_inverse_tr_32x16_avx2(const int16_t* src, int16_t* dst, tr_type_t hor, tr_type_t ver)
 {
@@ -7790,6 +7801,7 @@ static void fast_inverse_tr_32x32_avx2_ver(const int16_t* src, __m256i* dst, con
   }
 }
 
+#if 0
 static void fast_inverse_tr_32x32_avx2_hor(const __m256i* src, int16_t* dst, const int16_t* coeff, int32_t shift, int line, int skip_line, int skip_line2)
 {
   const int32_t    add = 1 << (shift - 1);
@@ -7885,6 +7897,7 @@ static void fast_inverse_tr_32x32_avx2_hor(const __m256i* src, int16_t* dst, con
     dst += 16;
   }
 }
+#endif
 
 static void fast_inverse_tr_32x32_avx2(const int16_t* src, int16_t* dst, tr_type_t hor, tr_type_t ver)
 {
@@ -7946,6 +7959,51 @@ extern void uvg_get_tr_type(
   tr_type_t* ver_out,
   const int8_t mts_type);
 
+// The 32-point butterfly leaves the 64-bit quarters of each 16 coefficient
+// half in 0, 2, 1, 3 order when it is run on a single line.
+static INLINE void reorder_1d_32_avx2(int16_t* output)
+{
+  __m256i* v = (__m256i*)output;
+  _mm256_store_si256(&v[0], _mm256_permute4x64_epi64(_mm256_load_si256(&v[0]), _MM_SHUFFLE(3, 1, 2, 0)));
+  _mm256_store_si256(&v[1], _mm256_permute4x64_epi64(_mm256_load_si256(&v[1]), _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+// Clear the coefficients right of width - skip_width and below
+// height - skip_height.
+static INLINE void zero_out_high_freq(int16_t* output, int width, int height, int skip_width, int skip_height)
+{
+  if (skip_width) {
+    for (int y = 0; y < height - skip_height; ++y) {
+      memset(&output[y * width + width - skip_width], 0, skip_width * sizeof(int16_t));
+    }
+  }
+  if (skip_height) {
+    memset(&output[(height - skip_height) * width], 0, skip_height * width * sizeof(int16_t));
+  }
+}
+
+// Size of the high frequency region the generic transforms leave out,
+// either zeroing it in the forward direction or ignoring it in the inverse.
+static INLINE void get_skip_region(int width, int height, tr_type_t type_hor, tr_type_t type_ver,
+                                   bool lfnst, bool inverse, int* skip_width, int* skip_height)
+{
+  *skip_width  = (type_hor != DCT2 && width == 32) ? 16 : 0;
+  *skip_height = (type_ver != DCT2 && height == 32) ? 16 : 0;
+  if (lfnst) {
+    if ((width == 4 && height > 4) || (width > 4 && height == 4)) {
+      *skip_width  = width - 4;
+      *skip_height = height - 4;
+    }
+    else if (width >= 8 && height >= 8) {
+      *skip_width  = width - 8;
+      *skip_height = height - 8;
+    }
+  }
+  // The vertical DCT-II passes never skip rows and of the inverse
+  // DST-VII and DCT-VIII passes only the 8-point ones do.
+  if (type_ver == DCT2 || (inverse && height != 8)) *skip_height = 0;
+}
+
 static void mts_dct_avx2(
   const int8_t bitdepth,
   const color_t color,
@@ -7961,7 +8019,9 @@ static void mts_dct_avx2(
 
   uvg_get_tr_type(width, height, color, tu, &type_hor, &type_ver, mts_type);
 
-  if (type_hor == DCT2 && type_ver == DCT2 && !tu->lfnst_idx && width == height)
+  const bool lfnst = (tu->lfnst_idx && color == COLOR_Y) || (tu->cr_lfnst_idx && color != COLOR_Y);
+
+  if (type_hor == DCT2 && type_ver == DCT2 && !tu->lfnst_idx && !tu->cr_lfnst_idx && width == height)
   {
     dct_func* dct_func = uvg_get_dct_func(width, height, color, tu->type);
     dct_func(bitdepth, input, output);
@@ -7969,24 +8029,33 @@ static void mts_dct_avx2(
   else{
     const int log2_width_minus1  = uvg_g_convert_to_log2[width] - 1;
     const int log2_height_minus1 = uvg_g_convert_to_log2[height] - 1;
+    const int32_t shift_1d = (height == 1 ? log2_width_minus1 : log2_height_minus1) + bitdepth - 8;
     // Transforms with 1 lenght dimensions are handled separately since their interface differ from other full pass functions
     if (height == 1) {
       if (width == 16) {
-        fast_forward_DCT2_B16_avx2_hor(input, (__m256i*)output, type_hor == DCT2 ? ff_dct2_16xN_coeff_hor : ff_dst7_16xN_coeff_hor, 3, 1, 0, 0);
+        fast_forward_DCT2_B16_avx2_hor(input, (__m256i*)output, type_hor == DCT2 ? ff_dct2_16xN_coeff_hor : ff_dst7_16xN_coeff_hor, shift_1d, 1, 0, 0);
       } else if (width == 32) {
-        fast_forward_DCT2_B32_avx2_hor(input, (__m256i*)output, ff_dct2_32xN_coeff_hor, 4, 1, 0, 0);        
+        fast_forward_DCT2_B32_avx2_hor(input, (__m256i*)output, ff_dct2_32xN_coeff_hor, shift_1d, 1, 0, 0);        
+        reorder_1d_32_avx2(output);
       }
     }
     else if (width == 1){
       if (height == 16) {
-        fast_forward_DCT2_B16_avx2_hor(input, (__m256i*)output, type_ver == DCT2 ? ff_dct2_16xN_coeff_hor : ff_dst7_16xN_coeff_hor, 3, 1, 0, 0);
+        fast_forward_DCT2_B16_avx2_hor(input, (__m256i*)output, type_ver == DCT2 ? ff_dct2_16xN_coeff_hor : ff_dst7_16xN_coeff_hor, shift_1d, 1, 0, 0);
       } else if (height == 32) {
-        fast_forward_DCT2_B32_avx2_hor(input, (__m256i*)output, ff_dct2_32xN_coeff_hor, 4, 1, 0, 0);        
+        fast_forward_DCT2_B32_avx2_hor(input, (__m256i*)output, ff_dct2_32xN_coeff_hor, shift_1d, 1, 0, 0);        
+        reorder_1d_32_avx2(output);
       }
     }
     else {
       dct_full_pass* dct_func = dct_function_table[log2_width_minus1][log2_height_minus1];
       dct_func(input, output, type_hor, type_ver);
+
+      // The full passes compute every coefficient. Clear the ones the
+      // generic transform skips so that the results are identical.
+      int skip_width, skip_height;
+      get_skip_region(width, height, type_hor, type_ver, lfnst, false, &skip_width, &skip_height);
+      zero_out_high_freq(output, width, height, skip_width, skip_height);
     }
   }
 }
@@ -8007,7 +8076,9 @@ static void mts_idct_avx2(
 
   uvg_get_tr_type(width, height, color, tu, &type_hor, &type_ver, mts_type);
 
-  if (type_hor == DCT2 && type_ver == DCT2 && width == height)
+  const bool lfnst = (tu->lfnst_idx && color == COLOR_Y) || (tu->cr_lfnst_idx && color != COLOR_Y);
+
+  if (type_hor == DCT2 && type_ver == DCT2 && !tu->lfnst_idx && !tu->cr_lfnst_idx && width == height)
   {
     dct_func* idct_func = uvg_get_idct_func(width, height, color, tu->type);
     idct_func(bitdepth, input, output);
@@ -8015,39 +8086,54 @@ static void mts_idct_avx2(
   else {
     const int log2_width_minus1  = uvg_g_convert_to_log2[width] - 1;
     const int log2_height_minus1 = uvg_g_convert_to_log2[height] - 1;
+    const int32_t shift_1d = INVERSE_SHIFT_2ND + 1;
     // Transforms with 1 lenght dimensions can be transformed with existing forward functions
     if (height == 1) {
       if (width == 16) {
-        fast_forward_DCT2_B16_avx2_hor(input, (__m256i*)output, type_hor == DCT2 ? fi_dct2_16x1_coeff_hor : fi_dst7_16x1_coeff_hor, 13, 1, 0, 0);
+        fast_forward_DCT2_B16_avx2_hor(input, (__m256i*)output, type_hor == DCT2 ? fi_dct2_16x1_coeff_hor : fi_dst7_16x1_coeff_hor, shift_1d, 1, 0, 0);
         _mm256_store_si256((__m256i*)output, _mm256_permute4x64_epi64(_mm256_load_si256((__m256i*)output), _MM_SHUFFLE(3, 1, 2, 0)));
       } else if (width == 32) {
-        fast_forward_DCT2_B32_avx2_hor(input, (__m256i*)output, fi_dct2_32xN_coeff_hor, 13, 1, 0, 0);        
+        fast_forward_DCT2_B32_avx2_hor(input, (__m256i*)output, fi_dct2_32xN_coeff_hor, shift_1d, 1, 0, 0);        
+        reorder_1d_32_avx2(output);
       }
     }
     else if (width == 1){
       if (height == 16) {
-        fast_forward_DCT2_B16_avx2_hor(input, (__m256i*)output, type_ver == DCT2 ? fi_dct2_16x1_coeff_hor : fi_dst7_16x1_coeff_hor, 13, 1, 0, 0);
+        fast_forward_DCT2_B16_avx2_hor(input, (__m256i*)output, type_ver == DCT2 ? fi_dct2_16x1_coeff_hor : fi_dst7_16x1_coeff_hor, shift_1d, 1, 0, 0);
         _mm256_store_si256((__m256i*)output, _mm256_permute4x64_epi64(_mm256_load_si256((__m256i*)output), _MM_SHUFFLE(3, 1, 2, 0)));
       } else if (height == 32) {
-        fast_forward_DCT2_B32_avx2_hor(input, (__m256i*)output, fi_dct2_32xN_coeff_hor, 13, 1, 0, 0);        
+        fast_forward_DCT2_B32_avx2_hor(input, (__m256i*)output, fi_dct2_32xN_coeff_hor, shift_1d, 1, 0, 0);        
+        reorder_1d_32_avx2(output);
       }
     }
     else {
       dct_full_pass* idct_func = idct_function_table[log2_width_minus1][log2_height_minus1];
-      idct_func(input, output, type_hor, type_ver);
+
+      // The generic transform never reads the skipped coefficients.
+      int skip_width, skip_height;
+      get_skip_region(width, height, type_hor, type_ver, lfnst, true, &skip_width, &skip_height);
+      if (skip_width || skip_height) {
+        ALIGNED(64) int16_t masked[TR_MAX_WIDTH * TR_MAX_WIDTH];
+        memcpy(masked, input, width * height * sizeof(int16_t));
+        zero_out_high_freq(masked, width, height, skip_width, skip_height);
+        idct_func(masked, output, type_hor, type_ver);
+      }
+      else {
+        idct_func(input, output, type_hor, type_ver);
+      }
     }
   }
 }
 
-#endif // UVG_BIT_DEPTH == 8
 #endif //COMPILE_INTEL_AVX2
 
 int uvg_strategy_register_dct_avx2(void* opaque, uint8_t bitdepth)
 {
   bool success = true;
 #if COMPILE_INTEL_AVX2
-#if UVG_BIT_DEPTH == 8
-  if (bitdepth == 8){
+  // The transforms take their shifts from the bit depth, so they work on
+  // residuals of any supported bit depth.
+  if (bitdepth == UVG_BIT_DEPTH){
     //success &= uvg_strategyselector_register(opaque, "fast_forward_dst_4x4", "avx2", 40, &matrix_dst_4x4_avx2);
 
     success &= uvg_strategyselector_register(opaque, "dct_4x4", "avx2", 40, &matrix_dct_4x4_avx2);
@@ -8066,7 +8152,6 @@ int uvg_strategy_register_dct_avx2(void* opaque, uint8_t bitdepth)
     success &= uvg_strategyselector_register(opaque, "mts_idct", "avx2", 40, &mts_idct_avx2);
 
   }
-#endif // UVG_BIT_DEPTH == 8
 #endif //COMPILE_INTEL_AVX2  
   return success;
 }
@@ -32,8 +32,6 @@ ALIGNED(32) static const int16_t  fast_forward_dct2_b2_coeff[32] = {
   64, -64, 64, -64, 64, -64, 64, -64, 64, -64, 64, -64, 64, -64, 64, -64,
 };
 
-static const int16_t* fast_inverse_dct2_b2_coeff = fast_forward_dct2_b2_coeff; // Inverse coeffs for this transform are same as forward
-
 // Coeff arrays for B4
 ALIGNED(32) static const int16_t  fast_forward_dct2_b4_coeff[64] = {
  64,  64,  64,  64,  64,  64,  64,  64,  64, -64,  64, -64,  64, -64,  64, -64,
@@ -135,8 +133,6 @@ ALIGNED(32) static const int16_t  fast_inverse_dst7_b8_coeff[128] = {
 -46,  85,  85, -71, -78,  46,  32, -17, -46,  85,  85, -71, -78,  46,  32, -17,
 };
 
-static const int16_t* fast_inverse_dct8_b8_coeff = fast_forward_dct8_b8_coeff; // The table used in forward transform works with inverse also.
-
 // Coeff arrays for forward B16
 ALIGNED(32) static const int16_t  fast_forward_dct2_b16_coeff[256] = {
  64,  64,  90,  87,  89,  75,  87,  57,  64, -64,  57, -80,  50, -89,  43, -90,
@@ -234,8 +230,6 @@ ALIGNED(32) static const int16_t  fast_inverse_dst7_b16_coeff[256] = {
  85,  73, -68, -81,  40,  87,  -8, -88, -87,  55,  73, -40, -48,  25,  17,  -8,
 };
 
-static const int16_t* fast_inverse_dct8_b16_coeff = fast_forward_dct8_b16_coeff;
-
 // Coeff arrays for forward B32
 ALIGNED(32) static const int16_t  fast_forward_dct2_b32_coeff[1024] = {
  64,  64,  90,  90,  90,  87,  90,  82,  89,  75,  88,  67,  87,  57,  85,  46,  // 0
@@ -573,8 +567,6 @@ ALIGNED(32) static const int16_t  fast_inverse_dst7_b32_coeff[1024] = {
 -89,  60,  85, -53, -78,  46,  68, -38, -56,  30,  42, -21, -26,  13,   9,  -4,
 };
 
-static const int16_t* fast_inverse_dct8_b32_coeff = fast_forward_dct8_b32_coeff;
-
 
 // Shuffle tables for advanced and optimized avx2 functions
 
@@ -3473,8 +3465,6 @@ ALIGNED(32) static const int16_t  ff_dct8_16x32_coeff_ver[1024] = {
 };
 
 
-          static const int16_t* fi_dct2_16x32_coeff_hor = fi_dct2_16x16_coeff_hor;
-
           static const int16_t* fi_dst7_16x32_coeff_hor = fi_dst7_16x16_coeff_hor;
 
           static const int16_t* fi_dct8_16x32_coeff_hor = ff_dct8_16x16_coeff_ver;
@@ -4824,4 +4814,4 @@ ALIGNED(32) static const int16_t  ff_dct8_32x32_coeff_ver[1024] = {
 }
 
 
-#endif DCT_AVX2_TABLES_H
+#endif // DCT_AVX2_TABLES_H
@@ -40,32 +40,40 @@
 #include <stdlib.h>
 
 #include "strategyselector.h"
+#include "strategies/generic/intra-generic.h"
 #include "strategies/missing-intel-intrinsics.h"
 
+// Size of the work buffers holding the references of an angular prediction.
+#define ANGULAR_REF_BUFFER_SIZE (2 * 128 + 3 + 33 * MAX_REF_LINE_IDX)
+
  /**
- * \brief Generate angular predictions.
- * \param cu_loc        CU locationand size data.
- * \param intra_mode    Angular mode in range 2..34.
+ * \brief Generate angular prediction from references copied to work buffers.
+ *
+ * For negative angles the references start at index width of temp_main and
+ * temp_side, and the side reference is projected in front of the main
+ * reference. For positive angles the references start at index 0 and the end
+ * of the main reference is padded.
+ *
+ * \param width         Width of the block.
+ * \param height        Height of the block.
+ * \param intra_mode    Angular mode in range 2..66.
  * \param channel_type  Color channel.
- * \param in_ref_above  Pointer to -1 index of above reference, length=width*2+1.
- * \param in_ref_left   Pointer to -1 index of left reference, length=width*2+1.
+ * \param temp_main     Work buffer holding the reference to interpolate from.
+ * \param temp_side     Work buffer holding the other reference.
  * \param dst           Buffer of size width*width.
  * \param multi_ref_idx Reference line index for use with MRL.
  */
-static void uvg_angular_pred_avx2(
-  const cu_loc_t* const cu_loc,
+static void angular_pred_from_refs_avx2(
+  const int width,
+  const int height,
   const int_fast8_t intra_mode,
   const int_fast8_t channel_type,
-  const uvg_pixel *const in_ref_above,
-  const uvg_pixel *const in_ref_left,
+  uvg_pixel *const temp_main,
+  uvg_pixel *const temp_side,
   uvg_pixel *const dst,
-  const uint8_t multi_ref_idx,
-  const uint8_t isp_mode,
-  const int cu_dim)
+  const uint8_t multi_ref_idx)
 {
   // ISP_TODO: non-square block implementation, height is passed but not used
-  const int width = channel_type == COLOR_Y ? cu_loc->width : cu_loc->chroma_width;
-  const int height = channel_type == COLOR_Y ? cu_loc->height : cu_loc->chroma_height;
   const int log2_width =  uvg_g_convert_to_log2[width];
   const int log2_height = uvg_g_convert_to_log2[height];
 
@@ -73,8 +81,7 @@ static void uvg_angular_pred_avx2(
   assert(intra_mode >= 2 && intra_mode <= 66);
 
   // TODO: implement handling of MRL
-  uint8_t multi_ref_index = channel_type == COLOR_Y ? multi_ref_idx : 0;
-  uint8_t isp = isp_mode;
+  uint8_t multi_ref_index = multi_ref_idx;
 
   __m256i p_shuf_01 = _mm256_setr_epi8(
     0x00, 0x01, 0x01, 0x02, 0x02, 0x03, 0x03, 0x04,
@@ -144,12 +151,6 @@ static void uvg_angular_pred_avx2(
     { 0,  2, 63, -1 },
   };
 
-                                                    // Temporary buffer for modes 11-25.
-                                                    // It only needs to be big enough to hold indices from -width to width-1.
-  //uvg_pixel tmp_ref[2 * 128 + 3 + 33 * MAX_REF_LINE:IDX] = { 0 };
-  uvg_pixel temp_main[2 * 128 + 3 + 33 * MAX_REF_LINE_IDX] = { 0 };
-  uvg_pixel temp_side[2 * 128 + 3 + 33 * MAX_REF_LINE_IDX] = { 0 };
-
   int32_t pred_mode = intra_mode; // ToDo: handle WAIP
 
   // Whether to swap references to always project on the left reference row.
@@ -159,7 +160,7 @@ static void uvg_angular_pred_avx2(
   //const int_fast8_t mode_disp = vertical_mode ? intra_mode - 26 : 10 - intra_mode;
   
   // Sample displacement per column in fractions of 32.
-  const int_fast8_t sample_disp = (mode_disp < 0 ? -1 : 1) * modedisp2sampledisp[abs(mode_disp)];
+  const int16_t sample_disp = (mode_disp < 0 ? -1 : 1) * modedisp2sampledisp[abs(mode_disp)];
   
   // TODO: replace latter width with height
   int scale = MIN(2, log2_width - pre_scale[abs(mode_disp)]);
@@ -172,9 +173,6 @@ static void uvg_angular_pred_avx2(
   // Set ref_main and ref_side such that, when indexed with 0, they point to
   // index 0 in block coordinates.
   if (sample_disp < 0) {
-    memcpy(&temp_main[width], vertical_mode ? in_ref_above : in_ref_left, sizeof(uvg_pixel) * (width + 1 + multi_ref_index + 1));
-    memcpy(&temp_side[width], vertical_mode ? in_ref_left : in_ref_above, sizeof(uvg_pixel) * (width + 1 + multi_ref_index + 1));
-
     ref_main = temp_main + width;
     ref_side = temp_side + width;
 
@@ -217,16 +215,6 @@ static void uvg_angular_pred_avx2(
     //tmp_ref[most_negative_index + index_offset - 1] = tmp_ref[most_negative_index + index_offset];
   }
   else {
-
-    memcpy(temp_main, vertical_mode ? in_ref_above : in_ref_left, sizeof(uvg_pixel)* (width * 2 + multi_ref_index + 1));
-    memcpy(temp_side, vertical_mode ? in_ref_left : in_ref_above, sizeof(uvg_pixel)* (width * 2 + multi_ref_index + 1));
-
-    const int s = 0;
-    const int max_index = (multi_ref_index << s) + 2;
-    const int ref_length = width << 1;
-    const uvg_pixel val = temp_main[ref_length + multi_ref_index];
-    memset(temp_main + ref_length + multi_ref_index, val, max_index + 1);
-
     ref_main = temp_main;
     ref_side = temp_side;
     //// sample_disp >= 0 means we don't need to refer to negative indices,
@@ -501,13 +489,144 @@ static void uvg_angular_pred_avx2(
   }
 }
 
+ /**
+ * \brief Generate angular predictions.
+ *
+ * Only square blocks without ISP are handled here, other shapes use the
+ * generic implementation.
+ *
+ * \param cu_loc        CU locationand size data.
+ * \param intra_mode    Angular mode in range 2..34.
+ * \param channel_type  Color channel.
+ * \param in_ref_above  Pointer to -1 index of above reference, length=width*2+1.
+ * \param in_ref_left   Pointer to -1 index of left reference, length=width*2+1.
+ * \param dst           Buffer of size width*width.
+ * \param multi_ref_idx Reference line index for use with MRL.
+ */
+static void uvg_angular_pred_avx2(
+  const cu_loc_t* const cu_loc,
+  const int_fast8_t intra_mode,
+  const int_fast8_t channel_type,
+  const uvg_pixel *const in_ref_above,
+  const uvg_pixel *const in_ref_left,
+  uvg_pixel *const dst,
+  const uint8_t multi_ref_idx,
+  const uint8_t isp_mode,
+  const int cu_dim)
+{
+  const int width = channel_type == COLOR_Y ? cu_loc->width : cu_loc->chroma_width;
+  const int height = channel_type == COLOR_Y ? cu_loc->height : cu_loc->chroma_height;
+  if (width != height || isp_mode) {
+    uvg_angular_pred_generic(cu_loc, intra_mode, channel_type, in_ref_above, in_ref_left,
+                             dst, multi_ref_idx, isp_mode, cu_dim);
+    return;
+  }
+
+  // TODO: implement handling of MRL
+  uint8_t multi_ref_index = channel_type == COLOR_Y ? multi_ref_idx : 0;
+
+  uvg_pixel temp_main[ANGULAR_REF_BUFFER_SIZE] = { 0 };
+  uvg_pixel temp_side[ANGULAR_REF_BUFFER_SIZE] = { 0 };
+
+  const bool vertical_mode = intra_mode >= 34;
+  const int_fast8_t mode_disp = vertical_mode ? intra_mode - 50 : -(intra_mode - 18);
+
+  if (mode_disp < 0) {
+    memcpy(&temp_main[width], vertical_mode ? in_ref_above : in_ref_left, sizeof(uvg_pixel) * (width + 1 + multi_ref_index + 1));
+    memcpy(&temp_side[width], vertical_mode ? in_ref_left : in_ref_above, sizeof(uvg_pixel) * (width + 1 + multi_ref_index + 1));
+  }
+  else {
+    memcpy(temp_main, vertical_mode ? in_ref_above : in_ref_left, sizeof(uvg_pixel)* (width * 2 + multi_ref_index + 1));
+    memcpy(temp_side, vertical_mode ? in_ref_left : in_ref_above, sizeof(uvg_pixel)* (width * 2 + multi_ref_index + 1));
+
+    const int s = 0;
+    const int max_index = (multi_ref_index << s) + 2;
+    const int ref_length = width << 1;
+    const uvg_pixel val = temp_main[ref_length + multi_ref_index];
+    memset(temp_main + ref_length + multi_ref_index, val, max_index + 1);
+  }
+
+  angular_pred_from_refs_avx2(width, height, intra_mode, channel_type, temp_main, temp_side, dst, multi_ref_index);
+}
+
+
+/**
+ * \brief Generate luma angular predictions for several modes.
+ *
+ * The reference buffers are built once for all negative angles and once per
+ * direction for the positive angles. Only square blocks are handled here,
+ * other shapes use the generic implementation.
+ *
+ * \param cu_loc        CU location and size data.
+ * \param intra_modes   Wide angle corrected angular modes.
+ * \param num_modes     Number of modes in intra_modes.
+ * \param in_ref_above  Pointer to -1 index of above reference, length=width*2+1.
+ * \param in_ref_left   Pointer to -1 index of left reference, length=width*2+1.
+ * \param dst           Buffers of size width*width, one for each mode.
+ * \param multi_ref_idx Reference line index for use with MRL.
+ */
+static void uvg_angular_pred_multi_avx2(
+  const cu_loc_t* const cu_loc,
+  const int8_t *const intra_modes,
+  const int num_modes,
+  const uvg_pixel *const in_ref_above,
+  const uvg_pixel *const in_ref_left,
+  uvg_pixel *const *const dst,
+  const uint8_t multi_ref_idx)
+{
+  const int width = cu_loc->width;
+  if (width != cu_loc->height) {
+    uvg_angular_pred_multi_generic(cu_loc, intra_modes, num_modes, in_ref_above, in_ref_left, dst, multi_ref_idx);
+    return;
+  }
+
+  // Negative angles, positive vertical angles and positive horizontal angles.
+  uvg_pixel temp_above[3][ANGULAR_REF_BUFFER_SIZE];
+  uvg_pixel temp_left[3][ANGULAR_REF_BUFFER_SIZE];
+  bool initialized[3] = { false, false, false };
+
+  for (int i = 0; i < num_modes; ++i) {
+    const int_fast8_t intra_mode = intra_modes[i];
+    const bool vertical_mode = intra_mode >= 34;
+    const int_fast8_t mode_disp = vertical_mode ? intra_mode - 50 : -(intra_mode - 18);
+    const int group = mode_disp < 0 ? 0 : (vertical_mode ? 1 : 2);
+    uvg_pixel *const above = temp_above[group];
+    uvg_pixel *const left = temp_left[group];
+
+    if (!initialized[group]) {
+      memset(above, 0, ANGULAR_REF_BUFFER_SIZE * sizeof(uvg_pixel));
+      memset(left, 0, ANGULAR_REF_BUFFER_SIZE * sizeof(uvg_pixel));
+      if (group == 0) {
+        memcpy(&above[width], in_ref_above, sizeof(uvg_pixel) * (width + 1 + multi_ref_idx + 1));
+        memcpy(&left[width], in_ref_left, sizeof(uvg_pixel) * (width + 1 + multi_ref_idx + 1));
+      }
+      else {
+        memcpy(above, in_ref_above, sizeof(uvg_pixel) * (width * 2 + multi_ref_idx + 1));
+        memcpy(left, in_ref_left, sizeof(uvg_pixel) * (width * 2 + multi_ref_idx + 1));
+
+        uvg_pixel *const ref_main = vertical_mode ? above : left;
+        const int max_index = multi_ref_idx + 2;
+        const int ref_length = width << 1;
+        const uvg_pixel val = ref_main[ref_length + multi_ref_idx];
+        memset(ref_main + ref_length + multi_ref_idx, val, max_index + 1);
+      }
+      initialized[group] = true;
+    }
+
+    angular_pred_from_refs_avx2(width, width, intra_mode, COLOR_Y,
+                                vertical_mode ? above : left,
+                                vertical_mode ? left : above,
+                                dst[i], multi_ref_idx);
+  }
+}
+
 /**
  * \brief Generate planar prediction.
  * \param cu_loc        CU location and size data.
  * \param color         Color channel.
  * \param in_ref_above  Pointer to -1 index of above reference, length=width*2+1.
- * \param in_ref_left   Pointer to -1 index of left reference, length=width*2+1.
- * \param dst           Buffer of size width*width.
+ * \param in_ref_left   Pointer to -1 index of left reference, length=height*2+1.
+ * \param dst           Buffer of size width*height.
  */
 static void uvg_intra_pred_planar_avx2(
   const cu_loc_t* const cu_loc,
@@ -516,24 +635,29 @@ static void uvg_intra_pred_planar_avx2(
   const uint8_t *const ref_left,
   uint8_t *const dst)
 {
-  // ISP_TODO: non-square block implementation, height is passed but not used
   const int width = color == COLOR_Y ? cu_loc->width : cu_loc->chroma_width;
   const int height = color == COLOR_Y ? cu_loc->height : cu_loc->chroma_height;
   const int log2_width =  uvg_g_convert_to_log2[width];
   const int log2_height = uvg_g_convert_to_log2[height];
 
-  assert((log2_width >= 2 && log2_width <= 5) && (log2_height >= 2 && log2_height <= 5));
+  // If ISP is enabled log_dim 1 is possible (limit was previously 2)
+  assert((log2_width >= 2 && log2_width <= 5) && log2_height <= 5);
 
   const uint8_t top_right = ref_top[width + 1];
-  const uint8_t bottom_left = ref_left[width + 1];
+  const uint8_t bottom_left = ref_left[height + 1];
 
-  if (log2_width > 2) {
-    
-    __m128i v_width = _mm_set1_epi16(width);
-    __m128i v_top_right = _mm_set1_epi16(top_right);
-    __m128i v_bottom_left = _mm_set1_epi16(bottom_left);
+  if (width != 4 || height != 4) {
+    const __m128i v_width = _mm_set1_epi16(width);
+    const __m128i v_height = _mm_set1_epi16(height);
+    const __m128i v_top_right = _mm_set1_epi16(top_right);
+    const __m128i v_bottom_left = _mm_set1_epi16(bottom_left);
+    // The horizontal and vertical terms are weighted by height and width
+    // in 32 bits, the sums do not fit in 16 bits for rectangular blocks.
+    const __m128i weights = _mm_set1_epi32((width << 16) | height);
+    const __m128i offset = _mm_set1_epi32(1 << (log2_width + log2_height));
+    const int final_shift = 1 + log2_width + log2_height;
 
-    for (int y = 0; y < width; ++y) {
+    for (int y = 0; y < height; ++y) {
 
       __m128i x_plus_1 = _mm_setr_epi16(-7, -6, -5, -4, -3, -2, -1, 0);
       __m128i v_ref_left = _mm_set1_epi16(ref_left[y + 1]);
@@ -545,18 +669,25 @@ static void uvg_intra_pred_planar_avx2(
         v_ref_top = _mm_cvtepu8_epi16(v_ref_top);
 
         __m128i hor = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(v_width, x_plus_1), v_ref_left), _mm_mullo_epi16(x_plus_1, v_top_right));
-        __m128i ver = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(v_width, y_plus_1), v_ref_top), _mm_mullo_epi16(y_plus_1, v_bottom_left));
+        __m128i ver = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(v_height, y_plus_1), v_ref_top), _mm_mullo_epi16(y_plus_1, v_bottom_left));
 
-        //dst[y * width + x] = ho
+        __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(hor, ver), weights);
+        __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(hor, ver), weights);
+        lo = _mm_srli_epi32(_mm_add_epi32(lo, offset), final_shift);
+        hi = _mm_srli_epi32(_mm_add_epi32(hi, offset), final_shift);
 
-        __m128i chunk = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(ver, hor), v_width), (log2_width + 1));
+        __m128i chunk = _mm_packs_epi32(lo, hi);
         chunk = _mm_packus_epi16(chunk, chunk);
-        _mm_storel_epi64((__m128i*)&(dst[y * width + x]), chunk);
+        if (width == 4) {
+          *(int32_t*)&(dst[y * width + x]) = _mm_cvtsi128_si32(chunk);
+        } else {
+          _mm_storel_epi64((__m128i*)&(dst[y * width + x]), chunk);
+        }
       }
     }
   } else {
-    // Only if log2_width == 2 <=> width == 4
-    assert(width == 4);
+    // Only 4x4 blocks
+    assert(width == 4 && height == 4);
     const __m128i rl_shufmask = _mm_setr_epi32(0x04040404, 0x05050505,
                                                0x06060606, 0x07070707);
 
@@ -970,10 +1101,9 @@ static void uvg_intra_pred_filtered_dc_avx2(
 
 /**
 * \brief Position Dependent Prediction Combination for Planar and DC modes.
-* \param log2_width    Log2 of width, range 2..5.
-* \param width         Block width matching log2_width.
+* \param cu_loc        CU location and size data.
 * \param used_ref      Pointer used reference pixel struct.
-* \param dst           Buffer of size width*width.
+* \param dst           Buffer of size width*height.
 */
 static void uvg_pdpc_planar_dc_avx2(
   const int mode,
@@ -982,7 +1112,6 @@ static void uvg_pdpc_planar_dc_avx2(
   const uvg_intra_ref *const used_ref,
   uvg_pixel *const dst)
 {
-  // ISP_TODO: non-square block implementation, height is passed but not used
   assert(mode == 0 || mode == 1);  // planar or DC
   const int width = color == COLOR_Y ? cu_loc->width : cu_loc->chroma_width;
   const int height = color == COLOR_Y ? cu_loc->height : cu_loc->chroma_height;
@@ -1003,12 +1132,11 @@ static void uvg_pdpc_planar_dc_avx2(
     6, 7, 6, 7, 6, 7, 6, 7
   );
 
-  // TODO: replace latter log2_width with log2_height
-  const int scale = ((log2_width - 2 + log2_width - 2 + 2) >> 2);
+  const int scale = ((log2_width - 2 + log2_height - 2 + 2) >> 2);
 
   // Same weights regardless of axis, compute once
   int16_t w[LCU_WIDTH];
-  for (int i = 0; i < width; i += 4) {
+  for (int i = 0; i < MAX(width, height); i += 4) {
     __m128i base = _mm_set1_epi32(i);
     __m128i offs = _mm_setr_epi32(0, 1, 2, 3);
     __m128i idxs = _mm_add_epi32(base, offs);
@@ -1021,8 +1149,7 @@ static void uvg_pdpc_planar_dc_avx2(
   }
 
   // Process in 4x4 blocks
-  // TODO: replace width with height
-  for (int y = 0; y < width; y += 4) {
+  for (int y = 0; y < height; y += 4) {
     for (int x = 0; x < width; x += 4) {
 
       uint32_t dw_left;
@@ -1066,6 +1193,377 @@ static void uvg_pdpc_planar_dc_avx2(
   }
 }
 
+#else // UVG_BIT_DEPTH == 8
+
+#include <immintrin.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cu.h"
+#include "intra.h"
+#include "strategyselector.h"
+#include "uvg_math.h"
+
+/*
+ * Angular and planar prediction for 16-bit uvg_pixel. The sample arithmetic
+ * follows intra-generic.c exactly; products of samples and weights are
+ * formed with madd_epi16 so they are not limited to 16 bits.
+ */
+
+static INLINE __m128i clip_pack_epi32_16bit(__m128i lo, __m128i hi)
+{
+  return _mm_min_epu16(_mm_packus_epi32(lo, hi), _mm_set1_epi16(PIXEL_MAX));
+}
+
+/**
+ * \brief Interpolate one row of an angular prediction with a 4-tap filter.
+ *
+ * dst[x] = clip((f[0] * ref[x] + f[1] * ref[x + 1] + f[2] * ref[x + 2] + f[3] * ref[x + 3] + 32) >> 6)
+ */
+static INLINE void filter_4tap_row_16bit_avx2(const uvg_pixel *ref, const int16_t f[4], uvg_pixel *dst, int width)
+{
+  const __m256i w01 = _mm256_set1_epi32((uint16_t)f[0] | ((uint32_t)(uint16_t)f[1] << 16));
+  const __m256i w23 = _mm256_set1_epi32((uint16_t)f[2] | ((uint32_t)(uint16_t)f[3] << 16));
+  const __m256i round = _mm256_set1_epi32(32);
+
+  int x = 0;
+  for (; x + 8 <= width; x += 8) {
+    const __m128i p0 = _mm_loadu_si128((const __m128i *)&ref[x + 0]);
+    const __m128i p1 = _mm_loadu_si128((const __m128i *)&ref[x + 1]);
+    const __m128i p2 = _mm_loadu_si128((const __m128i *)&ref[x + 2]);
+    const __m128i p3 = _mm_loadu_si128((const __m128i *)&ref[x + 3]);
+    const __m256i p01 = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi16(p0, p1)), _mm_unpackhi_epi16(p0, p1), 1);
+    const __m256i p23 = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi16(p2, p3)), _mm_unpackhi_epi16(p2, p3), 1);
+
+    __m256i sum = _mm256_add_epi32(_mm256_madd_epi16(p01, w01), _mm256_madd_epi16(p23, w23));
+    sum = _mm256_srai_epi32(_mm256_add_epi32(sum, round), 6);
+
+    const __m128i out = clip_pack_epi32_16bit(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    _mm_storeu_si128((__m128i *)&dst[x], out);
+  }
+  for (; x + 4 <= width; x += 4) {
+    const __m128i p0 = _mm_loadl_epi64((const __m128i *)&ref[x + 0]);
+    const __m128i p1 = _mm_loadl_epi64((const __m128i *)&ref[x + 1]);
+    const __m128i p2 = _mm_loadl_epi64((const __m128i *)&ref[x + 2]);
+    const __m128i p3 = _mm_loadl_epi64((const __m128i *)&ref[x + 3]);
+
+    __m128i sum = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(p0, p1), _mm256_castsi256_si128(w01)),
+                                _mm_madd_epi16(_mm_unpacklo_epi16(p2, p3), _mm256_castsi256_si128(w23)));
+    sum = _mm_srai_epi32(_mm_add_epi32(sum, _mm256_castsi256_si128(round)), 6);
+
+    _mm_storel_epi64((__m128i *)&dst[x], clip_pack_epi32_16bit(sum, sum));
+  }
+  for (; x < width; ++x) {
+    const int32_t sum = f[0] * ref[x] + f[1] * ref[x + 1] + f[2] * ref[x + 2] + f[3] * ref[x + 3];
+    dst[x] = CLIP_TO_PIXEL((sum + 32) >> 6);
+  }
+}
+
+/**
+ * \brief Transpose a block of src_w x src_h samples into dst.
+ */
+static INLINE void transpose_block_16bit_avx2(const uvg_pixel *src, int src_w, int src_h, uvg_pixel *dst)
+{
+  if (src_w % 4 != 0 || src_h % 4 != 0) {
+    for (int y = 0; y < src_h; ++y) {
+      for (int x = 0; x < src_w; ++x) {
+        dst[x * src_h + y] = src[y * src_w + x];
+      }
+    }
+    return;
+  }
+
+  for (int y = 0; y < src_h; y += 4) {
+    for (int x = 0; x < src_w; x += 4) {
+      const __m128i r0 = _mm_loadl_epi64((const __m128i *)&src[(y + 0) * src_w + x]);
+      const __m128i r1 = _mm_loadl_epi64((const __m128i *)&src[(y + 1) * src_w + x]);
+      const __m128i r2 = _mm_loadl_epi64((const __m128i *)&src[(y + 2) * src_w + x]);
+      const __m128i r3 = _mm_loadl_epi64((const __m128i *)&src[(y + 3) * src_w + x]);
+      const __m128i r01 = _mm_unpacklo_epi16(r0, r1);
+      const __m128i r23 = _mm_unpacklo_epi16(r2, r3);
+      const __m128i c01 = _mm_unpacklo_epi32(r01, r23);
+      const __m128i c23 = _mm_unpackhi_epi32(r01, r23);
+      _mm_storel_epi64((__m128i *)&dst[(x + 0) * src_h + y], c01);
+      _mm_storel_epi64((__m128i *)&dst[(x + 1) * src_h + y], _mm_unpackhi_epi64(c01, c01));
+      _mm_storel_epi64((__m128i *)&dst[(x + 2) * src_h + y], c23);
+      _mm_storel_epi64((__m128i *)&dst[(x + 3) * src_h + y], _mm_unpackhi_epi64(c23, c23));
+    }
+  }
+}
+
+/**
+ * \brief Generate angular predictions.
+ * \param cu_loc        CU location and size data.
+ * \param intra_mode    Angular mode in range 2..66.
+ * \param channel_type  Color channel.
+ * \param in_ref_above  Pointer to -1 index of above reference.
+ * \param in_ref_left   Pointer to -1 index of left reference.
+ * \param dst           Buffer of size width*height.
+ * \param multi_ref_idx Reference line index for use with MRL.
+ * \param isp_mode      ISP split direction.
+ * \param cu_dim        Size of the CU the ISP partitions belong to.
+ */
+static void uvg_angular_pred_16bit_avx2(
+  const cu_loc_t* const cu_loc,
+  const int_fast8_t intra_mode,
+  const int_fast8_t channel_type,
+  const uvg_pixel *const in_ref_above,
+  const uvg_pixel *const in_ref_left,
+  uvg_pixel *const dst,
+  const uint8_t multi_ref_idx,
+  const uint8_t isp_mode,
+  const int cu_dim)
+{
+  int width  = channel_type == COLOR_Y ? cu_loc->width : cu_loc->chroma_width;
+  int height = channel_type == COLOR_Y ? cu_loc->height : cu_loc->chroma_height;
+  const int log2_width  = uvg_g_convert_to_log2[width];
+  const int log2_height = uvg_g_convert_to_log2[height];
+
+  assert((log2_width >= 2 && log2_width <= 5) && log2_height <= 5);
+
+  static const int16_t modedisp2sampledisp[32] = { 0,    1,    2,    3,    4,    6,     8,   10,   12,   14,   16,   18,   20,   23,   26,   29,   32,   35,   39,  45,  51,  57,  64,  73,  86, 102, 128, 171, 256, 341, 512, 1024 };
+  static const int16_t modedisp2invsampledisp[32] = { 0, 16384, 8192, 5461, 4096, 2731, 2048, 1638, 1365, 1170, 1024, 910, 819, 712, 630, 565, 512, 468, 420, 364, 321, 287, 256, 224, 191, 161, 128, 96, 64, 48, 32, 16 }; // (512 * 32) / sampledisp
+  static const int32_t pre_scale[] = { 8, 7, 6, 5, 5, 4, 4, 4, 3, 3, 3, 3, 3, 3, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 0, 0, 0, -1, -1, -2, -3 };
+
+  static const int16_t cubic_filter[32][4] =
+  {
+    { 0, 64,  0,  0 },
+    { -1, 63,  2,  0 },
+    { -2, 62,  4,  0 },
+    { -2, 60,  7, -1 },
+    { -2, 58, 10, -2 },
+    { -3, 57, 12, -2 },
+    { -4, 56, 14, -2 },
+    { -4, 55, 15, -2 },
+    { -4, 54, 16, -2 },
+    { -5, 53, 18, -2 },
+    { -6, 52, 20, -2 },
+    { -6, 49, 24, -3 },
+    { -6, 46, 28, -4 },
+    { -5, 44, 29, -4 },
+    { -4, 42, 30, -4 },
+    { -4, 39, 33, -4 },
+    { -4, 36, 36, -4 },
+    { -4, 33, 39, -4 },
+    { -4, 30, 42, -4 },
+    { -4, 29, 44, -5 },
+    { -4, 28, 46, -6 },
+    { -3, 24, 49, -6 },
+    { -2, 20, 52, -6 },
+    { -2, 18, 53, -5 },
+    { -2, 16, 54, -4 },
+    { -2, 15, 55, -4 },
+    { -2, 14, 56, -4 },
+    { -2, 12, 57, -3 },
+    { -2, 10, 58, -2 },
+    { -1,  7, 60, -2 },
+    { 0,  4, 62, -2 },
+    { 0,  2, 63, -1 },
+  };
+
+  // Horizontal modes are predicted transposed into temp_dst and flipped
+  // into dst at the end.
+  ALIGNED(32) uvg_pixel temp_dst[TR_MAX_WIDTH * TR_MAX_WIDTH];
+
+  uvg_pixel temp_above[2 * 128 + 3 + 33 * MAX_REF_LINE_IDX] = { 0 };
+  uvg_pixel temp_left[2 * 128 + 3 + 33 * MAX_REF_LINE_IDX] = { 0 };
+
+  const int32_t pred_mode = intra_mode;
+  const uint8_t multi_ref_index = multi_ref_idx;
+
+  // Whether to swap references to always project on the left reference row.
+  const bool vertical_mode = intra_mode >= 34;
+  // Modes distance to horizontal or vertical mode.
+  const int_fast8_t mode_disp = vertical_mode ? pred_mode - 50 : -(pred_mode - 18);
+
+  // Sample displacement per column in fractions of 32.
+  const int16_t sample_disp = (mode_disp < 0 ? -1 : 1) * modedisp2sampledisp[abs(mode_disp)];
+
+  const int side_size = vertical_mode ? log2_height : log2_width;
+  const int scale = MIN(2, side_size - pre_scale[abs(mode_disp)]);
+
+  // Pointer for the reference we are interpolating from.
+  uvg_pixel *ref_main;
+  // Pointer for the other reference.
+  const uvg_pixel *ref_side;
+  uvg_pixel *work = vertical_mode ? dst : temp_dst;
+
+  const int top_ref_length  = isp_mode == ISP_MODE_VER ? width + cu_dim  : width << 1;
+  const int left_ref_length = isp_mode == ISP_MODE_HOR ? height + cu_dim : height << 1;
+
+  // Set ref_main and ref_side such that, when indexed with 0, they point to
+  // index 0 in block coordinates.
+  if (sample_disp < 0) {
+    memcpy(&temp_above[height], &in_ref_above[0], (width + 2 + multi_ref_index) * sizeof(uvg_pixel));
+    memcpy(&temp_left[width], &in_ref_left[0], (height + 2 + multi_ref_index) * sizeof(uvg_pixel));
+
+    ref_main = vertical_mode ? temp_above + height : temp_left + width;
+    ref_side = vertical_mode ? temp_left + width : temp_above + height;
+
+    const int size_side = vertical_mode ? height : width;
+    for (int i = -size_side; i <= -1; i++) {
+      ref_main[i] = ref_side[MIN((-i * modedisp2invsampledisp[abs(mode_disp)] + 256) >> 9, size_side)];
+    }
+  } else {
+    memcpy(&temp_above[0], &in_ref_above[0], (top_ref_length + 1 + multi_ref_index) * sizeof(uvg_pixel));
+    memcpy(&temp_left[0], &in_ref_left[0], (left_ref_length + 1 + multi_ref_index) * sizeof(uvg_pixel));
+
+    ref_main = vertical_mode ? temp_above : temp_left;
+    ref_side = vertical_mode ? temp_left : temp_above;
+
+    const int log2_ratio = log2_width - log2_height;
+    const int s = MAX(0, vertical_mode ? log2_ratio : -log2_ratio);
+    const int max_index = (multi_ref_index << s) + 2;
+    int ref_length;
+    if (isp_mode) {
+      ref_length = vertical_mode ? top_ref_length : left_ref_length;
+    } else {
+      ref_length = vertical_mode ? width << 1 : height << 1;
+    }
+    const uvg_pixel val = ref_main[ref_length + multi_ref_index];
+    for (int j = 1; j <= max_index; j++) {
+      ref_main[ref_length + multi_ref_index + j] = val;
+    }
+  }
+
+  // compensate for line offset in reference line buffers
+  ref_main += multi_ref_index;
+  ref_side += multi_ref_index;
+  if (!vertical_mode) { SWAP(width, height, int) }
+
+  if (sample_disp != 0) {
+    bool use_cubic = true; // Default to cubic filter
+    static const int uvg_intra_hor_ver_dist_thres[8] = { 24, 24, 24, 14, 2, 0, 0, 0 };
+    const int filter_threshold = uvg_intra_hor_ver_dist_thres[(log2_width + log2_height) >> 1];
+    const int dist_from_vert_or_hor = MIN(abs(pred_mode - 50), abs(pred_mode - 18));
+    if (dist_from_vert_or_hor > filter_threshold && (abs(sample_disp) & 0x1F) != 0) {
+      use_cubic = false;
+    }
+    // Cubic must be used if ref line != 0 or if isp mode is != 0
+    if (multi_ref_index || isp_mode) {
+      use_cubic = true;
+    }
+
+    bool pdpc_filter = (width >= TR_MIN_WIDTH && height >= TR_MIN_WIDTH) && multi_ref_index == 0;
+    if (mode_disp < 0) {
+      pdpc_filter = false;
+    } else if (mode_disp > 0) {
+      pdpc_filter &= (scale >= 0);
+    }
+
+    for (int_fast32_t y = 0, delta_pos = sample_disp * (1 + multi_ref_index); y < height; ++y, delta_pos += sample_disp) {
+      const int_fast32_t delta_int = delta_pos >> 5;
+      const int_fast32_t delta_fract = delta_pos & (32 - 1);
+      uvg_pixel *const row = &work[y * width];
+
+      if ((abs(sample_disp) & 0x1F) != 0) {
+        if (channel_type == 0) {
+          const int16_t filter_coeff[4] = { 16 - (delta_fract >> 1), 32 - (delta_fract >> 1), 16 + (delta_fract >> 1), delta_fract >> 1 };
+          filter_4tap_row_16bit_avx2(&ref_main[delta_int], use_cubic ? cubic_filter[delta_fract] : filter_coeff, row, width);
+        } else {
+          // Linear interpolation between ref_main[x + 1] and ref_main[x + 2]
+          // written as a 4-tap filter with twice the weights.
+          const int16_t linear[4] = { 0, 2 * (32 - delta_fract), 2 * delta_fract, 0 };
+          filter_4tap_row_16bit_avx2(&ref_main[delta_int], linear, row, width);
+        }
+      } else {
+        // Just copy the integer samples
+        memcpy(row, &ref_main[delta_int + 1], width * sizeof(uvg_pixel));
+      }
+
+      if (pdpc_filter) {
+        int inv_angle_sum = 256;
+        for (int x = 0; x < MIN(3 << scale, width); x++) {
+          inv_angle_sum += modedisp2invsampledisp[abs(mode_disp)];
+
+          const int wL = 32 >> (2 * x >> scale);
+          const uvg_pixel left = ref_side[y + (inv_angle_sum >> 9) + 1];
+          row[x] = row[x] + ((wL * (left - row[x]) + 32) >> 6);
+        }
+      }
+    }
+  } else {
+    // Mode is horizontal or vertical, just copy the pixels.
+    const bool do_pdpc = ((width >= 4 && height >= 4) && sample_disp >= 0 && multi_ref_index == 0);
+    const int pdpc_scale = (log2_width + log2_height - 2) >> 2;
+    const uvg_pixel top_left = ref_main[0];
+
+    for (int_fast32_t y = 0; y < height; ++y) {
+      uvg_pixel *const row = &work[y * width];
+      memcpy(row, &ref_main[1], width * sizeof(uvg_pixel));
+      if (do_pdpc) {
+        const uvg_pixel left = ref_side[1 + y];
+        for (int_fast32_t x = 0; x < MIN(3 << pdpc_scale, width); ++x) {
+          const int wL = 32 >> (2 * x >> pdpc_scale);
+          row[x] = CLIP_TO_PIXEL(row[x] + ((wL * (left - top_left) + 32) >> 6));
+        }
+      }
+    }
+  }
+
+  // Flip the block if this is was a horizontal mode.
+  if (!vertical_mode) {
+    transpose_block_16bit_avx2(work, width, height, dst);
+  }
+}
+
+/**
+ * \brief Generate planar prediction.
+ * \param cu_loc        CU location and size data.
+ * \param color         Color channel.
+ * \param ref_top       Pointer to -1 index of above reference.
+ * \param ref_left      Pointer to -1 index of left reference.
+ * \param dst           Buffer of size width*height.
+ */
+static void uvg_intra_pred_planar_16bit_avx2(
+  const cu_loc_t* const cu_loc,
+  color_t color,
+  const uvg_pixel *const ref_top,
+  const uvg_pixel *const ref_left,
+  uvg_pixel *const dst)
+{
+  const int width = color == COLOR_Y ? cu_loc->width : cu_loc->chroma_width;
+  const int height = color == COLOR_Y ? cu_loc->height : cu_loc->chroma_height;
+  const int log2_width  = uvg_g_convert_to_log2[width];
+  const int log2_height = uvg_g_convert_to_log2[height];
+
+  assert((log2_width >= 2 && log2_width <= 5) && log2_height <= 5);
+
+  const int final_shift = 1 + log2_width + log2_height;
+  const __m256i offset = _mm256_set1_epi32(1 << (log2_width + log2_height));
+  const __m256i top_right = _mm256_set1_epi32(ref_top[width + 1]);
+  const __m256i bottom_left = _mm256_set1_epi32(ref_left[height + 1]);
+
+  // Eight columns at a time, four for 4-wide blocks. The vertical term
+  // (height - 1 - y) * top[x] + (y + 1) * bottom_left is kept in 32-bit
+  // lanes and stepped by bottom_left - top[x] for each row.
+  for (int x = 0; x < width; x += 8) {
+    const __m128i top_16 = width == 4 ? _mm_loadl_epi64((const __m128i *)&ref_top[x + 1])
+                                      : _mm_loadu_si128((const __m128i *)&ref_top[x + 1]);
+    const __m256i top = _mm256_cvtepu16_epi32(top_16);
+    const __m256i bottom = _mm256_sub_epi32(bottom_left, top);
+    __m256i ver = _mm256_slli_epi32(top, log2_height);
+    const __m256i x_plus_1 = _mm256_add_epi32(_mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 8), _mm256_set1_epi32(x));
+
+    for (int y = 0; y < height; ++y) {
+      const int32_t left = ref_left[y + 1];
+      const __m256i hor = _mm256_add_epi32(_mm256_set1_epi32(left << log2_width),
+                                           _mm256_mullo_epi32(x_plus_1, _mm256_sub_epi32(top_right, _mm256_set1_epi32(left))));
+      ver = _mm256_add_epi32(ver, bottom);
+
+      __m256i sum = _mm256_add_epi32(_mm256_slli_epi32(hor, log2_height), _mm256_slli_epi32(ver, log2_width));
+      sum = _mm256_srli_epi32(_mm256_add_epi32(sum, offset), final_shift);
+      const __m128i out = _mm_packus_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+
+      if (width == 4) {
+        _mm_storel_epi64((__m128i *)&dst[y * width + x], out);
+      } else {
+        _mm_storeu_si128((__m128i *)&dst[y * width + x], out);
+      }
+    }
+  }
+}
+
 #endif //UVG_BIT_DEPTH == 8
 #endif //COMPILE_INTEL_AVX2 && defined X86_64
 
@@ -1076,10 +1574,16 @@ int uvg_strategy_register_intra_avx2(void* opaque, uint8_t bitdepth)
 #if UVG_BIT_DEPTH == 8
   if (bitdepth == 8) {
     success &= uvg_strategyselector_register(opaque, "angular_pred", "avx2", 40, &uvg_angular_pred_avx2);
+    success &= uvg_strategyselector_register(opaque, "angular_pred_multi", "avx2", 40, &uvg_angular_pred_multi_avx2);
     success &= uvg_strategyselector_register(opaque, "intra_pred_planar", "avx2", 40, &uvg_intra_pred_planar_avx2);
     success &= uvg_strategyselector_register(opaque, "intra_pred_filtered_dc", "avx2", 40, &uvg_intra_pred_filtered_dc_avx2);
     success &= uvg_strategyselector_register(opaque, "pdpc_planar_dc", "avx2", 40, &uvg_pdpc_planar_dc_avx2);
   }
+#else // UVG_BIT_DEPTH == 8
+  if (bitdepth > 8) {
+    success &= uvg_strategyselector_register(opaque, "angular_pred", "avx2", 40, &uvg_angular_pred_16bit_avx2);
+    success &= uvg_strategyselector_register(opaque, "intra_pred_planar", "avx2", 40, &uvg_intra_pred_planar_16bit_avx2);
+  }
 #endif //UVG_BIT_DEPTH == 8
 #endif //COMPILE_INTEL_AVX2 && defined X86_64
   return success;
@@ -245,6 +245,26 @@ static void uvg_ipol_8tap_hor_px_im_avx2(int8_t *filter,
   }
 }
 
+/**
+ * \brief Clip two rows of four filtered samples to pixels and store them.
+ *
+ * The low lane of sum holds the first row and the high lane the second.
+ */
+static INLINE void store_px_4x2_avx2(__m256i sum, uvg_pixel *dst_addr0, uvg_pixel *dst_addr1)
+{
+#if UVG_BIT_DEPTH == 8
+  sum = _mm256_packs_epi32(sum, sum);
+  sum = _mm256_packus_epi16(sum, sum);
+  *(uint32_t*)dst_addr0 = _mm_cvtsi128_si32(_mm256_castsi256_si128(sum));
+  *(uint32_t*)dst_addr1 = _mm_cvtsi128_si32(_mm256_extracti128_si256(sum, 1));
+#else
+  sum = _mm256_packus_epi32(sum, sum);
+  sum = _mm256_min_epu16(sum, _mm256_set1_epi16(PIXEL_MAX));
+  _mm_storel_epi64((__m128i*)dst_addr0, _mm256_castsi256_si128(sum));
+  _mm_storel_epi64((__m128i*)dst_addr1, _mm256_extracti128_si256(sum, 1));
+#endif
+}
+
 static void uvg_ipol_8tap_ver_im_px_avx2(int8_t *filter,
   int width,
   int height,
@@ -326,13 +346,7 @@ static void uvg_ipol_8tap_ver_im_px_avx2(int8_t *filter,
       sum = _mm256_srai_epi32(sum, shift2);
       sum = _mm256_add_epi32(sum, _mm256_set1_epi32(wp_offset1));
       sum = _mm256_srai_epi32(sum, wp_shift1);
-      sum = _mm256_packs_epi32(sum, sum);
-      sum = _mm256_packus_epi16(sum, sum);
-
-      uvg_pixel *dst_addr0 = &dst[(y + 0) * dst_stride + x];
-      uvg_pixel *dst_addr1 = &dst[(y + 1) * dst_stride + x];
-      *(uint32_t*)dst_addr0 = _mm_cvtsi128_si32(_mm256_castsi256_si128(sum));
-      *(uint32_t*)dst_addr1 = _mm_cvtsi128_si32(_mm256_extracti128_si256(sum, 1));
+      store_px_4x2_avx2(sum, &dst[(y + 0) * dst_stride + x], &dst[(y + 1) * dst_stride + x]);
     }
   }
 }
@@ -421,6 +435,7 @@ int16_t dst_stride)
   }
 }
 
+#if UVG_BIT_DEPTH == 8
 static void uvg_ipol_4tap_hor_px_im_avx2(int8_t *filter,
   int width,
   int height,
@@ -484,6 +499,7 @@ static void uvg_ipol_4tap_hor_px_im_avx2(int8_t *filter,
     }
   }
 }
+#endif // UVG_BIT_DEPTH == 8
 
 static void uvg_ipol_4tap_ver_im_px_avx2(int8_t *filter,
   int width,
@@ -548,13 +564,7 @@ static void uvg_ipol_4tap_ver_im_px_avx2(int8_t *filter,
       sum = _mm256_srai_epi32(sum, shift2);
       sum = _mm256_add_epi32(sum, _mm256_set1_epi32(wp_offset1));
       sum = _mm256_srai_epi32(sum, wp_shift1);
-      sum = _mm256_packs_epi32(sum, sum);
-      sum = _mm256_packus_epi16(sum, sum);
-
-      uvg_pixel *dst_addr0 = &dst[(y + 0) * dst_stride + x];
-      uvg_pixel *dst_addr1 = &dst[(y + 1) * dst_stride + x];
-      *(uint32_t*)dst_addr0 = _mm_cvtsi128_si32(_mm256_castsi256_si128(sum));
-      *(uint32_t*)dst_addr1 = _mm_cvtsi128_si32(_mm256_extracti128_si256(sum, 1));
+      store_px_4x2_avx2(sum, &dst[(y + 0) * dst_stride + x], &dst[(y + 1) * dst_stride + x]);
     }
   }
 }
@@ -1137,6 +1147,102 @@ static void uvg_filter_qpel_blocks_diag_luma_avx2(const encoder_control_t * enco
   }
 }
 
+#if UVG_BIT_DEPTH != 8
+/**
+ * \brief Filter eight samples of two rows of 16-bit pixels horizontally.
+ *
+ * Pairs of neighbouring samples are multiplied with pairs of taps, so the
+ * sums are kept in 32 bits. When half is set, only four samples per row are
+ * read and written.
+ */
+static INLINE void filter_hor_2x8_16bit_avx2(const int8_t *filter, int taps,
+                                             const uvg_pixel *src, int16_t src_stride,
+                                             int16_t *dst, int16_t dst_stride, bool half)
+{
+  const int shift1 = UVG_BIT_DEPTH - 8;
+
+  __m256i sum_lo = _mm256_setzero_si256();
+  __m256i sum_hi = _mm256_setzero_si256();
+  for (int k = 0; k < taps; k += 2) {
+    const uint32_t w = (uint16_t)filter[k] | ((uint32_t)(uint16_t)filter[k + 1] << 16);
+    const __m256i weights = _mm256_set1_epi32(w);
+    __m256i a;
+    __m256i b;
+    if (half) {
+      a = _mm256_castsi128_si256(_mm_loadl_epi64((__m128i*)&src[k]));
+      a = _mm256_inserti128_si256(a, _mm_loadl_epi64((__m128i*)&src[src_stride + k]), 1);
+      b = _mm256_castsi128_si256(_mm_loadl_epi64((__m128i*)&src[k + 1]));
+      b = _mm256_inserti128_si256(b, _mm_loadl_epi64((__m128i*)&src[src_stride + k + 1]), 1);
+    } else {
+      a = _mm256_castsi128_si256(_mm_loadu_si128((__m128i*)&src[k]));
+      a = _mm256_inserti128_si256(a, _mm_loadu_si128((__m128i*)&src[src_stride + k]), 1);
+      b = _mm256_castsi128_si256(_mm_loadu_si128((__m128i*)&src[k + 1]));
+      b = _mm256_inserti128_si256(b, _mm_loadu_si128((__m128i*)&src[src_stride + k + 1]), 1);
+    }
+    sum_lo = _mm256_add_epi32(sum_lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), weights));
+    sum_hi = _mm256_add_epi32(sum_hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), weights));
+  }
+  sum_lo = _mm256_srai_epi32(sum_lo, shift1);
+  sum_hi = _mm256_srai_epi32(sum_hi, shift1);
+  const __m256i sum = _mm256_packs_epi32(sum_lo, sum_hi);
+
+  if (half) {
+    _mm_storel_epi64((__m128i*)dst, _mm256_castsi256_si128(sum));
+    _mm_storel_epi64((__m128i*)(dst + dst_stride), _mm256_extracti128_si256(sum, 1));
+  } else {
+    _mm_storeu_si128((__m128i*)dst, _mm256_castsi256_si128(sum));
+    _mm_storeu_si128((__m128i*)(dst + dst_stride), _mm256_extracti128_si256(sum, 1));
+  }
+}
+
+static void uvg_ipol_8tap_hor_px_im_16bit_avx2(int8_t *filter,
+  int width,
+  int height,
+  uvg_pixel *src,
+  int16_t src_stride,
+  int16_t *dst,
+  int16_t dst_stride)
+{
+  uvg_pixel *top_left = src - src_stride * UVG_LUMA_FILTER_OFFSET - UVG_LUMA_FILTER_OFFSET;
+
+  for (int y = 0; y < height + UVG_EXT_PADDING_LUMA; y += 2) {
+    int x = 0;
+    for (; x + 7 < width; x += 8) {
+      filter_hor_2x8_16bit_avx2(filter, 8, top_left + src_stride * y + x, src_stride,
+                                dst + y * dst_stride + x, dst_stride, false);
+    }
+    if (x < width) {
+      filter_hor_2x8_16bit_avx2(filter, 8, top_left + src_stride * y + x, src_stride,
+                                dst + y * dst_stride + x, dst_stride, true);
+    }
+  }
+}
+
+static void uvg_ipol_4tap_hor_px_im_16bit_avx2(int8_t *filter,
+  int width,
+  int height,
+  uvg_pixel *src,
+  int16_t src_stride,
+  int16_t *dst,
+  int16_t dst_stride)
+{
+  uvg_pixel *top_left = src - src_stride * UVG_CHROMA_FILTER_OFFSET - UVG_CHROMA_FILTER_OFFSET;
+
+  for (int y = 0; y < height + UVG_EXT_PADDING_CHROMA; y += 2) {
+    int x = 0;
+    for (; x + 7 < width; x += 8) {
+      filter_hor_2x8_16bit_avx2(filter, 4, top_left + src_stride * y + x, src_stride,
+                                dst + y * dst_stride + x, dst_stride, false);
+    }
+    if (x < width) {
+      filter_hor_2x8_16bit_avx2(filter, 4, top_left + src_stride * y + x, src_stride,
+                                dst + y * dst_stride + x, dst_stride, true);
+    }
+  }
+}
+
+#endif // UVG_BIT_DEPTH != 8
+
 static void uvg_sample_quarterpel_luma_avx2(const encoder_control_t * const encoder,
   uvg_pixel *src, 
   int16_t src_stride, 
@@ -1157,7 +1263,11 @@ static void uvg_sample_quarterpel_luma_avx2(const encoder_control_t * const enco
   ALIGNED(64) int16_t hor_intermediate[UVG_IPOL_MAX_IM_SIZE_LUMA_SIMD];
   int16_t hor_stride = LCU_WIDTH;
 
+#if UVG_BIT_DEPTH == 8
   uvg_ipol_8tap_hor_px_im_avx2(hor_fir, width, height, src, src_stride, hor_intermediate, hor_stride);
+#else
+  uvg_ipol_8tap_hor_px_im_16bit_avx2(hor_fir, width, height, src, src_stride, hor_intermediate, hor_stride);
+#endif
   uvg_ipol_8tap_ver_im_px_avx2(ver_fir, width, height, hor_intermediate, hor_stride, dst, dst_stride);
 }
 
@@ -1182,7 +1292,11 @@ static void uvg_sample_quarterpel_luma_hi_avx2(const encoder_control_t * const e
   ALIGNED(64) int16_t hor_intermediate[UVG_IPOL_MAX_IM_SIZE_LUMA_SIMD];
   int16_t hor_stride = LCU_WIDTH;
 
+#if UVG_BIT_DEPTH == 8
   uvg_ipol_8tap_hor_px_im_avx2(hor_fir, width, height, src, src_stride, hor_intermediate, hor_stride);
+#else
+  uvg_ipol_8tap_hor_px_im_16bit_avx2(hor_fir, width, height, src, src_stride, hor_intermediate, hor_stride);
+#endif
   uvg_ipol_8tap_ver_im_hi_avx2(ver_fir, width, height, hor_intermediate, hor_stride, dst, dst_stride);
 }
 
@@ -1211,7 +1325,11 @@ static void uvg_sample_octpel_chroma_avx2(const encoder_control_t *const encoder
   ALIGNED(64) int16_t hor_intermediate[UVG_IPOL_MAX_IM_SIZE_CHROMA_SIMD];
   int16_t hor_stride = LCU_WIDTH_C;
 
+#if UVG_BIT_DEPTH == 8
   uvg_ipol_4tap_hor_px_im_avx2(hor_fir, width, height, src, src_stride, hor_intermediate, hor_stride);
+#else
+  uvg_ipol_4tap_hor_px_im_16bit_avx2(hor_fir, width, height, src, src_stride, hor_intermediate, hor_stride);
+#endif
   uvg_ipol_4tap_ver_im_px_avx2(ver_fir, width, height, hor_intermediate, hor_stride, dst, dst_stride);
 }
 
@@ -1239,10 +1357,95 @@ static void uvg_sample_octpel_chroma_hi_avx2(const encoder_control_t *const enco
   ALIGNED(64) int16_t hor_intermediate[UVG_IPOL_MAX_IM_SIZE_CHROMA_SIMD];
   int16_t hor_stride = LCU_WIDTH_C;
 
+#if UVG_BIT_DEPTH == 8
   uvg_ipol_4tap_hor_px_im_avx2(hor_fir, width, height, src, src_stride, hor_intermediate, hor_stride);
+#else
+  uvg_ipol_4tap_hor_px_im_16bit_avx2(hor_fir, width, height, src, src_stride, hor_intermediate, hor_stride);
+#endif
   uvg_ipol_4tap_ver_im_hi_avx2(ver_fir, width, height, hor_intermediate, hor_stride, dst, dst_stride);
 }
 
+#if UVG_BIT_DEPTH == 8
+static INLINE void fill_row_avx2(uint8_t *dst, uint8_t value, int n)
+{
+  const __m256i v = _mm256_set1_epi8((char)value);
+  if (n >= 32) {
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+      _mm256_storeu_si256((__m256i *)&dst[i], v);
+    }
+    // Cover the rest with an overlapping store.
+    if (i < n) _mm256_storeu_si256((__m256i *)&dst[n - 32], v);
+  } else if (n >= 16) {
+    _mm_storeu_si128((__m128i *)dst, _mm256_castsi256_si128(v));
+    _mm_storeu_si128((__m128i *)&dst[n - 16], _mm256_castsi256_si128(v));
+  } else if (n >= 8) {
+    _mm_storel_epi64((__m128i *)dst, _mm256_castsi256_si128(v));
+    _mm_storel_epi64((__m128i *)&dst[n - 8], _mm256_castsi256_si128(v));
+  } else if (n >= 4) {
+    const uint32_t v4 = value * 0x01010101u;
+    memcpy(dst, &v4, 4);
+    memcpy(&dst[n - 4], &v4, 4);
+  } else {
+    for (int i = 0; i < n; ++i) dst[i] = value;
+  }
+}
+
+static INLINE void copy_row_avx2(uint8_t *dst, const uint8_t *src, int n)
+{
+  if (n >= 32) {
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+      _mm256_storeu_si256((__m256i *)&dst[i], _mm256_loadu_si256((const __m256i *)&src[i]));
+    }
+    // Cover the rest with an overlapping load and store.
+    if (i < n) {
+      _mm256_storeu_si256((__m256i *)&dst[n - 32], _mm256_loadu_si256((const __m256i *)&src[n - 32]));
+    }
+  } else if (n >= 16) {
+    _mm_storeu_si128((__m128i *)dst, _mm_loadu_si128((const __m128i *)src));
+    _mm_storeu_si128((__m128i *)&dst[n - 16], _mm_loadu_si128((const __m128i *)&src[n - 16]));
+  } else if (n >= 8) {
+    _mm_storel_epi64((__m128i *)dst, _mm_loadl_epi64((const __m128i *)src));
+    _mm_storel_epi64((__m128i *)&dst[n - 8], _mm_loadl_epi64((const __m128i *)&src[n - 8]));
+  } else if (n >= 4) {
+    uint32_t head, tail;
+    memcpy(&head, src, 4);
+    memcpy(&tail, &src[n - 4], 4);
+    memcpy(dst, &head, 4);
+    memcpy(&dst[n - 4], &tail, 4);
+  } else {
+    for (int i = 0; i < n; ++i) dst[i] = src[i];
+  }
+}
+
+static void copy_extended_block_avx2(const uvg_pixel *src, int src_w, int src_h, int src_s,
+                                     int blk_x, int blk_y, int blk_w, int blk_h,
+                                     uvg_pixel *dst, int dst_s)
+{
+  const int cnt_l = CLIP(0, blk_w, -blk_x);
+  const int cnt_r = CLIP(0, blk_w - cnt_l, blk_x + blk_w - src_w);
+  const int cnt_m = blk_w - cnt_l - cnt_r;
+
+  if (cnt_l == 0 && cnt_r == 0) {
+    // Only rows need to be replicated.
+    for (int y = 0; y < blk_h; ++y) {
+      const uvg_pixel *row = &src[CLIP(0, src_h - 1, blk_y + y) * src_s];
+      copy_row_avx2(&dst[y * dst_s], &row[blk_x], blk_w);
+    }
+    return;
+  }
+
+  for (int y = 0; y < blk_h; ++y) {
+    const uvg_pixel *row = &src[CLIP(0, src_h - 1, blk_y + y) * src_s];
+    uvg_pixel *out = &dst[y * dst_s];
+    if (cnt_l) fill_row_avx2(out, row[0], cnt_l);
+    if (cnt_m) copy_row_avx2(&out[cnt_l], &row[blk_x + cnt_l], cnt_m);
+    if (cnt_r) fill_row_avx2(&out[cnt_l + cnt_m], row[src_w - 1], cnt_r);
+  }
+}
+#endif // UVG_BIT_DEPTH == 8
+
 #endif //COMPILE_INTEL_AVX2 && defined X86_64
 
 int uvg_strategy_register_ipol_avx2(void* opaque, uint8_t bitdepth)
@@ -1254,10 +1457,15 @@ int uvg_strategy_register_ipol_avx2(void* opaque, uint8_t bitdepth)
     success &= uvg_strategyselector_register(opaque, "filter_hpel_blocks_diag_luma", "avx2", 40, &uvg_filter_hpel_blocks_diag_luma_avx2);
     success &= uvg_strategyselector_register(opaque, "filter_qpel_blocks_hor_ver_luma", "avx2", 40, &uvg_filter_qpel_blocks_hor_ver_luma_avx2);
     success &= uvg_strategyselector_register(opaque, "filter_qpel_blocks_diag_luma", "avx2", 40, &uvg_filter_qpel_blocks_diag_luma_avx2);
+  }
+  if (bitdepth == UVG_BIT_DEPTH) {
     success &= uvg_strategyselector_register(opaque, "sample_quarterpel_luma", "avx2", 40, &uvg_sample_quarterpel_luma_avx2);
     success &= uvg_strategyselector_register(opaque, "sample_octpel_chroma", "avx2", 40, &uvg_sample_octpel_chroma_avx2);
     success &= uvg_strategyselector_register(opaque, "sample_quarterpel_luma_hi", "avx2", 40, &uvg_sample_quarterpel_luma_hi_avx2);
     success &= uvg_strategyselector_register(opaque, "sample_octpel_chroma_hi", "avx2", 40, &uvg_sample_octpel_chroma_hi_avx2);
+#if UVG_BIT_DEPTH == 8
+    success &= uvg_strategyselector_register(opaque, "copy_extended_block", "avx2", 40, &copy_extended_block_avx2);
+#endif // UVG_BIT_DEPTH == 8
   }
 #endif //COMPILE_INTEL_AVX2 && defined X86_64
   return success;
@@ -46,6 +46,7 @@
 #include <emmintrin.h>
 #include <mmintrin.h>
 #include <xmmintrin.h>
+#include <math.h>
 #include <string.h>
 #include "strategies/strategies-picture.h"
 #include "strategyselector.h"
@@ -714,11 +715,237 @@ SATD_NXN_DUAL_AVX2(64)
 SATD_ANY_SIZE_MULTI_AVX2(quad_avx2, 4)
 
 
+/**
+ * \brief  Load 16 samples of a block in raster order, widened to 16 bits.
+ *
+ * Rows narrower than 16 samples are packed together, so one load covers
+ * one row of 16, two rows of 8 or four rows of 4 samples.
+ */
+static INLINE __m256i load_16_px_raster_avx2(const uint8_t *buf, int stride, int width)
+{
+  __m128i px;
+  if (width >= 16) {
+    px = _mm_loadu_si128((const __m128i*)buf);
+  } else if (width == 8) {
+    px = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)buf),
+                            _mm_loadl_epi64((const __m128i*)(buf + stride)));
+  } else {
+    px = _mm_setr_epi32(*(const int32_t*)(buf + 0 * stride), *(const int32_t*)(buf + 1 * stride),
+                        *(const int32_t*)(buf + 2 * stride), *(const int32_t*)(buf + 3 * stride));
+  }
+  return _mm256_cvtepu8_epi16(px);
+}
+
+static INLINE void load_vtm_tile_avx2(__m256i *regs, const uint8_t *buf, int stride, int tile_w, int num_regs)
+{
+  const int rows_per_reg = 16 / tile_w;
+  for (int r = 0; r < num_regs; ++r) {
+    regs[r] = load_16_px_raster_avx2(buf + r * rows_per_reg * stride, stride, tile_w);
+  }
+}
+
+/**
+ * \brief  Sum of absolute Hadamard coefficients of 16 * num_regs differences.
+ *
+ * The 2D Hadamard transform of a WxH tile is the 1D transform of its W*H
+ * samples in raster order, so the same butterflies cover every tile shape
+ * of xGetHADs. The coefficients come out in a different order and with
+ * different signs than in VTM, which does not change the sum. The DC
+ * coefficient is always left in the first sample and returned in *dc.
+ */
+static INLINE int hadamard_sum_flat_avx2(__m256i *diff, int num_regs, int *dc)
+{
+  const __m256i sign_1 = _mm256_setr_epi16(1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1);
+  const __m256i sign_2 = _mm256_setr_epi16(1, 1, -1, -1, 1, 1, -1, -1, 1, 1, -1, -1, 1, 1, -1, -1);
+  const __m256i sign_4 = _mm256_setr_epi16(1, 1, 1, 1, -1, -1, -1, -1, 1, 1, 1, 1, -1, -1, -1, -1);
+  const __m256i sign_8 = _mm256_setr_epi16(1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1, -1, -1, -1, -1, -1);
+
+  // Butterflies between samples 1, 2, 4 and 8 apart within each register.
+  for (int r = 0; r < num_regs; ++r) {
+    __m256i v = diff[r];
+    __m256i t = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+    v = _mm256_add_epi16(_mm256_sign_epi16(v, sign_1), t);
+    v = _mm256_add_epi16(_mm256_sign_epi16(v, sign_2), _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    v = _mm256_add_epi16(_mm256_sign_epi16(v, sign_4), _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm256_add_epi16(_mm256_sign_epi16(v, sign_8), _mm256_permute4x64_epi64(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    diff[r] = v;
+  }
+
+  // Butterflies between registers.
+  for (int dist = 1; dist < num_regs; dist <<= 1) {
+    for (int r = 0; r < num_regs; ++r) {
+      if (r & dist) continue;
+      const __m256i a = diff[r];
+      const __m256i b = diff[r + dist];
+      diff[r] = _mm256_add_epi16(a, b);
+      diff[r + dist] = _mm256_sub_epi16(a, b);
+    }
+  }
+
+  // With 8-bit samples even the 128 sample transform fits in 16 bits.
+  const __m256i ones = _mm256_set1_epi16(1);
+  __m256i sum = _mm256_setzero_si256();
+  for (int r = 0; r < num_regs; ++r) {
+    sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_abs_epi16(diff[r]), ones));
+  }
+  __m128i sum_128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+  sum_128 = _mm_add_epi32(sum_128, _mm_shuffle_epi32(sum_128, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum_128 = _mm_add_epi32(sum_128, _mm_shuffle_epi32(sum_128, _MM_SHUFFLE(2, 3, 0, 1)));
+
+  *dc = (int16_t)_mm256_extract_epi16(diff[0], 0);
+  return _mm_cvtsi128_si32(sum_128);
+}
+
+/**
+ * \brief  SATD of one tile, normalized like the xCalcHADs functions.
+ */
+static INLINE unsigned satd_vtm_tile_avx2(__m256i *diff, int tile_w, int tile_h)
+{
+  int dc;
+  int sad = hadamard_sum_flat_avx2(diff, tile_w * tile_h / 16, &dc);
+  dc = abs(dc);
+  sad -= dc;
+  sad += dc >> 2;
+
+  switch (tile_w * tile_h) {
+    case 4 * 4:
+      return (sad + 1) >> 1;
+    case 8 * 8:
+      return (sad + 2) >> 2;
+    case 4 * 8:
+      return (int)(sad / sqrt(4.0 * 8) * 2);
+    default:
+      return (int)(sad / sqrt(16.0 * 8) * 2);
+  }
+}
+
+/**
+ * \brief  Calculate the VTM style SATD of up to four predictions.
+ *
+ * Matches xGetHADs. The original block is loaded once per tile and
+ * shared by all of the predictions.
+ */
+static void satd_any_size_vtm_quad_avx2(int width, int height,
+                                        const uint8_t **preds,
+                                        const int stride,
+                                        const uint8_t *orig,
+                                        const int orig_stride,
+                                        unsigned num_modes,
+                                        unsigned *costs_out,
+                                        int8_t *valid)
+{
+  int tile_w;
+  int tile_h;
+  if (width > height && height % 8 == 0 && width % 16 == 0) {
+    tile_w = 16;
+    tile_h = 8;
+  } else if (width < height && width % 8 == 0 && height % 16 == 0) {
+    tile_w = 8;
+    tile_h = 16;
+  } else if (width > height && height % 4 == 0 && width % 8 == 0) {
+    tile_w = 8;
+    tile_h = 4;
+  } else if (width < height && width % 4 == 0 && height % 8 == 0) {
+    tile_w = 4;
+    tile_h = 8;
+  } else if (width % 8 == 0 && height % 8 == 0) {
+    tile_w = 8;
+    tile_h = 8;
+  } else if (width % 4 == 0 && height % 4 == 0) {
+    tile_w = 4;
+    tile_h = 4;
+  } else {
+    for (unsigned mode = 0; mode < num_modes; ++mode) {
+      costs_out[mode] = (unsigned)uvg_satd_any_size_vtm(width, height, orig, orig_stride, preds[mode], stride);
+    }
+    return;
+  }
+  const int num_regs = tile_w * tile_h / 16;
+
+  for (unsigned mode = 0; mode < num_modes; ++mode) {
+    costs_out[mode] = 0;
+  }
+
+  for (int y = 0; y < height; y += tile_h) {
+    for (int x = 0; x < width; x += tile_w) {
+      __m256i orig_px[8];
+      load_vtm_tile_avx2(orig_px, &orig[y * orig_stride + x], orig_stride, tile_w, num_regs);
+
+      for (unsigned mode = 0; mode < num_modes; ++mode) {
+        __m256i diff[8];
+        load_vtm_tile_avx2(diff, &preds[mode][y * stride + x], stride, tile_w, num_regs);
+        for (int r = 0; r < num_regs; ++r) {
+          diff[r] = _mm256_sub_epi16(orig_px[r], diff[r]);
+        }
+        costs_out[mode] += satd_vtm_tile_avx2(diff, tile_w, tile_h);
+      }
+    }
+  }
+}
+
+// For square blocks xGetHADs uses the same 4x4 and 8x8 tiles as the
+// fixed size SATD functions.
+#define SATD_NXN_QUAD_AVX2(n) \
+static void satd_8bit_ ## n ## x ## n ## _quad_avx2( \
+  const pred_buffer preds, const uint8_t * const orig, unsigned num_modes, unsigned *satds_out) \
+{ \
+  const uint8_t *pred_ptrs[4] = { preds[0], preds[1], preds[2], preds[3] }; \
+  satd_any_size_vtm_quad_avx2((n), (n), pred_ptrs, (n), orig, (n), num_modes, satds_out, NULL); \
+}
+
+SATD_NXN_QUAD_AVX2(4)
+SATD_NXN_QUAD_AVX2(8)
+SATD_NXN_QUAD_AVX2(16)
+SATD_NXN_QUAD_AVX2(32)
+
+/**
+ * \brief  Calculate SADs of up to four contiguous predictions of num_px samples.
+ */
+static INLINE void sad_8bit_quad_avx2(const pred_buffer preds, const uint8_t *orig,
+                                      int num_px, unsigned num_modes, unsigned *costs_out)
+{
+  if (num_px < 32) {
+    const __m128i orig_px = _mm_loadu_si128((const __m128i*)orig);
+    for (unsigned mode = 0; mode < num_modes; ++mode) {
+      const __m128i sad = _mm_sad_epu8(_mm_loadu_si128((const __m128i*)preds[mode]), orig_px);
+      costs_out[mode] = _mm_cvtsi128_si32(sad) + _mm_extract_epi32(sad, 2);
+    }
+    return;
+  }
+
+  __m256i sums[4] = { _mm256_setzero_si256(), _mm256_setzero_si256(),
+                      _mm256_setzero_si256(), _mm256_setzero_si256() };
+  for (int i = 0; i < num_px; i += 32) {
+    const __m256i orig_px = _mm256_loadu_si256((const __m256i*)(orig + i));
+    for (unsigned mode = 0; mode < num_modes; ++mode) {
+      const __m256i pred_px = _mm256_loadu_si256((const __m256i*)(preds[mode] + i));
+      sums[mode] = _mm256_add_epi64(sums[mode], _mm256_sad_epu8(pred_px, orig_px));
+    }
+  }
+  for (unsigned mode = 0; mode < num_modes; ++mode) {
+    __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(sums[mode]), _mm256_extracti128_si256(sums[mode], 1));
+    sum = _mm_add_epi64(sum, _mm_unpackhi_epi64(sum, sum));
+    costs_out[mode] = _mm_cvtsi128_si32(sum);
+  }
+}
+
+#define SAD_NXN_QUAD_AVX2(n) \
+static void sad_8bit_ ## n ## x ## n ## _quad_avx2( \
+  const pred_buffer preds, const uint8_t * const orig, unsigned num_modes, unsigned *costs_out) \
+{ \
+  sad_8bit_quad_avx2(preds, orig, (n) * (n), num_modes, costs_out); \
+}
+
+SAD_NXN_QUAD_AVX2(4)
+SAD_NXN_QUAD_AVX2(8)
+SAD_NXN_QUAD_AVX2(16)
+SAD_NXN_QUAD_AVX2(32)
+
+
 static unsigned pixels_calc_ssd_avx2(const uint8_t *const ref, const uint8_t *const rec,
                  const int ref_stride, const int rec_stride,
                  const int width, const int height)
 {
-  assert(width == height && "Non square not yet implemented");
   __m256i ssd_part;
   __m256i diff = _mm256_setzero_si256();
   __m128i sum;
@@ -731,6 +958,18 @@ static unsigned pixels_calc_ssd_avx2(const uint8_t *const ref, const uint8_t *co
 
   int ssd;
 
+  if ((width % 8 != 0 || height % 2 != 0) && (width != 4 || height != 4)) {
+    // Narrow and single row ISP blocks are not worth a kernel.
+    ssd = 0;
+    for (int y = 0; y < height; ++y) {
+      for (int x = 0; x < width; ++x) {
+        int diff_px = ref[x + y * ref_stride] - rec[x + y * rec_stride];
+        ssd += diff_px * diff_px;
+      }
+    }
+    return ssd >> (2*(UVG_BIT_DEPTH-8));
+  }
+
   switch (width) {
 
   case 4:
@@ -768,14 +1007,12 @@ static unsigned pixels_calc_ssd_avx2(const uint8_t *const ref, const uint8_t *co
   default:
 
     ssd_part = _mm256_setzero_si256();
-    for (int y = 0; y < width; y += 8) {
+    for (int y = 0; y < height; y += 2) {
       for (int x = 0; x < width; x += 8) {
-        for (int i = 0; i < 8; i += 2) {
-          ref_epi16 = _mm256_cvtepu8_epi16(_mm_unpacklo_epi64(_mm_loadl_epi64((__m128i*)&(ref[x + (y + i) * ref_stride])), _mm_loadl_epi64((__m128i*)&(ref[x + (y + i + 1) * ref_stride]))));
-          rec_epi16 = _mm256_cvtepu8_epi16(_mm_unpacklo_epi64(_mm_loadl_epi64((__m128i*)&(rec[x + (y + i) * rec_stride])), _mm_loadl_epi64((__m128i*)&(rec[x + (y + i + 1) * rec_stride]))));
-          diff = _mm256_sub_epi16(ref_epi16, rec_epi16);
-          ssd_part = _mm256_add_epi32(ssd_part, _mm256_madd_epi16(diff, diff));
-        }
+        ref_epi16 = _mm256_cvtepu8_epi16(_mm_unpacklo_epi64(_mm_loadl_epi64((__m128i*)&(ref[x + y * ref_stride])), _mm_loadl_epi64((__m128i*)&(ref[x + (y + 1) * ref_stride]))));
+        rec_epi16 = _mm256_cvtepu8_epi16(_mm_unpacklo_epi64(_mm_loadl_epi64((__m128i*)&(rec[x + y * rec_stride])), _mm_loadl_epi64((__m128i*)&(rec[x + (y + 1) * rec_stride]))));
+        diff = _mm256_sub_epi16(ref_epi16, rec_epi16);
+        ssd_part = _mm256_add_epi32(ssd_part, _mm256_madd_epi16(diff, diff));
       }
     }
 
@@ -1491,6 +1728,26 @@ static void bipred_average_avx2(lcu_t *const lcu,
   }
 }
 
+static void reg_sad_x4_avx2(const uint8_t * const data1, const uint8_t * const data2[4],
+                            const int32_t width, const int32_t height,
+                            const uint32_t stride1, const uint32_t stride2,
+                            uint32_t sad_out[4])
+{
+  if (width == 4) {
+    reg_sad_x4_w4(data1, data2, height, stride1, stride2, sad_out);
+  } else if (width == 8) {
+    reg_sad_x4_w8(data1, data2, height, stride1, stride2, sad_out);
+  } else if (width == 16) {
+    reg_sad_x4_w16_avx2(data1, data2, height, stride1, stride2, sad_out);
+  } else if (width % 32 == 0) {
+    reg_sad_x4_w32n(data1, data2, width, height, stride1, stride2, sad_out);
+  } else {
+    for (int i = 0; i < 4; ++i) {
+      sad_out[i] = uvg_reg_sad_avx2(data1, data2[i], width, height, stride1, stride2);
+    }
+  }
+}
+
 static optimized_sad_func_ptr_t get_optimized_sad_avx2(int32_t width)
 {
   if (width == 0)
@@ -1745,7 +2002,16 @@ static INLINE __m128i get_residual_8x1_avx2(const uint8_t* a_in, const uint8_t*
 }
 
 static void generate_residual_avx2(const uint8_t* ref_in, const uint8_t* pred_in, int16_t* residual, int width, int height, int ref_stride, int pred_stride) {
-  // ISP_TODO: non-square block implementation, height is passed but not used
+  if (width < 4 || (width == 4 && height % 4 != 0) || (width == 8 && height % 2 != 0)) {
+    // Narrow and short ISP blocks are not worth a kernel.
+    for (int y = 0; y < height; ++y) {
+      for (int x = 0; x < width; ++x) {
+        residual[x + y * width] = (int16_t)(ref_in[x + y * ref_stride] - pred_in[x + y * pred_stride]);
+      }
+    }
+    return;
+  }
+
   __m128i diff = _mm_setzero_si128();
   switch (width) {
   case 4:
@@ -1782,6 +2048,361 @@ static void generate_residual_avx2(const uint8_t* ref_in, const uint8_t* pred_in
 }
 
 
+#else // UVG_BIT_DEPTH == 8
+
+#include "strategies/avx2/picture-avx2.h"
+
+#include <immintrin.h>
+#include <stdlib.h>
+#include "strategies/strategies-picture.h"
+#include "strategyselector.h"
+
+/*
+ * Kernels for 16-bit uvg_pixel. The difference of two samples fits in an
+ * int16 for every supported bit depth, so SAD, SSD and residuals are
+ * computed in 16 bits and accumulated in 32 bits. The Hadamard transforms
+ * grow past 16 bits and are done on 32-bit lanes.
+ */
+
+static INLINE uint32_t hsum_8x32b_16bit_avx2(const __m256i v)
+{
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  return (uint32_t)_mm_cvtsi128_si32(sum);
+}
+
+static INLINE uint32_t hsum_4x32b_16bit_avx2(__m128i sum)
+{
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  return (uint32_t)_mm_cvtsi128_si32(sum);
+}
+
+/**
+ * \brief Absolute differences of 16 samples, summed pairwise into 32 bits.
+ */
+static INLINE __m256i sad_16_16bit_avx2(const uvg_pixel *a, const uvg_pixel *b)
+{
+  const __m256i va = _mm256_loadu_si256((const __m256i *)a);
+  const __m256i vb = _mm256_loadu_si256((const __m256i *)b);
+  const __m256i diff = _mm256_abs_epi16(_mm256_sub_epi16(va, vb));
+  return _mm256_madd_epi16(diff, _mm256_set1_epi16(1));
+}
+
+static INLINE __m128i sad_8_16bit_avx2(const uvg_pixel *a, const uvg_pixel *b)
+{
+  const __m128i va = _mm_loadu_si128((const __m128i *)a);
+  const __m128i vb = _mm_loadu_si128((const __m128i *)b);
+  const __m128i diff = _mm_abs_epi16(_mm_sub_epi16(va, vb));
+  return _mm_madd_epi16(diff, _mm_set1_epi16(1));
+}
+
+static INLINE __m128i sad_4_16bit_avx2(const uvg_pixel *a, const uvg_pixel *b)
+{
+  const __m128i va = _mm_loadl_epi64((const __m128i *)a);
+  const __m128i vb = _mm_loadl_epi64((const __m128i *)b);
+  const __m128i diff = _mm_abs_epi16(_mm_sub_epi16(va, vb));
+  return _mm_madd_epi16(diff, _mm_set1_epi16(1));
+}
+
+/**
+ * \brief Calculate SAD between two rectangular regions of 16-bit pixels.
+ */
+static unsigned reg_sad_16bit_avx2(const uvg_pixel * const data1, const uvg_pixel * const data2,
+                                   const int width, const int height,
+                                   const unsigned stride1, const unsigned stride2)
+{
+  __m256i sum = _mm256_setzero_si256();
+  __m128i sum_128 = _mm_setzero_si128();
+  unsigned sad = 0;
+
+  for (int y = 0; y < height; ++y) {
+    const uvg_pixel *row1 = &data1[y * stride1];
+    const uvg_pixel *row2 = &data2[y * stride2];
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+      sum = _mm256_add_epi32(sum, sad_16_16bit_avx2(&row1[x], &row2[x]));
+    }
+    if (x + 8 <= width) {
+      sum_128 = _mm_add_epi32(sum_128, sad_8_16bit_avx2(&row1[x], &row2[x]));
+      x += 8;
+    }
+    if (x + 4 <= width) {
+      sum_128 = _mm_add_epi32(sum_128, sad_4_16bit_avx2(&row1[x], &row2[x]));
+      x += 4;
+    }
+    for (; x < width; ++x) {
+      sad += abs(row1[x] - row2[x]);
+    }
+  }
+
+  return sad + hsum_8x32b_16bit_avx2(sum) + hsum_4x32b_16bit_avx2(sum_128);
+}
+
+static void reg_sad_x4_16bit_avx2(const uvg_pixel * const data1, const uvg_pixel * const data2[4],
+                                  const int width, const int height,
+                                  const unsigned stride1, const unsigned stride2,
+                                  unsigned sad_out[4])
+{
+  for (int i = 0; i < 4; ++i) {
+    sad_out[i] = reg_sad_16bit_avx2(data1, data2[i], width, height, stride1, stride2);
+  }
+}
+
+#define SAD_NXN_16BIT_AVX2(n) \
+static unsigned sad_ ## n ## x ## n ## _16bit_avx2(const uvg_pixel *block1, const uvg_pixel *block2) \
+{ \
+  return reg_sad_16bit_avx2(block1, block2, (n), (n), (n), (n)) >> (UVG_BIT_DEPTH - 8); \
+}
+
+SAD_NXN_16BIT_AVX2(8)
+SAD_NXN_16BIT_AVX2(16)
+SAD_NXN_16BIT_AVX2(32)
+SAD_NXN_16BIT_AVX2(64)
+
+/**
+ * \brief One butterfly stage of a Hadamard transform across registers.
+ */
+#define HADAMARD_BUTTERFLY_16BIT(type, add, sub, rows, a, b) do { \
+  const type tmp_ = (rows)[a]; \
+  (rows)[a] = add(tmp_, (rows)[b]); \
+  (rows)[b] = sub(tmp_, (rows)[b]); \
+} while (0)
+
+static INLINE void ver_transform_8x8_16bit_avx2(__m256i rows[8])
+{
+  for (int i = 0; i < 4; ++i) {
+    HADAMARD_BUTTERFLY_16BIT(__m256i, _mm256_add_epi32, _mm256_sub_epi32, rows, i, i + 4);
+  }
+  for (int i = 0; i < 8; i += 4) {
+    HADAMARD_BUTTERFLY_16BIT(__m256i, _mm256_add_epi32, _mm256_sub_epi32, rows, i, i + 2);
+    HADAMARD_BUTTERFLY_16BIT(__m256i, _mm256_add_epi32, _mm256_sub_epi32, rows, i + 1, i + 3);
+  }
+  for (int i = 0; i < 8; i += 2) {
+    HADAMARD_BUTTERFLY_16BIT(__m256i, _mm256_add_epi32, _mm256_sub_epi32, rows, i, i + 1);
+  }
+}
+
+static INLINE void transpose_8x8_epi32_avx2(__m256i rows[8])
+{
+  const __m256i t0 = _mm256_unpacklo_epi32(rows[0], rows[1]);
+  const __m256i t1 = _mm256_unpackhi_epi32(rows[0], rows[1]);
+  const __m256i t2 = _mm256_unpacklo_epi32(rows[2], rows[3]);
+  const __m256i t3 = _mm256_unpackhi_epi32(rows[2], rows[3]);
+  const __m256i t4 = _mm256_unpacklo_epi32(rows[4], rows[5]);
+  const __m256i t5 = _mm256_unpackhi_epi32(rows[4], rows[5]);
+  const __m256i t6 = _mm256_unpacklo_epi32(rows[6], rows[7]);
+  const __m256i t7 = _mm256_unpackhi_epi32(rows[6], rows[7]);
+
+  const __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+  const __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+  const __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+  const __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+  const __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+  const __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+  const __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+  const __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+  rows[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+  rows[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+  rows[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+  rows[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+  rows[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+  rows[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+  rows[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+  rows[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
+
+/**
+ * \brief Calculate SATD between two 8x8 blocks inside bigger arrays.
+ */
+static unsigned satd_8x8_subblock_16bit_avx2(const uvg_pixel *buf1, unsigned stride1,
+                                             const uvg_pixel *buf2, unsigned stride2)
+{
+  __m256i rows[8];
+  for (int y = 0; y < 8; ++y) {
+    const __m256i a = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)&buf1[y * stride1]));
+    const __m256i b = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)&buf2[y * stride2]));
+    rows[y] = _mm256_sub_epi32(a, b);
+  }
+
+  ver_transform_8x8_16bit_avx2(rows);
+  transpose_8x8_epi32_avx2(rows);
+  ver_transform_8x8_16bit_avx2(rows);
+
+  __m256i sum = _mm256_abs_epi32(rows[0]);
+  for (int y = 1; y < 8; ++y) {
+    sum = _mm256_add_epi32(sum, _mm256_abs_epi32(rows[y]));
+  }
+  unsigned sad = hsum_8x32b_16bit_avx2(sum);
+
+  const int dc = abs(_mm256_cvtsi256_si32(rows[0]));
+  sad -= dc - (dc >> 2);
+
+  return (sad + 2) >> 2;
+}
+
+/**
+ * \brief Calculate SATD between two 4x4 blocks inside bigger arrays.
+ */
+static unsigned uvg_satd_4x4_subblock_16bit_avx2(const uvg_pixel *buf1, int32_t stride1,
+                                             const uvg_pixel *buf2, int32_t stride2)
+{
+  __m128i rows[4];
+  for (int y = 0; y < 4; ++y) {
+    const __m128i a = _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)&buf1[y * stride1]));
+    const __m128i b = _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)&buf2[y * stride2]));
+    rows[y] = _mm_sub_epi32(a, b);
+  }
+
+  for (int pass = 0; pass < 2; ++pass) {
+    HADAMARD_BUTTERFLY_16BIT(__m128i, _mm_add_epi32, _mm_sub_epi32, rows, 0, 2);
+    HADAMARD_BUTTERFLY_16BIT(__m128i, _mm_add_epi32, _mm_sub_epi32, rows, 1, 3);
+    HADAMARD_BUTTERFLY_16BIT(__m128i, _mm_add_epi32, _mm_sub_epi32, rows, 0, 1);
+    HADAMARD_BUTTERFLY_16BIT(__m128i, _mm_add_epi32, _mm_sub_epi32, rows, 2, 3);
+
+    if (pass == 0) {
+      const __m128i t0 = _mm_unpacklo_epi32(rows[0], rows[1]);
+      const __m128i t1 = _mm_unpackhi_epi32(rows[0], rows[1]);
+      const __m128i t2 = _mm_unpacklo_epi32(rows[2], rows[3]);
+      const __m128i t3 = _mm_unpackhi_epi32(rows[2], rows[3]);
+      rows[0] = _mm_unpacklo_epi64(t0, t2);
+      rows[1] = _mm_unpackhi_epi64(t0, t2);
+      rows[2] = _mm_unpacklo_epi64(t1, t3);
+      rows[3] = _mm_unpackhi_epi64(t1, t3);
+    }
+  }
+
+  __m128i sum = _mm_abs_epi32(rows[0]);
+  for (int y = 1; y < 4; ++y) {
+    sum = _mm_add_epi32(sum, _mm_abs_epi32(rows[y]));
+  }
+  unsigned satd = hsum_4x32b_16bit_avx2(sum);
+
+  const int dc = abs(_mm_cvtsi128_si32(rows[0]));
+  satd -= dc - (dc >> 2);
+
+  return (satd + 1) >> 1;
+}
+
+static unsigned satd_4x4_16bit_avx2(const uvg_pixel *org, const uvg_pixel *cur)
+{
+  return uvg_satd_4x4_subblock_16bit_avx2(org, 4, cur, 4);
+}
+
+SATD_NxN(16bit_avx2,  8)
+SATD_NxN(16bit_avx2, 16)
+SATD_NxN(16bit_avx2, 32)
+SATD_NxN(16bit_avx2, 64)
+SATD_ANY_SIZE(16bit_avx2)
+
+#define SATD_NXN_DUAL_16BIT_AVX2(n) \
+static void satd_ ## n ## x ## n ## _dual_16bit_avx2( \
+  const pred_buffer preds, const uvg_pixel * const orig, unsigned num_modes, unsigned *satds_out) \
+{ \
+  satds_out[0] = satd_ ## n ## x ## n ## _16bit_avx2(orig, preds[0]); \
+  satds_out[1] = satd_ ## n ## x ## n ## _16bit_avx2(orig, preds[1]); \
+}
+
+SATD_NXN_DUAL_16BIT_AVX2(8)
+SATD_NXN_DUAL_16BIT_AVX2(16)
+SATD_NXN_DUAL_16BIT_AVX2(32)
+SATD_NXN_DUAL_16BIT_AVX2(64)
+
+static void satd_4x4_dual_16bit_avx2(
+  const pred_buffer preds, const uvg_pixel * const orig, unsigned num_modes, unsigned *satds_out)
+{
+  satds_out[0] = satd_4x4_16bit_avx2(orig, preds[0]);
+  satds_out[1] = satd_4x4_16bit_avx2(orig, preds[1]);
+}
+
+/**
+ * \brief Calculate SATD of four predictions against the same block.
+ *
+ * Follows the block partitioning of satd_any_size_quad_generic: when the
+ * size is not a multiple of 8, the leftover 4-sample column and row are
+ * dropped and only the 8x8 blocks contribute to the cost.
+ */
+static void satd_any_size_quad_16bit_avx2(int width, int height,
+                                          const uvg_pixel **preds, const int stride,
+                                          const uvg_pixel *orig, const int orig_stride,
+                                          unsigned num_modes, unsigned *costs_out,
+                                          int8_t *valid)
+{
+  if (width % 8 != 0) width -= 4;
+  if (height % 8 != 0) height -= 4;
+
+  for (int i = 0; i < 4; ++i) {
+    unsigned sum = 0;
+    for (int y = 0; y < height; y += 8) {
+      for (int x = 0; x < width; x += 8) {
+        sum += satd_8x8_subblock_16bit_avx2(&preds[i][y * stride + x], stride,
+                                            &orig[y * orig_stride + x], orig_stride);
+      }
+    }
+    costs_out[i] = sum >> (UVG_BIT_DEPTH - 8);
+  }
+}
+
+static unsigned pixels_calc_ssd_16bit_avx2(const uvg_pixel *const ref, const uvg_pixel *const rec,
+                                           const int ref_stride, const int rec_stride,
+                                           const int width, const int height)
+{
+  __m256i sum = _mm256_setzero_si256();
+  __m128i sum_128 = _mm_setzero_si128();
+  int ssd = 0;
+
+  for (int y = 0; y < height; ++y) {
+    const uvg_pixel *ref_row = &ref[y * ref_stride];
+    const uvg_pixel *rec_row = &rec[y * rec_stride];
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+      const __m256i a = _mm256_loadu_si256((const __m256i *)&ref_row[x]);
+      const __m256i b = _mm256_loadu_si256((const __m256i *)&rec_row[x]);
+      const __m256i diff = _mm256_sub_epi16(a, b);
+      sum = _mm256_add_epi32(sum, _mm256_madd_epi16(diff, diff));
+    }
+    for (; x + 4 <= width; x += 4) {
+      const __m128i a = _mm_loadl_epi64((const __m128i *)&ref_row[x]);
+      const __m128i b = _mm_loadl_epi64((const __m128i *)&rec_row[x]);
+      const __m128i diff = _mm_sub_epi16(a, b);
+      sum_128 = _mm_add_epi32(sum_128, _mm_madd_epi16(diff, diff));
+    }
+    for (; x < width; ++x) {
+      const int diff = ref_row[x] - rec_row[x];
+      ssd += diff * diff;
+    }
+  }
+  ssd += (int)(hsum_8x32b_16bit_avx2(sum) + hsum_4x32b_16bit_avx2(sum_128));
+
+  return ssd >> (2 * (UVG_BIT_DEPTH - 8));
+}
+
+static void generate_residual_16bit_avx2(const uvg_pixel *ref_in, const uvg_pixel *pred_in, int16_t *residual,
+                                         int width, int height, int ref_stride, int pred_stride)
+{
+  for (int y = 0; y < height; ++y) {
+    const uvg_pixel *ref_row = &ref_in[y * ref_stride];
+    const uvg_pixel *pred_row = &pred_in[y * pred_stride];
+    int16_t *res_row = &residual[y * width];
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+      const __m256i a = _mm256_loadu_si256((const __m256i *)&ref_row[x]);
+      const __m256i b = _mm256_loadu_si256((const __m256i *)&pred_row[x]);
+      _mm256_storeu_si256((__m256i *)&res_row[x], _mm256_sub_epi16(a, b));
+    }
+    for (; x + 4 <= width; x += 4) {
+      const __m128i a = _mm_loadl_epi64((const __m128i *)&ref_row[x]);
+      const __m128i b = _mm_loadl_epi64((const __m128i *)&pred_row[x]);
+      _mm_storel_epi64((__m128i *)&res_row[x], _mm_sub_epi16(a, b));
+    }
+    for (; x < width; ++x) {
+      res_row[x] = (int16_t)(ref_row[x] - pred_row[x]);
+    }
+  }
+}
+
 #endif // KVZ_BIT_DEPTH == 8
 #endif //COMPILE_INTEL_AVX2
 
@@ -1797,6 +2418,7 @@ int uvg_strategy_register_picture_avx2(void* opaque, uint8_t bitdepth)
   if (bitdepth == 8){
 
     success &= uvg_strategyselector_register(opaque, "reg_sad", "avx2", 40, &uvg_reg_sad_avx2);
+    success &= uvg_strategyselector_register(opaque, "reg_sad_x4", "avx2", 40, &reg_sad_x4_avx2);
     success &= uvg_strategyselector_register(opaque, "sad_8x8", "avx2", 40, &sad_8bit_8x8_avx2);
     success &= uvg_strategyselector_register(opaque, "sad_16x16", "avx2", 40, &sad_8bit_16x16_avx2);
     success &= uvg_strategyselector_register(opaque, "sad_32x32", "avx2", 40, &sad_8bit_32x32_avx2);
@@ -1815,6 +2437,16 @@ int uvg_strategy_register_picture_avx2(void* opaque, uint8_t bitdepth)
     success &= uvg_strategyselector_register(opaque, "satd_64x64_dual", "avx2", 40, &satd_8bit_64x64_dual_avx2);
     success &= uvg_strategyselector_register(opaque, "satd_any_size", "avx2", 40, &satd_any_size_8bit_avx2);
     success &= uvg_strategyselector_register(opaque, "satd_any_size_quad", "avx2", 40, &satd_any_size_quad_avx2);
+    success &= uvg_strategyselector_register(opaque, "satd_any_size_vtm_quad", "avx2", 40, &satd_any_size_vtm_quad_avx2);
+
+    success &= uvg_strategyselector_register(opaque, "satd_4x4_quad", "avx2", 40, &satd_8bit_4x4_quad_avx2);
+    success &= uvg_strategyselector_register(opaque, "satd_8x8_quad", "avx2", 40, &satd_8bit_8x8_quad_avx2);
+    success &= uvg_strategyselector_register(opaque, "satd_16x16_quad", "avx2", 40, &satd_8bit_16x16_quad_avx2);
+    success &= uvg_strategyselector_register(opaque, "satd_32x32_quad", "avx2", 40, &satd_8bit_32x32_quad_avx2);
+    success &= uvg_strategyselector_register(opaque, "sad_4x4_quad", "avx2", 40, &sad_8bit_4x4_quad_avx2);
+    success &= uvg_strategyselector_register(opaque, "sad_8x8_quad", "avx2", 40, &sad_8bit_8x8_quad_avx2);
+    success &= uvg_strategyselector_register(opaque, "sad_16x16_quad", "avx2", 40, &sad_8bit_16x16_quad_avx2);
+    success &= uvg_strategyselector_register(opaque, "sad_32x32_quad", "avx2", 40, &sad_8bit_32x32_quad_avx2);
 
     success &= uvg_strategyselector_register(opaque, "pixels_calc_ssd", "avx2", 40, &pixels_calc_ssd_avx2);
     success &= uvg_strategyselector_register(opaque, "bipred_average", "avx2", 40, &bipred_average_avx2);
@@ -1827,6 +2459,33 @@ int uvg_strategy_register_picture_avx2(void* opaque, uint8_t bitdepth)
     success &= uvg_strategyselector_register(opaque, "generate_residual", "avx2", 0, &generate_residual_avx2);
 
   }
+#else // UVG_BIT_DEPTH == 8
+  if (bitdepth > 8) {
+    success &= uvg_strategyselector_register(opaque, "reg_sad", "avx2", 40, &reg_sad_16bit_avx2);
+    success &= uvg_strategyselector_register(opaque, "reg_sad_x4", "avx2", 40, &reg_sad_x4_16bit_avx2);
+    success &= uvg_strategyselector_register(opaque, "sad_8x8", "avx2", 40, &sad_8x8_16bit_avx2);
+    success &= uvg_strategyselector_register(opaque, "sad_16x16", "avx2", 40, &sad_16x16_16bit_avx2);
+    success &= uvg_strategyselector_register(opaque, "sad_32x32", "avx2", 40, &sad_32x32_16bit_avx2);
+    success &= uvg_strategyselector_register(opaque, "sad_64x64", "avx2", 40, &sad_64x64_16bit_avx2);
+
+    success &= uvg_strategyselector_register(opaque, "satd_4x4", "avx2", 40, &satd_4x4_16bit_avx2);
+    success &= uvg_strategyselector_register(opaque, "satd_8x8", "avx2", 40, &satd_8x8_16bit_avx2);
+    success &= uvg_strategyselector_register(opaque, "satd_16x16", "avx2", 40, &satd_16x16_16bit_avx2);
+    success &= uvg_strategyselector_register(opaque, "satd_32x32", "avx2", 40, &satd_32x32_16bit_avx2);
+    success &= uvg_strategyselector_register(opaque, "satd_64x64", "avx2", 40, &satd_64x64_16bit_avx2);
+
+    success &= uvg_strategyselector_register(opaque, "satd_4x4_dual", "avx2", 40, &satd_4x4_dual_16bit_avx2);
+    success &= uvg_strategyselector_register(opaque, "satd_8x8_dual", "avx2", 40, &satd_8x8_dual_16bit_avx2);
+    success &= uvg_strategyselector_register(opaque, "satd_16x16_dual", "avx2", 40, &satd_16x16_dual_16bit_avx2);
+    success &= uvg_strategyselector_register(opaque, "satd_32x32_dual", "avx2", 40, &satd_32x32_dual_16bit_avx2);
+    success &= uvg_strategyselector_register(opaque, "satd_64x64_dual", "avx2", 40, &satd_64x64_dual_16bit_avx2);
+    success &= uvg_strategyselector_register(opaque, "satd_any_size", "avx2", 40, &satd_any_size_16bit_avx2);
+    success &= uvg_strategyselector_register(opaque, "satd_any_size_quad", "avx2", 40, &satd_any_size_quad_16bit_avx2);
+
+    success &= uvg_strategyselector_register(opaque, "pixels_calc_ssd", "avx2", 40, &pixels_calc_ssd_16bit_avx2);
+
+    success &= uvg_strategyselector_register(opaque, "generate_residual", "avx2", 0, &generate_residual_16bit_avx2);
+  }
 #endif // UVG_BIT_DEPTH == 8
 #endif
   return success;
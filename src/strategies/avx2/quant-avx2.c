@@ -379,6 +379,14 @@ static INLINE unsigned uvg_math_floor_log2(unsigned value)
 void uvg_quant_avx2(const encoder_state_t * const state, const coeff_t * __restrict coef, coeff_t * __restrict q_coef, int32_t width,
   int32_t height, color_t color, int8_t scan_idx, int8_t block_type, int8_t transform_skip, uint8_t lfnst_idx)
 {
+  // LFNST blocks only have up to 16 coefficients and are quantized one by
+  // one. The sign hiding below reads 4x4 coefficient groups, which 1 and 2
+  // wide or high blocks do not have.
+  if (lfnst_idx != 0 || width < 4 || height < 4) {
+    uvg_quant_generic(state, (coeff_t *)coef, q_coef, width, height, color, scan_idx, block_type, transform_skip, lfnst_idx);
+    return;
+  }
+
   const encoder_control_t * const encoder = state->encoder_control;
   const uint32_t log2_tr_width  = uvg_g_convert_to_log2[width];
   const uint32_t log2_tr_height = uvg_g_convert_to_log2[height];
@@ -410,81 +418,60 @@ void uvg_quant_avx2(const encoder_state_t * const state, const coeff_t * __restr
     high_b = low_b;
   }
 
-  if(lfnst_idx == 0) {
-    for (int32_t n = 0; n < width * height; n += VEC_WIDTH) {
+  for (int32_t n = 0; n < width * height; n += VEC_WIDTH) {
 
-      __m256i v_level = _mm256_loadu_si256((__m256i *)(coef + n));
-      __m256i v_sign = _mm256_cmpgt_epi16(_mm256_setzero_si256(), v_level);
-      v_sign = _mm256_or_si256(v_sign, _mm256_set1_epi16(1));
+    __m256i v_level = _mm256_loadu_si256((__m256i *)(coef + n));
+    __m256i v_sign = _mm256_cmpgt_epi16(_mm256_setzero_si256(), v_level);
+    v_sign = _mm256_or_si256(v_sign, _mm256_set1_epi16(1));
 
-      if (state->encoder_control->scaling_list.enable) {
-        __m256i v_quant_coeff_lo = _mm256_loadu_si256(((__m256i *)(quant_coeff + n)) + 0);
-        __m256i v_quant_coeff_hi = _mm256_loadu_si256(((__m256i *)(quant_coeff + n)) + 1);
+    if (state->encoder_control->scaling_list.enable) {
+      __m256i v_quant_coeff_lo = _mm256_loadu_si256(((__m256i *)(quant_coeff + n)) + 0);
+      __m256i v_quant_coeff_hi = _mm256_loadu_si256(((__m256i *)(quant_coeff + n)) + 1);
 
-        low_b  = _mm256_permute2x128_si256(v_quant_coeff_lo,
-                                           v_quant_coeff_hi,
-                                           0x20);
+      low_b  = _mm256_permute2x128_si256(v_quant_coeff_lo,
+                                         v_quant_coeff_hi,
+                                         0x20);
 
-        high_b = _mm256_permute2x128_si256(v_quant_coeff_lo,
-                                           v_quant_coeff_hi,
-                                           0x31);
-      }
+      high_b = _mm256_permute2x128_si256(v_quant_coeff_lo,
+                                         v_quant_coeff_hi,
+                                         0x31);
+    }
 
-      // TODO: do we need to have this?
-      // #define CHECK_QUANT_COEFFS
-      #ifdef CHECK_QUANT_COEFFS
-      __m256i abs_vq_lo = _mm256_abs_epi32(v_quant_coeff_lo);
-      __m256i abs_vq_hi = _mm256_abs_epi32(v_quant_coeff_hi);
+    // TODO: do we need to have this?
+    // #define CHECK_QUANT_COEFFS
+    #ifdef CHECK_QUANT_COEFFS
+    __m256i abs_vq_lo = _mm256_abs_epi32(v_quant_coeff_lo);
+    __m256i abs_vq_hi = _mm256_abs_epi32(v_quant_coeff_hi);
 
-      __m256i vq_over_16b_lo = _mm256_cmpgt_epi32(abs_vq_lo, _mm256_set1_epi32(0x7fff));
-      __m256i vq_over_16b_hi = _mm256_cmpgt_epi32(abs_vq_hi, _mm256_set1_epi32(0x7fff));
+    __m256i vq_over_16b_lo = _mm256_cmpgt_epi32(abs_vq_lo, _mm256_set1_epi32(0x7fff));
+    __m256i vq_over_16b_hi = _mm256_cmpgt_epi32(abs_vq_hi, _mm256_set1_epi32(0x7fff));
 
-      uint32_t over_16b_mask_lo = _mm256_movemask_epi8(vq_over_16b_lo);
-      uint32_t over_16b_mask_hi = _mm256_movemask_epi8(vq_over_16b_hi);
+    uint32_t over_16b_mask_lo = _mm256_movemask_epi8(vq_over_16b_lo);
+    uint32_t over_16b_mask_hi = _mm256_movemask_epi8(vq_over_16b_hi);
 
-      assert(!(over_16b_mask_lo || over_16b_mask_hi));
+    assert(!(over_16b_mask_lo || over_16b_mask_hi));
 #endif
 
-      v_level = _mm256_abs_epi16(v_level);
-      __m256i low_a  = _mm256_unpacklo_epi16(v_level, _mm256_setzero_si256());
-      __m256i high_a = _mm256_unpackhi_epi16(v_level, _mm256_setzero_si256());
+    v_level = _mm256_abs_epi16(v_level);
+    __m256i low_a  = _mm256_unpacklo_epi16(v_level, _mm256_setzero_si256());
+    __m256i high_a = _mm256_unpackhi_epi16(v_level, _mm256_setzero_si256());
 
-      __m256i v_level32_a = _mm256_mullo_epi32(low_a,  low_b);
-      __m256i v_level32_b = _mm256_mullo_epi32(high_a, high_b);
+    __m256i v_level32_a = _mm256_mullo_epi32(low_a,  low_b);
+    __m256i v_level32_b = _mm256_mullo_epi32(high_a, high_b);
 
-      v_level32_a = _mm256_add_epi32(v_level32_a, _mm256_set1_epi32(add));
-      v_level32_b = _mm256_add_epi32(v_level32_b, _mm256_set1_epi32(add));
+    v_level32_a = _mm256_add_epi32(v_level32_a, _mm256_set1_epi32(add));
+    v_level32_b = _mm256_add_epi32(v_level32_b, _mm256_set1_epi32(add));
 
-      v_level32_a = _mm256_srai_epi32(v_level32_a, q_bits);
-      v_level32_b = _mm256_srai_epi32(v_level32_b, q_bits);
+    v_level32_a = _mm256_srai_epi32(v_level32_a, q_bits);
+    v_level32_b = _mm256_srai_epi32(v_level32_b, q_bits);
 
-      v_level = _mm256_packs_epi32(v_level32_a, v_level32_b);
-      v_level = _mm256_sign_epi16(v_level, v_sign);
+    v_level = _mm256_packs_epi32(v_level32_a, v_level32_b);
+    v_level = _mm256_sign_epi16(v_level, v_sign);
 
-      _mm256_storeu_si256((__m256i *)(q_coef + n), v_level);
+    _mm256_storeu_si256((__m256i *)(q_coef + n), v_level);
 
-      v_ac_sum = _mm256_add_epi32(v_ac_sum, v_level32_a);
-      v_ac_sum = _mm256_add_epi32(v_ac_sum, v_level32_b);
-    }
-  }
-  else {
-    const int max_number_of_coeffs = ((width == 4 && height == 4) || (width == 8 && height == 8)) ? 8 : 16;
-    memset(q_coef, 0, width * height * sizeof(coeff_t));
-    for (int32_t n = 0; n < max_number_of_coeffs; n++) {
-      const uint32_t idx = scan[n];
-      int32_t level = coef[idx];
-      int64_t abs_level = (int64_t)abs(level);
-      int32_t sign;
-
-      sign = (level < 0 ? -1 : 1);
-
-      int32_t curr_quant_coeff = quant_coeff[n];
-      level = (abs_level * curr_quant_coeff + add) >> q_bits;
-      ac_sum += level;
-
-      level *= sign;
-      q_coef[idx] = (coeff_t)(CLIP(-32768, 32767, level));
-    }
+    v_ac_sum = _mm256_add_epi32(v_ac_sum, v_level32_a);
+    v_ac_sum = _mm256_add_epi32(v_ac_sum, v_level32_b);
   }
 
   __m128i temp = _mm_add_epi32(_mm256_castsi256_si128(v_ac_sum), _mm256_extracti128_si256(v_ac_sum, 1));
@@ -616,16 +603,13 @@ static void get_quantized_recon_avx2(int16_t *residual, const uint8_t *pred_in,
   else {
     switch (width) {
     case 4:
-      for (int y = 0; y < height; y += 4) {
-        *(int32_t*)& (rec_out[(y + 0) * out_stride]) = get_quantized_recon_4x1_avx2(residual + (y + 0) * width, pred_in + (y + 0) * in_stride);
-        *(int32_t*)& (rec_out[(y + 1) * out_stride]) = get_quantized_recon_4x1_avx2(residual + (y + 1) * width, pred_in + (y + 1) * in_stride);
-        *(int32_t*)& (rec_out[(y + 2) * out_stride]) = get_quantized_recon_4x1_avx2(residual + (y + 2) * width, pred_in + (y + 2) * in_stride);
-        *(int32_t*)& (rec_out[(y + 3) * out_stride]) = get_quantized_recon_4x1_avx2(residual + (y + 3) * width, pred_in + (y + 3) * in_stride);
+      for (int y = 0; y < height; ++y) {
+        *(int32_t*)& (rec_out[y * out_stride]) = get_quantized_recon_4x1_avx2(residual + y * width, pred_in + y * in_stride);
       }
       break;
     case 8:
       for (int y = 0; y < height; ++y) {
-        *(int32_t*)& (rec_out[y * out_stride]) = get_quantized_recon_8x1_avx2(residual + y * width, pred_in + y * in_stride);
+        *(int64_t*)& (rec_out[y * out_stride]) = get_quantized_recon_8x1_avx2(residual + y * width, pred_in + y * in_stride);
       }
       break;
     default:
@@ -668,7 +652,6 @@ int uvg_quantize_residual_avx2(encoder_state_t *const state,
   // Temporary arrays to pass data to and from uvg_quant and transform functions.
   ALIGNED(64) int16_t residual[TR_MAX_WIDTH * TR_MAX_WIDTH];
   ALIGNED(64) coeff_t coeff[TR_MAX_WIDTH * TR_MAX_WIDTH];
-  // ISP_TODO: non-square block implementation, height is passed but not used
   
   int has_coeffs = 0;
 
@@ -682,7 +665,7 @@ int uvg_quantize_residual_avx2(encoder_state_t *const state,
     int y, x;
     int sign, absval;
     int maxAbsclipBD = (1 << UVG_BIT_DEPTH) - 1;
-    for (y = 0; y < width; ++y) {
+    for (y = 0; y < height; ++y) {
       for (x = 0; x < width; ++x) {
         sign = residual[x + y * width] >= 0 ? 1 : -1;
         absval = sign * residual[x + y * width];
@@ -144,6 +144,98 @@ static INLINE uint32_t reg_sad_w64(const uint8_t * const data1, const uint8_t *
   return _mm_cvtsi128_si32(sad);
 }
 
+/*
+ * SAD of one block against four blocks at once. Width must be a multiple
+ * of 32.
+ */
+static INLINE void reg_sad_x4_w32n(const uint8_t * const data1, const uint8_t * const data2[4],
+                                   const int32_t width, const int32_t height,
+                                   const uint32_t stride1, const uint32_t stride2,
+                                   uint32_t sad_out[4])
+{
+  const uint8_t *ref0 = data2[0];
+  const uint8_t *ref1 = data2[1];
+  const uint8_t *ref2 = data2[2];
+  const uint8_t *ref3 = data2[3];
+  __m256i avx_inc0 = _mm256_setzero_si256();
+  __m256i avx_inc1 = _mm256_setzero_si256();
+  __m256i avx_inc2 = _mm256_setzero_si256();
+  __m256i avx_inc3 = _mm256_setzero_si256();
+
+  for (int32_t y = 0; y < height; y++) {
+    const uint8_t *row1 = data1 + y * stride1;
+    const int32_t offset2 = y * stride2;
+    for (int32_t x = 0; x < width; x += 32) {
+      __m256i a = _mm256_loadu_si256((const __m256i *)(row1 + x));
+      __m256i b0 = _mm256_loadu_si256((const __m256i *)(ref0 + offset2 + x));
+      __m256i b1 = _mm256_loadu_si256((const __m256i *)(ref1 + offset2 + x));
+      __m256i b2 = _mm256_loadu_si256((const __m256i *)(ref2 + offset2 + x));
+      __m256i b3 = _mm256_loadu_si256((const __m256i *)(ref3 + offset2 + x));
+      avx_inc0 = _mm256_add_epi64(avx_inc0, _mm256_sad_epu8(a, b0));
+      avx_inc1 = _mm256_add_epi64(avx_inc1, _mm256_sad_epu8(a, b1));
+      avx_inc2 = _mm256_add_epi64(avx_inc2, _mm256_sad_epu8(a, b2));
+      avx_inc3 = _mm256_add_epi64(avx_inc3, _mm256_sad_epu8(a, b3));
+    }
+  }
+
+  const __m128i sums[4] = {
+    _mm_add_epi64(_mm256_castsi256_si128(avx_inc0), _mm256_extracti128_si256(avx_inc0, 1)),
+    _mm_add_epi64(_mm256_castsi256_si128(avx_inc1), _mm256_extracti128_si256(avx_inc1, 1)),
+    _mm_add_epi64(_mm256_castsi256_si128(avx_inc2), _mm256_extracti128_si256(avx_inc2, 1)),
+    _mm_add_epi64(_mm256_castsi256_si128(avx_inc3), _mm256_extracti128_si256(avx_inc3, 1)),
+  };
+  reg_sad_x4_store(sums, sad_out);
+}
+
+/*
+ * Two rows of 16 pixels per register.
+ */
+static INLINE void reg_sad_x4_w16_avx2(const uint8_t * const data1, const uint8_t * const data2[4],
+                                       const int32_t height, const uint32_t stride1,
+                                       const uint32_t stride2, uint32_t sad_out[4])
+{
+  const uint8_t *ref0 = data2[0];
+  const uint8_t *ref1 = data2[1];
+  const uint8_t *ref2 = data2[2];
+  const uint8_t *ref3 = data2[3];
+  __m256i avx_inc0 = _mm256_setzero_si256();
+  __m256i avx_inc1 = _mm256_setzero_si256();
+  __m256i avx_inc2 = _mm256_setzero_si256();
+  __m256i avx_inc3 = _mm256_setzero_si256();
+  int32_t y;
+
+  const int32_t height_twoline_groups = height & ~1;
+
+#define LOAD_W16_X2(ptr, stride) \
+  _mm256_inserti128_si256( \
+    _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)((ptr) + (y + 0) * (stride)))), \
+    _mm_loadu_si128((const __m128i *)((ptr) + (y + 1) * (stride))), 1)
+
+  for (y = 0; y < height_twoline_groups; y += 2) {
+    __m256i a = LOAD_W16_X2(data1, stride1);
+    avx_inc0 = _mm256_add_epi64(avx_inc0, _mm256_sad_epu8(a, LOAD_W16_X2(ref0, stride2)));
+    avx_inc1 = _mm256_add_epi64(avx_inc1, _mm256_sad_epu8(a, LOAD_W16_X2(ref1, stride2)));
+    avx_inc2 = _mm256_add_epi64(avx_inc2, _mm256_sad_epu8(a, LOAD_W16_X2(ref2, stride2)));
+    avx_inc3 = _mm256_add_epi64(avx_inc3, _mm256_sad_epu8(a, LOAD_W16_X2(ref3, stride2)));
+  }
+#undef LOAD_W16_X2
+
+  __m128i sums[4] = {
+    _mm_add_epi64(_mm256_castsi256_si128(avx_inc0), _mm256_extracti128_si256(avx_inc0, 1)),
+    _mm_add_epi64(_mm256_castsi256_si128(avx_inc1), _mm256_extracti128_si256(avx_inc1, 1)),
+    _mm_add_epi64(_mm256_castsi256_si128(avx_inc2), _mm256_extracti128_si256(avx_inc2, 1)),
+    _mm_add_epi64(_mm256_castsi256_si128(avx_inc3), _mm256_extracti128_si256(avx_inc3, 1)),
+  };
+  if (y < height) {
+    __m128i a = _mm_loadu_si128((const __m128i *)(data1 + y * stride1));
+    sums[0] = _mm_add_epi64(sums[0], _mm_sad_epu8(a, _mm_loadu_si128((const __m128i *)(ref0 + y * stride2))));
+    sums[1] = _mm_add_epi64(sums[1], _mm_sad_epu8(a, _mm_loadu_si128((const __m128i *)(ref1 + y * stride2))));
+    sums[2] = _mm_add_epi64(sums[2], _mm_sad_epu8(a, _mm_loadu_si128((const __m128i *)(ref2 + y * stride2))));
+    sums[3] = _mm_add_epi64(sums[3], _mm_sad_epu8(a, _mm_loadu_si128((const __m128i *)(ref3 + y * stride2))));
+  }
+  reg_sad_x4_store(sums, sad_out);
+}
+
 static uint32_t hor_sad_avx2_w32(const uint8_t *pic_data, const uint8_t *ref_data,
                                  int32_t height, uint32_t pic_stride, uint32_t ref_stride,
                                  const uint32_t left, const uint32_t right)
@@ -897,6 +897,303 @@ use_generic:
       block_height, band_pos, sao_bands);
 }
 
+#else // UVG_BIT_DEPTH == 8
+#include <immintrin.h>
+
+#include "strategies/generic/sao_shared_generics.h"
+#include "strategies/avx2/avx2_common_functions.h"
+#include "cu.h"
+#include "encoder.h"
+#include "encoderstate.h"
+#include "sao.h"
+#include "strategyselector.h"
+
+// 16-bit uvg_pixel versions of the SAO kernels. Sixteen pixels are handled
+// per YMM register and the offsets, which are tiny compared to the sample
+// range, are looked up from an epi16 table with a byte shuffle.
+
+/**
+ * \brief Look up epi16 entries of table with indices in idx.
+ *
+ * Lanes of invalid that are set get a zero result.
+ */
+static INLINE __m256i lookup_epi16(const __m256i table, const __m256i idx, const __m256i invalid)
+{
+  // Index i selects bytes 2 * i and 2 * i + 1.
+  __m256i shuf = _mm256_add_epi16(_mm256_mullo_epi16(idx, _mm256_set1_epi16(0x0202)), _mm256_set1_epi16(0x0100));
+  shuf = _mm256_or_si256(shuf, invalid);
+  return _mm256_shuffle_epi8(table, shuf);
+}
+
+/**
+ * \brief Load up to eight int32 values as an epi16 table in both lanes.
+ */
+static INLINE __m256i load_table_epi16(const int32_t *values, int count)
+{
+  int16_t table[8] = { 0 };
+  for (int i = 0; i < count; ++i) {
+    table[i] = (int16_t)values[i];
+  }
+  return _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)table));
+}
+
+/**
+ * \brief Calculate 2 + SIGN3(c - a) + SIGN3(c - b) for each pixel.
+ */
+static INLINE __m256i calc_eo_idx_16bit(const __m256i a, const __m256i b, const __m256i c)
+{
+  const __m256i sign_a = _mm256_sub_epi16(_mm256_cmpgt_epi16(a, c), _mm256_cmpgt_epi16(c, a));
+  const __m256i sign_b = _mm256_sub_epi16(_mm256_cmpgt_epi16(b, c), _mm256_cmpgt_epi16(c, b));
+  return _mm256_add_epi16(_mm256_add_epi16(sign_a, sign_b), _mm256_set1_epi16(2));
+}
+
+/**
+ * \brief Edge offsets ordered by eo_idx instead of the edge category.
+ */
+static INLINE __m256i load_eo_table_16bit(const int32_t *offsets)
+{
+  const int32_t by_idx[5] = { offsets[1], offsets[2], offsets[0], offsets[3], offsets[4] };
+  return load_table_epi16(by_idx, 5);
+}
+
+/**
+ * \brief Check that offset - 2 * (orig - rec) can be computed in 16 bits.
+ */
+static INLINE bool offsets_fit_16bit(const int32_t *offsets, int count)
+{
+  const int32_t limit = INT16_MAX - 2 * ((1 << UVG_BIT_DEPTH) - 1);
+  for (int i = 0; i < count; ++i) {
+    if (offsets[i] > limit || offsets[i] < -limit) return false;
+  }
+  return true;
+}
+
+static int32_t sao_edge_ddistortion_16bit_avx2(const uvg_pixel *orig_data,
+                                               const uvg_pixel *rec_data,
+                                                     int32_t    block_width,
+                                                     int32_t    block_height,
+                                                     int32_t    eo_class,
+                                               const int32_t    offsets[NUM_SAO_EDGE_CATEGORIES])
+{
+  const vector2d_t a_ofs = g_sao_edge_offsets[eo_class][0];
+  const vector2d_t b_ofs = g_sao_edge_offsets[eo_class][1];
+  const int32_t a_pos = a_ofs.y * block_width + a_ofs.x;
+  const int32_t b_pos = b_ofs.y * block_width + b_ofs.x;
+
+  if (!offsets_fit_16bit(offsets, NUM_SAO_EDGE_CATEGORIES)) {
+    return sao_edge_ddistortion_generic(orig_data, rec_data, block_width,
+                                        block_height, eo_class, offsets);
+  }
+
+  const __m256i table = load_eo_table_16bit(offsets);
+  const __m256i zero = _mm256_setzero_si256();
+
+  int32_t sum = 0;
+  __m256i sum_v = _mm256_setzero_si256();
+  for (int32_t y = 1; y < block_height - 1; y++) {
+    int32_t x = 1;
+    for (; x + 16 <= block_width - 1; x += 16) {
+      const uvg_pixel *c_data = &rec_data[y * block_width + x];
+      const __m256i a    = _mm256_loadu_si256((const __m256i *)(c_data + a_pos));
+      const __m256i b    = _mm256_loadu_si256((const __m256i *)(c_data + b_pos));
+      const __m256i c    = _mm256_loadu_si256((const __m256i *)c_data);
+      const __m256i orig = _mm256_loadu_si256((const __m256i *)&orig_data[y * block_width + x]);
+
+      const __m256i offset = lookup_epi16(table, calc_eo_idx_16bit(a, b, c), zero);
+      const __m256i diff   = _mm256_sub_epi16(orig, c);
+
+      // (diff - offset)^2 - diff^2 == offset * (offset - 2 * diff)
+      const __m256i rhs = _mm256_sub_epi16(offset, _mm256_add_epi16(diff, diff));
+      sum_v = _mm256_add_epi32(sum_v, _mm256_madd_epi16(offset, rhs));
+    }
+    for (; x < block_width - 1; x++) {
+      const int32_t c_pos = y * block_width + x;
+      const uvg_pixel c = rec_data[c_pos];
+      const int32_t offset = offsets[sao_calc_eo_cat(rec_data[c_pos + a_pos], rec_data[c_pos + b_pos], c)];
+      const int32_t diff = orig_data[c_pos] - c;
+      sum += offset * (offset - 2 * diff);
+    }
+  }
+  return sum + hsum_8x32b(sum_v);
+}
+
+static void calc_sao_edge_dir_16bit_avx2(const uvg_pixel *orig_data,
+                                         const uvg_pixel *rec_data,
+                                               int32_t    eo_class,
+                                               int32_t    block_width,
+                                               int32_t    block_height,
+                                               int32_t    cat_sum_cnt[2][NUM_SAO_EDGE_CATEGORIES])
+{
+  static const int eo_idx_to_cat[] = { 1, 2, 0, 3, 4 };
+
+  const vector2d_t a_ofs = g_sao_edge_offsets[eo_class][0];
+  const vector2d_t b_ofs = g_sao_edge_offsets[eo_class][1];
+  const int32_t a_pos = a_ofs.y * block_width + a_ofs.x;
+  const int32_t b_pos = b_ofs.y * block_width + b_ofs.x;
+
+  const __m256i ones = _mm256_set1_epi16(1);
+
+  // Sums and counts are kept per eo_idx in epi32 lanes.
+  __m256i sums[5];
+  __m256i cnts[5];
+  for (int i = 0; i < 5; i++) {
+    sums[i] = _mm256_setzero_si256();
+    cnts[i] = _mm256_setzero_si256();
+  }
+
+  for (int32_t y = 1; y < block_height - 1; y++) {
+    int32_t x = 1;
+    for (; x + 16 <= block_width - 1; x += 16) {
+      const uvg_pixel *c_data = &rec_data[y * block_width + x];
+      const __m256i a    = _mm256_loadu_si256((const __m256i *)(c_data + a_pos));
+      const __m256i b    = _mm256_loadu_si256((const __m256i *)(c_data + b_pos));
+      const __m256i c    = _mm256_loadu_si256((const __m256i *)c_data);
+      const __m256i orig = _mm256_loadu_si256((const __m256i *)&orig_data[y * block_width + x]);
+
+      const __m256i eo_idx = calc_eo_idx_16bit(a, b, c);
+      const __m256i diff   = _mm256_sub_epi16(orig, c);
+
+      for (int i = 0; i < 5; i++) {
+        const __m256i mask = _mm256_cmpeq_epi16(eo_idx, _mm256_set1_epi16(i));
+        sums[i] = _mm256_add_epi32(sums[i], _mm256_madd_epi16(_mm256_and_si256(mask, diff), ones));
+        cnts[i] = _mm256_sub_epi32(cnts[i], _mm256_madd_epi16(mask, ones));
+      }
+    }
+    for (; x < block_width - 1; x++) {
+      const int32_t c_pos = y * block_width + x;
+      const uvg_pixel c = rec_data[c_pos];
+      const int eo_cat = sao_calc_eo_cat(rec_data[c_pos + a_pos], rec_data[c_pos + b_pos], c);
+
+      cat_sum_cnt[0][eo_cat] += orig_data[c_pos] - c;
+      cat_sum_cnt[1][eo_cat] += 1;
+    }
+  }
+
+  for (int i = 0; i < 5; i++) {
+    cat_sum_cnt[0][eo_idx_to_cat[i]] += hsum_8x32b(sums[i]);
+    cat_sum_cnt[1][eo_idx_to_cat[i]] += hsum_8x32b(cnts[i]);
+  }
+}
+
+static void sao_reconstruct_color_16bit_avx2(const encoder_control_t *encoder,
+                                             const uvg_pixel         *rec_data,
+                                                   uvg_pixel         *new_rec_data,
+                                             const sao_info_t        *sao,
+                                                   int32_t            stride,
+                                                   int32_t            new_stride,
+                                                   int32_t            block_width,
+                                                   int32_t            block_height,
+                                                   color_t            color_i)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i pixel_max = _mm256_set1_epi16(PIXEL_MAX);
+
+  if (sao->type == SAO_TYPE_BAND) {
+    const int32_t shift = encoder->bitdepth - 5;
+    const int32_t band_pos = color_i == COLOR_V ? 1 : 0;
+    const int32_t cur_bp = sao->band_position[band_pos];
+    const __m256i table = load_table_epi16(&sao->offsets[1 + 5 * band_pos], 4);
+    const __m256i bp = _mm256_set1_epi16(cur_bp);
+    const __m256i threes = _mm256_set1_epi16(3);
+
+    for (int32_t y = 0; y < block_height; y++) {
+      int32_t x = 0;
+      for (; x + 16 <= block_width; x += 16) {
+        const __m256i rec = _mm256_loadu_si256((const __m256i *)&rec_data[y * stride + x]);
+        const __m256i band = _mm256_sub_epi16(_mm256_srli_epi16(rec, shift), bp);
+        const __m256i invalid = _mm256_or_si256(_mm256_cmpgt_epi16(zero, band), _mm256_cmpgt_epi16(band, threes));
+
+        __m256i result = _mm256_add_epi16(rec, lookup_epi16(table, band, invalid));
+        result = _mm256_min_epi16(_mm256_max_epi16(result, zero), pixel_max);
+        _mm256_storeu_si256((__m256i *)&new_rec_data[y * new_stride + x], result);
+      }
+      for (; x < block_width; x++) {
+        const uvg_pixel rec = rec_data[y * stride + x];
+        const int32_t band = (rec >> shift) - cur_bp;
+        int32_t result = rec;
+        if (band >= 0 && band <= 3) {
+          result = CLIP_TO_PIXEL(rec + sao->offsets[band + 1 + 5 * band_pos]);
+        }
+        new_rec_data[y * new_stride + x] = (uvg_pixel)result;
+      }
+    }
+  } else {
+    const int32_t offset_v = color_i == COLOR_V ? 5 : 0;
+    const vector2d_t a_ofs = g_sao_edge_offsets[sao->eo_class][0];
+    const vector2d_t b_ofs = g_sao_edge_offsets[sao->eo_class][1];
+    const int32_t a_pos = a_ofs.y * stride + a_ofs.x;
+    const int32_t b_pos = b_ofs.y * stride + b_ofs.x;
+    const __m256i table = load_eo_table_16bit(&sao->offsets[offset_v]);
+
+    for (int32_t y = 0; y < block_height; y++) {
+      int32_t x = 0;
+      for (; x + 16 <= block_width; x += 16) {
+        const uvg_pixel *c_data = &rec_data[y * stride + x];
+        const __m256i a = _mm256_loadu_si256((const __m256i *)(c_data + a_pos));
+        const __m256i b = _mm256_loadu_si256((const __m256i *)(c_data + b_pos));
+        const __m256i c = _mm256_loadu_si256((const __m256i *)c_data);
+
+        __m256i result = _mm256_add_epi16(c, lookup_epi16(table, calc_eo_idx_16bit(a, b, c), zero));
+        result = _mm256_min_epi16(_mm256_max_epi16(result, zero), pixel_max);
+        _mm256_storeu_si256((__m256i *)&new_rec_data[y * new_stride + x], result);
+      }
+      for (; x < block_width; x++) {
+        const uvg_pixel *c_data = &rec_data[y * stride + x];
+        const int eo_cat = sao_calc_eo_cat(c_data[a_pos], c_data[b_pos], c_data[0]);
+        new_rec_data[y * new_stride + x] = (uvg_pixel)CLIP_TO_PIXEL(c_data[0] + sao->offsets[eo_cat + offset_v]);
+      }
+    }
+  }
+}
+
+static int32_t sao_band_ddistortion_16bit_avx2(const encoder_state_t *state,
+                                               const uvg_pixel       *orig_data,
+                                               const uvg_pixel       *rec_data,
+                                                     int32_t          block_width,
+                                                     int32_t          block_height,
+                                                     int32_t          band_pos,
+                                               const int32_t          sao_bands[4])
+{
+  if (!offsets_fit_16bit(sao_bands, 4)) {
+    return sao_band_ddistortion_generic(state, orig_data, rec_data, block_width,
+                                        block_height, band_pos, sao_bands);
+  }
+
+  const int32_t shift = state->encoder_control->bitdepth - 5;
+  const __m256i table = load_table_epi16(sao_bands, 4);
+  const __m256i bp = _mm256_set1_epi16(band_pos);
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i threes = _mm256_set1_epi16(3);
+
+  int32_t sum = 0;
+  __m256i sum_v = _mm256_setzero_si256();
+  for (int32_t y = 0; y < block_height; y++) {
+    int32_t x = 0;
+    for (; x + 16 <= block_width; x += 16) {
+      const int32_t curr_pos = y * block_width + x;
+      const __m256i rec  = _mm256_loadu_si256((const __m256i *)&rec_data[curr_pos]);
+      const __m256i orig = _mm256_loadu_si256((const __m256i *)&orig_data[curr_pos]);
+
+      const __m256i band = _mm256_sub_epi16(_mm256_srli_epi16(rec, shift), bp);
+      const __m256i invalid = _mm256_or_si256(_mm256_cmpgt_epi16(zero, band), _mm256_cmpgt_epi16(band, threes));
+      const __m256i offset = lookup_epi16(table, band, invalid);
+      const __m256i diff = _mm256_sub_epi16(orig, rec);
+
+      // (diff - offset)^2 - diff^2 == offset * (offset - 2 * diff)
+      const __m256i rhs = _mm256_sub_epi16(offset, _mm256_add_epi16(diff, diff));
+      sum_v = _mm256_add_epi32(sum_v, _mm256_madd_epi16(offset, rhs));
+    }
+    for (; x < block_width; x++) {
+      const int32_t curr_pos = y * block_width + x;
+      const int32_t band = (rec_data[curr_pos] >> shift) - band_pos;
+      const int32_t offset = band >= 0 && band <= 3 ? sao_bands[band] : 0;
+      const int32_t diff = orig_data[curr_pos] - rec_data[curr_pos];
+      sum += offset * (offset - 2 * diff);
+    }
+  }
+  return sum + hsum_8x32b(sum_v);
+}
+
 #endif // UVG_BIT_DEPTH == 8
 #endif //COMPILE_INTEL_AVX2
 
@@ -911,6 +1208,13 @@ int uvg_strategy_register_sao_avx2(void* opaque, uint8_t bitdepth)
     success &= uvg_strategyselector_register(opaque, "sao_reconstruct_color", "avx2", 40, &sao_reconstruct_color_avx2);
     success &= uvg_strategyselector_register(opaque, "sao_band_ddistortion", "avx2", 40, &sao_band_ddistortion_avx2);
   }
+#else // UVG_BIT_DEPTH == 8
+  if (bitdepth > 8) {
+    success &= uvg_strategyselector_register(opaque, "sao_edge_ddistortion", "avx2", 40, &sao_edge_ddistortion_16bit_avx2);
+    success &= uvg_strategyselector_register(opaque, "calc_sao_edge_dir", "avx2", 40, &calc_sao_edge_dir_16bit_avx2);
+    success &= uvg_strategyselector_register(opaque, "sao_reconstruct_color", "avx2", 40, &sao_reconstruct_color_16bit_avx2);
+    success &= uvg_strategyselector_register(opaque, "sao_band_ddistortion", "avx2", 40, &sao_band_ddistortion_16bit_avx2);
+  }
 #endif // UVG_BIT_DEPTH == 8
 #endif //COMPILE_INTEL_AVX2
   return success;
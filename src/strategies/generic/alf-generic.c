@@ -38,6 +38,7 @@
 #include "uvg266.h"
 #include "alf.h"
 #include "strategyselector.h"
+#include "uvg_math.h"
 
 extern uvg_pixel uvg_fast_clip_32bit_to_pixel(int32_t value);
 
@@ -739,6 +740,106 @@ static void alf_filter_7x7_block_generic(encoder_state_t* const state,
 
 
 
+static void alf_filter_cc_block_generic(encoder_state_t * const state,
+  uvg_pixel *dst_buf, const uvg_pixel *rec_src,
+  const int rec_luma_stride,
+  const alf_component_id comp_id, const int16_t *filter_coeff,
+  const clp_rngs clp_rngs, int vb_ctu_height, int vb_pos,
+  const int x_pos, const int y_pos,
+  const int blk_width,
+  const int blk_height)
+{
+
+  assert(!(1 << uvg_math_floor_log2(vb_ctu_height) != vb_ctu_height)); //Not a power of 2
+
+  assert(comp_id != COMPONENT_Y); //Must be chroma
+
+  enum uvg_chroma_format chroma_format = state->encoder_control->chroma_format;
+  uint8_t scale_y = (comp_id == COMPONENT_Y || chroma_format != UVG_CSP_420) ? 0 : 1;
+  uint8_t scale_x = (comp_id == COMPONENT_Y || chroma_format == UVG_CSP_444) ? 0 : 1;
+  const int cls_size_y = 4;
+  const int cls_size_x = 4;
+  const int start_height = y_pos;
+  const int end_height = y_pos + blk_height;
+  const int start_width = x_pos;
+  const int end_width = x_pos + blk_width;
+  const int luma_start_height = start_height << scale_y;
+  const int luma_start_width = start_width << scale_x;
+
+  assert(!(start_height % cls_size_y)); //Wrong start_height in filtering
+  assert(!(start_width % cls_size_x)); //Wrong start_width in filtering
+  assert(!((end_height - start_height) % cls_size_y)); //Wrong end_height in filtering
+  assert(!((end_width - start_width) % cls_size_x)); //Wrong end_width in filtering
+
+  const uvg_pixel* src_buf = rec_src;
+  const uvg_pixel* luma_ptr = src_buf + luma_start_height * rec_luma_stride + luma_start_width;
+
+  const int chroma_stride = rec_luma_stride >> scale_x;
+  uvg_pixel* chroma_ptr = dst_buf + start_height * chroma_stride + start_width;
+
+  for (int i = 0; i < end_height - start_height; i += cls_size_y)
+  {
+    for (int j = 0; j < end_width - start_width; j += cls_size_x)
+    {
+      for (int ii = 0; ii < cls_size_y; ii++)
+      {
+        int row = ii;
+        int col = j;
+        uvg_pixel *src_self = chroma_ptr + col + row * chroma_stride;
+
+        int offset1 = rec_luma_stride;
+        int offset2 = -rec_luma_stride;
+        int offset3 = 2 * rec_luma_stride;
+        row <<= scale_y;
+        col <<= scale_x;
+        const uvg_pixel *src_cross = luma_ptr + col + row * rec_luma_stride;
+
+        int pos = ((start_height + i + ii) << scale_y) & (vb_ctu_height - 1);
+        if (scale_y == 0 && (pos == vb_pos || pos == vb_pos + 1))
+        {
+          continue;
+        }
+        if (pos == (vb_pos - 2) || pos == (vb_pos + 1))
+        {
+          offset3 = offset1;
+        }
+        else if (pos == (vb_pos - 1) || pos == vb_pos)
+        {
+          offset1 = 0;
+          offset2 = 0;
+          offset3 = 0;
+        }
+
+        for (int jj = 0; jj < cls_size_x; jj++)
+        {
+          const int jj2 = (jj << scale_x);
+          const int offset0 = 0;
+
+          int sum = 0;
+          const uvg_pixel curr_src_cross = src_cross[offset0 + jj2];
+          sum += filter_coeff[0] * (src_cross[offset2 + jj2] - curr_src_cross);
+          sum += filter_coeff[1] * (src_cross[offset0 + jj2 - 1] - curr_src_cross);
+          sum += filter_coeff[2] * (src_cross[offset0 + jj2 + 1] - curr_src_cross);
+          sum += filter_coeff[3] * (src_cross[offset1 + jj2 - 1] - curr_src_cross);
+          sum += filter_coeff[4] * (src_cross[offset1 + jj2] - curr_src_cross);
+          sum += filter_coeff[5] * (src_cross[offset1 + jj2 + 1] - curr_src_cross);
+          sum += filter_coeff[6] * (src_cross[offset3 + jj2] - curr_src_cross);
+
+          sum = (sum + ((1 << 7/*m_scaleBits*/) >> 1)) >> 7/*m_scaleBits*/;
+          const int offset = 1 << clp_rngs.comp[comp_id].bd >> 1;
+          sum = uvg_fast_clip_32bit_to_pixel(sum + offset) - offset;
+          sum += src_self[jj];
+          src_self[jj] = uvg_fast_clip_32bit_to_pixel(sum);
+        }
+      }
+    }
+
+    chroma_ptr += chroma_stride * cls_size_y;
+
+    luma_ptr += rec_luma_stride * cls_size_y << scale_y;
+  }
+}
+
 static void alf_calc_covariance_generic(int16_t e_local[MAX_NUM_ALF_LUMA_COEFF][MAX_ALF_NUM_CLIPPING_VALUES],
   const uvg_pixel* rec,
   const int stride,
@@ -1006,6 +1107,7 @@ int uvg_strategy_register_alf_generic(void* opaque, uint8_t bitdepth)
   success &= uvg_strategyselector_register(opaque, "alf_derive_classification_blk", "generic", 0, &alf_derive_classification_blk_generic);
   success &= uvg_strategyselector_register(opaque, "alf_filter_5x5_blk", "generic", 0, &alf_filter_5x5_block_generic);
   success &= uvg_strategyselector_register(opaque, "alf_filter_7x7_blk", "generic", 0, &alf_filter_7x7_block_generic);
+  success &= uvg_strategyselector_register(opaque, "alf_filter_cc_blk", "generic", 0, &alf_filter_cc_block_generic);
   success &= uvg_strategyselector_register(opaque, "alf_get_blk_stats", "generic", 0, &alf_get_blk_stats_generic);
   
 
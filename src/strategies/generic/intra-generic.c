@@ -40,86 +40,154 @@
 #include "strategyselector.h"
 #include "uvg_math.h"
 
+static const int16_t modedisp2sampledisp[32] = { 0,    1,    2,    3,    4,    6,     8,   10,   12,   14,   16,   18,   20,   23,   26,   29,   32,   35,   39,  45,  51,  57,  64,  73,  86, 102, 128, 171, 256, 341, 512, 1024 };
+static const int16_t modedisp2invsampledisp[32] = { 0, 16384, 8192, 5461, 4096, 2731, 2048, 1638, 1365, 1170, 1024, 910, 819, 712, 630, 565, 512, 468, 420, 364, 321, 287, 256, 224, 191, 161, 128, 96, 64, 48, 32, 16 }; // (512 * 32) / sampledisp
+static const int32_t pre_scale[] = { 8, 7, 6, 5, 5, 4, 4, 4, 3, 3, 3, 3, 3, 3, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 0, 0, 0, -1, -1, -2, -3 };
+
+static const int16_t cubic_filter[32][4] =
+{
+  { 0, 64,  0,  0 },
+  { -1, 63,  2,  0 },
+  { -2, 62,  4,  0 },
+  { -2, 60,  7, -1 },
+  { -2, 58, 10, -2 },
+  { -3, 57, 12, -2 },
+  { -4, 56, 14, -2 },
+  { -4, 55, 15, -2 },
+  { -4, 54, 16, -2 },
+  { -5, 53, 18, -2 },
+  { -6, 52, 20, -2 },
+  { -6, 49, 24, -3 },
+  { -6, 46, 28, -4 },
+  { -5, 44, 29, -4 },
+  { -4, 42, 30, -4 },
+  { -4, 39, 33, -4 },
+  { -4, 36, 36, -4 },
+  { -4, 33, 39, -4 },
+  { -4, 30, 42, -4 },
+  { -4, 29, 44, -5 },
+  { -4, 28, 46, -6 },
+  { -3, 24, 49, -6 },
+  { -2, 20, 52, -6 },
+  { -2, 18, 53, -5 },
+  { -2, 16, 54, -4 },
+  { -2, 15, 55, -4 },
+  { -2, 14, 56, -4 },
+  { -2, 12, 57, -3 },
+  { -2, 10, 58, -2 },
+  { -1,  7, 60, -2 },
+  { 0,  4, 62, -2 },
+  { 0,  2, 63, -1 },
+};
+
+// Size of the work buffers holding the references of an angular prediction.
+#define ANGULAR_REF_BUFFER_SIZE (2 * 128 + 3 + 33 * MAX_REF_LINE_IDX)
+
 
 /**
- * \brief Generate angular predictions.
- * \param cu_loc        CU location and size data.
- * \param intra_mode    Angular mode in range 2..34.
- * \param channel_type  Color channel.
- * \param in_ref_above  Pointer to -1 index of above reference, length=width*2+1.
- * \param in_ref_left   Pointer to -1 index of left reference, length=height*2+1.
- * \param dst           Buffer of size width*width.
+ * \brief Copy references to the work buffers of an angular prediction.
+ *
+ * For negative angles the references are placed so that there is room for
+ * projecting the side reference in front of the main reference. For positive
+ * angles the end of the main reference is padded. The buffers only depend on
+ * the sign of the angle and, for positive angles, on the prediction
+ * direction, so they can be shared between modes.
+ *
+ * \param width         Width of the block.
+ * \param height        Height of the block.
+ * \param vertical_mode Whether the main reference is the above reference.
+ * \param negative_disp Whether the angle has a negative sample displacement.
+ * \param in_ref_above  Pointer to -1 index of above reference.
+ * \param in_ref_left   Pointer to -1 index of left reference.
+ * \param temp_above    Zero initialized buffer of size ANGULAR_REF_BUFFER_SIZE.
+ * \param temp_left     Zero initialized buffer of size ANGULAR_REF_BUFFER_SIZE.
  * \param multi_ref_idx Multi reference line index for use with MRL.
+ * \param isp_mode      ISP split type.
+ * \param cu_dim        Size of the CU in the ISP split direction.
  */
-static void uvg_angular_pred_generic(
-  const cu_loc_t* const cu_loc,
-  const int_fast8_t intra_mode,
-  const int_fast8_t channel_type,
+static void angular_pred_copy_refs_generic(
+  const int width,
+  const int height,
+  const bool vertical_mode,
+  const bool negative_disp,
   const uvg_pixel *const in_ref_above,
   const uvg_pixel *const in_ref_left,
-  uvg_pixel *const dst,
+  uvg_pixel *const temp_above,
+  uvg_pixel *const temp_left,
   const uint8_t multi_ref_idx,
   const uint8_t isp_mode,
   const int cu_dim)
 {
-  int width  = channel_type == COLOR_Y ? cu_loc->width : cu_loc->chroma_width;
-  int height = channel_type == COLOR_Y ? cu_loc->height : cu_loc->chroma_height;
   const int log2_width  = uvg_g_convert_to_log2[width];
   const int log2_height = uvg_g_convert_to_log2[height];
-  
-  assert((log2_width >= 2 && log2_width <= 5) &&  log2_height <= 5);
-  // assert(intra_mode >= 2 && intra_mode <= 66);
+  const uint8_t multi_ref_index = multi_ref_idx;
 
-  static const int16_t modedisp2sampledisp[32] = { 0,    1,    2,    3,    4,    6,     8,   10,   12,   14,   16,   18,   20,   23,   26,   29,   32,   35,   39,  45,  51,  57,  64,  73,  86, 102, 128, 171, 256, 341, 512, 1024 };
-  static const int16_t modedisp2invsampledisp[32] = { 0, 16384, 8192, 5461, 4096, 2731, 2048, 1638, 1365, 1170, 1024, 910, 819, 712, 630, 565, 512, 468, 420, 364, 321, 287, 256, 224, 191, 161, 128, 96, 64, 48, 32, 16 }; // (512 * 32) / sampledisp
-  static const int32_t pre_scale[] = { 8, 7, 6, 5, 5, 4, 4, 4, 3, 3, 3, 3, 3, 3, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 0, 0, 0, -1, -1, -2, -3 };
-  
-  static const int16_t cubic_filter[32][4] =
-  {
-    { 0, 64,  0,  0 },
-    { -1, 63,  2,  0 },
-    { -2, 62,  4,  0 },
-    { -2, 60,  7, -1 },
-    { -2, 58, 10, -2 },
-    { -3, 57, 12, -2 },
-    { -4, 56, 14, -2 },
-    { -4, 55, 15, -2 },
-    { -4, 54, 16, -2 },
-    { -5, 53, 18, -2 },
-    { -6, 52, 20, -2 },
-    { -6, 49, 24, -3 },
-    { -6, 46, 28, -4 },
-    { -5, 44, 29, -4 },
-    { -4, 42, 30, -4 },
-    { -4, 39, 33, -4 },
-    { -4, 36, 36, -4 },
-    { -4, 33, 39, -4 },
-    { -4, 30, 42, -4 },
-    { -4, 29, 44, -5 },
-    { -4, 28, 46, -6 },
-    { -3, 24, 49, -6 },
-    { -2, 20, 52, -6 },
-    { -2, 18, 53, -5 },
-    { -2, 16, 54, -4 },
-    { -2, 15, 55, -4 },
-    { -2, 14, 56, -4 },
-    { -2, 12, 57, -3 },
-    { -2, 10, 58, -2 },
-    { -1,  7, 60, -2 },
-    { 0,  4, 62, -2 },
-    { 0,  2, 63, -1 },
-  };
-
-                                                    // Temporary buffer for modes 11-25.
-                                                    // It only needs to be big enough to hold indices from -width to width-1.
+  if (negative_disp) {
+    memcpy(&temp_above[height], &in_ref_above[0], (width + 2 + multi_ref_index) * sizeof(uvg_pixel));
+    memcpy(&temp_left[width], &in_ref_left[0], (height + 2 + multi_ref_index) * sizeof(uvg_pixel));
+  }
+  else {
+    const int top_ref_length  = isp_mode == ISP_MODE_VER ? width + cu_dim  : width << 1;
+    const int left_ref_length = isp_mode == ISP_MODE_HOR ? height + cu_dim : height << 1;
 
-  uvg_pixel temp_dst[TR_MAX_WIDTH * TR_MAX_WIDTH];
+    memcpy(&temp_above[0], &in_ref_above[0], (top_ref_length + 1 + multi_ref_index) * sizeof(uvg_pixel));
+    memcpy(&temp_left[0], &in_ref_left[0], (left_ref_length + 1 + multi_ref_index) * sizeof(uvg_pixel));
 
+    uvg_pixel *ref_main = vertical_mode ? temp_above : temp_left;
 
-  // TODO: check the correct size for these arrays when MRL is used
-  //uvg_pixel tmp_ref[2 * 128 + 3 + 33 * MAX_REF_LINE_IDX] = { 0 };
-  uvg_pixel temp_above[2 * 128 + 3 + 33 * MAX_REF_LINE_IDX] = { 0 };
-  uvg_pixel temp_left[2 * 128 + 3 + 33 * MAX_REF_LINE_IDX] = { 0 };
+    const int log2_ratio = log2_width - log2_height;
+    const int s = MAX(0, vertical_mode ? log2_ratio : -log2_ratio);
+    const int max_index = (multi_ref_index << s) + 2;
+    int ref_length;
+    if (isp_mode) {
+      ref_length = vertical_mode ? top_ref_length : left_ref_length;
+    }
+    else {
+      ref_length = vertical_mode ? width << 1 : height << 1;
+    }
+    const uvg_pixel val = ref_main[ref_length + multi_ref_index];
+    for (int j = 1; j <= max_index; j++) {
+      ref_main[ref_length + multi_ref_index +  j] = val;
+    }
+  }
+}
+
+
+/**
+ * \brief Generate angular prediction from references prepared with
+ *        angular_pred_copy_refs_generic.
+ *
+ * The side reference is projected in front of the main reference for
+ * negative angles, which only touches the part of temp_above or temp_left
+ * reserved for it.
+ *
+ * \param width         Width of the block.
+ * \param height        Height of the block.
+ * \param intra_mode    Wide angle corrected angular mode.
+ * \param channel_type  Color channel.
+ * \param temp_above    Prepared above reference.
+ * \param temp_left     Prepared left reference.
+ * \param dst           Buffer of size width*height.
+ * \param multi_ref_idx Multi reference line index for use with MRL.
+ * \param isp_mode      ISP split type.
+ */
+static void angular_pred_from_refs_generic(
+  int width,
+  int height,
+  const int_fast8_t intra_mode,
+  const int_fast8_t channel_type,
+  uvg_pixel *const temp_above,
+  uvg_pixel *const temp_left,
+  uvg_pixel *const dst,
+  const uint8_t multi_ref_idx,
+  const uint8_t isp_mode)
+{
+  const int log2_width  = uvg_g_convert_to_log2[width];
+  const int log2_height = uvg_g_convert_to_log2[height];
+
+  // Temporary buffer for modes 11-25.
+  // It only needs to be big enough to hold indices from -width to width-1.
+  uvg_pixel temp_dst[TR_MAX_WIDTH * TR_MAX_WIDTH];
 
   uint32_t pred_mode = intra_mode; // ToDo: handle WAIP
 
@@ -142,16 +210,10 @@ static void uvg_angular_pred_generic(
   // Pointer for the other reference.
   const uvg_pixel *ref_side;
   uvg_pixel* work = width == height || vertical_mode ? dst : temp_dst;
-  
-  const int top_ref_length  = isp_mode == ISP_MODE_VER ? width + cu_dim  : width << 1;
-  const int left_ref_length = isp_mode == ISP_MODE_HOR ? height + cu_dim : height << 1;
 
   // Set ref_main and ref_side such that, when indexed with 0, they point to
   // index 0 in block coordinates.
   if (sample_disp < 0) {
-    memcpy(&temp_above[height], &in_ref_above[0], (width + 2 + multi_ref_index) * sizeof(uvg_pixel));
-    memcpy(&temp_left[width], &in_ref_left[0], (height + 2 + multi_ref_index) * sizeof(uvg_pixel));
-
     ref_main = vertical_mode ? temp_above + height : temp_left + width;
     ref_side = vertical_mode ? temp_left + width : temp_above + height;
 
@@ -161,29 +223,10 @@ static void uvg_angular_pred_generic(
     }
   }
   else {
-    memcpy(&temp_above[0], &in_ref_above[0], (top_ref_length + 1 + multi_ref_index) * sizeof(uvg_pixel));
-    memcpy(&temp_left[0], &in_ref_left[0], (left_ref_length + 1 + multi_ref_index) * sizeof(uvg_pixel));
-
     ref_main = vertical_mode ? temp_above : temp_left;
     ref_side = vertical_mode ? temp_left : temp_above;
-
-    const int log2_ratio = log2_width - log2_height;
-    const int s = MAX(0, vertical_mode ? log2_ratio : -log2_ratio);
-    const int max_index = (multi_ref_index << s) + 2;
-    int ref_length;
-    if (isp_mode) {
-      ref_length = vertical_mode ? top_ref_length : left_ref_length;
-    }
-    else {
-      ref_length = vertical_mode ? width << 1 : height << 1;
-    }
-    const uvg_pixel val = ref_main[ref_length + multi_ref_index];
-    for (int j = 1; j <= max_index; j++) {
-      ref_main[ref_length + multi_ref_index +  j] = val;
-    }
   }
 
-
   // compensate for line offset in reference line buffers
   ref_main += multi_ref_index;
   ref_side += multi_ref_index;
@@ -315,6 +358,98 @@ static void uvg_angular_pred_generic(
   }
 }
 
+/**
+ * \brief Generate angular predictions.
+ * \param cu_loc        CU location and size data.
+ * \param intra_mode    Angular mode in range 2..34.
+ * \param channel_type  Color channel.
+ * \param in_ref_above  Pointer to -1 index of above reference, length=width*2+1.
+ * \param in_ref_left   Pointer to -1 index of left reference, length=height*2+1.
+ * \param dst           Buffer of size width*width.
+ * \param multi_ref_idx Multi reference line index for use with MRL.
+ */
+void uvg_angular_pred_generic(
+  const cu_loc_t* const cu_loc,
+  const int_fast8_t intra_mode,
+  const int_fast8_t channel_type,
+  const uvg_pixel *const in_ref_above,
+  const uvg_pixel *const in_ref_left,
+  uvg_pixel *const dst,
+  const uint8_t multi_ref_idx,
+  const uint8_t isp_mode,
+  const int cu_dim)
+{
+  const int width  = channel_type == COLOR_Y ? cu_loc->width : cu_loc->chroma_width;
+  const int height = channel_type == COLOR_Y ? cu_loc->height : cu_loc->chroma_height;
+  
+  assert((width >= 4 && width <= 32) && height <= 32);
+  // assert(intra_mode >= 2 && intra_mode <= 66);
+
+  // TODO: check the correct size for these arrays when MRL is used
+  uvg_pixel temp_above[ANGULAR_REF_BUFFER_SIZE] = { 0 };
+  uvg_pixel temp_left[ANGULAR_REF_BUFFER_SIZE] = { 0 };
+
+  const bool vertical_mode = intra_mode >= 34;
+  const int_fast8_t mode_disp = vertical_mode ? intra_mode - 50 : -((int32_t)intra_mode - 18);
+
+  angular_pred_copy_refs_generic(width, height, vertical_mode, mode_disp < 0,
+                                 in_ref_above, in_ref_left, temp_above, temp_left,
+                                 multi_ref_idx, isp_mode, cu_dim);
+  angular_pred_from_refs_generic(width, height, intra_mode, channel_type,
+                                 temp_above, temp_left, dst, multi_ref_idx, isp_mode);
+}
+
+
+/**
+ * \brief Generate luma angular predictions for several modes.
+ *
+ * The reference buffers are built once for all negative angles and once per
+ * direction for the positive angles instead of once per mode.
+ *
+ * \param cu_loc        CU location and size data.
+ * \param intra_modes   Wide angle corrected angular modes.
+ * \param num_modes     Number of modes in intra_modes.
+ * \param in_ref_above  Pointer to -1 index of above reference, length=width*2+1.
+ * \param in_ref_left   Pointer to -1 index of left reference, length=height*2+1.
+ * \param dst           Buffers of size width*height, one for each mode.
+ * \param multi_ref_idx Multi reference line index for use with MRL.
+ */
+void uvg_angular_pred_multi_generic(
+  const cu_loc_t* const cu_loc,
+  const int8_t *const intra_modes,
+  const int num_modes,
+  const uvg_pixel *const in_ref_above,
+  const uvg_pixel *const in_ref_left,
+  uvg_pixel *const *const dst,
+  const uint8_t multi_ref_idx)
+{
+  const int width  = cu_loc->width;
+  const int height = cu_loc->height;
+
+  // Negative angles, positive vertical angles and positive horizontal angles.
+  uvg_pixel temp_above[3][ANGULAR_REF_BUFFER_SIZE];
+  uvg_pixel temp_left[3][ANGULAR_REF_BUFFER_SIZE];
+  bool initialized[3] = { false, false, false };
+
+  for (int i = 0; i < num_modes; ++i) {
+    const int_fast8_t intra_mode = intra_modes[i];
+    const bool vertical_mode = intra_mode >= 34;
+    const int_fast8_t mode_disp = vertical_mode ? intra_mode - 50 : -((int32_t)intra_mode - 18);
+    const int group = mode_disp < 0 ? 0 : (vertical_mode ? 1 : 2);
+
+    if (!initialized[group]) {
+      memset(temp_above[group], 0, sizeof(temp_above[group]));
+      memset(temp_left[group], 0, sizeof(temp_left[group]));
+      angular_pred_copy_refs_generic(width, height, vertical_mode, mode_disp < 0,
+                                     in_ref_above, in_ref_left, temp_above[group], temp_left[group],
+                                     multi_ref_idx, 0, 0);
+      initialized[group] = true;
+    }
+    angular_pred_from_refs_generic(width, height, intra_mode, COLOR_Y,
+                                   temp_above[group], temp_left[group], dst[i], multi_ref_idx, 0);
+  }
+}
+
 
 /**
  * \brief Generate planar prediction.
@@ -463,6 +598,7 @@ int uvg_strategy_register_intra_generic(void* opaque, uint8_t bitdepth)
   bool success = true;
 
   success &= uvg_strategyselector_register(opaque, "angular_pred", "generic", 0, &uvg_angular_pred_generic);
+  success &= uvg_strategyselector_register(opaque, "angular_pred_multi", "generic", 0, &uvg_angular_pred_multi_generic);
   success &= uvg_strategyselector_register(opaque, "intra_pred_planar", "generic", 0, &uvg_intra_pred_planar_generic);
   success &= uvg_strategyselector_register(opaque, "intra_pred_filtered_dc", "generic", 0, &uvg_intra_pred_filtered_dc_generic);
   success &= uvg_strategyselector_register(opaque, "pdpc_planar_dc", "generic", 0, &uvg_pdpc_planar_dc_generic);
@@ -38,8 +38,30 @@
  * Generic C implementations of optimized functions.
  */
 
+#include "cu.h"
 #include "global.h" // IWYU pragma: keep
+#include "uvg266.h"
 
 int uvg_strategy_register_intra_generic(void* opaque, uint8_t bitdepth);
 
+void uvg_angular_pred_generic(
+  const cu_loc_t* const cu_loc,
+  const int_fast8_t intra_mode,
+  const int_fast8_t channel_type,
+  const uvg_pixel *const in_ref_above,
+  const uvg_pixel *const in_ref_left,
+  uvg_pixel *const dst,
+  const uint8_t multi_ref_idx,
+  const uint8_t isp_mode,
+  const int cu_dim);
+
+void uvg_angular_pred_multi_generic(
+  const cu_loc_t* const cu_loc,
+  const int8_t *const intra_modes,
+  const int num_modes,
+  const uvg_pixel *const in_ref_above,
+  const uvg_pixel *const in_ref_left,
+  uvg_pixel *const *const dst,
+  const uint8_t multi_ref_idx);
+
 #endif //STRATEGIES_INTRA_GENERIC_H_
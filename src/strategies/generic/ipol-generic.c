@@ -758,6 +758,25 @@ void uvg_sample_octpel_chroma_hi_generic(const encoder_control_t * const encoder
 }
 
 
+static void copy_extended_block_generic(const uvg_pixel *src, int src_w, int src_h, int src_s,
+                                        int blk_x, int blk_y, int blk_w, int blk_h,
+                                        uvg_pixel *dst, int dst_s)
+{
+  const int cnt_l = CLIP(0, blk_w, -blk_x);
+  const int cnt_r = CLIP(0, blk_w - cnt_l, blk_x + blk_w - src_w);
+  const int cnt_m = blk_w - cnt_l - cnt_r;
+
+  for (int y = 0; y < blk_h; ++y) {
+    const uvg_pixel *row = &src[CLIP(0, src_h - 1, blk_y + y) * src_s];
+    uvg_pixel *dst_l = &dst[y * dst_s];
+    uvg_pixel *dst_m = dst_l + cnt_l;
+    uvg_pixel *dst_r = dst_m + cnt_m;
+    for (int i = 0; i < cnt_l; ++i) dst_l[i] = row[0];
+    if (cnt_m) memcpy(dst_m, &row[blk_x + cnt_l], cnt_m * sizeof(uvg_pixel));
+    for (int i = 0; i < cnt_r; ++i) dst_r[i] = row[src_w - 1];
+  }
+}
+
 void uvg_get_extended_block_generic(uvg_epol_args *args) {
 
   int min_y = args->blk_y - args->pad_t;
@@ -774,32 +793,15 @@ void uvg_get_extended_block_generic(uvg_epol_args *args) {
     *args->ext_s = args->pad_l + args->blk_w + args->pad_r;
     *args->ext_origin = args->buf + args->pad_t * (*args->ext_s) + args->pad_l;
 
-    // Note that stride equals width here.
-    int cnt_l = CLIP(0, *args->ext_s, -min_x);
-    int cnt_r = CLIP(0, *args->ext_s, max_x - (args->src_w - 1));
-    int cnt_m = CLIP(0, *args->ext_s, *args->ext_s - cnt_l - cnt_r);
+    // Copy each row including real padding. Note that stride equals
+    // width here.
+    const int rows = args->pad_t + args->blk_h + args->pad_b;
+    uvg_copy_extended_block(args->src, args->src_w, args->src_h, args->src_s,
+                            min_x, min_y, *args->ext_s, rows,
+                            args->buf, *args->ext_s);
 
-    // For each row including real padding.
     // Don't read "don't care" values (SIMD padding). Zero them out.
-    int y;
-    for (y = -args->pad_t; y < args->blk_h + args->pad_b; ++y) {
-
-      int clipped_y = CLIP(0, args->src_h - 1, args->blk_y + y);
-      uvg_pixel *sample_l = args->src + clipped_y * args->src_s;
-      uvg_pixel *sample_r = args->src + clipped_y * args->src_s + args->src_w - 1;
-      uvg_pixel *src_m = args->src + clipped_y * args->src_s + MAX(min_x, 0);
-      uvg_pixel *dst_l = args->buf + (y + args->pad_t) * (*args->ext_s);
-      uvg_pixel *dst_m = dst_l + cnt_l;
-      uvg_pixel *dst_r = dst_m + cnt_m;
-      for (int i = 0; i < cnt_l; ++i) *(dst_l + i) = *sample_l;
-      for (int i = 0; i < cnt_m; ++i) *(dst_m + i) = *(src_m + i);
-      for (int i = 0; i < cnt_r; ++i) *(dst_r + i) = *sample_r;
-    }
-
-    for (int y_simd = 0; y_simd < args->pad_b_simd; ++y_simd) {
-      uvg_pixel *dst = args->buf + (y + args->pad_t + y_simd) * (*args->ext_s);
-      FILL_ARRAY(dst, 0, *args->ext_s);
-    }
+    FILL_ARRAY(args->buf + rows * (*args->ext_s), 0, args->pad_b_simd * (*args->ext_s));
 
   } else {
 
@@ -822,6 +824,7 @@ int uvg_strategy_register_ipol_generic(void* opaque, uint8_t bitdepth)
   success &= uvg_strategyselector_register(opaque, "sample_quarterpel_luma_hi", "generic", 0, &uvg_sample_quarterpel_luma_hi_generic);
   success &= uvg_strategyselector_register(opaque, "sample_octpel_chroma_hi", "generic", 0, &uvg_sample_octpel_chroma_hi_generic);
   success &= uvg_strategyselector_register(opaque, "get_extended_block", "generic", 0, &uvg_get_extended_block_generic);
+  success &= uvg_strategyselector_register(opaque, "copy_extended_block", "generic", 0, &copy_extended_block_generic);
 
   return success;
 }
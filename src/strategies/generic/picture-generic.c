@@ -111,6 +111,27 @@ static unsigned reg_sad_generic(const uvg_pixel * const data1, const uvg_pixel *
   return sad;
 }
 
+/**
+ * \brief Calculate SADs of one block against four blocks.
+ *
+ * \param data1   Starting point of the block.
+ * \param data2   Starting points of the four blocks it is compared to.
+ * \param width   Width of the blocks.
+ * \param height  Height of the blocks.
+ * \param stride1 Stride of data1.
+ * \param stride2 Stride of each of data2.
+ * \param sad_out Returns the four SADs.
+ */
+static void reg_sad_x4_generic(const uvg_pixel * const data1, const uvg_pixel * const data2[4],
+                               const int width, const int height,
+                               const unsigned stride1, const unsigned stride2,
+                               unsigned sad_out[4])
+{
+  for (int i = 0; i < 4; ++i) {
+    sad_out[i] = reg_sad_generic(data1, data2[i], width, height, stride1, stride2);
+  }
+}
+
 /**
  * \brief  Transform differences between two 4x4 blocks.
  * From HM 13.0
@@ -409,6 +430,39 @@ SATD_DUAL_NXN(16, uvg_pixel)
 SATD_DUAL_NXN(32, uvg_pixel)
 SATD_DUAL_NXN(64, uvg_pixel)
 
+// Declare these functions to make sure the signature of the macro matches.
+static cost_pixel_nxn_multi_func satd_4x4_quad_generic;
+static cost_pixel_nxn_multi_func satd_8x8_quad_generic;
+static cost_pixel_nxn_multi_func satd_16x16_quad_generic;
+static cost_pixel_nxn_multi_func satd_32x32_quad_generic;
+
+#define SATD_QUAD_NXN(n, pixel_type) \
+static void satd_ ## n ## x ## n ## _quad_generic( \
+  const pred_buffer preds, const pixel_type * const orig, unsigned num_modes, unsigned *costs_out) \
+{ \
+  for (unsigned mode = 0; mode < num_modes; ++mode) { \
+    unsigned sum = 0; \
+    for (unsigned y = 0; y < (n); y += 8) { \
+      unsigned row = y * (n); \
+      for (unsigned x = 0; x < (n); x += 8) { \
+        sum += satd_8x8_subblock_generic(&orig[row + x], (n), &preds[mode][row + x], (n)); \
+      } \
+    } \
+    costs_out[mode] = sum>>(UVG_BIT_DEPTH-8); \
+  } \
+}
+
+static void satd_4x4_quad_generic(const pred_buffer preds, const uvg_pixel * const orig, unsigned num_modes, unsigned *costs_out)
+{
+  for (unsigned mode = 0; mode < num_modes; ++mode) {
+    costs_out[mode] = satd_4x4_generic(orig, preds[mode]);
+  }
+}
+
+SATD_QUAD_NXN(8, uvg_pixel)
+SATD_QUAD_NXN(16, uvg_pixel)
+SATD_QUAD_NXN(32, uvg_pixel)
+
 #define SATD_ANY_SIZE_MULTI_GENERIC(suffix, num_parallel_blocks) \
   static cost_pixel_any_size_multi_func satd_any_size_## suffix; \
   static void satd_any_size_ ## suffix ( \
@@ -1045,6 +1099,20 @@ static uint64_t xGetHADs(int width, int height, const uvg_pixel* ref_in, int ref
   return (uiSum >> 0);
 }
 
+static void satd_any_size_vtm_quad_generic(int width, int height,
+                                           const uvg_pixel **preds,
+                                           const int stride,
+                                           const uvg_pixel *orig,
+                                           const int orig_stride,
+                                           unsigned num_modes,
+                                           unsigned *costs_out,
+                                           int8_t *valid)
+{
+  for (unsigned mode = 0; mode < num_modes; ++mode) {
+    costs_out[mode] = (unsigned)xGetHADs(width, height, orig, orig_stride, preds[mode], stride);
+  }
+}
+
 
 // Function macro for defining SAD calculating functions
 // for fixed size blocks.
@@ -1109,6 +1177,30 @@ SAD_DUAL_NXN(16, uvg_pixel)
 SAD_DUAL_NXN(32, uvg_pixel)
 SAD_DUAL_NXN(64, uvg_pixel)
 
+// Declare these functions to make sure the signature of the macro matches.
+static cost_pixel_nxn_multi_func sad_4x4_quad_generic;
+static cost_pixel_nxn_multi_func sad_8x8_quad_generic;
+static cost_pixel_nxn_multi_func sad_16x16_quad_generic;
+static cost_pixel_nxn_multi_func sad_32x32_quad_generic;
+
+#define SAD_QUAD_NXN(n, pixel_type) \
+static void sad_ ##  n ## x ## n ## _quad_generic( \
+  const pred_buffer preds, const pixel_type * const orig, unsigned num_modes, unsigned *costs_out) \
+{ \
+  for (unsigned mode = 0; mode < num_modes; ++mode) { \
+    unsigned sum = 0; \
+    for (unsigned i = 0; i < (n)*(n); ++i) { \
+      sum += abs(preds[mode][i] - orig[i]); \
+    } \
+    costs_out[mode] = sum>>(UVG_BIT_DEPTH-8); \
+  } \
+}
+
+SAD_QUAD_NXN(4, uvg_pixel)
+SAD_QUAD_NXN(8, uvg_pixel)
+SAD_QUAD_NXN(16, uvg_pixel)
+SAD_QUAD_NXN(32, uvg_pixel)
+
 static unsigned pixels_calc_ssd_generic(const uvg_pixel *const ref, const uvg_pixel *const rec,
                  const int ref_stride, const int rec_stride,
                  const int width, const int height)
@@ -1432,18 +1524,64 @@ static uint32_t uvg_crc32c_8x8_8bit_generic(const uvg_pixel *buf, uint32_t pic_s
   return crc ^ 0xFFFFFFFF;
 }
 
+static uint32_t uvg_crc32c_8x8_16bit_generic(const uvg_pixel *buf, uint32_t pic_stride)
+{
+  uint32_t crc = 0xFFFFFFFF;
+  for (int y = 0; y < 8; ++y) {
+    for (int x = 0; x < 8; ++x) {
+      const uvg_pixel px = buf[y * pic_stride + x];
+      crc = (crc >> 8) ^ uvg_crc_table[(crc ^ px) & 0xFF];
+      crc = (crc >> 8) ^ uvg_crc_table[(crc ^ (px >> 8)) & 0xFF];
+    }
+  }
+  return crc ^ 0xFFFFFFFF;
+}
+
+static void uvg_crc32c_4x4_x4_8bit_generic(const uvg_pixel *buf, uint32_t pic_stride, uint32_t step, uint32_t crc_out[4])
+{
+  for (int i = 0; i < 4; ++i) {
+    crc_out[i] = uvg_crc32c_4x4_8bit_generic(buf + i * step, pic_stride);
+  }
+}
+
+static void uvg_crc32c_4x4_x4_16bit_generic(const uvg_pixel *buf, uint32_t pic_stride, uint32_t step, uint32_t crc_out[4])
+{
+  for (int i = 0; i < 4; ++i) {
+    crc_out[i] = uvg_crc32c_4x4_16bit_generic(buf + i * step, pic_stride);
+  }
+}
+
+static void uvg_crc32c_8x8_x4_8bit_generic(const uvg_pixel *buf, uint32_t pic_stride, uint32_t step, uint32_t crc_out[4])
+{
+  for (int i = 0; i < 4; ++i) {
+    crc_out[i] = uvg_crc32c_8x8_8bit_generic(buf + i * step, pic_stride);
+  }
+}
+static void uvg_crc32c_8x8_x4_16bit_generic(const uvg_pixel *buf, uint32_t pic_stride, uint32_t step, uint32_t crc_out[4])
+{
+  for (int i = 0; i < 4; ++i) {
+    crc_out[i] = uvg_crc32c_8x8_16bit_generic(buf + i * step, pic_stride);
+  }
+}
+
 int uvg_strategy_register_picture_generic(void* opaque, uint8_t bitdepth)
 {
   bool success = true;
   if (bitdepth == 8) {
     success &= uvg_strategyselector_register(opaque, "crc32c_4x4", "generic", 0, &uvg_crc32c_4x4_8bit_generic);
     success &= uvg_strategyselector_register(opaque, "crc32c_8x8", "generic", 0, &uvg_crc32c_8x8_8bit_generic);
+    success &= uvg_strategyselector_register(opaque, "crc32c_4x4_x4", "generic", 0, &uvg_crc32c_4x4_x4_8bit_generic);
+    success &= uvg_strategyselector_register(opaque, "crc32c_8x8_x4", "generic", 0, &uvg_crc32c_8x8_x4_8bit_generic);
   } else {
     success &= uvg_strategyselector_register(opaque, "crc32c_4x4", "generic", 0, &uvg_crc32c_4x4_16bit_generic);
+    success &= uvg_strategyselector_register(opaque, "crc32c_8x8", "generic", 0, &uvg_crc32c_8x8_16bit_generic);
+    success &= uvg_strategyselector_register(opaque, "crc32c_4x4_x4", "generic", 0, &uvg_crc32c_4x4_x4_16bit_generic);
+    success &= uvg_strategyselector_register(opaque, "crc32c_8x8_x4", "generic", 0, &uvg_crc32c_8x8_x4_16bit_generic);
   }
   
 
   success &= uvg_strategyselector_register(opaque, "reg_sad", "generic", 0, &reg_sad_generic);
+  success &= uvg_strategyselector_register(opaque, "reg_sad_x4", "generic", 0, &reg_sad_x4_generic);
 
   success &= uvg_strategyselector_register(opaque, "sad_4x4", "generic", 0, &sad_4x4_generic);
   success &= uvg_strategyselector_register(opaque, "sad_8x8", "generic", 0, &sad_8x8_generic);
@@ -1463,14 +1601,24 @@ int uvg_strategy_register_picture_generic(void* opaque, uint8_t bitdepth)
   success &= uvg_strategyselector_register(opaque, "sad_32x32_dual", "generic", 0, &sad_32x32_dual_generic);
   success &= uvg_strategyselector_register(opaque, "sad_64x64_dual", "generic", 0, &sad_64x64_dual_generic);
 
+  success &= uvg_strategyselector_register(opaque, "sad_4x4_quad", "generic", 0, &sad_4x4_quad_generic);
+  success &= uvg_strategyselector_register(opaque, "sad_8x8_quad", "generic", 0, &sad_8x8_quad_generic);
+  success &= uvg_strategyselector_register(opaque, "sad_16x16_quad", "generic", 0, &sad_16x16_quad_generic);
+  success &= uvg_strategyselector_register(opaque, "sad_32x32_quad", "generic", 0, &sad_32x32_quad_generic);
+
   success &= uvg_strategyselector_register(opaque, "satd_4x4_dual", "generic", 0, &satd_4x4_dual_generic);
   success &= uvg_strategyselector_register(opaque, "satd_8x8_dual", "generic", 0, &satd_8x8_dual_generic);
   success &= uvg_strategyselector_register(opaque, "satd_16x16_dual", "generic", 0, &satd_16x16_dual_generic);
   success &= uvg_strategyselector_register(opaque, "satd_32x32_dual", "generic", 0, &satd_32x32_dual_generic);
   success &= uvg_strategyselector_register(opaque, "satd_64x64_dual", "generic", 0, &satd_64x64_dual_generic);
+  success &= uvg_strategyselector_register(opaque, "satd_4x4_quad", "generic", 0, &satd_4x4_quad_generic);
+  success &= uvg_strategyselector_register(opaque, "satd_8x8_quad", "generic", 0, &satd_8x8_quad_generic);
+  success &= uvg_strategyselector_register(opaque, "satd_16x16_quad", "generic", 0, &satd_16x16_quad_generic);
+  success &= uvg_strategyselector_register(opaque, "satd_32x32_quad", "generic", 0, &satd_32x32_quad_generic);
   success &= uvg_strategyselector_register(opaque, "satd_any_size", "generic", 0, &satd_any_size_generic);
   success &= uvg_strategyselector_register(opaque, "satd_any_size_vtm", "generic", 0, &xGetHADs);
   success &= uvg_strategyselector_register(opaque, "satd_any_size_quad", "generic", 0, &satd_any_size_quad_generic);
+  success &= uvg_strategyselector_register(opaque, "satd_any_size_vtm_quad", "generic", 0, &satd_any_size_vtm_quad_generic);
 
   success &= uvg_strategyselector_register(opaque, "pixels_calc_ssd", "generic", 0, &pixels_calc_ssd_generic);
   success &= uvg_strategyselector_register(opaque, "bipred_average", "generic", 0, &bipred_average_generic);
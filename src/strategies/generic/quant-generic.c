@@ -129,7 +129,7 @@ void uvg_quant_generic(
     for (int32_t n = 0; n < width * height; n++) {
       int32_t level = coef[n];
       int64_t abs_level = (int64_t)abs(level);
-      int32_t curr_quant_coeff = quant_coeff[n];
+      int32_t curr_quant_coeff = use_scaling_list ? quant_coeff[n] : default_quant_coeff;
 
       level = (int32_t)((abs_level * curr_quant_coeff + add) >> q_bits);
       delta_u[n] = (int32_t)((abs_level * curr_quant_coeff - (level << q_bits)) >> q_bits8);
@@ -0,0 +1,134 @@
+/*****************************************************************************
+ * This file is part of uvg266 VVC encoder.
+ *
+ * Copyright (c) 2021, Tampere University, ITU/ISO/IEC, project contributors
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ * * Neither the name of the Tampere University or ITU/ISO/IEC nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * INCLUDING NEGLIGENCE OR OTHERWISE ARISING IN ANY WAY OUT OF THE USE OF THIS
+ ****************************************************************************/
+
+#include "global.h"
+
+#if COMPILE_INTEL_SSE41
+#include "uvg266.h"
+#if UVG_BIT_DEPTH == 8
+#include "strategies/sse41/ipol-sse41.h"
+
+#include <immintrin.h>
+#include <string.h>
+
+#include "strategies/strategies-ipol.h"
+#include "strategyselector.h"
+
+
+static INLINE void fill_row_sse41(uint8_t *dst, uint8_t value, int n)
+{
+  const __m128i v = _mm_set1_epi8((char)value);
+  if (n >= 16) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+      _mm_storeu_si128((__m128i *)&dst[i], v);
+    }
+    // Cover the rest with an overlapping store.
+    if (i < n) _mm_storeu_si128((__m128i *)&dst[n - 16], v);
+  } else if (n >= 8) {
+    _mm_storel_epi64((__m128i *)dst, v);
+    _mm_storel_epi64((__m128i *)&dst[n - 8], v);
+  } else if (n >= 4) {
+    const uint32_t v4 = value * 0x01010101u;
+    memcpy(dst, &v4, 4);
+    memcpy(&dst[n - 4], &v4, 4);
+  } else {
+    for (int i = 0; i < n; ++i) dst[i] = value;
+  }
+}
+
+static INLINE void copy_row_sse41(uint8_t *dst, const uint8_t *src, int n)
+{
+  if (n >= 16) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+      _mm_storeu_si128((__m128i *)&dst[i], _mm_loadu_si128((const __m128i *)&src[i]));
+    }
+    // Cover the rest with an overlapping load and store.
+    if (i < n) {
+      _mm_storeu_si128((__m128i *)&dst[n - 16], _mm_loadu_si128((const __m128i *)&src[n - 16]));
+    }
+  } else if (n >= 8) {
+    _mm_storel_epi64((__m128i *)dst, _mm_loadl_epi64((const __m128i *)src));
+    _mm_storel_epi64((__m128i *)&dst[n - 8], _mm_loadl_epi64((const __m128i *)&src[n - 8]));
+  } else if (n >= 4) {
+    uint32_t head, tail;
+    memcpy(&head, src, 4);
+    memcpy(&tail, &src[n - 4], 4);
+    memcpy(dst, &head, 4);
+    memcpy(&dst[n - 4], &tail, 4);
+  } else {
+    for (int i = 0; i < n; ++i) dst[i] = src[i];
+  }
+}
+
+static void copy_extended_block_sse41(const uvg_pixel *src, int src_w, int src_h, int src_s,
+                                      int blk_x, int blk_y, int blk_w, int blk_h,
+                                      uvg_pixel *dst, int dst_s)
+{
+  const int cnt_l = CLIP(0, blk_w, -blk_x);
+  const int cnt_r = CLIP(0, blk_w - cnt_l, blk_x + blk_w - src_w);
+  const int cnt_m = blk_w - cnt_l - cnt_r;
+
+  if (cnt_l == 0 && cnt_r == 0) {
+    // Only rows need to be replicated.
+    for (int y = 0; y < blk_h; ++y) {
+      const uvg_pixel *row = &src[CLIP(0, src_h - 1, blk_y + y) * src_s];
+      copy_row_sse41(&dst[y * dst_s], &row[blk_x], blk_w);
+    }
+    return;
+  }
+
+  for (int y = 0; y < blk_h; ++y) {
+    const uvg_pixel *row = &src[CLIP(0, src_h - 1, blk_y + y) * src_s];
+    uvg_pixel *out = &dst[y * dst_s];
+    if (cnt_l) fill_row_sse41(out, row[0], cnt_l);
+    if (cnt_m) copy_row_sse41(&out[cnt_l], &row[blk_x + cnt_l], cnt_m);
+    if (cnt_r) fill_row_sse41(&out[cnt_l + cnt_m], row[src_w - 1], cnt_r);
+  }
+}
+
+#endif // UVG_BIT_DEPTH == 8
+#endif //COMPILE_INTEL_SSE41
+
+
+int uvg_strategy_register_ipol_sse41(void* opaque, uint8_t bitdepth) {
+  bool success = true;
+#if COMPILE_INTEL_SSE41
+#if UVG_BIT_DEPTH == 8
+  if (bitdepth == 8){
+    success &= uvg_strategyselector_register(opaque, "copy_extended_block", "sse41", 20, &copy_extended_block_sse41);
+  }
+#endif // UVG_BIT_DEPTH == 8
+#endif
+  return success;
+}
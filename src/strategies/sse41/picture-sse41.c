@@ -63,6 +63,24 @@ uint32_t uvg_reg_sad_sse41(const uint8_t * const data1, const uint8_t * const da
     return reg_sad_arbitrary(data1, data2, width, height, stride1, stride2);
 }
 
+static void reg_sad_x4_sse41(const uint8_t * const data1, const uint8_t * const data2[4],
+                             const int32_t width, const int32_t height,
+                             const uint32_t stride1, const uint32_t stride2,
+                             uint32_t sad_out[4])
+{
+  if (width == 4) {
+    reg_sad_x4_w4(data1, data2, height, stride1, stride2, sad_out);
+  } else if (width == 8) {
+    reg_sad_x4_w8(data1, data2, height, stride1, stride2, sad_out);
+  } else if (width % 16 == 0) {
+    reg_sad_x4_w16n(data1, data2, width, height, stride1, stride2, sad_out);
+  } else {
+    for (int i = 0; i < 4; ++i) {
+      sad_out[i] = uvg_reg_sad_sse41(data1, data2[i], width, height, stride1, stride2);
+    }
+  }
+}
+
 static optimized_sad_func_ptr_t get_optimized_sad_sse41(int32_t width)
 {
   if (width == 0)
@@ -238,6 +256,7 @@ int uvg_strategy_register_picture_sse41(void* opaque, uint8_t bitdepth) {
 #if UVG_BIT_DEPTH == 8
   if (bitdepth == 8){
     success &= uvg_strategyselector_register(opaque, "reg_sad", "sse41", 20, &uvg_reg_sad_sse41);
+    success &= uvg_strategyselector_register(opaque, "reg_sad_x4", "sse41", 20, &reg_sad_x4_sse41);
     success &= uvg_strategyselector_register(opaque, "get_optimized_sad", "sse41", 20, &get_optimized_sad_sse41);
     success &= uvg_strategyselector_register(opaque, "ver_sad", "sse41", 20, &ver_sad_sse41);
     success &= uvg_strategyselector_register(opaque, "hor_sad", "sse41", 20, &hor_sad_sse41);
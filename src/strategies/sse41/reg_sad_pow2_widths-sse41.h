@@ -349,6 +349,148 @@ static INLINE uint32_t reg_sad_arbitrary(const uint8_t * const data1, const uint
   return _mm_cvtsi128_si32(sad);
 }
 
+/**
+ * \brief Add up the partial sums of four SADs.
+ */
+static INLINE void reg_sad_x4_store(const __m128i sums[4], uint32_t sad_out[4])
+{
+  __m128i sum_01 = _mm_add_epi64(_mm_unpacklo_epi64(sums[0], sums[1]),
+                                 _mm_unpackhi_epi64(sums[0], sums[1]));
+  __m128i sum_23 = _mm_add_epi64(_mm_unpacklo_epi64(sums[2], sums[3]),
+                                 _mm_unpackhi_epi64(sums[2], sums[3]));
+  __m128i sad    = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(sum_01),
+                                                   _mm_castsi128_ps(sum_23),
+                                                   _MM_SHUFFLE(2, 0, 2, 0)));
+  _mm_storeu_si128((__m128i *)sad_out, sad);
+}
+
+/*
+ * SAD of one block against four blocks at once. The rows of the first
+ * block are loaded once for all four.
+ */
+static INLINE void reg_sad_x4_w4(const uint8_t * const data1, const uint8_t * const data2[4],
+                                 const int32_t height, const uint32_t stride1,
+                                 const uint32_t stride2, uint32_t sad_out[4])
+{
+  const uint8_t *ref0 = data2[0];
+  const uint8_t *ref1 = data2[1];
+  const uint8_t *ref2 = data2[2];
+  const uint8_t *ref3 = data2[3];
+  __m128i sse_inc0 = _mm_setzero_si128();
+  __m128i sse_inc1 = _mm_setzero_si128();
+  __m128i sse_inc2 = _mm_setzero_si128();
+  __m128i sse_inc3 = _mm_setzero_si128();
+  int32_t y;
+
+  const int32_t height_fourline_groups = height & ~3;
+
+#define LOAD_W4_X4(ptr, stride) \
+  _mm_insert_epi32(_mm_insert_epi32(_mm_insert_epi32( \
+    _mm_cvtsi32_si128(*(const uint32_t *)((ptr) + (y + 0) * (stride))), \
+    *(const uint32_t *)((ptr) + (y + 1) * (stride)), 1), \
+    *(const uint32_t *)((ptr) + (y + 2) * (stride)), 2), \
+    *(const uint32_t *)((ptr) + (y + 3) * (stride)), 3)
+
+  for (y = 0; y < height_fourline_groups; y += 4) {
+    __m128i a = LOAD_W4_X4(data1, stride1);
+    sse_inc0 = _mm_add_epi64(sse_inc0, _mm_sad_epu8(a, LOAD_W4_X4(ref0, stride2)));
+    sse_inc1 = _mm_add_epi64(sse_inc1, _mm_sad_epu8(a, LOAD_W4_X4(ref1, stride2)));
+    sse_inc2 = _mm_add_epi64(sse_inc2, _mm_sad_epu8(a, LOAD_W4_X4(ref2, stride2)));
+    sse_inc3 = _mm_add_epi64(sse_inc3, _mm_sad_epu8(a, LOAD_W4_X4(ref3, stride2)));
+  }
+#undef LOAD_W4_X4
+
+  for (; y < height; y++) {
+    __m128i a = _mm_cvtsi32_si128(*(const uint32_t *)(data1 + y * stride1));
+    sse_inc0 = _mm_add_epi64(sse_inc0, _mm_sad_epu8(a, _mm_cvtsi32_si128(*(const uint32_t *)(ref0 + y * stride2))));
+    sse_inc1 = _mm_add_epi64(sse_inc1, _mm_sad_epu8(a, _mm_cvtsi32_si128(*(const uint32_t *)(ref1 + y * stride2))));
+    sse_inc2 = _mm_add_epi64(sse_inc2, _mm_sad_epu8(a, _mm_cvtsi32_si128(*(const uint32_t *)(ref2 + y * stride2))));
+    sse_inc3 = _mm_add_epi64(sse_inc3, _mm_sad_epu8(a, _mm_cvtsi32_si128(*(const uint32_t *)(ref3 + y * stride2))));
+  }
+
+  const __m128i sums[4] = { sse_inc0, sse_inc1, sse_inc2, sse_inc3 };
+  reg_sad_x4_store(sums, sad_out);
+}
+
+static INLINE void reg_sad_x4_w8(const uint8_t * const data1, const uint8_t * const data2[4],
+                                 const int32_t height, const uint32_t stride1,
+                                 const uint32_t stride2, uint32_t sad_out[4])
+{
+  const uint8_t *ref0 = data2[0];
+  const uint8_t *ref1 = data2[1];
+  const uint8_t *ref2 = data2[2];
+  const uint8_t *ref3 = data2[3];
+  __m128i sse_inc0 = _mm_setzero_si128();
+  __m128i sse_inc1 = _mm_setzero_si128();
+  __m128i sse_inc2 = _mm_setzero_si128();
+  __m128i sse_inc3 = _mm_setzero_si128();
+  int32_t y;
+
+  const int32_t height_twoline_groups = height & ~1;
+
+#define LOAD_W8_X2(ptr, stride) \
+  _mm_castpd_si128(_mm_loadh_pd(_mm_loadl_pd(_mm_setzero_pd(), \
+    (const double *)((ptr) + (y + 0) * (stride))), \
+    (const double *)((ptr) + (y + 1) * (stride))))
+
+  for (y = 0; y < height_twoline_groups; y += 2) {
+    __m128i a = LOAD_W8_X2(data1, stride1);
+    sse_inc0 = _mm_add_epi64(sse_inc0, _mm_sad_epu8(a, LOAD_W8_X2(ref0, stride2)));
+    sse_inc1 = _mm_add_epi64(sse_inc1, _mm_sad_epu8(a, LOAD_W8_X2(ref1, stride2)));
+    sse_inc2 = _mm_add_epi64(sse_inc2, _mm_sad_epu8(a, LOAD_W8_X2(ref2, stride2)));
+    sse_inc3 = _mm_add_epi64(sse_inc3, _mm_sad_epu8(a, LOAD_W8_X2(ref3, stride2)));
+  }
+#undef LOAD_W8_X2
+
+  if (y < height) {
+    __m128i a = _mm_loadl_epi64((const __m128i *)(data1 + y * stride1));
+    sse_inc0 = _mm_add_epi64(sse_inc0, _mm_sad_epu8(a, _mm_loadl_epi64((const __m128i *)(ref0 + y * stride2))));
+    sse_inc1 = _mm_add_epi64(sse_inc1, _mm_sad_epu8(a, _mm_loadl_epi64((const __m128i *)(ref1 + y * stride2))));
+    sse_inc2 = _mm_add_epi64(sse_inc2, _mm_sad_epu8(a, _mm_loadl_epi64((const __m128i *)(ref2 + y * stride2))));
+    sse_inc3 = _mm_add_epi64(sse_inc3, _mm_sad_epu8(a, _mm_loadl_epi64((const __m128i *)(ref3 + y * stride2))));
+  }
+
+  const __m128i sums[4] = { sse_inc0, sse_inc1, sse_inc2, sse_inc3 };
+  reg_sad_x4_store(sums, sad_out);
+}
+
+/*
+ * Width must be a multiple of 16.
+ */
+static INLINE void reg_sad_x4_w16n(const uint8_t * const data1, const uint8_t * const data2[4],
+                                   const int32_t width, const int32_t height,
+                                   const uint32_t stride1, const uint32_t stride2,
+                                   uint32_t sad_out[4])
+{
+  const uint8_t *ref0 = data2[0];
+  const uint8_t *ref1 = data2[1];
+  const uint8_t *ref2 = data2[2];
+  const uint8_t *ref3 = data2[3];
+  __m128i sse_inc0 = _mm_setzero_si128();
+  __m128i sse_inc1 = _mm_setzero_si128();
+  __m128i sse_inc2 = _mm_setzero_si128();
+  __m128i sse_inc3 = _mm_setzero_si128();
+
+  for (int32_t y = 0; y < height; y++) {
+    const uint8_t *row1 = data1 + y * stride1;
+    const int32_t offset2 = y * stride2;
+    for (int32_t x = 0; x < width; x += 16) {
+      __m128i a = _mm_loadu_si128((const __m128i *)(row1 + x));
+      __m128i b0 = _mm_loadu_si128((const __m128i *)(ref0 + offset2 + x));
+      __m128i b1 = _mm_loadu_si128((const __m128i *)(ref1 + offset2 + x));
+      __m128i b2 = _mm_loadu_si128((const __m128i *)(ref2 + offset2 + x));
+      __m128i b3 = _mm_loadu_si128((const __m128i *)(ref3 + offset2 + x));
+      sse_inc0 = _mm_add_epi64(sse_inc0, _mm_sad_epu8(a, b0));
+      sse_inc1 = _mm_add_epi64(sse_inc1, _mm_sad_epu8(a, b1));
+      sse_inc2 = _mm_add_epi64(sse_inc2, _mm_sad_epu8(a, b2));
+      sse_inc3 = _mm_add_epi64(sse_inc3, _mm_sad_epu8(a, b3));
+    }
+  }
+
+  const __m128i sums[4] = { sse_inc0, sse_inc1, sse_inc2, sse_inc3 };
+  reg_sad_x4_store(sums, sad_out);
+}
+
 static uint32_t ver_sad_w4(const uint8_t *pic_data, const uint8_t *ref_data,
                            int32_t height, uint32_t stride)
 {
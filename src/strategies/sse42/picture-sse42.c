@@ -79,6 +79,61 @@ static uint32_t uvg_crc32c_8x8_8bit_sse42(const uvg_pixel *buf, uint32_t pic_str
 }
 
 
+/**
+ * \brief Checksums of four blocks at once.
+ *
+ * The crc32 instruction has a latency of several cycles but a throughput
+ * of one per cycle, so four independent checksums are computed in
+ * about the time of one.
+ */
+static void uvg_crc32c_4x4_x4_8bit_sse42(const uvg_pixel *buf, uint32_t pic_stride, uint32_t step, uint32_t crc_out[4])
+{
+  uint32_t crc0 = 0xFFFFFFFF, crc1 = 0xFFFFFFFF, crc2 = 0xFFFFFFFF, crc3 = 0xFFFFFFFF;
+  for (int y = 0; y < 4; ++y) {
+    const uvg_pixel *line = &buf[y * pic_stride];
+    crc0 = _mm_crc32_u32(crc0, *((uint32_t *)&line[0 * step]));
+    crc1 = _mm_crc32_u32(crc1, *((uint32_t *)&line[1 * step]));
+    crc2 = _mm_crc32_u32(crc2, *((uint32_t *)&line[2 * step]));
+    crc3 = _mm_crc32_u32(crc3, *((uint32_t *)&line[3 * step]));
+  }
+  crc_out[0] = crc0 ^ 0xFFFFFFFF;
+  crc_out[1] = crc1 ^ 0xFFFFFFFF;
+  crc_out[2] = crc2 ^ 0xFFFFFFFF;
+  crc_out[3] = crc3 ^ 0xFFFFFFFF;
+}
+
+static void uvg_crc32c_4x4_x4_16bit_sse42(const uvg_pixel *buf, uint32_t pic_stride, uint32_t step, uint32_t crc_out[4])
+{
+  uint64_t crc0 = 0xFFFFFFFF, crc1 = 0xFFFFFFFF, crc2 = 0xFFFFFFFF, crc3 = 0xFFFFFFFF;
+  for (int y = 0; y < 4; ++y) {
+    const uvg_pixel *line = &buf[y * pic_stride];
+    crc0 = _mm_crc32_u64(crc0, *((uint64_t *)&line[0 * step]));
+    crc1 = _mm_crc32_u64(crc1, *((uint64_t *)&line[1 * step]));
+    crc2 = _mm_crc32_u64(crc2, *((uint64_t *)&line[2 * step]));
+    crc3 = _mm_crc32_u64(crc3, *((uint64_t *)&line[3 * step]));
+  }
+  crc_out[0] = (uint32_t)(crc0 ^ 0xFFFFFFFF);
+  crc_out[1] = (uint32_t)(crc1 ^ 0xFFFFFFFF);
+  crc_out[2] = (uint32_t)(crc2 ^ 0xFFFFFFFF);
+  crc_out[3] = (uint32_t)(crc3 ^ 0xFFFFFFFF);
+}
+
+static void uvg_crc32c_8x8_x4_8bit_sse42(const uvg_pixel *buf, uint32_t pic_stride, uint32_t step, uint32_t crc_out[4])
+{
+  uint64_t crc0 = 0xFFFFFFFF, crc1 = 0xFFFFFFFF, crc2 = 0xFFFFFFFF, crc3 = 0xFFFFFFFF;
+  for (int y = 0; y < 8; ++y) {
+    const uvg_pixel *line = &buf[y * pic_stride];
+    crc0 = _mm_crc32_u64(crc0, *((uint64_t *)&line[0 * step]));
+    crc1 = _mm_crc32_u64(crc1, *((uint64_t *)&line[1 * step]));
+    crc2 = _mm_crc32_u64(crc2, *((uint64_t *)&line[2 * step]));
+    crc3 = _mm_crc32_u64(crc3, *((uint64_t *)&line[3 * step]));
+  }
+  crc_out[0] = (uint32_t)(crc0 ^ 0xFFFFFFFF);
+  crc_out[1] = (uint32_t)(crc1 ^ 0xFFFFFFFF);
+  crc_out[2] = (uint32_t)(crc2 ^ 0xFFFFFFFF);
+  crc_out[3] = (uint32_t)(crc3 ^ 0xFFFFFFFF);
+}
+
 #endif //COMPILE_INTEL_SSE42
 
 int uvg_strategy_register_picture_sse42(void* opaque, uint8_t bitdepth) {
@@ -87,8 +142,11 @@ int uvg_strategy_register_picture_sse42(void* opaque, uint8_t bitdepth) {
   if (bitdepth == 8){
     success &= uvg_strategyselector_register(opaque, "crc32c_4x4", "sse42", 0, &uvg_crc32c_4x4_8bit_sse42);
     success &= uvg_strategyselector_register(opaque, "crc32c_8x8", "sse42", 0, &uvg_crc32c_8x8_8bit_sse42); 
+    success &= uvg_strategyselector_register(opaque, "crc32c_4x4_x4", "sse42", 0, &uvg_crc32c_4x4_x4_8bit_sse42);
+    success &= uvg_strategyselector_register(opaque, "crc32c_8x8_x4", "sse42", 0, &uvg_crc32c_8x8_x4_8bit_sse42);
   } else {
     success &= uvg_strategyselector_register(opaque, "crc32c_4x4", "sse42", 0, &uvg_crc32c_4x4_16bit_sse42); 
+    success &= uvg_strategyselector_register(opaque, "crc32c_4x4_x4", "sse42", 0, &uvg_crc32c_4x4_x4_16bit_sse42);
   }
 #endif
   return success;
@@ -41,6 +41,7 @@
 alf_derive_classification_blk_func* uvg_alf_derive_classification_blk;
 alf_filter_5x5_blk_func* uvg_alf_filter_5x5_blk;
 alf_filter_7x7_blk_func* uvg_alf_filter_7x7_blk;
+alf_filter_cc_blk_func* uvg_alf_filter_cc_blk;
 alf_get_blk_stats_func* uvg_alf_get_blk_stats;
 
 int uvg_strategy_register_alf(void* opaque, uint8_t bitdepth) {
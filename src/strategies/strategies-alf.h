@@ -90,6 +90,20 @@ typedef void (alf_filter_7x7_blk_func)(encoder_state_t* const state,
   int vb_pos,
   const int vb_ctu_height);
 
+typedef void (alf_filter_cc_blk_func)(encoder_state_t* const state,
+  uvg_pixel* dst_buf,
+  const uvg_pixel* rec_src,
+  const int rec_luma_stride,
+  const alf_component_id comp_id,
+  const int16_t* filter_coeff,
+  const clp_rngs clp_rngs,
+  int vb_ctu_height,
+  int vb_pos,
+  const int x_pos,
+  const int y_pos,
+  const int blk_width,
+  const int blk_height);
+
 typedef void (alf_get_blk_stats_func)(encoder_state_t* const state,
   channel_type channel,
   alf_covariance* alf_covariance,
@@ -112,6 +126,7 @@ typedef void (alf_get_blk_stats_func)(encoder_state_t* const state,
 extern alf_derive_classification_blk_func * uvg_alf_derive_classification_blk;
 extern alf_filter_5x5_blk_func* uvg_alf_filter_5x5_blk;
 extern alf_filter_7x7_blk_func* uvg_alf_filter_7x7_blk;
+extern alf_filter_cc_blk_func* uvg_alf_filter_cc_blk;
 extern alf_get_blk_stats_func* uvg_alf_get_blk_stats;
 
 int uvg_strategy_register_alf(void* opaque, uint8_t bitdepth);
@@ -121,6 +136,7 @@ int uvg_strategy_register_alf(void* opaque, uint8_t bitdepth);
   {"alf_derive_classification_blk", (void**) &uvg_alf_derive_classification_blk}, \
   {"alf_filter_5x5_blk", (void**) &uvg_alf_filter_5x5_blk}, \
   {"alf_filter_7x7_blk", (void**) &uvg_alf_filter_7x7_blk}, \
+  {"alf_filter_cc_blk", (void**) &uvg_alf_filter_cc_blk}, \
   {"alf_get_blk_stats", (void**) &uvg_alf_get_blk_stats}, \
  
 
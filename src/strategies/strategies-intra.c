@@ -39,6 +39,7 @@
 
 // Define function pointers.
 angular_pred_func *uvg_angular_pred;
+angular_pred_multi_func *uvg_angular_pred_multi;
 intra_pred_planar_func *uvg_intra_pred_planar;
 intra_pred_filtered_dc_func *uvg_intra_pred_filtered_dc;
 pdpc_planar_dc_func *uvg_pdpc_planar_dc;
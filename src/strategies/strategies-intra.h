@@ -55,6 +55,15 @@ typedef void (angular_pred_func)(
   const uint8_t isp_mode,
   const int cu_dim);
 
+typedef void (angular_pred_multi_func)(
+  const cu_loc_t* const cu_loc,
+  const int8_t *const intra_modes,
+  const int num_modes,
+  const uvg_pixel *const in_ref_above,
+  const uvg_pixel *const in_ref_left,
+  uvg_pixel *const *const dst,
+  const uint8_t multi_ref_idx);
+
 typedef void (intra_pred_planar_func)(
   const cu_loc_t* const cu_loc,
   color_t color,
@@ -78,6 +87,7 @@ typedef void (pdpc_planar_dc_func)(
 
 // Declare function pointers.
 extern angular_pred_func * uvg_angular_pred;
+extern angular_pred_multi_func * uvg_angular_pred_multi;
 extern intra_pred_planar_func * uvg_intra_pred_planar;
 extern intra_pred_filtered_dc_func * uvg_intra_pred_filtered_dc;
 extern pdpc_planar_dc_func * uvg_pdpc_planar_dc;
@@ -87,6 +97,7 @@ int uvg_strategy_register_intra(void* opaque, uint8_t bitdepth);
 
 #define STRATEGIES_INTRA_EXPORTS \
   {"angular_pred", (void**) &uvg_angular_pred}, \
+  {"angular_pred_multi", (void**) &uvg_angular_pred_multi}, \
   {"intra_pred_planar", (void**) &uvg_intra_pred_planar}, \
   {"intra_pred_filtered_dc", (void**) &uvg_intra_pred_filtered_dc}, \
   {"pdpc_planar_dc", (void**) &uvg_pdpc_planar_dc}, \
@@ -34,6 +34,7 @@
 
 #include "strategies/avx2/ipol-avx2.h"
 #include "strategies/generic/ipol-generic.h"
+#include "strategies/sse41/ipol-sse41.h"
 #include "strategyselector.h"
 
 
@@ -43,6 +44,7 @@ ipol_blocks_func * uvg_filter_hpel_blocks_diag_luma;
 ipol_blocks_func * uvg_filter_qpel_blocks_hor_ver_luma;
 ipol_blocks_func * uvg_filter_qpel_blocks_diag_luma;
 epol_func *uvg_get_extended_block;
+epol_copy_func *uvg_copy_extended_block;
 uvg_sample_quarterpel_luma_func * uvg_sample_quarterpel_luma;
 uvg_sample_octpel_chroma_func * uvg_sample_octpel_chroma;
 uvg_sample_quarterpel_luma_hi_func * uvg_sample_quarterpel_luma_hi;
@@ -54,6 +56,9 @@ int uvg_strategy_register_ipol(void* opaque, uint8_t bitdepth) {
 
   success &= uvg_strategy_register_ipol_generic(opaque, bitdepth);
 
+  if (uvg_g_hardware_flags.intel_flags.sse41) {
+    success &= uvg_strategy_register_ipol_sse41(opaque, bitdepth);
+  }
   if (uvg_g_hardware_flags.intel_flags.avx2) {
     success &= uvg_strategy_register_ipol_avx2(opaque, bitdepth);
   }
@@ -93,6 +93,27 @@ typedef struct {
 
 typedef void(epol_func)(uvg_epol_args *args);
 
+/**
+ * \brief Copy a block of a picture, extending the picture over its borders.
+ *
+ * Samples of the block outside the picture get the value of the closest
+ * sample inside it.
+ *
+ * \param src     top-left sample of the picture
+ * \param src_w   width of the picture
+ * \param src_h   height of the picture
+ * \param src_s   stride of the picture
+ * \param blk_x   x-coordinate of the block in the picture, may be negative
+ * \param blk_y   y-coordinate of the block in the picture, may be negative
+ * \param blk_w   width of the block
+ * \param blk_h   height of the block
+ * \param dst     destination of the block
+ * \param dst_s   stride of the destination
+ */
+typedef void(epol_copy_func)(const uvg_pixel *src, int src_w, int src_h, int src_s,
+                             int blk_x, int blk_y, int blk_w, int blk_h,
+                             uvg_pixel *dst, int dst_s);
+
 
 typedef void(uvg_sample_quarterpel_luma_func)(const encoder_control_t * const encoder, uvg_pixel *src, int16_t src_stride, int width, int height, uvg_pixel *dst, int16_t dst_stride, int8_t hor_flag, int8_t ver_flag, const mv_t mv[2]);
 typedef void(uvg_sample_octpel_chroma_func)(const encoder_control_t * const encoder, uvg_pixel *src, int16_t src_stride, int width, int height, uvg_pixel *dst, int16_t dst_stride, int8_t hor_flag, int8_t ver_flag, const mv_t mv[2]);
@@ -128,6 +149,7 @@ extern ipol_blocks_func * uvg_filter_hpel_blocks_diag_luma;
 extern ipol_blocks_func * uvg_filter_qpel_blocks_hor_ver_luma;
 extern ipol_blocks_func * uvg_filter_qpel_blocks_diag_luma;
 extern epol_func * uvg_get_extended_block;
+extern epol_copy_func * uvg_copy_extended_block;
 extern uvg_sample_quarterpel_luma_func * uvg_sample_quarterpel_luma;
 extern uvg_sample_octpel_chroma_func * uvg_sample_octpel_chroma;
 extern uvg_sample_quarterpel_luma_hi_func * uvg_sample_quarterpel_luma_hi;
@@ -147,6 +169,7 @@ int uvg_strategy_register_ipol(void* opaque, uint8_t bitdepth);
   {"sample_quarterpel_luma_hi", (void**) &uvg_sample_quarterpel_luma_hi}, \
   {"sample_octpel_chroma_hi", (void**) &uvg_sample_octpel_chroma_hi}, \
   {"get_extended_block", (void**) &uvg_get_extended_block}, \
+  {"copy_extended_block", (void**) &uvg_copy_extended_block}, \
 
 
 
@@ -44,7 +44,10 @@
 // Define function pointers.
 crc32c_4x4_func * uvg_crc32c_4x4 = 0;
 crc32c_8x8_func * uvg_crc32c_8x8 = 0;
+crc32c_4x4_x4_func * uvg_crc32c_4x4_x4 = 0;
+crc32c_8x8_x4_func * uvg_crc32c_8x8_x4 = 0;
 reg_sad_func * uvg_reg_sad = 0;
+reg_sad_x4_func * uvg_reg_sad_x4 = 0;
 
 cost_pixel_nxn_func * uvg_sad_4x4 = 0;
 cost_pixel_nxn_func * uvg_sad_8x8 = 0;
@@ -70,9 +73,20 @@ cost_pixel_nxn_multi_func * uvg_satd_16x16_dual = 0;
 cost_pixel_nxn_multi_func * uvg_satd_32x32_dual = 0;
 cost_pixel_nxn_multi_func * uvg_satd_64x64_dual = 0;
 
+cost_pixel_nxn_multi_func * uvg_sad_4x4_quad = 0;
+cost_pixel_nxn_multi_func * uvg_sad_8x8_quad = 0;
+cost_pixel_nxn_multi_func * uvg_sad_16x16_quad = 0;
+cost_pixel_nxn_multi_func * uvg_sad_32x32_quad = 0;
+
+cost_pixel_nxn_multi_func * uvg_satd_4x4_quad = 0;
+cost_pixel_nxn_multi_func * uvg_satd_8x8_quad = 0;
+cost_pixel_nxn_multi_func * uvg_satd_16x16_quad = 0;
+cost_pixel_nxn_multi_func * uvg_satd_32x32_quad = 0;
+
 cost_pixel_any_size_func * uvg_satd_any_size = 0;
 cost_pixel_any_size_func * uvg_satd_any_size_vtm = 0;
 cost_pixel_any_size_multi_func * uvg_satd_any_size_quad = 0;
+cost_pixel_any_size_multi_func * uvg_satd_any_size_vtm_quad = 0;
 
 pixels_calc_ssd_func * uvg_pixels_calc_ssd = 0;
 
@@ -229,6 +243,67 @@ cost_pixel_nxn_multi_func * uvg_pixels_get_sad_dual_func(unsigned width, unsigne
   return NULL;
 }
 
+/**
+* \brief  Get a function that calculates SATDs for up to 4 NxN blocks.
+*
+* Rectangular blocks have no fixed size kernel, use
+* uvg_satd_any_size_vtm_quad for them instead.
+*
+* \param width  Width of the region for which SATD is calculated.
+* \param height  Height of the region for which SATD is calculated.
+*
+* \returns  Pointer to cost_pixel_nxn_multi_func.
+*/
+cost_pixel_nxn_multi_func * uvg_pixels_get_satd_quad_func(unsigned width, unsigned height)
+{
+  if(width == height) {
+    switch (width) {
+      case 4:
+        return uvg_satd_4x4_quad;
+      case 8:
+        return uvg_satd_8x8_quad;
+      case 16:
+        return uvg_satd_16x16_quad;
+      case 32:
+        return uvg_satd_32x32_quad;
+      default:
+        return NULL;
+    }
+  }
+  return NULL;
+}
+
+
+/**
+* \brief  Get a function that calculates SADs for up to 4 NxN blocks.
+*
+* Rectangular blocks have no fixed size kernel, use uvg_reg_sad_x4 for
+* them instead.
+*
+* \param width  Width of the region for which SAD is calculated.
+* \param height  Height of the region for which SAD is calculated.
+*
+* \returns  Pointer to cost_pixel_nxn_multi_func.
+*/
+cost_pixel_nxn_multi_func * uvg_pixels_get_sad_quad_func(unsigned width, unsigned height)
+{
+  if(width == height) {
+    switch (width) {
+      case 4:
+        return uvg_sad_4x4_quad;
+      case 8:
+        return uvg_sad_8x8_quad;
+      case 16:
+        return uvg_sad_16x16_quad;
+      case 32:
+        return uvg_sad_32x32_quad;
+      default:
+        return NULL;
+    }
+  }
+  return NULL;
+}
+
 // Precomputed CRC32C lookup table for polynomial 0x04C11DB7
 const uint32_t uvg_crc_table[256] = {
   0x00000000, 0xf26b8303, 0xe13b70f7, 0x1350f3f4, 0xc79a971f, 0x35f1141c,
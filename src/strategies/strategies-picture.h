@@ -115,6 +115,10 @@ static unsigned satd_ ## n ## x ## n ## _ ## suffix ( \
 typedef unsigned(reg_sad_func)(const uvg_pixel *const data1, const uvg_pixel *const data2,
   const int width, const int height,
   const unsigned stride1, const unsigned stride2);
+typedef void(reg_sad_x4_func)(const uvg_pixel *const data1, const uvg_pixel *const data2[4],
+  const int width, const int height,
+  const unsigned stride1, const unsigned stride2,
+  unsigned sad_out[4]);
 typedef unsigned (cost_pixel_nxn_func)(const uvg_pixel *block1, const uvg_pixel *block2);
 typedef unsigned (cost_pixel_any_size_func)(
     int width, int height,
@@ -156,12 +160,18 @@ extern const uint32_t uvg_crc_table[256];
 
 typedef uint32_t(crc32c_4x4_func)(const uvg_pixel *buf, uint32_t pic_stride);
 typedef uint32_t(crc32c_8x8_func)(const uvg_pixel *buf, uint32_t pic_stride);
+// Checksums of four blocks starting at buf + i * step.
+typedef void(crc32c_4x4_x4_func)(const uvg_pixel *buf, uint32_t pic_stride, uint32_t step, uint32_t crc_out[4]);
+typedef void(crc32c_8x8_x4_func)(const uvg_pixel *buf, uint32_t pic_stride, uint32_t step, uint32_t crc_out[4]);
 
 // Declare function pointers.
 extern crc32c_4x4_func * uvg_crc32c_4x4;
 extern crc32c_8x8_func * uvg_crc32c_8x8;
+extern crc32c_4x4_x4_func * uvg_crc32c_4x4_x4;
+extern crc32c_8x8_x4_func * uvg_crc32c_8x8_x4;
 
 extern reg_sad_func * uvg_reg_sad;
+extern reg_sad_x4_func * uvg_reg_sad_x4;
 
 extern cost_pixel_nxn_func * uvg_sad_4x4;
 extern cost_pixel_nxn_func * uvg_sad_8x8;
@@ -189,7 +199,18 @@ extern cost_pixel_nxn_multi_func * uvg_satd_16x16_dual;
 extern cost_pixel_nxn_multi_func * uvg_satd_32x32_dual;
 extern cost_pixel_nxn_multi_func * uvg_satd_64x64_dual;
 
+extern cost_pixel_nxn_multi_func * uvg_sad_4x4_quad;
+extern cost_pixel_nxn_multi_func * uvg_sad_8x8_quad;
+extern cost_pixel_nxn_multi_func * uvg_sad_16x16_quad;
+extern cost_pixel_nxn_multi_func * uvg_sad_32x32_quad;
+
+extern cost_pixel_nxn_multi_func * uvg_satd_4x4_quad;
+extern cost_pixel_nxn_multi_func * uvg_satd_8x8_quad;
+extern cost_pixel_nxn_multi_func * uvg_satd_16x16_quad;
+extern cost_pixel_nxn_multi_func * uvg_satd_32x32_quad;
+
 extern cost_pixel_any_size_multi_func *uvg_satd_any_size_quad;
+extern cost_pixel_any_size_multi_func *uvg_satd_any_size_vtm_quad;
 
 extern pixels_calc_ssd_func *uvg_pixels_calc_ssd;
 
@@ -206,11 +227,16 @@ extern generate_residual_func* uvg_generate_residual;
 int uvg_strategy_register_picture(void* opaque, uint8_t bitdepth);
 cost_pixel_nxn_multi_func * uvg_pixels_get_satd_dual_func(unsigned width, unsigned height);
 cost_pixel_nxn_multi_func * uvg_pixels_get_sad_dual_func(unsigned width, unsigned height);
+cost_pixel_nxn_multi_func * uvg_pixels_get_satd_quad_func(unsigned width, unsigned height);
+cost_pixel_nxn_multi_func * uvg_pixels_get_sad_quad_func(unsigned width, unsigned height);
 
 #define STRATEGIES_PICTURE_EXPORTS \
   {"crc32c_4x4", (void**) &uvg_crc32c_4x4}, \
   {"crc32c_8x8", (void **)&uvg_crc32c_8x8}, \
+  {"crc32c_4x4_x4", (void **)&uvg_crc32c_4x4_x4}, \
+  {"crc32c_8x8_x4", (void **)&uvg_crc32c_8x8_x4}, \
   {"reg_sad", (void**) &uvg_reg_sad}, \
+  {"reg_sad_x4", (void**) &uvg_reg_sad_x4}, \
   {"sad_4x4", (void**) &uvg_sad_4x4}, \
   {"sad_8x8", (void**) &uvg_sad_8x8}, \
   {"sad_16x16", (void**) &uvg_sad_16x16}, \
@@ -233,7 +259,16 @@ cost_pixel_nxn_multi_func * uvg_pixels_get_sad_dual_func(unsigned width, unsigne
   {"satd_16x16_dual", (void**) &uvg_satd_16x16_dual}, \
   {"satd_32x32_dual", (void**) &uvg_satd_32x32_dual}, \
   {"satd_64x64_dual", (void**) &uvg_satd_64x64_dual}, \
+  {"sad_4x4_quad", (void**) &uvg_sad_4x4_quad}, \
+  {"sad_8x8_quad", (void**) &uvg_sad_8x8_quad}, \
+  {"sad_16x16_quad", (void**) &uvg_sad_16x16_quad}, \
+  {"sad_32x32_quad", (void**) &uvg_sad_32x32_quad}, \
+  {"satd_4x4_quad", (void**) &uvg_satd_4x4_quad}, \
+  {"satd_8x8_quad", (void**) &uvg_satd_8x8_quad}, \
+  {"satd_16x16_quad", (void**) &uvg_satd_16x16_quad}, \
+  {"satd_32x32_quad", (void**) &uvg_satd_32x32_quad}, \
   {"satd_any_size_quad", (void**) &uvg_satd_any_size_quad}, \
+  {"satd_any_size_vtm_quad", (void**) &uvg_satd_any_size_vtm_quad}, \
   {"pixels_calc_ssd", (void**) &uvg_pixels_calc_ssd}, \
   {"bipred_average", (void**) &uvg_bipred_average}, \
   {"get_optimized_sad", (void**) &uvg_get_optimized_sad}, \
@@ -45,16 +45,22 @@
 /**
  * \file
  *
+ * Every worker thread owns a queue of ready jobs, ordered by job priority.
+ * A worker takes the job with the highest priority from its own queue and,
+ * when that is empty, steals one from the queue of another worker. Jobs
+ * with equal priority are run in the order they became ready. The queue
+ * lock of the thread queue is only used for putting idle workers to sleep.
+ *
  * Lock acquisition order:
  *
  * 1. When locking a job and its dependency, the dependecy must be locked
  * first and then the job depending on it.
  *
- * 2. When locking a job and the thread queue, the thread queue must be
- * locked first and then the job.
+ * 2. The lock of a worker queue must be locked last. No other lock may be
+ * taken while holding it.
  *
- * 3. When accessing threadqueue_job_t.next, the thread queue must be
- * locked.
+ * 3. When accessing threadqueue_job_t.next or threadqueue_job_t.prev, the
+ * worker queue containing the job must be locked.
  */
 
 #define THREADQUEUE_LIST_REALLOC_SIZE 32
@@ -168,20 +174,56 @@ struct threadqueue_job_t {
   void *arg;
 
   /**
-   * \brief Pointer to the next job in the queue.
+   * \brief Jobs with higher priority are run first.
+   */
+  int64_t priority;
+
+  /**
+   * \brief Pointer to the next job in the worker queue.
    */
   struct threadqueue_job_t *next;
 
+  /**
+   * \brief Pointer to the previous job in the worker queue.
+   */
+  struct threadqueue_job_t *prev;
+
 };
 
 
+/**
+ * \brief Ready jobs of one worker thread.
+ */
+typedef struct threadqueue_worker_t {
+  threadqueue_queue_t *threadqueue;
+
+  /**
+   * \brief Protects first and last.
+   */
+  pthread_mutex_t lock;
+
+  /**
+   * \brief Pointer to the ready job with the highest priority
+   *
+   * Written with UVG_ATOMIC_STORE_PTR so that other workers can check it
+   * without taking the lock.
+   */
+  threadqueue_job_t *first;
+
+  /**
+   * \brief Pointer to the ready job with the lowest priority
+   */
+  threadqueue_job_t *last;
+} threadqueue_worker_t;
+
+
 struct threadqueue_queue_t {
   pthread_mutex_t lock;
 
   /**
    * \brief Job available condition variable
    *
-   * Signalled when there is a new job to do.
+   * Signalled when there is a new job to do and some worker is idle.
    */
   pthread_cond_t job_available;
 
@@ -197,6 +239,11 @@ struct threadqueue_queue_t {
    */
   pthread_t *threads;
 
+  /**
+   * \brief Queues of ready jobs, one for each thread
+   */
+  threadqueue_worker_t *workers;
+
   /**
    * \brief Number of threads spawned
    */
@@ -210,139 +257,243 @@ struct threadqueue_queue_t {
   /**
    * \brief If true, threads should stop ASAP.
    */
-  bool stop;
+  volatile bool stop;
 
   /**
-   * \brief Pointer to the first ready job
+   * \brief Number of jobs in all worker queues
    */
-  threadqueue_job_t *first;
+  volatile int32_t ready_count;
 
   /**
-   * \brief Pointer to the last ready job
+   * \brief Number of workers waiting for job_available
    */
-  threadqueue_job_t *last;
+  volatile int32_t idle_count;
+
+  /**
+   * \brief Worker queue that gets the next job submitted from outside
+   */
+  volatile int32_t next_worker;
 };
 
 
 /**
  * \brief Add a job to the queue of jobs ready to run.
  *
- * The caller must have locked the thread queue and the job. This function
- * takes the ownership of the job.
+ * The caller must have locked the job or be the only one referring to it
+ * outside of its dependencies. This function takes the ownership of the
+ * job.
  */
-static void threadqueue_push_job(threadqueue_queue_t * threadqueue,
-                                 threadqueue_job_t *job)
+static int threadqueue_push_job(threadqueue_worker_t *worker,
+                                threadqueue_job_t *job)
 {
   assert(job->ndepends == 0);
   job->state = THREADQUEUE_JOB_STATE_READY;
 
-  if (threadqueue->first == NULL) {
-    threadqueue->first = job;
-  } else {
-    threadqueue->last->next = job;
+  PTHREAD_LOCK(&worker->lock);
+  // New jobs usually have the lowest priority, so search from the end.
+  // This is linear in the number of ready jobs of the worker in the worst
+  // case. The encoder submits the LCUs of a frame in raster order and the
+  // wavefront keeps only about one ready LCU per row in each queue, so the
+  // search rarely goes past a few jobs.
+  threadqueue_job_t *prev = worker->last;
+  while (prev && prev->priority < job->priority) {
+    prev = prev->prev;
   }
-
-  threadqueue->last = job;
-  job->next = NULL;
+  job->prev = prev;
+  job->next = prev ? prev->next : worker->first;
+  if (job->prev) job->prev->next = job;
+  else           UVG_ATOMIC_STORE_PTR(&worker->first, job);
+  if (job->next) job->next->prev = job;
+  else           worker->last    = job;
+  PTHREAD_UNLOCK(&worker->lock);
+
+  UVG_ATOMIC_INC(&worker->threadqueue->ready_count);
+  return 1;
 }
 
 
 /**
- * \brief Retrieve a job from the queue of jobs ready to run.
+ * \brief Retrieve the job with the highest priority from the queue of a
+ * worker.
+ *
+ * The calling function receives the ownership of the job.
  *
- * The caller must have locked the thread queue. The calling function
- * receives the ownership of the job.
+ * \return the job, or NULL if the queue is empty
  */
-static threadqueue_job_t * threadqueue_pop_job(threadqueue_queue_t * threadqueue)
+static threadqueue_job_t * threadqueue_pop_job(threadqueue_worker_t *worker)
 {
-  assert(threadqueue->first != NULL);
+  if (UVG_ATOMIC_LOAD_PTR(&worker->first) == NULL) {
+    // Checked without locking to avoid contention on empty queues.
+    return NULL;
+  }
 
-  threadqueue_job_t *job = threadqueue->first;
-  threadqueue->first = job->next;
-  job->next = NULL;
+  PTHREAD_LOCK(&worker->lock);
+  threadqueue_job_t *job = worker->first;
+  if (job) {
+    UVG_ATOMIC_STORE_PTR(&worker->first, job->next);
+    if (job->next) job->next->prev = NULL;
+    else           worker->last    = NULL;
+    job->next = NULL;
+    job->prev = NULL;
+  }
+  PTHREAD_UNLOCK(&worker->lock);
 
-  if (threadqueue->first == NULL) {
-    threadqueue->last = NULL;
+  if (job) {
+    UVG_ATOMIC_DEC(&worker->threadqueue->ready_count);
   }
+  return job;
+}
 
+
+/**
+ * \brief Find a ready job for a worker, stealing one if its own queue is
+ * empty.
+ */
+static threadqueue_job_t * threadqueue_find_job(threadqueue_worker_t *worker)
+{
+  threadqueue_queue_t *const threadqueue = worker->threadqueue;
+
+  threadqueue_job_t *job = threadqueue_pop_job(worker);
+  const int own_index = (int)(worker - threadqueue->workers);
+  // Workers start running while the rest are still being created.
+  const int thread_count = UVG_ATOMIC_LOAD(&threadqueue->thread_count);
+  for (int i = 1; !job && i < thread_count; ++i) {
+    job = threadqueue_pop_job(&threadqueue->workers[(own_index + i) % thread_count]);
+  }
   return job;
 }
 
 
 /**
- * \brief Function executed by worker threads.
+ * \brief Wake up at most count idle workers.
  */
-static void* threadqueue_worker(void* threadqueue_opaque)
+static int threadqueue_wake_workers(threadqueue_queue_t *threadqueue, int count)
 {
-  threadqueue_queue_t * const threadqueue = (threadqueue_queue_t *) threadqueue_opaque;
+  // Idle workers increment idle_count before checking ready_count for the
+  // last time, and ready_count is incremented before we get here, so
+  // either we see the idle worker or it sees the job.
+  if (count <= 0 || UVG_ATOMIC_LOAD(&threadqueue->idle_count) == 0) {
+    return 1;
+  }
 
   PTHREAD_LOCK(&threadqueue->lock);
+  for (int i = 0; i < count && i < threadqueue->idle_count; ++i) {
+    PTHREAD_COND_SIGNAL(&threadqueue->job_available);
+  }
+  PTHREAD_UNLOCK(&threadqueue->lock);
+  return 1;
+}
 
-  for (;;) {
-    while (!threadqueue->stop && threadqueue->first == NULL) {
-      // Wait until there is something to do in the queue.
-      PTHREAD_COND_WAIT(&threadqueue->job_available, &threadqueue->lock);
-    }
 
-    if (threadqueue->stop) {
-      break;
+/**
+ * \brief Mark a job completed and release the jobs depending on it.
+ *
+ * The released job with the highest priority is returned so that the
+ * calling thread can run it right away while the data it depends on is
+ * still in its caches. The rest are added to the queue of the worker.
+ *
+ * \return a job ready to run, or NULL
+ */
+static threadqueue_job_t * threadqueue_finish_job(threadqueue_worker_t *worker, threadqueue_job_t *job)
+{
+  threadqueue_queue_t *const threadqueue = worker->threadqueue;
+  threadqueue_job_t *next_job = NULL;
+
+  PTHREAD_LOCK(&job->lock);
+  assert(job->state == THREADQUEUE_JOB_STATE_RUNNING);
+  job->state = THREADQUEUE_JOB_STATE_DONE;
+
+  PTHREAD_COND_SIGNAL(&threadqueue->job_done);
+
+  // Go through all the jobs that depend on this one, decreasing their
+  // ndepends. Count how many jobs were queued so we know how many threads
+  // to wake up.
+  int num_new_jobs = 0;
+  for (int i = 0; i < job->rdepends_count; ++i) {
+    threadqueue_job_t * const depjob = job->rdepends[i];
+    // The dependency (job) is locked before the job depending on it.
+    // This must be the same order as in uvg_threadqueue_job_dep_add.
+    PTHREAD_LOCK(&depjob->lock);
+
+    assert(depjob->state == THREADQUEUE_JOB_STATE_WAITING ||
+           depjob->state == THREADQUEUE_JOB_STATE_PAUSED);
+    assert(depjob->ndepends > 0);
+    depjob->ndepends--;
+
+    if (depjob->ndepends == 0 && depjob->state == THREADQUEUE_JOB_STATE_WAITING) {
+      if (next_job == NULL) {
+        // Keep the first released job for this thread.
+        depjob->state = THREADQUEUE_JOB_STATE_READY;
+        next_job = uvg_threadqueue_copy_ref(depjob);
+      } else if (depjob->priority > next_job->priority) {
+        // Nobody else refers to next_job yet, so it can be queued unlocked.
+        threadqueue_push_job(worker, next_job);
+        num_new_jobs++;
+        depjob->state = THREADQUEUE_JOB_STATE_READY;
+        next_job = uvg_threadqueue_copy_ref(depjob);
+      } else {
+        threadqueue_push_job(worker, uvg_threadqueue_copy_ref(depjob));
+        num_new_jobs++;
+      }
     }
 
-    // Get a job and remove it from the queue.
-    threadqueue_job_t *job = threadqueue_pop_job(threadqueue);
+    // Clear this reference to the job.
+    PTHREAD_UNLOCK(&depjob->lock);
+    uvg_threadqueue_free_job(&job->rdepends[i]);
+  }
+  job->rdepends_count = 0;
 
-    PTHREAD_LOCK(&job->lock);
-    assert(job->state == THREADQUEUE_JOB_STATE_READY);
-    job->state = THREADQUEUE_JOB_STATE_RUNNING;
-    PTHREAD_UNLOCK(&job->lock);
-    PTHREAD_UNLOCK(&threadqueue->lock);
+  PTHREAD_UNLOCK(&job->lock);
+  uvg_threadqueue_free_job(&job);
 
-    job->fptr(job->arg);
+  threadqueue_wake_workers(threadqueue, num_new_jobs);
 
-    PTHREAD_LOCK(&threadqueue->lock);
-    PTHREAD_LOCK(&job->lock);
-    assert(job->state == THREADQUEUE_JOB_STATE_RUNNING);
-    job->state = THREADQUEUE_JOB_STATE_DONE;
+  return next_job;
+}
 
-    PTHREAD_COND_SIGNAL(&threadqueue->job_done);
-
-    // Go through all the jobs that depend on this one, decreasing their
-    // ndepends. Count how many jobs can now start executing so we know how
-    // many threads to wake up.
-    int num_new_jobs = 0;
-    for (int i = 0; i < job->rdepends_count; ++i) {
-      threadqueue_job_t * const depjob = job->rdepends[i];
-      // The dependency (job) is locked before the job depending on it.
-      // This must be the same order as in uvg_threadqueue_job_dep_add.
-      PTHREAD_LOCK(&depjob->lock);
-
-      assert(depjob->state == THREADQUEUE_JOB_STATE_WAITING ||
-             depjob->state == THREADQUEUE_JOB_STATE_PAUSED);
-      assert(depjob->ndepends > 0);
-      depjob->ndepends--;
-
-      if (depjob->ndepends == 0 && depjob->state == THREADQUEUE_JOB_STATE_WAITING) {
-        // Move the job to ready jobs.
-        threadqueue_push_job(threadqueue, uvg_threadqueue_copy_ref(depjob));
-        num_new_jobs++;
-      }
 
-      // Clear this reference to the job.
-      PTHREAD_UNLOCK(&depjob->lock);
-      uvg_threadqueue_free_job(&job->rdepends[i]);
+/**
+ * \brief Function executed by worker threads.
+ */
+static void* threadqueue_worker(void* worker_opaque)
+{
+  threadqueue_worker_t * const worker = (threadqueue_worker_t *) worker_opaque;
+  threadqueue_queue_t * const threadqueue = worker->threadqueue;
+
+  threadqueue_job_t *job = NULL;
+
+  for (;;) {
+    if (job == NULL) {
+      job = threadqueue_find_job(worker);
+    }
+
+    if (job == NULL) {
+      // Wait until there is something to do in any of the queues.
+      PTHREAD_LOCK(&threadqueue->lock);
+      UVG_ATOMIC_INC(&threadqueue->idle_count);
+      while (!threadqueue->stop && UVG_ATOMIC_LOAD(&threadqueue->ready_count) == 0) {
+        PTHREAD_COND_WAIT(&threadqueue->job_available, &threadqueue->lock);
+      }
+      UVG_ATOMIC_DEC(&threadqueue->idle_count);
+      const bool stop = threadqueue->stop;
+      PTHREAD_UNLOCK(&threadqueue->lock);
+      if (stop) {
+        break;
+      }
+      continue;
     }
-    job->rdepends_count = 0;
 
+    PTHREAD_LOCK(&job->lock);
+    assert(job->state == THREADQUEUE_JOB_STATE_READY);
+    job->state = THREADQUEUE_JOB_STATE_RUNNING;
     PTHREAD_UNLOCK(&job->lock);
-    uvg_threadqueue_free_job(&job);
 
-    // The current thread will process one of the new jobs so we wake up
-    // one threads less than the the number of new jobs.
-    for (int i = 0; i < num_new_jobs - 1; i++) {
-      pthread_cond_signal(&threadqueue->job_available);
-    }
+    job->fptr(job->arg);
+
+    job = threadqueue_finish_job(worker, job);
   }
 
+  PTHREAD_LOCK(&threadqueue->lock);
   threadqueue->thread_running_count--;
   PTHREAD_UNLOCK(&threadqueue->lock);
   return NULL;
@@ -356,7 +507,7 @@ static void* threadqueue_worker(void* threadqueue_opaque)
  */
 threadqueue_queue_t * uvg_threadqueue_init(int thread_count)
 {
-  threadqueue_queue_t *threadqueue = MALLOC(threadqueue_queue_t, 1);
+  threadqueue_queue_t *threadqueue = calloc(1, sizeof(threadqueue_queue_t));
   if (!threadqueue) {
     goto failed;
   }
@@ -381,22 +532,34 @@ threadqueue_queue_t * uvg_threadqueue_init(int thread_count)
     fprintf(stderr, "Could not malloc threadqueue->threads!\n");
     goto failed;
   }
+
+  threadqueue->workers = calloc(MAX(thread_count, 1), sizeof(threadqueue_worker_t));
+  if (!threadqueue->workers) {
+    fprintf(stderr, "Could not malloc threadqueue->workers!\n");
+    goto failed;
+  }
+  for (int i = 0; i < thread_count; i++) {
+    threadqueue->workers[i].threadqueue = threadqueue;
+    if (pthread_mutex_init(&threadqueue->workers[i].lock, NULL) != 0) {
+      fprintf(stderr, "pthread_mutex_init failed!\n");
+      goto failed;
+    }
+  }
+
   threadqueue->thread_count = 0;
   threadqueue->thread_running_count = 0;
 
   threadqueue->stop = false;
 
-  threadqueue->first              = NULL;
-  threadqueue->last               = NULL;
-
   // Lock the queue before creating threads, to ensure they all have correct information.
   PTHREAD_LOCK(&threadqueue->lock);
   for (int i = 0; i < thread_count; i++) {
-    if (pthread_create(&threadqueue->threads[i], NULL, threadqueue_worker, threadqueue) != 0) {
+    if (pthread_create(&threadqueue->threads[i], NULL, threadqueue_worker, &threadqueue->workers[i]) != 0) {
         fprintf(stderr, "pthread_create failed!\n");
+        PTHREAD_UNLOCK(&threadqueue->lock);
         goto failed;
     }
-    threadqueue->thread_count++;
+    UVG_ATOMIC_INC(&threadqueue->thread_count);
     threadqueue->thread_running_count++;
   }
   PTHREAD_UNLOCK(&threadqueue->lock);
@@ -438,29 +601,88 @@ threadqueue_job_t * uvg_threadqueue_job_create(void (*fptr)(void *arg), void *ar
   job->refcount       = 1;
   job->fptr           = fptr;
   job->arg            = arg;
+  job->priority       = 0;
+  job->next           = NULL;
+  job->prev           = NULL;
 
   return job;
 }
 
 
+/**
+ * \brief Reuse a finished job or create a new one.
+ *
+ * If *job_ptr is a finished job that nobody else refers to, it is reset
+ * to run fptr(arg) keeping its mutex and dependency list allocated.
+ * Otherwise the reference in *job_ptr is released and replaced with a new
+ * job, as with uvg_threadqueue_job_create.
+ *
+ * \return the job in *job_ptr, or NULL on failure
+ */
+threadqueue_job_t * uvg_threadqueue_job_recycle(threadqueue_job_t **job_ptr,
+                                                void (*fptr)(void *arg),
+                                                void *arg)
+{
+  threadqueue_job_t *job = *job_ptr;
+  // The refcount can not grow here if no other references exist.
+  if (job && UVG_ATOMIC_LOAD(&job->refcount) == 1) {
+    PTHREAD_LOCK(&job->lock);
+    const bool reusable = job->state == THREADQUEUE_JOB_STATE_DONE;
+    if (reusable) {
+      assert(job->ndepends == 0 && job->rdepends_count == 0);
+      job->state    = THREADQUEUE_JOB_STATE_PAUSED;
+      job->fptr     = fptr;
+      job->arg      = arg;
+      job->priority = 0;
+    }
+    PTHREAD_UNLOCK(&job->lock);
+    if (reusable) return job;
+  }
+
+  uvg_threadqueue_free_job(job_ptr);
+  *job_ptr = uvg_threadqueue_job_create(fptr, arg);
+  return *job_ptr;
+}
+
+
+/**
+ * \brief Set the priority of a job.
+ *
+ * Among the jobs that are ready to run, the ones with higher priority are
+ * run first. Jobs have priority 0 by default, which is higher than that of
+ * every LCU job of the encoder, so the encoder sets the priority of all of
+ * its jobs explicitly. Must be called before the job is submitted.
+ */
+void uvg_threadqueue_job_set_priority(threadqueue_job_t *job, int64_t priority)
+{
+  assert(job->state == THREADQUEUE_JOB_STATE_PAUSED);
+  job->priority = priority;
+}
+
+
 int uvg_threadqueue_submit(threadqueue_queue_t * const threadqueue, threadqueue_job_t *job)
 {
-  PTHREAD_LOCK(&threadqueue->lock);
   PTHREAD_LOCK(&job->lock);
   assert(job->state == THREADQUEUE_JOB_STATE_PAUSED);
 
+  bool queued = false;
   if (threadqueue->thread_count == 0) {
     // When not using threads, run the job immediately.
     job->fptr(job->arg);
     job->state = THREADQUEUE_JOB_STATE_DONE;
   } else if (job->ndepends == 0) {
-    threadqueue_push_job(threadqueue, uvg_threadqueue_copy_ref(job));
-    pthread_cond_signal(&threadqueue->job_available);
+    // Spread jobs submitted from outside the workers evenly.
+    const int index = (uint32_t)UVG_ATOMIC_INC(&threadqueue->next_worker) % threadqueue->thread_count;
+    threadqueue_push_job(&threadqueue->workers[index], uvg_threadqueue_copy_ref(job));
+    queued = true;
   } else {
     job->state = THREADQUEUE_JOB_STATE_WAITING;
   }
   PTHREAD_UNLOCK(&job->lock);
-  PTHREAD_UNLOCK(&threadqueue->lock);
+
+  if (queued) {
+    threadqueue_wake_workers(threadqueue, 1);
+  }
 
   return 1;
 }
@@ -478,7 +700,7 @@ int uvg_threadqueue_submit(threadqueue_queue_t * const threadqueue, threadqueue_
 int uvg_threadqueue_job_dep_add(threadqueue_job_t *job, threadqueue_job_t *dependency)
 {
   // Lock the dependency first and then the job depending on it.
-  // This must be the same order as in threadqueue_worker.
+  // This must be the same order as in threadqueue_finish_job.
   PTHREAD_LOCK(&dependency->lock);
 
   if (dependency->state == THREADQUEUE_JOB_STATE_DONE) {
@@ -617,12 +839,17 @@ void uvg_threadqueue_free(threadqueue_queue_t *threadqueue)
   uvg_threadqueue_stop(threadqueue);
 
   // Free all jobs.
-  while (threadqueue->first) {
-    threadqueue_job_t *next = threadqueue->first->next;
-    uvg_threadqueue_free_job(&threadqueue->first);
-    threadqueue->first = next;
+  for (int i = 0; threadqueue->workers && i < threadqueue->thread_count; i++) {
+    threadqueue_worker_t *worker = &threadqueue->workers[i];
+    while (worker->first) {
+      threadqueue_job_t *next = worker->first->next;
+      uvg_threadqueue_free_job(&worker->first);
+      worker->first = next;
+    }
+    worker->last = NULL;
+    pthread_mutex_destroy(&worker->lock);
   }
-  threadqueue->last = NULL;
+  FREE_POINTER(threadqueue->workers);
 
   FREE_POINTER(threadqueue->threads);
   threadqueue->thread_count = 0;
@@ -44,9 +44,17 @@
 typedef struct threadqueue_job_t threadqueue_job_t;
 typedef struct threadqueue_queue_t threadqueue_queue_t;
 
+/**
+ * \brief Priority of jobs the encoder waits for before it can submit more
+ * work, such as the lookahead analysis. They run before any other job.
+ */
+#define THREADQUEUE_PRIORITY_URGENT INT64_MAX
+
 threadqueue_queue_t * uvg_threadqueue_init(int thread_count);
 
 threadqueue_job_t * uvg_threadqueue_job_create(void (*fptr)(void *arg), void *arg);
+threadqueue_job_t * uvg_threadqueue_job_recycle(threadqueue_job_t **job_ptr, void (*fptr)(void *arg), void *arg);
+void uvg_threadqueue_job_set_priority(threadqueue_job_t *job, int64_t priority);
 int uvg_threadqueue_submit(threadqueue_queue_t * threadqueue, threadqueue_job_t *job);
 
 int uvg_threadqueue_job_dep_add(threadqueue_job_t *job, threadqueue_job_t *dependency);
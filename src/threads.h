@@ -67,6 +67,9 @@
 
 #define UVG_ATOMIC_INC(ptr)                     __sync_add_and_fetch((volatile int32_t*)ptr, 1)
 #define UVG_ATOMIC_DEC(ptr)                     __sync_add_and_fetch((volatile int32_t*)ptr, -1)
+#define UVG_ATOMIC_LOAD(ptr)                    __atomic_load_n((volatile int32_t*)ptr, __ATOMIC_SEQ_CST)
+#define UVG_ATOMIC_LOAD_PTR(ptr)                __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#define UVG_ATOMIC_STORE_PTR(ptr, val)          __atomic_store_n(ptr, val, __ATOMIC_RELEASE)
 
 #else //__GNUC__
 //TODO: we assume !GCC => Windows... this may be bad
@@ -81,6 +84,9 @@
 
 #define UVG_ATOMIC_INC(ptr)                     InterlockedIncrement((volatile LONG*)ptr)
 #define UVG_ATOMIC_DEC(ptr)                     InterlockedDecrement((volatile LONG*)ptr)
+#define UVG_ATOMIC_LOAD(ptr)                    InterlockedCompareExchange((volatile LONG*)ptr, 0, 0)
+#define UVG_ATOMIC_LOAD_PTR(ptr)                InterlockedCompareExchangePointer((PVOID volatile*)ptr, NULL, NULL)
+#define UVG_ATOMIC_STORE_PTR(ptr, val)          InterlockedExchangePointer((PVOID volatile*)ptr, val)
 
 #endif //__GNUC__
 
@@ -46,6 +46,7 @@
 #include "global.h"
 #include "image.h"
 #include "input_frame_buffer.h"
+#include "lookahead.h"
 #include "uvg266_internal.h"
 #include "strategyselector.h"
 #include "threadqueue.h"
@@ -61,6 +62,9 @@ static void uvg266_close(uvg_encoder *encoder)
       uvg_threadqueue_stop(encoder->control->threadqueue);
     }
 
+    uvg_lookahead_free(encoder->lookahead);
+    encoder->lookahead = NULL;
+
     if (encoder->states) {
       // Flush input frame buffer.
       uvg_picture *pic = NULL;
@@ -121,6 +125,13 @@ static uvg_encoder * uvg266_open(const uvg_config *cfg)
 
   uvg_init_input_frame_buffer(&encoder->input_buffer);
 
+  if (encoder->control->cfg.lookahead > 0) {
+    encoder->lookahead = uvg_lookahead_alloc(encoder->control);
+    if (!encoder->lookahead) {
+      goto uvg266_open_failure;
+    }
+  }
+
   encoder->states = calloc(encoder->num_encoder_states, sizeof(encoder_state_t));
   if (!encoder->states) {
     goto uvg266_open_failure;
@@ -265,10 +276,24 @@ static int uvg266_encode(uvg_encoder *enc,
     CHECKPOINT_MARK("read source frame: %d", state->frame->num + enc->control->cfg.seek);
   }
 
-  uvg_picture* frame = uvg_encoder_feed_frame(
-    &enc->input_buffer, state, pic_in,
-    enc->frames_done || state->encoder_control->cfg.rc_algorithm != UVG_OBA
-  );
+  const int first_done = enc->frames_done || state->encoder_control->cfg.rc_algorithm != UVG_OBA;
+  uvg_picture* frame = NULL;
+  if (enc->lookahead) {
+    if (pic_in != NULL) {
+      uvg_lookahead_push(enc->lookahead, pic_in);
+    }
+    // The input frame buffer may hold frames while filling a GOP, so when
+    // flushing, keep feeding frames from the lookahead until one comes out.
+    uvg_picture *la_pic = NULL;
+    do {
+      la_pic = uvg_lookahead_pop(enc->lookahead, pic_in == NULL);
+      if (la_pic == NULL && pic_in != NULL) break;
+      frame = uvg_encoder_feed_frame(&enc->input_buffer, state, la_pic, first_done);
+      uvg_image_free(la_pic);
+    } while (frame == NULL && la_pic != NULL && pic_in == NULL);
+  } else {
+    frame = uvg_encoder_feed_frame(&enc->input_buffer, state, pic_in, first_done);
+  }
   if (frame) {
     assert(state->frame->num == enc->frames_started);
     // Start encoding.
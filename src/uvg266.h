@@ -115,6 +115,7 @@ enum uvg_ime_algorithm {
   UVG_IME_FULL32 = 5, //! \since 3.6.0
   UVG_IME_FULL64 = 6, //! \since 3.6.0
   UVG_IME_DIA = 7, // Experimental. TODO: change into a proper doc comment
+  UVG_IME_PYRAMID = 8, //!< Coarse-to-fine search on downscaled frames.
 };
 
 /**
@@ -553,6 +554,27 @@ typedef struct uvg_config
 
   uint8_t ibc; /* \brief Intra Block Copy parameter */
   uint8_t dep_quant;
+
+  /** \brief Number of frames analyzed ahead of encoding, 0 to disable */
+  int32_t lookahead;
+
+  /** \brief Threshold for inserting intra frames at scene cuts, 0 to disable */
+  int8_t scenecut;
+
+  /** \brief Enable QP offsets from the lookahead CU-tree */
+  int8_t cutree;
+
+  /** \brief Keep copies of reference frames with a wide replicated border */
+  int8_t ref_padding;
+
+  /** \brief Seed the integer motion search from other depths and references, and skip references whose best starting point is clearly worse */
+  int8_t me_ref_skip;
+
+  /** \brief Maximum iterations of bi-prediction vector refinement, 0 to disable */
+  int8_t bipred_refine;
+
+  /** \brief Estimate the global motion of frames to seed the motion search */
+  int8_t global_motion;
 } uvg_config;
 
 /**
@@ -592,6 +614,13 @@ typedef struct uvg_picture {
     int8_t *roi_array;
   } roi;
 
+  struct
+  {
+    int8_t scene_cut;  //!< \brief The picture starts a new scene.
+    double complexity; //!< \brief Cost of the picture relative to the pictures after it.
+    double *cutree_offsets; //!< \brief Delta QP of each CTU from the CU-tree, or NULL.
+  } lookahead; //!< \brief Set by the lookahead of the encoder.
+
 } uvg_picture;
 
 /**
@@ -42,6 +42,7 @@
 
 #include "uvg266.h"
 #include "input_frame_buffer.h"
+#include "lookahead.h"
 
 
 // Forward declarations.
@@ -71,6 +72,11 @@ struct uvg_encoder {
    */
   input_frame_buffer_t input_buffer;
 
+  /**
+   * \brief Lookahead for input frames, NULL if disabled.
+   */
+  lookahead_t *lookahead;
+
   unsigned frames_started;
   unsigned frames_done;
 };
@@ -35,6 +35,7 @@
 #include <stdlib.h>
 
 #include "image.h"
+#include "ref_padding.h"
 #include "sao.h"
 #include "alf.h"
 
@@ -98,6 +99,9 @@ int uvg_videoframe_free(videoframe_t * const frame)
 
   uvg_cu_array_free(&frame->cu_array);
   uvg_cu_array_free(&frame->chroma_cu_array);
+  uvg_col_motion_field_free(&frame->col_motion);
+  uvg_image_pyramid_free(&frame->pyramid);
+  uvg_ref_padding_free(&frame->padding);
 
   FREE_POINTER(frame->sao_luma);
   FREE_POINTER(frame->sao_chroma);
@@ -42,6 +42,7 @@
 #include "global.h" // IWYU pragma: keep
 #include "uvg266.h"
 #include "hashmap.h"
+#include "image.h"
 
 
 /**
@@ -71,6 +72,9 @@ typedef struct videoframe
 
   cu_array_t* cu_array;     //!< \brief Info for each CU at each depth.
   cu_array_t* chroma_cu_array;     //!< \brief Info for each CU at each depth.
+  col_motion_field_t* col_motion; //!< \brief Motion of the frame for TMVP of later frames.
+  uvg_image_pyramid_t* pyramid; //!< \brief Downscaled luma of the source for motion estimation, or NULL.
+  struct uvg_ref_padding* padding; //!< \brief Copy of rec with a wide replicated border, or NULL.
   struct lmcs_aps* lmcs_aps; //!< \brief LMCS parameters for both the current frame.
   struct sao_info_t *sao_luma;   //!< \brief Array of sao parameters for every LCU.
   struct sao_info_t *sao_chroma;   //!< \brief Array of sao parameters for every LCU.
@@ -83,7 +87,9 @@ typedef struct videoframe
   uvg_pixel **ibc_buffer_u; //!< \brief Intra Block Copy buffer for each LCU row 
   uvg_pixel **ibc_buffer_v; //!< \brief Intra Block Copy buffer for each LCU row
   uvg_hashmap_t **ibc_hashmap_row; //!< \brief Hashmap for IBC hash search for each LCU row
+  uvg_hashmap_t **ibc_hashmap_row_prev; //!< \brief Hashmaps of the previous frame encoded with this frame, for motion search
   uint32_t *ibc_hashmap_pos_to_hash; //!< \brief Hashmap reverse search for position to hash
+  uint32_t *ibc_hashmap_pos_to_hash_prev; //!< \brief Position to hash of the previous frame encoded with this frame
   uint32_t ibc_hashmap_pos_to_hash_stride; //!< \brief Hashmap position to hash stride
   cu_info_t* hmvp_lut_ibc; //!< \brief Look-up table for HMVP in IBC, one for each LCU row
   uint8_t* hmvp_size_ibc; //!< \brief HMVP IBC LUT size
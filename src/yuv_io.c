@@ -47,12 +47,24 @@ static void fill_after_frame(unsigned height, unsigned array_width,
 
   while (p < end) {
     // Fill the line by copying the line above.
-    memcpy(p, p - array_width, array_width);
+    memcpy(p, p - array_width, array_width * sizeof(uvg_pixel));
     p += array_width;
   }
 }
 
 
+// Spread 1-byte samples at the start of an array to 2-byte samples in place.
+static void spread_bytes_to_pixels(uvg_pixel *data, unsigned size)
+{
+  const unsigned char *byte_buf = (const unsigned char *)data;
+
+  // Go from the back so that no sample is overwritten before it is read.
+  for (unsigned i = size; i-- > 0;) {
+    data[i] = byte_buf[i];
+  }
+}
+
+
 static int read_and_fill_frame_data(FILE *file,
                                     unsigned width, unsigned height, unsigned bytes_per_sample,
                                     unsigned array_width, uvg_pixel *data)
@@ -67,6 +79,10 @@ static int read_and_fill_frame_data(FILE *file,
     if (width != fread(p, bytes_per_sample, width, file))
       return 0;
 
+    if (bytes_per_sample < sizeof(uvg_pixel)) {
+      spread_bytes_to_pixels(p, width);
+    }
+
     // Fill the rest with the last pixel value.
     fill_char = p[width - 1];
 
@@ -98,35 +114,7 @@ static void shift_to_bitdepth(uvg_pixel* input, int size, int from_bitdepth, int
     if (shift > 0) {
       input[i] = (input[i] & bitdepth_mask) << shift;
     } else {
-      input[i] = (input[i] & bitdepth_mask) >> shift;
-    }
-  }
-}
-
-
-// Shift and copy 1-byte aligned samples to 2-byte aligned array
-static void shift_to_bitdepth_and_spread(uvg_pixel *input,
-                                         int size,
-                                         int from_bitdepth,
-                                         int to_bitdepth)
-{
-  assert(sizeof(uvg_pixel) > 1);
-  int shift = to_bitdepth - from_bitdepth;
-  unsigned char *byte_buf = (unsigned char *)input;
-  uvg_pixel bitdepth_mask = (1 << from_bitdepth) - 1;
-  
-  // Starting from the back of the 1-byte samples, copy each sample to it's
-  // place in the 2-byte per sample array, overwriting the bytes that have
-  // already been copied in the process.
-  // Even though the two pointers are aliased, this should work because the
-  // future values read through byte_buf poiner never change as a result of
-  // writing through input pointer.
-  for (int i = size - 1; i >= 0; --i) {
-    // Shifting by a negative number is undefined.
-    if (shift > 0) {
-      input[i] = (byte_buf[i] & bitdepth_mask) << shift;
-    } else {
-      input[i] = (byte_buf[i] & bitdepth_mask) >> shift;
+      input[i] = (input[i] & bitdepth_mask) >> -shift;
     }
   }
 }
@@ -168,6 +156,9 @@ static int yuv_io_read_plane(
     // No need to extend pixels.
     const size_t pixel_size = sizeof(unsigned char);
     if (fread(out_buf, pixel_size, buf_bytes, file) != buf_bytes)  return 0;
+    if (bytes_per_sample < sizeof(uvg_pixel)) {
+      spread_bytes_to_pixels(out_buf, in_width * in_height);
+    }
   } else {
     // Need to copy pixels to fill the image in horizontal direction.
     if (!read_and_fill_frame_data(file, in_width, in_height, bytes_per_sample, out_width, out_buf)) return 0;
@@ -188,9 +179,7 @@ static int yuv_io_read_plane(
   // Shift the data to the correct bitdepth.
   // Ignore any bits larger than in_bitdepth to guarantee ouput data will be
   // in the correct range.
-  if (in_bitdepth <= 8 && out_bitdepth > 8) {
-    shift_to_bitdepth_and_spread(out_buf, out_length, in_bitdepth, out_bitdepth);
-  } else if (in_bitdepth != out_bitdepth) {
+  if (in_bitdepth != out_bitdepth) {
     shift_to_bitdepth(out_buf, out_length, in_bitdepth, out_bitdepth);
   } else if (in_bitdepth % 8 != 0) {
     mask_to_bitdepth(out_buf, out_length, out_bitdepth);
@@ -0,0 +1,382 @@
+/*****************************************************************************
+ * This file is part of uvg266 VVC encoder.
+ *
+ * Copyright (c) 2021, Tampere University, ITU/ISO/IEC, project contributors
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ * * Neither the name of the Tampere University or ITU/ISO/IEC nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * INCLUDING NEGLIGENCE OR OTHERWISE ARISING IN ANY WAY OUT OF THE USE OF THIS
+ ****************************************************************************/
+
+#include "greatest/greatest.h"
+
+#include "test_strategies.h"
+
+#include "src/alf.h"
+#include "src/encoder.h"
+#include "src/encoderstate.h"
+#include "src/strategies/strategies-alf.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+//////////////////////////////////////////////////////////////////////////
+// MACROS
+#define PIC_WIDTH 128
+#define PIC_HEIGHT 128
+#define MARGIN 32
+#define STRIDE (PIC_WIDTH + 2 * MARGIN)
+#define BUF_SIZE (STRIDE * (PIC_HEIGHT + 2 * MARGIN))
+#define PIC_OFFSET (MARGIN * STRIDE + MARGIN)
+#define VB_CTU_HEIGHT 64
+#define VB_POS (VB_CTU_HEIGHT - ALF_VB_POS_ABOVE_CTUROW_LUMA)
+
+//////////////////////////////////////////////////////////////////////////
+// GLOBALS
+static encoder_control_t encoder;
+static alf_info_t alf_info;
+static uvg_picture rec;
+static videoframe_t videoframe;
+static encoder_state_config_tile_t tile;
+static encoder_state_t state;
+
+static uvg_pixel src[BUF_SIZE];
+static uvg_pixel expected[BUF_SIZE];
+static uvg_pixel actual[BUF_SIZE];
+
+static alf_classifier classes[PIC_HEIGHT][PIC_WIDTH];
+static alf_classifier expected_classes[PIC_HEIGHT][PIC_WIDTH];
+static alf_classifier actual_classes[PIC_HEIGHT][PIC_WIDTH];
+static alf_classifier *class_rows[PIC_HEIGHT];
+
+static short luma_coeff[MAX_NUM_ALF_CLASSES * MAX_NUM_ALF_LUMA_COEFF];
+static int16_t luma_clip[MAX_NUM_ALF_CLASSES * MAX_NUM_ALF_LUMA_COEFF];
+// The SIMD filters load 8 coefficients at a time.
+static short chroma_coeff[8];
+static int16_t chroma_clip[8];
+static int16_t cc_coeff[MAX_NUM_CC_ALF_CHROMA_COEFF];
+
+// Block sizes that leave 4, 8 and 12 columns after the last full 16.
+#define NUM_WIDTHS 11
+#define NUM_HEIGHTS 4
+static const int widths[NUM_WIDTHS] = { 4, 8, 12, 16, 20, 24, 28, 32, 40, 60, 64 };
+static const int heights[NUM_HEIGHTS] = { 4, 8, 32, 64 };
+
+static struct {
+  alf_derive_classification_blk_func * tested_classification;
+  alf_derive_classification_blk_func * generic_classification;
+  alf_filter_5x5_blk_func * tested_5x5;
+  alf_filter_5x5_blk_func * generic_5x5;
+  alf_filter_7x7_blk_func * tested_7x7;
+  alf_filter_7x7_blk_func * generic_7x7;
+  alf_filter_cc_blk_func * tested_cc;
+  alf_filter_cc_blk_func * generic_cc;
+} test_env;
+
+
+//////////////////////////////////////////////////////////////////////////
+// SETUP, TEARDOWN AND HELPER FUNCTIONS
+static void setup_tests()
+{
+  encoder.bitdepth = UVG_BIT_DEPTH;
+  encoder.chroma_format = UVG_CSP_420;
+  rec.y = src + PIC_OFFSET;
+  rec.stride = STRIDE;
+  videoframe.rec = &rec;
+  videoframe.alf_info = &alf_info;
+  tile.frame = &videoframe;
+  state.encoder_control = &encoder;
+  state.tile = &tile;
+
+  srand(23);
+  // Smooth gradients with noise of a different strength in each 16x16
+  // area, so that the blocks get different classes and directions.
+  for (int y = 0; y < PIC_HEIGHT + 2 * MARGIN; ++y) {
+    for (int x = 0; x < STRIDE; ++x) {
+      const int amplitude = ((x / 16 + 3 * (y / 16)) % 5) * 24;
+      const int noise = amplitude ? rand() % (2 * amplitude + 1) - amplitude : 0;
+      const int value = (x % 16 < 8 ? 2 * x + y : 3 * y) % 160 + 48 + noise;
+      src[y * STRIDE + x] = CLIP(0, PIXEL_MAX, value << (UVG_BIT_DEPTH - 8));
+    }
+  }
+
+  for (int y = 0; y < PIC_HEIGHT; ++y) {
+    for (int x = 0; x < PIC_WIDTH; ++x) {
+      classes[y][x].class_idx = rand() % MAX_NUM_ALF_CLASSES;
+      classes[y][x].transpose_idx = rand() % 4;
+    }
+  }
+
+  const int16_t clip_values[4] = { 1 << UVG_BIT_DEPTH,
+                                   32 << (UVG_BIT_DEPTH - 8),
+                                   8 << (UVG_BIT_DEPTH - 8),
+                                   2 << (UVG_BIT_DEPTH - 8) };
+  for (int i = 0; i < MAX_NUM_ALF_CLASSES * MAX_NUM_ALF_LUMA_COEFF; ++i) {
+    luma_coeff[i] = rand() % 256 - 128;
+    luma_clip[i] = clip_values[rand() % 4];
+  }
+  for (int i = 0; i < MAX_NUM_ALF_CHROMA_COEFF; ++i) {
+    chroma_coeff[i] = rand() % 256 - 128;
+    chroma_clip[i] = clip_values[rand() % 4];
+  }
+  for (int i = 0; i < MAX_NUM_CC_ALF_CHROMA_COEFF; ++i) {
+    const int magnitude = 1 << (rand() % 7);
+    cc_coeff[i] = rand() % 2 ? magnitude : -magnitude;
+  }
+
+  memset(&test_env, 0, sizeof(test_env));
+  for (unsigned i = 0; i < strategies.count; ++i) {
+    const strategy_t * strategy = &strategies.strategies[i];
+    if (strcmp(strategy->strategy_name, "generic") != 0) continue;
+    if (strcmp(strategy->type, "alf_derive_classification_blk") == 0) {
+      test_env.generic_classification = strategy->fptr;
+    } else if (strcmp(strategy->type, "alf_filter_5x5_blk") == 0) {
+      test_env.generic_5x5 = strategy->fptr;
+    } else if (strcmp(strategy->type, "alf_filter_7x7_blk") == 0) {
+      test_env.generic_7x7 = strategy->fptr;
+    } else if (strcmp(strategy->type, "alf_filter_cc_blk") == 0) {
+      test_env.generic_cc = strategy->fptr;
+    }
+  }
+}
+
+
+static void set_classifier(alf_classifier rows[PIC_HEIGHT][PIC_WIDTH])
+{
+  for (int y = 0; y < PIC_HEIGHT; ++y) {
+    class_rows[y] = rows[y];
+  }
+  alf_info.classifier = class_rows;
+}
+
+
+static void reset_dst(void)
+{
+  memcpy(expected, src, sizeof(src));
+  memcpy(actual, src, sizeof(src));
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// TESTS
+
+/**
+ * \brief Classify blocks of every size the encoder uses at positions on
+ *        both sides of the virtual boundary.
+ */
+TEST alf_classification(void)
+{
+  ASSERT(test_env.generic_classification != NULL);
+
+  const int shift = UVG_BIT_DEPTH + 4;
+  for (int n_height = 8; n_height <= CLASSIFICATION_BLK_SIZE; n_height += 8) {
+    for (int n_width = 8; n_width <= CLASSIFICATION_BLK_SIZE; n_width += 8) {
+      for (int y = 0; y + n_height <= PIC_HEIGHT; y += 24) {
+        for (int x = 0; x + n_width <= PIC_WIDTH; x += 40) {
+          memset(expected_classes, 0xff, sizeof(expected_classes));
+          memset(actual_classes, 0xff, sizeof(actual_classes));
+
+          set_classifier(expected_classes);
+          test_env.generic_classification(&state, shift, n_height, n_width, x, y, x, y,
+                                          VB_CTU_HEIGHT, VB_POS);
+          set_classifier(actual_classes);
+          test_env.tested_classification(&state, shift, n_height, n_width, x, y, x, y,
+                                         VB_CTU_HEIGHT, VB_POS);
+
+          char testname[100];
+          sprintf(testname, "%dx%d block at (%d, %d)", n_width, n_height, x, y);
+          for (int i = 0; i < PIC_HEIGHT; ++i) {
+            for (int j = 0; j < PIC_WIDTH; ++j) {
+              ASSERT_EQm(testname, expected_classes[i][j].class_idx, actual_classes[i][j].class_idx);
+              ASSERT_EQm(testname, expected_classes[i][j].transpose_idx, actual_classes[i][j].transpose_idx);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  PASS();
+}
+
+
+/**
+ * \brief Filter chroma blocks with widths that are not multiples of 16
+ *        and check them against the generic filter.
+ */
+TEST alf_filter_5x5(void)
+{
+  ASSERT(test_env.generic_5x5 != NULL);
+
+  const clp_rng clp_rng = { .min = 0, .max = PIXEL_MAX, .bd = UVG_BIT_DEPTH };
+  const int vb_ctu_height = VB_CTU_HEIGHT >> 1;
+  const int vb_pos = vb_ctu_height - ALF_VB_POS_ABOVE_CTUROW_CHMA;
+
+  for (int h = 0; h < NUM_HEIGHTS; ++h) {
+    for (int w = 0; w < NUM_WIDTHS; ++w) {
+      const int width = widths[w];
+      const int height = heights[h];
+      for (int y = 0; y + height <= PIC_HEIGHT; y += 28) {
+        const int x = 4 * (y % 3);
+        reset_dst();
+        test_env.generic_5x5(&state, src + PIC_OFFSET, expected + PIC_OFFSET, STRIDE, STRIDE,
+                             chroma_coeff, chroma_clip, clp_rng, width, height,
+                             x, y, x, y, vb_pos, vb_ctu_height);
+        test_env.tested_5x5(&state, src + PIC_OFFSET, actual + PIC_OFFSET, STRIDE, STRIDE,
+                            chroma_coeff, chroma_clip, clp_rng, width, height,
+                            x, y, x, y, vb_pos, vb_ctu_height);
+
+        char testname[100];
+        sprintf(testname, "%dx%d block at (%d, %d)", width, height, x, y);
+        for (int i = 0; i < BUF_SIZE; ++i) {
+          ASSERT_EQm(testname, expected[i], actual[i]);
+        }
+      }
+    }
+  }
+
+  PASS();
+}
+
+
+/**
+ * \brief Filter luma blocks with random classes and transposes, with
+ *        widths that are multiples of 8, and check them against the
+ *        generic filter.
+ */
+TEST alf_filter_7x7(void)
+{
+  ASSERT(test_env.generic_7x7 != NULL);
+
+  const clp_rng clp_rng = { .min = 0, .max = PIXEL_MAX, .bd = UVG_BIT_DEPTH };
+  set_classifier(classes);
+
+  for (int h = 0; h < NUM_HEIGHTS; ++h) {
+    for (int w = 0; w < NUM_WIDTHS; ++w) {
+      const int width = widths[w];
+      const int height = heights[h];
+      if (width % 8 != 0) continue;
+      for (int y = 0; y + height <= PIC_HEIGHT; y += 28) {
+        const int x = 8 * (y % 3);
+        reset_dst();
+        test_env.generic_7x7(&state, src + PIC_OFFSET, expected + PIC_OFFSET, STRIDE, STRIDE,
+                             luma_coeff, luma_clip, clp_rng, width, height,
+                             x, y, x, y, VB_POS, VB_CTU_HEIGHT);
+        test_env.tested_7x7(&state, src + PIC_OFFSET, actual + PIC_OFFSET, STRIDE, STRIDE,
+                            luma_coeff, luma_clip, clp_rng, width, height,
+                            x, y, x, y, VB_POS, VB_CTU_HEIGHT);
+
+        char testname[100];
+        sprintf(testname, "%dx%d block at (%d, %d)", width, height, x, y);
+        for (int i = 0; i < BUF_SIZE; ++i) {
+          ASSERT_EQm(testname, expected[i], actual[i]);
+        }
+      }
+    }
+  }
+
+  PASS();
+}
+
+
+/**
+ * \brief Run the cross-component filter in every chroma format and check
+ *        it against the generic filter.
+ */
+TEST alf_filter_cc(void)
+{
+  ASSERT(test_env.generic_cc != NULL);
+
+  clp_rngs clp_rngs;
+  memset(&clp_rngs, 0, sizeof(clp_rngs));
+  for (int c = 0; c < MAX_NUM_COMPONENT; ++c) {
+    clp_rngs.comp[c].max = PIXEL_MAX;
+    clp_rngs.comp[c].bd = UVG_BIT_DEPTH;
+  }
+
+  const enum uvg_chroma_format formats[3] = { UVG_CSP_420, UVG_CSP_422, UVG_CSP_444 };
+  for (int f = 0; f < 3; ++f) {
+    encoder.chroma_format = formats[f];
+    const int scale_x = formats[f] == UVG_CSP_444 ? 0 : 1;
+    const int scale_y = formats[f] == UVG_CSP_420 ? 1 : 0;
+
+    for (int h = 0; h < NUM_HEIGHTS; ++h) {
+      for (int w = 0; w < NUM_WIDTHS; ++w) {
+        const int width = widths[w];
+        const int height = heights[h];
+        for (int y = 0; (y + height) << scale_y <= PIC_HEIGHT; y += 28) {
+          const int x = 4 * (y % 3);
+          if ((x + width) << scale_x > PIC_WIDTH) continue;
+
+          // The chroma plane is stored in the destination buffers with the
+          // chroma stride, and the luma is read from the source.
+          reset_dst();
+          test_env.generic_cc(&state, expected + PIC_OFFSET, src + PIC_OFFSET, STRIDE,
+                              COMPONENT_Cb, cc_coeff, clp_rngs, VB_CTU_HEIGHT, VB_POS,
+                              x, y, width, height);
+          test_env.tested_cc(&state, actual + PIC_OFFSET, src + PIC_OFFSET, STRIDE,
+                             COMPONENT_Cb, cc_coeff, clp_rngs, VB_CTU_HEIGHT, VB_POS,
+                             x, y, width, height);
+
+          char testname[100];
+          sprintf(testname, "format %d %dx%d block at (%d, %d)", formats[f], width, height, x, y);
+          for (int i = 0; i < BUF_SIZE; ++i) {
+          ASSERT_EQm(testname, expected[i], actual[i]);
+        }
+        }
+      }
+    }
+  }
+
+  encoder.chroma_format = UVG_CSP_420;
+  PASS();
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// TEST FIXTURES
+SUITE(alf_tests)
+{
+  setup_tests();
+
+  for (volatile unsigned i = 0; i < strategies.count; ++i) {
+    const strategy_t * strategy = &strategies.strategies[i];
+
+    if (strcmp(strategy->type, "alf_derive_classification_blk") == 0) {
+      test_env.tested_classification = strategy->fptr;
+      RUN_TEST(alf_classification);
+    } else if (strcmp(strategy->type, "alf_filter_5x5_blk") == 0) {
+      test_env.tested_5x5 = strategy->fptr;
+      RUN_TEST(alf_filter_5x5);
+    } else if (strcmp(strategy->type, "alf_filter_7x7_blk") == 0) {
+      test_env.tested_7x7 = strategy->fptr;
+      RUN_TEST(alf_filter_7x7);
+    } else if (strcmp(strategy->type, "alf_filter_cc_blk") == 0) {
+      test_env.tested_cc = strategy->fptr;
+      RUN_TEST(alf_filter_cc);
+    }
+  }
+}
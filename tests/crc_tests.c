@@ -0,0 +1,171 @@
+/*****************************************************************************
+ * This file is part of uvg266 VVC encoder.
+ *
+ * Copyright (c) 2021, Tampere University, ITU/ISO/IEC, project contributors
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ * * Neither the name of the Tampere University or ITU/ISO/IEC nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * INCLUDING NEGLIGENCE OR OTHERWISE ARISING IN ANY WAY OUT OF THE USE OF THIS
+ ****************************************************************************/
+
+#include "greatest/greatest.h"
+
+#include "test_strategies.h"
+
+#include "src/strategies/strategies-picture.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+//////////////////////////////////////////////////////////////////////////
+// MACROS
+#define STRIDE 80
+#define HEIGHT 16
+
+//////////////////////////////////////////////////////////////////////////
+// GLOBALS
+static uvg_pixel pic[STRIDE * HEIGHT];
+
+static struct {
+  crc32c_4x4_func * ref_4x4;
+  crc32c_8x8_func * ref_8x8;
+  crc32c_4x4_x4_func * tested_4x4_x4;
+  crc32c_8x8_x4_func * tested_8x8_x4;
+  const strategy_t * strategy;
+} test_env;
+
+
+//////////////////////////////////////////////////////////////////////////
+// SETUP, TEARDOWN AND HELPER FUNCTIONS
+static void setup_tests()
+{
+  srand(17);
+  for (int i = 0; i < STRIDE * HEIGHT; ++i) {
+    pic[i] = rand() % (1 << UVG_BIT_DEPTH);
+  }
+
+}
+
+/**
+ * \brief Find the per-block checksum of the same implementation as the
+ *        tested four-block one, falling back to generic.
+ *
+ * The 16-bit generic and sse42 checksums hash the pixels differently, so
+ * the four-block kernels are only required to match their own family.
+ * The encoder picks both from the same family.
+ */
+static void *find_ref_strategy(const char *type, const char *strategy_name)
+{
+  void *generic = NULL;
+  for (unsigned i = 0; i < strategies.count; ++i) {
+    if (strcmp(strategies.strategies[i].type, type) != 0) continue;
+    if (strcmp(strategies.strategies[i].strategy_name, strategy_name) == 0) {
+      return strategies.strategies[i].fptr;
+    }
+    if (strcmp(strategies.strategies[i].strategy_name, "generic") == 0) {
+      generic = strategies.strategies[i].fptr;
+    }
+  }
+  return generic;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// TESTS
+
+/**
+ * \brief Hash four 4x4 blocks at a time with the block distances used by
+ *        the IBC hashing and check them against hashing each block.
+ */
+TEST crc32c_4x4_x4(void)
+{
+  ASSERT(test_env.ref_4x4 != NULL);
+
+  for (uint32_t step = 1; step <= 16; step *= 2) {
+    for (int offset = 0; offset < 4; ++offset) {
+      const uvg_pixel *buf = &pic[(offset + 1) * STRIDE + offset];
+      uint32_t crcs[4];
+      test_env.tested_4x4_x4(buf, STRIDE, step, crcs);
+
+      char testname[100];
+      sprintf(testname, "%s step %u offset %d", test_env.strategy->strategy_name, step, offset);
+      for (int i = 0; i < 4; ++i) {
+        ASSERT_EQm(testname, test_env.ref_4x4(buf + i * step, STRIDE), crcs[i]);
+      }
+    }
+  }
+
+  PASS();
+}
+
+
+/**
+ * \brief Hash four 8x8 blocks at a time with the block distances used by
+ *        the IBC hashing and check them against hashing each block.
+ */
+TEST crc32c_8x8_x4(void)
+{
+  ASSERT(test_env.ref_8x8 != NULL);
+
+  for (uint32_t step = 1; step <= 16; step *= 2) {
+    for (int offset = 0; offset < 4; ++offset) {
+      const uvg_pixel *buf = &pic[offset * STRIDE + offset];
+      uint32_t crcs[4];
+      test_env.tested_8x8_x4(buf, STRIDE, step, crcs);
+
+      char testname[100];
+      sprintf(testname, "%s step %u offset %d", test_env.strategy->strategy_name, step, offset);
+      for (int i = 0; i < 4; ++i) {
+        ASSERT_EQm(testname, test_env.ref_8x8(buf + i * step, STRIDE), crcs[i]);
+      }
+    }
+  }
+
+  PASS();
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// TEST FIXTURES
+SUITE(crc_tests)
+{
+  setup_tests();
+
+  for (volatile unsigned i = 0; i < strategies.count; ++i) {
+    const strategy_t * strategy = &strategies.strategies[i];
+    test_env.strategy = strategy;
+
+    if (strcmp(strategy->type, "crc32c_4x4_x4") == 0) {
+      test_env.tested_4x4_x4 = strategy->fptr;
+      test_env.ref_4x4 = find_ref_strategy("crc32c_4x4", strategy->strategy_name);
+      RUN_TEST(crc32c_4x4_x4);
+    } else if (strcmp(strategy->type, "crc32c_8x8_x4") == 0) {
+      test_env.tested_8x8_x4 = strategy->fptr;
+      test_env.ref_8x8 = find_ref_strategy("crc32c_8x8", strategy->strategy_name);
+      RUN_TEST(crc32c_8x8_x4);
+    }
+  }
+}
@@ -55,6 +55,12 @@ static int16_t * dct_actual_bufs[NUM_TESTS] = { 0 }; // pointers returned by mal
 static int16_t dct_result[NUM_SIZES][LCU_WIDTH*LCU_WIDTH] = { { 0 } };
 static int16_t idct_result[NUM_SIZES][LCU_WIDTH*LCU_WIDTH] = { { 0 } };
 
+// Residuals covering the whole range of the bit depth and their transforms.
+static int16_t * full_range_buf = NULL;
+static int16_t * full_range_actual_buf = NULL;
+static int16_t dct_full_range_result[NUM_SIZES][LCU_WIDTH*LCU_WIDTH] = { { 0 } };
+static int16_t idct_full_range_result[NUM_SIZES][LCU_WIDTH*LCU_WIDTH] = { { 0 } };
+
 static struct test_env_t {
   int log_width; // for selecting dim from bufs
   dct_func * tested_func;
@@ -77,6 +83,15 @@ static void init_gradient(int x_px, int y_px, int width, int slope, int16_t *buf
   }
 }
 
+static void init_full_range(int width, int16_t *buf)
+{
+  uint32_t seed = 1;
+  for (int i = 0; i < width * width; ++i) {
+    seed = seed * 1103515245 + 12345;
+    buf[i] = (int16_t)((seed >> 16) % (2 * PIXEL_MAX + 1)) - PIXEL_MAX;
+  }
+}
+
 
 static void setup_tests()
 {
@@ -91,6 +106,10 @@ static void setup_tests()
       init_gradient(width, width, width, 255 / width, dct_bufs[test]);
   }
 
+  full_range_actual_buf = malloc(LCU_WIDTH*LCU_WIDTH*sizeof(int16_t) + SIMD_ALIGNMENT);
+  full_range_buf = ALIGNED_POINTER(full_range_actual_buf, SIMD_ALIGNMENT);
+  init_full_range(LCU_WIDTH, full_range_buf);
+
    
 
   // Select buffer width according to function name for dct function.
@@ -114,6 +133,7 @@ static void setup_tests()
     {
       dct_generic = strat->fptr;
       dct_generic(UVG_BIT_DEPTH, dct_bufs[block], dct_result[block]);
+      dct_generic(UVG_BIT_DEPTH, full_range_buf, dct_full_range_result[block]);
       ++block;
     }
   }
@@ -138,6 +158,7 @@ static void setup_tests()
     {
       idct_generic = strat->fptr;
       idct_generic(UVG_BIT_DEPTH, dct_bufs[block], idct_result[block]);
+      idct_generic(UVG_BIT_DEPTH, full_range_buf, idct_full_range_result[block]);
       ++block;
     }
   }
@@ -148,6 +169,7 @@ static void tear_down_tests()
   for (int test = 0; test < NUM_TESTS; ++test) {
     free(dct_actual_bufs[test]);
   }
+  free(full_range_actual_buf);
 }
 
 
@@ -187,6 +209,38 @@ TEST idct(void)
   PASS();
 }
 
+TEST dct_full_range(void)
+{
+  int index = test_env.log_width - 1;
+  if (strcmp(test_env.strategy->type, "fast_forward_dst_4x4") == 0) index = 0;
+
+  ALIGNED(32) int16_t test_result[LCU_WIDTH*LCU_WIDTH] = { 0 };
+
+  test_env.tested_func(UVG_BIT_DEPTH, full_range_buf, test_result);
+
+  for (int i = 0; i < LCU_WIDTH*LCU_WIDTH; ++i){
+    ASSERT_EQ(test_result[i], dct_full_range_result[index][i]);
+  }
+
+  PASS();
+}
+
+TEST idct_full_range(void)
+{
+  int index = test_env.log_width - 1;
+  if (strcmp(test_env.strategy->type, "fast_inverse_dst_4x4") == 0) index = 0;
+
+  ALIGNED(32) int16_t test_result[LCU_WIDTH*LCU_WIDTH] = { 0 };
+
+  test_env.tested_func(UVG_BIT_DEPTH, full_range_buf, test_result);
+
+  for (int i = 0; i < LCU_WIDTH*LCU_WIDTH; ++i){
+    ASSERT_EQ(test_result[i], idct_full_range_result[index][i]);
+  }
+
+  PASS();
+}
+
 
 //////////////////////////////////////////////////////////////////////////
 // TEST FIXTURES
@@ -246,11 +300,13 @@ SUITE(dct_tests)
       strcmp(strategy->type, "fast_forward_dst_4x4") == 0)
     {
       RUN_TEST(dct);
+      RUN_TEST(dct_full_range);
     }
     else if (strncmp(strategy->type, "idct_", 4) == 0 ||
       strcmp(strategy->type, "fast_inverse_dst_4x4") == 0)
     {
       RUN_TEST(idct);
+      RUN_TEST(idct_full_range);
     }
   }
 
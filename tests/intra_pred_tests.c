@@ -0,0 +1,294 @@
+/*****************************************************************************
+ * This file is part of uvg266 VVC encoder.
+ *
+ * Copyright (c) 2021, Tampere University, ITU/ISO/IEC, project contributors
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ * * Neither the name of the Tampere University or ITU/ISO/IEC nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * INCLUDING NEGLIGENCE OR OTHERWISE ARISING IN ANY WAY OUT OF THE USE OF THIS
+ ****************************************************************************/
+
+#include "greatest/greatest.h"
+
+#include "test_strategies.h"
+
+#include "src/intra.h"
+#include "src/strategies/strategies-intra.h"
+#include "src/strategyselector.h"
+
+#include <stdlib.h>
+
+
+//////////////////////////////////////////////////////////////////////////
+// MACROS
+#define REF_LENGTH (2 * 128 + 3 + 33 * MAX_REF_LINE_IDX)
+
+//////////////////////////////////////////////////////////////////////////
+// GLOBALS
+static uvg_pixel ref_above[REF_LENGTH];
+static uvg_pixel ref_left[REF_LENGTH];
+
+static uvg_intra_ref used_ref;
+
+static uvg_pixel multi_preds[UVG_NUM_INTRA_MODES][32 * 32];
+static uvg_pixel single_pred[32 * 32];
+static uvg_pixel tested_pred[32 * 32];
+
+static struct {
+  angular_pred_multi_func * tested_func;
+  angular_pred_func * tested_angular_func;
+  intra_pred_planar_func * tested_planar_func;
+  pdpc_planar_dc_func * tested_pdpc_func;
+  angular_pred_func * generic_func;
+  intra_pred_planar_func * generic_planar_func;
+  pdpc_planar_dc_func * generic_pdpc_func;
+} test_env;
+
+
+//////////////////////////////////////////////////////////////////////////
+// SETUP, TEARDOWN AND HELPER FUNCTIONS
+static void setup_tests()
+{
+  srand(5);
+  for (int i = 0; i < REF_LENGTH; ++i) {
+    ref_above[i] = rand() % (1 << UVG_BIT_DEPTH);
+    ref_left[i] = rand() % (1 << UVG_BIT_DEPTH);
+  }
+  ref_left[0] = ref_above[0];
+  memcpy(used_ref.top, ref_above, sizeof(used_ref.top));
+  memcpy(used_ref.left, ref_left, sizeof(used_ref.left));
+
+  test_env.generic_func = NULL;
+  test_env.generic_planar_func = NULL;
+  test_env.generic_pdpc_func = NULL;
+  for (unsigned i = 0; i < strategies.count; ++i) {
+    if (strcmp(strategies.strategies[i].strategy_name, "generic") != 0) continue;
+    if (strcmp(strategies.strategies[i].type, "angular_pred") == 0) {
+      test_env.generic_func = strategies.strategies[i].fptr;
+    } else if (strcmp(strategies.strategies[i].type, "intra_pred_planar") == 0) {
+      test_env.generic_planar_func = strategies.strategies[i].fptr;
+    } else if (strcmp(strategies.strategies[i].type, "pdpc_planar_dc") == 0) {
+      test_env.generic_pdpc_func = strategies.strategies[i].fptr;
+    }
+  }
+}
+
+
+static void fill_random_pred(uvg_pixel *pred)
+{
+  for (int i = 0; i < 32 * 32; ++i) {
+    pred[i] = rand() % (1 << UVG_BIT_DEPTH);
+  }
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// TESTS
+
+/**
+ * \brief Predict every angular mode with one call and check each prediction
+ *        against the generic single mode prediction.
+ */
+TEST angular_pred_multi(void)
+{
+  ASSERT(test_env.generic_func != NULL);
+
+  for (int log2_width = 2; log2_width <= 5; ++log2_width) {
+    for (int log2_height = 2; log2_height <= 5; ++log2_height) {
+      for (int multi_ref_idx = 0; multi_ref_idx < MAX_REF_LINE_IDX; ++multi_ref_idx) {
+        const int width = 1 << log2_width;
+        const int height = 1 << log2_height;
+        cu_loc_t cu_loc;
+        uvg_cu_loc_ctor(&cu_loc, 0, 0, width, height);
+
+        int8_t modes[UVG_NUM_INTRA_MODES];
+        uvg_pixel *dst[UVG_NUM_INTRA_MODES];
+        int num_modes = 0;
+        for (int mode = 2; mode <= 66; ++mode) {
+          modes[num_modes] = uvg_wide_angle_correction(mode, log2_width, log2_height, false);
+          dst[num_modes] = multi_preds[num_modes];
+          num_modes++;
+        }
+        memset(multi_preds, 0, sizeof(multi_preds));
+
+        test_env.tested_func(&cu_loc, modes, num_modes, ref_above, ref_left, dst, multi_ref_idx);
+
+        for (int i = 0; i < num_modes; ++i) {
+          memset(single_pred, 0, sizeof(single_pred));
+          test_env.generic_func(&cu_loc, modes[i], COLOR_Y, ref_above, ref_left, single_pred, multi_ref_idx, 0, 0);
+
+          char testname[100];
+          sprintf(testname, "%dx%d mode %d line %d", width, height, modes[i], multi_ref_idx);
+          for (int j = 0; j < width * height; ++j) {
+            ASSERT_EQm(testname, multi_preds[i][j], single_pred[j]);
+          }
+        }
+      }
+    }
+  }
+
+  PASS();
+}
+
+
+/**
+ * \brief Check single mode angular prediction of every block shape, with and
+ *        without ISP, against the generic prediction.
+ */
+TEST angular_pred_shapes(void)
+{
+  ASSERT(test_env.generic_func != NULL);
+
+  // ISP partitions are 1, 2 or 4 samples high with ISP_MODE_HOR and 4
+  // samples wide with ISP_MODE_VER, others are regular blocks.
+  for (int isp_mode = 0; isp_mode <= ISP_MODE_VER; ++isp_mode) {
+    for (int log2_width = 2; log2_width <= 5; ++log2_width) {
+      for (int log2_height = 0; log2_height <= 5; ++log2_height) {
+        if (isp_mode == 0 && log2_height < 2) continue;
+        if (isp_mode == ISP_MODE_HOR && (log2_height > 2 || log2_width < 3)) continue;
+        if (isp_mode == ISP_MODE_VER && (log2_width > 2 || log2_height < 3)) continue;
+        const int width = 1 << log2_width;
+        const int height = 1 << log2_height;
+        const int cu_dim = isp_mode == ISP_MODE_HOR ? height * 4 :
+                           isp_mode == ISP_MODE_VER ? width * 4 : 0;
+        cu_loc_t cu_loc;
+        uvg_cu_loc_ctor(&cu_loc, 0, 0, width, height);
+
+        for (int mode = 2; mode <= 66; ++mode) {
+          const int8_t pred_mode = uvg_wide_angle_correction(mode, log2_width, log2_height, false);
+          const int num_lines = isp_mode ? 1 : MAX_REF_LINE_IDX;
+          for (int multi_ref_idx = 0; multi_ref_idx < num_lines; ++multi_ref_idx) {
+            memset(single_pred, 0, sizeof(single_pred));
+            memset(tested_pred, 0, sizeof(tested_pred));
+            test_env.generic_func(&cu_loc, pred_mode, COLOR_Y, ref_above, ref_left,
+                                  single_pred, multi_ref_idx, isp_mode, cu_dim);
+            test_env.tested_angular_func(&cu_loc, pred_mode, COLOR_Y, ref_above, ref_left,
+                                         tested_pred, multi_ref_idx, isp_mode, cu_dim);
+
+            char testname[100];
+            sprintf(testname, "%dx%d mode %d line %d isp %d", width, height, pred_mode, multi_ref_idx, isp_mode);
+            for (int j = 0; j < width * height; ++j) {
+              ASSERT_EQm(testname, tested_pred[j], single_pred[j]);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  PASS();
+}
+
+
+/**
+ * \brief Check planar prediction of every block shape against the generic
+ *        prediction.
+ */
+TEST intra_pred_planar_shapes(void)
+{
+  ASSERT(test_env.generic_planar_func != NULL);
+
+  for (int log2_width = 2; log2_width <= 5; ++log2_width) {
+    for (int log2_height = 0; log2_height <= 5; ++log2_height) {
+      const int width = 1 << log2_width;
+      const int height = 1 << log2_height;
+      cu_loc_t cu_loc;
+      uvg_cu_loc_ctor(&cu_loc, 0, 0, width, height);
+
+      memset(single_pred, 0, sizeof(single_pred));
+      memset(tested_pred, 0, sizeof(tested_pred));
+      test_env.generic_planar_func(&cu_loc, COLOR_Y, ref_above, ref_left, single_pred);
+      test_env.tested_planar_func(&cu_loc, COLOR_Y, ref_above, ref_left, tested_pred);
+
+      char testname[100];
+      sprintf(testname, "%dx%d", width, height);
+      for (int j = 0; j < 32 * 32; ++j) {
+        ASSERT_EQm(testname, tested_pred[j], single_pred[j]);
+      }
+    }
+  }
+
+  PASS();
+}
+
+
+/**
+ * \brief Check planar and DC PDPC of every block shape against the generic
+ *        implementation.
+ */
+TEST pdpc_planar_dc_shapes(void)
+{
+  ASSERT(test_env.generic_pdpc_func != NULL);
+
+  for (int mode = 0; mode <= 1; ++mode) {
+    for (int log2_width = 2; log2_width <= 5; ++log2_width) {
+      for (int log2_height = 2; log2_height <= 5; ++log2_height) {
+        const int width = 1 << log2_width;
+        const int height = 1 << log2_height;
+        cu_loc_t cu_loc;
+        uvg_cu_loc_ctor(&cu_loc, 0, 0, width, height);
+
+        fill_random_pred(single_pred);
+        memcpy(tested_pred, single_pred, sizeof(tested_pred));
+        test_env.generic_pdpc_func(mode, &cu_loc, COLOR_Y, &used_ref, single_pred);
+        test_env.tested_pdpc_func(mode, &cu_loc, COLOR_Y, &used_ref, tested_pred);
+
+        char testname[100];
+        sprintf(testname, "%dx%d mode %d", width, height, mode);
+        for (int j = 0; j < 32 * 32; ++j) {
+          ASSERT_EQm(testname, tested_pred[j], single_pred[j]);
+        }
+      }
+    }
+  }
+
+  PASS();
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// TEST FIXTURES
+SUITE(intra_pred_tests)
+{
+  setup_tests();
+
+  for (volatile unsigned i = 0; i < strategies.count; ++i) {
+    const strategy_t * strategy = &strategies.strategies[i];
+
+    if (strcmp(strategy->type, "angular_pred_multi") == 0) {
+      test_env.tested_func = strategy->fptr;
+      RUN_TEST(angular_pred_multi);
+    } else if (strcmp(strategy->type, "angular_pred") == 0) {
+      test_env.tested_angular_func = strategy->fptr;
+      RUN_TEST(angular_pred_shapes);
+    } else if (strcmp(strategy->type, "intra_pred_planar") == 0) {
+      test_env.tested_planar_func = strategy->fptr;
+      RUN_TEST(intra_pred_planar_shapes);
+    } else if (strcmp(strategy->type, "pdpc_planar_dc") == 0) {
+      test_env.tested_pdpc_func = strategy->fptr;
+      RUN_TEST(pdpc_planar_dc_shapes);
+    }
+  }
+}
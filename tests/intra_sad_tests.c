@@ -55,6 +55,14 @@ static struct {
   cost_pixel_nxn_func * tested_func;
 } test_env;
 
+static struct {
+  int log_width;
+  cost_pixel_nxn_multi_func * tested_func;
+} quad_test_env;
+
+// Four 32x32 predictions in the layout used by intra search.
+static uvg_pixel quad_preds[4][32 * 32];
+
 
 //////////////////////////////////////////////////////////////////////////
 // SETUP, TEARDOWN AND HELPER FUNCTIONS
@@ -71,6 +79,14 @@ static void init_gradient(int x_px, int y_px, int width, int slope, uvg_pixel *b
 }
 
 
+static void fill_pixels(uvg_pixel *buf, uvg_pixel val, unsigned size)
+{
+  for (unsigned i = 0; i < size; ++i) {
+    buf[i] = val;
+  }
+}
+
+
 static void setup_tests()
 {
   for (int test = 0; test < NUM_TESTS; ++test) {
@@ -92,8 +108,8 @@ static void setup_tests()
   int test = 0;
   for (int w = LCU_MIN_LOG_W; w <= LCU_MAX_LOG_W; ++w) {
     unsigned size = 1 << (w * 2);
-    FILL_ARRAY(bufs[test][w][0], 0, size);
-    FILL_ARRAY(bufs[test][w][1], 255, size);
+    fill_pixels(bufs[test][w][0], 0, size);
+    fill_pixels(bufs[test][w][1], 255, size);
   }
 
   test = 1;
@@ -102,7 +118,7 @@ static void setup_tests()
     unsigned size = 1 << (w * 2);
     init_gradient(3, 1, width, 1, bufs[test][w][0]);
     //init_gradient(width / 2, 0, width, 1, bufs[test][w][1]);
-    FILL_ARRAY(bufs[test][w][1], 128, size);
+    fill_pixels(bufs[test][w][1], 128, size);
   }
 }
 
@@ -123,7 +139,8 @@ static unsigned test_calc_sad(const uvg_pixel * buf1, const uvg_pixel * buf2, in
   for (int i = 0; i < dim * dim; ++i) {
     result += abs(buf1[i] - buf2[i]);
   }
-  return result;
+  // The fixed size SAD functions scale the cost to 8-bit range.
+  return result >> (UVG_BIT_DEPTH - 8);
 }
 
 
@@ -148,7 +165,7 @@ TEST test_black_and_white(void)
   ASSERT_EQ(result1, result2);
 
   // Result matches trivial implementation.
-  ASSERT_EQ(result1, 255 * width * width);
+  ASSERT_EQ(result1, (255 * width * width) >> (UVG_BIT_DEPTH - 8));
 
   PASS();
 }
@@ -179,6 +196,37 @@ TEST test_gradient(void)
 }
 
 
+/**
+ * Test that each of the blocks gets its own SAD and that only num_modes
+ * blocks are used.
+ */
+TEST test_quad(void)
+{
+  const int log_width = quad_test_env.log_width;
+  const int width = 1 << log_width;
+  const unsigned size = width * width;
+
+  memcpy(quad_preds[0], bufs[0][log_width][0], size * sizeof(uvg_pixel));
+  memcpy(quad_preds[1], bufs[0][log_width][1], size * sizeof(uvg_pixel));
+  memcpy(quad_preds[2], bufs[1][log_width][1], size * sizeof(uvg_pixel));
+  for (unsigned i = 0; i < size; ++i) {
+    quad_preds[3][i] = (i * 7) & 255;
+  }
+  const uvg_pixel *orig = bufs[1][log_width][0];
+
+  for (unsigned num_modes = 1; num_modes <= 4; ++num_modes) {
+    unsigned results[4] = { 0 };
+    quad_test_env.tested_func(quad_preds, orig, num_modes, results);
+    for (unsigned mode = 0; mode < 4; ++mode) {
+      const unsigned expected = mode < num_modes ? test_calc_sad(quad_preds[mode], orig, width) : 0;
+      ASSERT_EQ(results[mode], expected);
+    }
+  }
+
+  PASS();
+}
+
+
 //////////////////////////////////////////////////////////////////////////
 // TEST FIXTURES
 SUITE(intra_sad_tests)
@@ -214,5 +262,25 @@ SUITE(intra_sad_tests)
     RUN_TEST(test_gradient);
   }
 
+  for (volatile unsigned i = 0; i < strategies.count; ++i) {
+    const char * type = strategies.strategies[i].type;
+
+    if (strcmp(type, "sad_4x4_quad") == 0) {
+      quad_test_env.log_width = 2;
+    } else if (strcmp(type, "sad_8x8_quad") == 0) {
+      quad_test_env.log_width = 3;
+    } else if (strcmp(type, "sad_16x16_quad") == 0) {
+      quad_test_env.log_width = 4;
+    } else if (strcmp(type, "sad_32x32_quad") == 0) {
+      quad_test_env.log_width = 5;
+    } else {
+      continue;
+    }
+
+    quad_test_env.tested_func = strategies.strategies[i].fptr;
+
+    RUN_TEST(test_quad);
+  }
+
   tear_down_tests();
 }
@@ -0,0 +1,183 @@
+/*****************************************************************************
+ * This file is part of uvg266 VVC encoder.
+ *
+ * Copyright (c) 2021, Tampere University, ITU/ISO/IEC, project contributors
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ * * Neither the name of the Tampere University or ITU/ISO/IEC nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * INCLUDING NEGLIGENCE OR OTHERWISE ARISING IN ANY WAY OUT OF THE USE OF THIS
+ ****************************************************************************/
+
+#include "greatest/greatest.h"
+
+#include "test_strategies.h"
+
+#include "src/strategies/strategies-ipol.h"
+#include "src/strategyselector.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+//////////////////////////////////////////////////////////////////////////
+// MACROS
+#define SRC_WIDTH 37
+#define SRC_HEIGHT 29
+#define DST_STRIDE 96
+#define DST_HEIGHT 24
+#define DST_GUARD 0xA5
+
+//////////////////////////////////////////////////////////////////////////
+// GLOBALS
+static uvg_pixel *src;
+static uvg_pixel expected[DST_STRIDE * DST_HEIGHT];
+static uvg_pixel actual[DST_STRIDE * DST_HEIGHT];
+
+static struct {
+  epol_copy_func * tested_func;
+  epol_copy_func * generic_func;
+  const strategy_t * strategy;
+} test_env;
+
+
+//////////////////////////////////////////////////////////////////////////
+// SETUP, TEARDOWN AND HELPER FUNCTIONS
+static void setup_tests()
+{
+  // Without any padding so that reading outside the picture shows up with
+  // address sanitizer.
+  src = malloc(SRC_WIDTH * SRC_HEIGHT * sizeof(uvg_pixel));
+  srand(7);
+  for (int i = 0; i < SRC_WIDTH * SRC_HEIGHT; ++i) {
+    src[i] = rand() % (1 << UVG_BIT_DEPTH);
+  }
+
+  test_env.generic_func = NULL;
+  for (unsigned i = 0; i < strategies.count; ++i) {
+    if (strcmp(strategies.strategies[i].type, "copy_extended_block") == 0 &&
+        strcmp(strategies.strategies[i].strategy_name, "generic") == 0) {
+      test_env.generic_func = strategies.strategies[i].fptr;
+    }
+  }
+}
+
+static void tear_down_tests()
+{
+  free(src);
+  src = NULL;
+}
+
+/**
+ * \brief Positions where a block of the given size is fully outside, crosses
+ *        an edge of, or is fully inside a picture of the given size.
+ */
+static int block_positions(int blk_size, int pic_size, int pos[12])
+{
+  int n = 0;
+  pos[n++] = -blk_size - 9;
+  pos[n++] = -blk_size;
+  pos[n++] = -blk_size + 1;
+  pos[n++] = -3;
+  pos[n++] = -1;
+  pos[n++] = 0;
+  pos[n++] = 5;
+  pos[n++] = pic_size - blk_size;
+  pos[n++] = pic_size - blk_size + 3;
+  pos[n++] = pic_size - 1;
+  pos[n++] = pic_size;
+  pos[n++] = pic_size + 7;
+  return n;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// TESTS
+
+/**
+ * \brief Copy blocks crossing every edge and corner of the picture and
+ *        check them against the generic version, including that nothing
+ *        is written outside the block.
+ */
+TEST copy_extended_block(void)
+{
+  ASSERT(test_env.generic_func != NULL);
+
+  static const int widths[] = { 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 36, 37, 38, 47, 64, 65, 80 };
+  static const int heights[] = { 1, 2, 5, 8, 17, 24 };
+
+  for (int wi = 0; wi < sizeof(widths) / sizeof(widths[0]); ++wi) {
+    for (int hi = 0; hi < sizeof(heights) / sizeof(heights[0]); ++hi) {
+      const int blk_w = widths[wi];
+      const int blk_h = heights[hi];
+      int pos_x[12];
+      int pos_y[12];
+      const int num_x = block_positions(blk_w, SRC_WIDTH, pos_x);
+      const int num_y = block_positions(blk_h, SRC_HEIGHT, pos_y);
+
+      for (int yi = 0; yi < num_y; ++yi) {
+        for (int xi = 0; xi < num_x; ++xi) {
+          memset(expected, DST_GUARD, sizeof(expected));
+          memset(actual, DST_GUARD, sizeof(actual));
+
+          test_env.generic_func(src, SRC_WIDTH, SRC_HEIGHT, SRC_WIDTH,
+                                pos_x[xi], pos_y[yi], blk_w, blk_h,
+                                &expected[8], DST_STRIDE);
+          test_env.tested_func(src, SRC_WIDTH, SRC_HEIGHT, SRC_WIDTH,
+                               pos_x[xi], pos_y[yi], blk_w, blk_h,
+                               &actual[8], DST_STRIDE);
+
+          char testname[100];
+          sprintf(testname, "%s %dx%d at (%d, %d)", test_env.strategy->strategy_name,
+                  blk_w, blk_h, pos_x[xi], pos_y[yi]);
+          for (int i = 0; i < DST_STRIDE * DST_HEIGHT; ++i) {
+            ASSERT_EQm(testname, expected[i], actual[i]);
+          }
+        }
+      }
+    }
+  }
+
+  PASS();
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// TEST FIXTURES
+SUITE(ipol_tests)
+{
+  setup_tests();
+
+  for (volatile unsigned i = 0; i < strategies.count; ++i) {
+    const strategy_t * strategy = &strategies.strategies[i];
+
+    if (strcmp(strategy->type, "copy_extended_block") == 0) {
+      test_env.tested_func = strategy->fptr;
+      test_env.strategy = strategy;
+      RUN_TEST(copy_extended_block);
+    }
+  }
+
+  tear_down_tests();
+}
@@ -216,6 +216,103 @@ TEST idct(void)
   PASS();
 }
 
+static void *get_generic_func(const char *type)
+{
+  for (int s = 0; s < strategies.count; ++s) {
+    if (strcmp(strategies.strategies[s].type, type) == 0 &&
+        strcmp(strategies.strategies[s].strategy_name, "generic") == 0) {
+      return strategies.strategies[s].fptr;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * \brief Check every rectangular size, MTS type and LFNST zero-out against
+ *        the generic implementation.
+ */
+TEST non_square(void)
+{
+  char testname[100];
+  mts_dct_func *generic_func = get_generic_func(test_env.strategy->type);
+  ASSERT(generic_func != NULL);
+
+  for (int log_h = LCU_MIN_LOG_W; log_h <= LCU_MAX_LOG_W; ++log_h) {
+    for (int log_w = LCU_MIN_LOG_W; log_w <= LCU_MAX_LOG_W; ++log_w) {
+      if (log_w == log_h) continue;
+      const int width = 1 << log_w;
+      const int height = 1 << log_h;
+      for (int tr_idx = MTS_DCT2_DCT2; tr_idx < MTS_DST7_DST7 + NUM_TRANSFORM; ++tr_idx) {
+        if (tr_idx == MTS_SKIP) continue;
+        for (int lfnst_idx = 0; lfnst_idx <= 1; ++lfnst_idx) {
+          sprintf(testname, "Block: %d x %d, tr_idx: %d, lfnst: %d", width, height, tr_idx, lfnst_idx);
+          cu_info_t tu;
+          tu.type = CU_INTRA;
+          tu.tr_idx = tr_idx;
+          tu.lfnst_idx = lfnst_idx;
+          tu.cr_lfnst_idx = 0;
+          tu.intra.isp_mode = 0;
+
+          int16_t *buf = dct_bufs[log_w - LCU_MIN_LOG_W];
+          ALIGNED(32) int16_t test_result[LCU_WIDTH * LCU_WIDTH] = { 0 };
+          ALIGNED(32) int16_t ref_result[LCU_WIDTH * LCU_WIDTH] = { 0 };
+
+          generic_func(UVG_BIT_DEPTH, COLOR_Y, &tu, width, height, buf, ref_result, UVG_MTS_BOTH);
+          test_env.tested_func(UVG_BIT_DEPTH, COLOR_Y, &tu, width, height, buf, test_result, UVG_MTS_BOTH);
+
+          for (int i = 0; i < width * height; ++i) {
+            ASSERT_EQm(testname, test_result[i], ref_result[i]);
+          }
+        }
+      }
+    }
+  }
+
+  PASS();
+}
+
+/**
+ * \brief Check the 1xN, Nx1, 2xN and Nx2 shapes produced by ISP against the
+ *        generic implementation.
+ */
+TEST isp_shapes(void)
+{
+  static const int shapes[][2] = {
+    { 1, 16 }, { 1, 32 }, { 16, 1 }, { 32, 1 },
+    { 2, 8 }, { 2, 16 }, { 2, 32 }, { 8, 2 }, { 16, 2 }, { 32, 2 },
+  };
+  char testname[100];
+  mts_dct_func *generic_func = get_generic_func(test_env.strategy->type);
+  ASSERT(generic_func != NULL);
+
+  for (int i = 0; i < sizeof(shapes) / sizeof(shapes[0]); ++i) {
+    const int width = shapes[i][0];
+    const int height = shapes[i][1];
+    for (int isp_mode = 1; isp_mode <= 2; ++isp_mode) {
+      sprintf(testname, "Block: %d x %d, isp_mode: %d", width, height, isp_mode);
+      cu_info_t tu;
+      tu.type = CU_INTRA;
+      tu.tr_idx = MTS_DCT2_DCT2;
+      tu.lfnst_idx = 0;
+      tu.cr_lfnst_idx = 0;
+      tu.intra.isp_mode = isp_mode;
+
+      int16_t *buf = dct_bufs[0];
+      ALIGNED(32) int16_t test_result[LCU_WIDTH * LCU_WIDTH] = { 0 };
+      ALIGNED(32) int16_t ref_result[LCU_WIDTH * LCU_WIDTH] = { 0 };
+
+      generic_func(UVG_BIT_DEPTH, COLOR_Y, &tu, width, height, buf, ref_result, UVG_MTS_BOTH);
+      test_env.tested_func(UVG_BIT_DEPTH, COLOR_Y, &tu, width, height, buf, test_result, UVG_MTS_BOTH);
+
+      for (int j = 0; j < width * height; ++j) {
+        ASSERT_EQm(testname, test_result[j], ref_result[j]);
+      }
+    }
+  }
+
+  PASS();
+}
+
 
 //////////////////////////////////////////////////////////////////////////
 // TEST FIXTURES
@@ -240,11 +337,15 @@ SUITE(mts_tests)
     {
       //fprintf(stderr, "Test: %s\r\n", strategy->strategy_name);
       RUN_TEST(dct);
+      RUN_TEST(non_square);
+      RUN_TEST(isp_shapes);
     }
     else if (strcmp(strategy->type, "mts_idct") == 0)
     {
       //fprintf(stderr, "Test: %s\r\n", strategy->strategy_name);
       RUN_TEST(idct);
+      RUN_TEST(non_square);
+      RUN_TEST(isp_shapes);
     }
   }
 
@@ -0,0 +1,221 @@
+/*****************************************************************************
+ * This file is part of uvg266 VVC encoder.
+ *
+ * Copyright (c) 2021, Tampere University, ITU/ISO/IEC, project contributors
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ * 
+ * * Neither the name of the Tampere University or ITU/ISO/IEC nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * INCLUDING NEGLIGENCE OR OTHERWISE ARISING IN ANY WAY OUT OF THE USE OF THIS
+ ****************************************************************************/
+
+#include "greatest/greatest.h"
+
+#include "test_strategies.h"
+
+#include "src/encoder.h"
+#include "src/encoderstate.h"
+#include "src/scalinglist.h"
+#include "src/strategies/strategies-picture.h"
+#include "src/strategies/strategies-quant.h"
+#include "src/strategyselector.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+//////////////////////////////////////////////////////////////////////////
+// MACROS
+#define MAX_WIDTH 32
+#define BUF_SIZE (MAX_WIDTH * MAX_WIDTH + 16)
+#define GUARD 0x5A5A
+#define NUM_BLOCKS 20
+
+//////////////////////////////////////////////////////////////////////////
+// GLOBALS
+static encoder_control_t encoder;
+static encoder_state_config_frame_t frame;
+static encoder_state_t state;
+
+static uvg_pixel ref[MAX_WIDTH * MAX_WIDTH];
+static uvg_pixel pred[MAX_WIDTH * MAX_WIDTH];
+static coeff_t coeff[NUM_BLOCKS][MAX_WIDTH * MAX_WIDTH];
+
+static int16_t expected[BUF_SIZE];
+static int16_t actual[BUF_SIZE];
+
+static struct {
+  quant_func * tested_quant;
+  quant_func * generic_quant;
+  generate_residual_func * tested_residual;
+  generate_residual_func * generic_residual;
+} test_env;
+
+
+//////////////////////////////////////////////////////////////////////////
+// SETUP, TEARDOWN AND HELPER FUNCTIONS
+static void setup_tests()
+{
+  encoder.bitdepth = UVG_BIT_DEPTH;
+  encoder.cfg.signhide_enable = true;
+  uvg_scalinglist_init(&encoder.scaling_list);
+  uvg_scalinglist_process(&encoder.scaling_list, encoder.bitdepth);
+
+  frame.slicetype = UVG_SLICE_I;
+  state.encoder_control = &encoder;
+  state.frame = &frame;
+  state.qp = 27;
+
+  srand(11);
+  for (int i = 0; i < MAX_WIDTH * MAX_WIDTH; ++i) {
+    ref[i] = rand() % (1 << UVG_BIT_DEPTH);
+    pred[i] = rand() % (1 << UVG_BIT_DEPTH);
+  }
+  // Mostly small coefficients so that blocks have several nonzero levels
+  // and sign hiding kicks in.
+  for (int b = 0; b < NUM_BLOCKS; ++b) {
+    for (int i = 0; i < MAX_WIDTH * MAX_WIDTH; ++i) {
+      const int range = (b + 1) * 64;
+      coeff[b][i] = (rand() % 4 == 0) ? (rand() % (2 * range + 1)) - range : 0;
+    }
+  }
+
+  test_env.generic_quant = NULL;
+  test_env.generic_residual = NULL;
+  for (unsigned i = 0; i < strategies.count; ++i) {
+    if (strcmp(strategies.strategies[i].strategy_name, "generic") != 0) continue;
+    if (strcmp(strategies.strategies[i].type, "quant") == 0) {
+      test_env.generic_quant = strategies.strategies[i].fptr;
+    } else if (strcmp(strategies.strategies[i].type, "generate_residual") == 0) {
+      test_env.generic_residual = strategies.strategies[i].fptr;
+    }
+  }
+}
+
+
+static void tear_down_tests()
+{
+  uvg_scalinglist_destroy(&encoder.scaling_list);
+}
+
+
+static void fill_guard(int16_t *buf)
+{
+  for (int i = 0; i < BUF_SIZE; ++i) buf[i] = GUARD;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// TESTS
+
+/**
+ * \brief Quantize blocks of every shape with at least 16 coefficients, with
+ *        sign hiding, and check them against the generic quantization.
+ */
+TEST quant_shapes(void)
+{
+  ASSERT(test_env.generic_quant != NULL);
+
+  for (int log2_width = 0; log2_width <= 5; ++log2_width) {
+    for (int log2_height = 0; log2_height <= 5; ++log2_height) {
+      if (log2_width + log2_height < 4) continue;
+      const int width = 1 << log2_width;
+      const int height = 1 << log2_height;
+
+      for (color_t color = COLOR_Y; color <= COLOR_U; ++color) {
+        for (int block_type = CU_INTRA; block_type <= CU_INTER; ++block_type) {
+          for (int b = 0; b < NUM_BLOCKS; ++b) {
+            fill_guard(expected);
+            fill_guard(actual);
+            test_env.generic_quant(&state, coeff[b], (coeff_t *)expected, width, height,
+                                   color, SCAN_DIAG, block_type, 0, 0);
+            test_env.tested_quant(&state, coeff[b], (coeff_t *)actual, width, height,
+                                  color, SCAN_DIAG, block_type, 0, 0);
+
+            char testname[100];
+            sprintf(testname, "%dx%d color %d type %d block %d",
+                    width, height, color, block_type, b);
+            for (int i = 0; i < width * height; ++i) {
+              ASSERT_EQm(testname, expected[i], actual[i]);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  PASS();
+}
+
+
+/**
+ * \brief Check the residual of every block shape, including the 1 and 2
+ *        wide and high ISP partitions, against the generic residual.
+ */
+TEST generate_residual_shapes(void)
+{
+  ASSERT(test_env.generic_residual != NULL);
+
+  for (int log2_width = 0; log2_width <= 5; ++log2_width) {
+    for (int log2_height = 0; log2_height <= 5; ++log2_height) {
+      const int width = 1 << log2_width;
+      const int height = 1 << log2_height;
+
+      fill_guard(expected);
+      fill_guard(actual);
+      test_env.generic_residual(ref, pred, expected, width, height, MAX_WIDTH, MAX_WIDTH);
+      test_env.tested_residual(ref, pred, actual, width, height, MAX_WIDTH, MAX_WIDTH);
+
+      char testname[100];
+      sprintf(testname, "%dx%d", width, height);
+      for (int i = 0; i < BUF_SIZE; ++i) {
+        ASSERT_EQm(testname, expected[i], actual[i]);
+      }
+    }
+  }
+
+  PASS();
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// TEST FIXTURES
+SUITE(quant_tests)
+{
+  setup_tests();
+
+  for (volatile unsigned i = 0; i < strategies.count; ++i) {
+    const strategy_t * strategy = &strategies.strategies[i];
+
+    if (strcmp(strategy->type, "quant") == 0) {
+      test_env.tested_quant = strategy->fptr;
+      RUN_TEST(quant_shapes);
+    } else if (strcmp(strategy->type, "generate_residual") == 0) {
+      test_env.tested_residual = strategy->fptr;
+      RUN_TEST(generate_residual_shapes);
+    }
+  }
+
+  tear_down_tests();
+}
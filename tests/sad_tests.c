@@ -44,7 +44,7 @@
 
 //////////////////////////////////////////////////////////////////////////
 // DEFINES
-#define TEST_SAD(X, Y) uvg_image_calc_sad(g_pic, g_ref, 0, 0, (X), (Y), 8, 8, NULL)
+#define TEST_SAD(X, Y) uvg_image_calc_sad(g_pic, g_ref, NULL, 0, 0, (X), (Y), 8, 8, NULL)
 
 //////////////////////////////////////////////////////////////////////////
 // GLOBALS
@@ -92,14 +92,14 @@ static void setup_tests()
   g_pic = uvg_image_alloc(UVG_CSP_420, 8, 8);
   for (int y = 0; y < 8; ++y) {
     for (int x = 0; x < 8; ++x) {
-      g_pic->y[y*g_pic->stride + x] = pic_data[8*y + x] + 48;
+      g_pic->y[y*g_pic->stride + x] = (pic_data[8*y + x] + 48) << (UVG_BIT_DEPTH - 8);
     }
   }
 
   g_ref = uvg_image_alloc(UVG_CSP_420, 8, 8);
   for (int y = 0; y < 8; ++y) {
     for (int x = 0; x < 8; ++x) {
-      g_ref->y[y*g_ref->stride + x] = ref_data[8*y + x] + 48;
+      g_ref->y[y*g_ref->stride + x] = (ref_data[8*y + x] + 48) << (UVG_BIT_DEPTH - 8);
     }
   }
 
@@ -108,7 +108,7 @@ static void setup_tests()
   for (int y = 0; y < 64; ++y) {
     for (int x = 0; x < 64; ++x) {
       i = ((64 * y) + x);
-      g_big_pic->y[y*g_big_pic->stride + x] = (i*i / 32 + i) % 255;
+      g_big_pic->y[y*g_big_pic->stride + x] = (i*i / 32 + i) % PIXEL_MAX;
     }
   }
 
@@ -117,7 +117,7 @@ static void setup_tests()
   for (int y = 0; y < 64; ++y) {
     for (int x = 0; x < 64; ++x) {
       i = ((64 * y) + x);
-      g_big_ref->y[y*g_big_ref->stride + x] = (i*i / 16 + i) % 255;
+      g_big_ref->y[y*g_big_ref->stride + x] = (i*i / 16 + i) % PIXEL_MAX;
     }
   }
 
@@ -125,7 +125,9 @@ static void setup_tests()
   memset(g_64x64_zero->y, 0, 64 * 64 * sizeof(uvg_pixel));
   
   g_64x64_max = uvg_image_alloc(UVG_CSP_420, 64, 64);
-  memset(g_64x64_max->y, PIXEL_MAX, 64 * 64 * sizeof(uvg_pixel));
+  for (int i = 0; i < 64 * 64; ++i) {
+    g_64x64_max->y[i] = PIXEL_MAX;
+  }
 }
 
 static void tear_down_tests()
@@ -343,6 +345,39 @@ TEST test_reg_sad_overflow(void)
 }
 
 
+TEST test_reg_sad_x4(void)
+{
+  unsigned width = sad_test_env.width;
+  unsigned height = sad_test_env.height;
+  unsigned stride = 64;
+
+  const uvg_pixel *refs[4] = {
+    g_big_ref->y,
+    g_big_ref->y + 1,
+    g_big_ref->y + stride,
+    g_big_ref->y + stride + 3,
+  };
+
+  void(*tested_func)(const uvg_pixel *, const uvg_pixel *const[4], int, int, unsigned, unsigned, unsigned[4]) = sad_test_env.tested_func;
+  unsigned results[4];
+  tested_func(g_big_pic->y, refs, width, height, stride, stride, results);
+
+  sprintf(sad_test_env.msg, "%s(%ux%u):%s",
+          sad_test_env.strategy->type,
+          width,
+          height,
+          sad_test_env.strategy->strategy_name);
+
+  for (int i = 0; i < 4; ++i) {
+    if (results[i] != simple_sad(g_big_pic->y, refs[i], stride, width, height)) {
+      FAILm(sad_test_env.msg);
+    }
+  }
+
+  PASSm(sad_test_env.msg);
+}
+
+
 //////////////////////////////////////////////////////////////////////////
 // TEST FIXTURES
 SUITE(sad_tests)
@@ -408,6 +443,26 @@ SUITE(sad_tests)
       RUN_TEST(test_reg_sad_overflow);
     }
   }
+
+  for (volatile unsigned i = 0; i < strategies.count; ++i) {
+    if (strcmp(strategies.strategies[i].type, "reg_sad_x4") != 0) {
+      continue;
+    }
+
+    static const int tested_dims[][2] = {
+      {64, 32}, {32, 32}, {16, 16}, {8, 8}, {4, 4},
+      {32, 8}, {8, 32}, {16, 4}, {4, 16}, {24, 16}, {12, 4}, {16, 7}, {8, 3}, {4, 5}
+    };
+
+    sad_test_env.tested_func = strategies.strategies[i].fptr;
+    sad_test_env.strategy = &strategies.strategies[i];
+    int num_dim_tests = sizeof(tested_dims) / sizeof(tested_dims[0]);
+    for (volatile int dim_test = 0; dim_test < num_dim_tests; ++dim_test) {
+      sad_test_env.width = tested_dims[dim_test][0];
+      sad_test_env.height = tested_dims[dim_test][1];
+      RUN_TEST(test_reg_sad_x4);
+    }
+  }
   
   tear_down_tests();
 }
@@ -40,7 +40,7 @@
 
 //////////////////////////////////////////////////////////////////////////
 // MACROS
-#define NUM_TESTS 3
+#define NUM_TESTS 5
 #define LCU_MAX_LOG_W 6
 #define LCU_MIN_LOG_W 2
 
@@ -51,8 +51,23 @@ static uvg_pixel * satd_bufs[NUM_TESTS][7][2];
 static struct {
   int log_width; // for selecting dim from satd_bufs
   cost_pixel_nxn_func * tested_func;
+  cost_pixel_nxn_func * generic_func;
 } satd_test_env;
 
+static struct {
+  int log_width;
+  cost_pixel_nxn_multi_func * tested_func;
+  cost_pixel_nxn_multi_func * generic_func;
+} satd_quad_test_env;
+
+static struct {
+  cost_pixel_any_size_multi_func * tested_func;
+  cost_pixel_any_size_multi_func * generic_func;
+} satd_vtm_quad_test_env;
+
+// Four 32x32 predictions in the layout used by intra search.
+static uvg_pixel satd_quad_preds[4][32 * 32];
+
 
 //////////////////////////////////////////////////////////////////////////
 // SETUP, TEARDOWN AND HELPER FUNCTIONS
@@ -101,6 +116,29 @@ static void setup_tests()
       satd_bufs[test][w][1][i] = 255 - 255 / (r + 1);
     }
   }
+
+  //Pseudorandom samples over the whole range of the bit depth
+  test = 3;
+  uint32_t seed = 1;
+  for (int w = LCU_MIN_LOG_W; w <= LCU_MAX_LOG_W; ++w) {
+    unsigned size = 1 << (w * 2);
+    for (int i = 0; i < size; ++i){
+      seed = seed * 1103515245 + 12345;
+      satd_bufs[test][w][0][i] = (seed >> 16) % (PIXEL_MAX + 1);
+      seed = seed * 1103515245 + 12345;
+      satd_bufs[test][w][1][i] = (seed >> 16) % (PIXEL_MAX + 1);
+    }
+  }
+
+  //Checker pattern with the largest possible differences
+  test = 4;
+  for (int w = LCU_MIN_LOG_W; w <= LCU_MAX_LOG_W; ++w) {
+    unsigned size = 1 << (w * 2);
+    for (int i = 0; i < size; ++i){
+      satd_bufs[test][w][0][i] = PIXEL_MAX * ( ( ((i >> w)%2) + (i % 2) ) % 2);
+      satd_bufs[test][w][1][i] = PIXEL_MAX - satd_bufs[test][w][0][i];
+    }
+  }
 }
 
 static void satd_tear_down_tests()
@@ -117,6 +155,8 @@ static void satd_tear_down_tests()
 //////////////////////////////////////////////////////////////////////////
 // TESTS
 
+#if UVG_BIT_DEPTH == 8
+// The expected results are for 8-bit samples.
 TEST satd_test_black_and_white(void)
 {
   const int satd_results[5] = {510, 1020, 4080, 16320, 65280};
@@ -171,6 +211,80 @@ TEST satd_test_gradient(void)
 
   PASS();
 }
+#endif // UVG_BIT_DEPTH == 8
+
+TEST satd_test_against_generic(void)
+{
+  for (int test = 3; test < NUM_TESTS; ++test) {
+    uvg_pixel * buf1 = satd_bufs[test][satd_test_env.log_width][0];
+    uvg_pixel * buf2 = satd_bufs[test][satd_test_env.log_width][1];
+
+    ASSERT_EQ(satd_test_env.tested_func(buf1, buf2), satd_test_env.generic_func(buf1, buf2));
+    ASSERT_EQ(satd_test_env.tested_func(buf2, buf1), satd_test_env.generic_func(buf2, buf1));
+  }
+
+  PASS();
+}
+
+static void satd_quad_setup_preds(const uvg_pixel *src[4], int log_width)
+{
+  for (int mode = 0; mode < 4; ++mode) {
+    memcpy(satd_quad_preds[mode], src[mode], (1 << (log_width * 2)) * sizeof(uvg_pixel));
+  }
+}
+
+TEST satd_quad_test_against_generic(void)
+{
+  const int log_width = satd_quad_test_env.log_width;
+
+  for (int test = 3; test < NUM_TESTS; ++test) {
+    const uvg_pixel *src[4] = {
+      satd_bufs[test][log_width][1], satd_bufs[2][log_width][0],
+      satd_bufs[7 - test][log_width][0], satd_bufs[7 - test][log_width][1],
+    };
+    satd_quad_setup_preds(src, log_width);
+    const uvg_pixel *orig = satd_bufs[test][log_width][0];
+
+    for (unsigned num_modes = 1; num_modes <= 4; ++num_modes) {
+      unsigned tested[4] = { 0 };
+      unsigned expected[4] = { 0 };
+      satd_quad_test_env.tested_func(satd_quad_preds, orig, num_modes, tested);
+      satd_quad_test_env.generic_func(satd_quad_preds, orig, num_modes, expected);
+      for (unsigned mode = 0; mode < num_modes; ++mode) {
+        ASSERT_EQ(tested[mode], expected[mode]);
+      }
+    }
+  }
+
+  PASS();
+}
+
+TEST satd_vtm_quad_test_against_generic(void)
+{
+  // Every block shape of intra search, read from inside 32x32 buffers.
+  for (int test = 3; test < NUM_TESTS; ++test) {
+    const uvg_pixel *preds[4] = {
+      satd_bufs[test][5][1], satd_bufs[2][5][0],
+      satd_bufs[7 - test][5][0], satd_bufs[7 - test][5][1],
+    };
+    const uvg_pixel *orig = satd_bufs[test][5][0];
+
+    for (int log_w = 2; log_w <= 5; ++log_w) {
+      for (int log_h = 2; log_h <= 5; ++log_h) {
+        unsigned tested[4] = { 0 };
+        unsigned expected[4] = { 0 };
+        satd_vtm_quad_test_env.tested_func(1 << log_w, 1 << log_h, preds, 32, orig, 32, 4, tested, NULL);
+        satd_vtm_quad_test_env.generic_func(1 << log_w, 1 << log_h, preds, 32, orig, 32, 4, expected, NULL);
+        for (int mode = 0; mode < 4; ++mode) {
+          ASSERT_EQ(tested[mode], expected[mode]);
+          ASSERT_EQ(tested[mode], uvg_satd_any_size_vtm(1 << log_w, 1 << log_h, orig, 32, preds[mode], 32));
+        }
+      }
+    }
+  }
+
+  PASS();
+}
 
 //////////////////////////////////////////////////////////////////////////
 // TEST FIXTURES
@@ -203,11 +317,60 @@ SUITE(satd_tests)
     }
 
     satd_test_env.tested_func = strategies.strategies[i].fptr;
+    satd_test_env.generic_func = NULL;
+    for (unsigned j = 0; j < strategies.count; ++j) {
+      if (strcmp(strategies.strategies[j].type, type) == 0 &&
+          strcmp(strategies.strategies[j].strategy_name, "generic") == 0) {
+        satd_test_env.generic_func = strategies.strategies[j].fptr;
+      }
+    }
 
     // Tests
+#if UVG_BIT_DEPTH == 8
     RUN_TEST(satd_test_black_and_white);
     RUN_TEST(satd_test_checkers);
     RUN_TEST(satd_test_gradient);
+#endif
+    if (satd_test_env.generic_func) {
+      RUN_TEST(satd_test_against_generic);
+    }
+  }
+
+  // Multi-block kernels used by intra rough search.
+  for (volatile unsigned i = 0; i < strategies.count; ++i) {
+    const char * type = strategies.strategies[i].type;
+    void * generic_func = NULL;
+    for (unsigned j = 0; j < strategies.count; ++j) {
+      if (strcmp(strategies.strategies[j].type, type) == 0 &&
+          strcmp(strategies.strategies[j].strategy_name, "generic") == 0) {
+        generic_func = strategies.strategies[j].fptr;
+      }
+    }
+    if (!generic_func) {
+      continue;
+    }
+
+    if (strcmp(type, "satd_any_size_vtm_quad") == 0) {
+      satd_vtm_quad_test_env.tested_func = strategies.strategies[i].fptr;
+      satd_vtm_quad_test_env.generic_func = generic_func;
+      RUN_TEST(satd_vtm_quad_test_against_generic);
+      continue;
+    }
+
+    if (strcmp(type, "satd_4x4_quad") == 0) {
+      satd_quad_test_env.log_width = 2;
+    } else if (strcmp(type, "satd_8x8_quad") == 0) {
+      satd_quad_test_env.log_width = 3;
+    } else if (strcmp(type, "satd_16x16_quad") == 0) {
+      satd_quad_test_env.log_width = 4;
+    } else if (strcmp(type, "satd_32x32_quad") == 0) {
+      satd_quad_test_env.log_width = 5;
+    } else {
+      continue;
+    }
+    satd_quad_test_env.tested_func = strategies.strategies[i].fptr;
+    satd_quad_test_env.generic_func = generic_func;
+    RUN_TEST(satd_quad_test_against_generic);
   }
 
   satd_tear_down_tests();
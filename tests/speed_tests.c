@@ -34,6 +34,7 @@
 
 #include "test_strategies.h"
 
+#include "src/encoderstate.h"
 #include "src/image.h"
 #include "src/threads.h"
 
@@ -68,6 +69,13 @@ static struct test_env_t {
   
   uvg_picture *inter_a;
   uvg_picture *inter_b;
+
+  // Just enough of an encoder state for the ALF kernels.
+  encoder_control_t alf_control;
+  encoder_state_config_tile_t alf_tile;
+  videoframe_t alf_frame;
+  alf_info_t alf_info;
+  encoder_state_t alf_state;
 } test_env;
 
 
@@ -113,6 +121,23 @@ static void setup_tests()
     test_env.inter_a->y[i] = (pattern1 + gradient) % PIXEL_MAX;
     test_env.inter_b->y[i] = (pattern2 + gradient) % PIXEL_MAX;
   }
+  for (unsigned i = 0; i < WIDTH_4K * HEIGHT_4K / 4; ++i) {
+    test_env.inter_a->u[i] = test_env.inter_a->y[i] >> 1;
+    test_env.inter_a->v[i] = test_env.inter_b->y[i] >> 1;
+  }
+
+  test_env.alf_control.bitdepth = UVG_BIT_DEPTH;
+  test_env.alf_control.chroma_format = UVG_CSP_420;
+  test_env.alf_frame.rec = test_env.inter_a;
+  test_env.alf_frame.alf_info = &test_env.alf_info;
+  test_env.alf_info.classifier = malloc(HEIGHT_4K * sizeof(alf_classifier*));
+  test_env.alf_info.classifier[0] = calloc(HEIGHT_4K * WIDTH_4K, sizeof(alf_classifier));
+  for (int y = 1; y < HEIGHT_4K; ++y) {
+    test_env.alf_info.classifier[y] = test_env.alf_info.classifier[0] + y * WIDTH_4K;
+  }
+  test_env.alf_tile.frame = &test_env.alf_frame;
+  test_env.alf_state.encoder_control = &test_env.alf_control;
+  test_env.alf_state.tile = &test_env.alf_tile;
 }
 
 static void tear_down_tests()
@@ -122,6 +147,8 @@ static void tear_down_tests()
   }
   uvg_image_free(test_env.inter_a);
   uvg_image_free(test_env.inter_b);
+  free(test_env.alf_info.classifier[0]);
+  free(test_env.alf_info.classifier);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -208,6 +235,46 @@ TEST test_intra_dual_speed(const int width)
 }
 
 
+TEST test_intra_quad_speed(const int width)
+{
+  const int num_slots = NUM_CHUNKS * 64 * 64 / (32 * 32);
+  uint64_t call_cnt = 0;
+  UVG_CLOCK_T clock_now;
+  UVG_GET_TIME(&clock_now);
+  double test_end = UVG_CLOCK_T_AS_DOUBLE(clock_now) + TIME_PER_TEST;
+
+  // Loop until time allocated for test has passed.
+  for (unsigned i = 0;
+    test_end > UVG_CLOCK_T_AS_DOUBLE(clock_now);
+    ++i)
+  {
+    int test = i % NUM_TESTS;
+    uint64_t sum = 0;
+    // Compare the first block against groups of four predictions laid out
+    // 32x32 samples apart, like in intra search.
+    uvg_pixel * buf1 = &bufs[test][0];
+    for (int slot = 4; slot + 4 <= num_slots; slot += 4) {
+      cost_pixel_nxn_multi_func *tested_func = test_env.tested_func;
+      pred_buffer preds = (pred_buffer)&bufs[test][slot * 32 * 32];
+      unsigned costs[4] = { 0, 0, 0, 0 };
+      tested_func(preds, buf1, 4, costs);
+      sum += costs[0] + costs[1] + costs[2] + costs[3];
+      ++call_cnt;
+    }
+
+    ASSERT(sum > 0);
+    UVG_GET_TIME(&clock_now)
+  }
+
+  double test_time = TIME_PER_TEST + UVG_CLOCK_T_AS_DOUBLE(clock_now) - test_end;
+  sprintf(test_env.msg, "%.3fM x %s:%s",
+    (double)call_cnt / 1000000.0 / test_time,
+    test_env.strategy->type,
+    test_env.strategy->strategy_name);
+  PASSm(test_env.msg);
+}
+
+
 TEST test_inter_speed(const int width, const int height)
 {
   unsigned call_cnt = 0;
@@ -314,6 +381,81 @@ TEST dct_speed(const int width)
 }
 
 
+TEST alf_speed(void)
+{
+  uint64_t call_cnt = 0;
+  encoder_state_t *const state = &test_env.alf_state;
+  const uvg_picture *src = test_env.inter_a;
+  uvg_picture *dst = test_env.inter_b;
+
+  const int vb_ctu_height = LCU_WIDTH;
+  const int vb_pos = LCU_WIDTH - ALF_VB_POS_ABOVE_CTUROW_LUMA;
+  const int vb_ctu_height_c = LCU_WIDTH_C;
+  const int vb_pos_c = LCU_WIDTH_C - ALF_VB_POS_ABOVE_CTUROW_CHMA;
+
+  short coeff[MAX_NUM_ALF_CLASSES * MAX_NUM_ALF_LUMA_COEFF];
+  int16_t clip[MAX_NUM_ALF_CLASSES * MAX_NUM_ALF_LUMA_COEFF];
+  for (int i = 0; i < MAX_NUM_ALF_CLASSES * MAX_NUM_ALF_LUMA_COEFF; ++i) {
+    coeff[i] = (i % MAX_NUM_ALF_LUMA_COEFF == MAX_NUM_ALF_LUMA_COEFF - 1) ? 0 : (i * 7) % 33 - 16;
+    clip[i] = 1 << (2 + i % 7);
+  }
+  const int16_t cc_coeff[MAX_NUM_CC_ALF_CHROMA_COEFF] = { 4, -8, 2, 16, -4, 8, -2 };
+  clp_rngs rngs = { 0 };
+  for (int comp = 0; comp < MAX_NUM_COMPONENT; ++comp) {
+    rngs.comp[comp].bd = UVG_BIT_DEPTH;
+    rngs.comp[comp].max = PIXEL_MAX;
+  }
+
+  UVG_CLOCK_T clock_now;
+  UVG_GET_TIME(&clock_now);
+  double test_end = UVG_CLOCK_T_AS_DOUBLE(clock_now) + TIME_PER_TEST;
+
+  const vector2d_t dims_lcu = { WIDTH_4K / 64 - 2, HEIGHT_4K / 64 - 2 };
+
+  // Loop until time allocated for test has passed.
+  for (uint64_t i = 0;
+      test_end > UVG_CLOCK_T_AS_DOUBLE(clock_now);
+      ++i)
+  {
+    // Filter one of the non-edge LCUs in raster scan order.
+    const int x = (1 + i % dims_lcu.x) * LCU_WIDTH;
+    const int y = (1 + (i / dims_lcu.x) % dims_lcu.y) * LCU_WIDTH;
+
+    if (strcmp(test_env.strategy->type, "alf_derive_classification_blk") == 0) {
+      alf_derive_classification_blk_func *tested_func = test_env.tested_func;
+      for (int blk_y = y; blk_y < y + LCU_WIDTH; blk_y += CLASSIFICATION_BLK_SIZE) {
+        for (int blk_x = x; blk_x < x + LCU_WIDTH; blk_x += CLASSIFICATION_BLK_SIZE) {
+          tested_func(state, UVG_BIT_DEPTH + 4, CLASSIFICATION_BLK_SIZE, CLASSIFICATION_BLK_SIZE,
+            blk_x, blk_y, blk_x, blk_y, vb_ctu_height, vb_pos);
+        }
+      }
+    } else if (strcmp(test_env.strategy->type, "alf_filter_7x7_blk") == 0) {
+      alf_filter_7x7_blk_func *tested_func = test_env.tested_func;
+      tested_func(state, src->y, dst->y, src->stride, dst->stride, coeff, clip, rngs.comp[COMPONENT_Y],
+        LCU_WIDTH, LCU_WIDTH, x, y, x, y, vb_pos, vb_ctu_height);
+    } else if (strcmp(test_env.strategy->type, "alf_filter_5x5_blk") == 0) {
+      alf_filter_5x5_blk_func *tested_func = test_env.tested_func;
+      tested_func(state, src->u, dst->u, src->stride >> 1, dst->stride >> 1, coeff, clip, rngs.comp[COMPONENT_Cb],
+        LCU_WIDTH_C, LCU_WIDTH_C, x >> 1, y >> 1, x >> 1, y >> 1, vb_pos_c, vb_ctu_height_c);
+    } else {
+      alf_filter_cc_blk_func *tested_func = test_env.tested_func;
+      tested_func(state, dst->u, src->y, src->stride, COMPONENT_Cb, cc_coeff, rngs,
+        vb_ctu_height, vb_pos, x >> 1, y >> 1, LCU_WIDTH_C, LCU_WIDTH_C);
+    }
+    ++call_cnt;
+
+    UVG_GET_TIME(&clock_now)
+  }
+
+  double test_time = TIME_PER_TEST + UVG_CLOCK_T_AS_DOUBLE(clock_now) - test_end;
+  sprintf(test_env.msg, "%.3fM x %s(LCU):%s",
+    (double)call_cnt / 1000000.0 / test_time,
+    test_env.strategy->type,
+    test_env.strategy->strategy_name);
+  PASSm(test_env.msg);
+}
+
+
 TEST intra_sad(void)
 {
   return test_intra_speed(test_env.width);
@@ -326,6 +468,12 @@ TEST intra_sad_dual(void)
 }
 
 
+TEST intra_sad_quad(void)
+{
+  return test_intra_quad_speed(test_env.width);
+}
+
+
 TEST intra_satd(void)
 {
   return test_intra_speed(test_env.width);
@@ -338,6 +486,12 @@ TEST intra_satd_dual(void)
 }
 
 
+TEST intra_satd_quad(void)
+{
+  return test_intra_quad_speed(test_env.width);
+}
+
+
 TEST inter_sad(void)
 {
   return test_inter_speed(test_env.width, test_env.height);
@@ -402,12 +556,16 @@ SUITE(speed_tests)
         RUN_TEST(intra_satd);
       } else if (strstr(strategy->type, "_dual")) {
         RUN_TEST(intra_satd_dual);
+      } else if (strstr(strategy->type, "_quad") && test_env.width != 0) {
+        RUN_TEST(intra_satd_quad);
       }
     } else if (strncmp(strategy->type, "sad_", 4) == 0) {
       if (strlen(strategy->type) <= 9) {
         RUN_TEST(intra_sad);
       } else if (strstr(strategy->type, "_dual")) {
         RUN_TEST(intra_sad_dual);
+      } else if (strstr(strategy->type, "_quad") && test_env.width != 0) {
+        RUN_TEST(intra_sad_quad);
       }
     } else if (strcmp(strategy->type, "reg_sad") == 0) {
       static const vector2d_t tested_dims[] = { 
@@ -432,6 +590,10 @@ SUITE(speed_tests)
                strcmp(strategy->type, "fast_inverse_dst_4x4") == 0)
     {
       RUN_TEST(idct);
+    } else if (strcmp(strategy->type, "alf_derive_classification_blk") == 0 ||
+               strncmp(strategy->type, "alf_filter_", 11) == 0)
+    {
+      RUN_TEST(alf_speed);
     }
   }
 
@@ -62,4 +62,19 @@ void init_test_strategies()
     fprintf(stderr, "strategy_register_quant failed!\n");
     return;
   }
+
+  if (!uvg_strategy_register_alf(&strategies, UVG_BIT_DEPTH)) {
+    fprintf(stderr, "strategy_register_alf failed!\n");
+    return;
+  }
+
+  if (!uvg_strategy_register_intra(&strategies, UVG_BIT_DEPTH)) {
+    fprintf(stderr, "strategy_register_intra failed!\n");
+    return;
+  }
+
+  if (!uvg_strategy_register_ipol(&strategies, UVG_BIT_DEPTH)) {
+    fprintf(stderr, "strategy_register_ipol failed!\n");
+    return;
+  }
 }
@@ -35,44 +35,52 @@
 #include "test_strategies.h"
 
 GREATEST_MAIN_DEFS();
-#if UVG_BIT_DEPTH == 8
 extern SUITE(sad_tests);
 extern SUITE(intra_sad_tests);
 extern SUITE(satd_tests);
 extern SUITE(speed_tests);
 extern SUITE(dct_tests);
 extern SUITE(mts_tests);
-#endif //UVG_BIT_DEPTH == 8
+extern SUITE(intra_pred_tests);
 
 extern SUITE(coeff_sum_tests);
+extern SUITE(ipol_tests);
+extern SUITE(quant_tests);
 extern SUITE(mv_cand_tests);
 extern SUITE(inter_recon_bipred_tests);
+extern SUITE(alf_tests);
+extern SUITE(crc_tests);
 
 int main(int argc, char **argv)
 {
   GREATEST_MAIN_BEGIN();
 
   init_test_strategies(1);
-#if UVG_BIT_DEPTH == 8
   RUN_SUITE(sad_tests);
   RUN_SUITE(intra_sad_tests);
   RUN_SUITE(satd_tests);
   RUN_SUITE(dct_tests);
   RUN_SUITE(mts_tests);
+  RUN_SUITE(intra_pred_tests);
 
   if (greatest_info.suite_filter &&
       greatest_name_match("speed", greatest_info.suite_filter))
   {
     RUN_SUITE(speed_tests);
   }
-#else
-  printf("10-bit tests are not yet supported\n");
-#endif //UVG_BIT_DEPTH == 8
 
   RUN_SUITE(coeff_sum_tests);
 
+  RUN_SUITE(ipol_tests);
+
+  RUN_SUITE(quant_tests);
+
   RUN_SUITE(mv_cand_tests);
 
+  RUN_SUITE(alf_tests);
+
+  RUN_SUITE(crc_tests);
+
   // Doesn't work in git
   //RUN_SUITE(inter_recon_bipred_tests);
 